@@ -36,11 +36,15 @@
 #include "GateOutputMgr.hh"
 #include "GatePrimaryGeneratorAction.hh"
 #include "GateUserActions.hh"
+#ifdef GATE_USE_MT
+#include "GateActionInitialization.hh"
+#endif
 #include "GateDigitizer.hh"
 #include "GateClock.hh"
 #include "GateUIcontrolMessenger.hh"
 #ifdef G4ANALYSIS_USE_ROOT
 #include "TPluginManager.h"
+#include "TROOT.h"
 #include "GateHitFileReader.hh"
 #endif
 #ifdef G4VIS_USE
@@ -188,6 +192,10 @@ int main( int argc, char* argv[] )
   // http://root.cern.ch/root/roottalk/roottalk08/0690.html
   // DS.
   gROOT->GetPluginManager()->AddHandler( "TVirtualStreamerInfo", "*", "TStreamerInfo", "RIO", "TStreamerInfo()" );
+
+  // ROOT files are read by several threads (ARF tables, phase-space
+  // read-ahead): this must be done before any TFile/TTree is created
+  ROOT::EnableThreadSafety();
 #endif
 
   GateSteppingVerbose* verbosity = new GateSteppingVerbose;
@@ -287,7 +295,12 @@ int main( int argc, char* argv[] )
   runManager->SetUserInitialization( GatePhysicsList::GetInstance() );
 
   // Set the users actions to handle callback for actors - before the initialisation
+#ifdef GATE_USE_MT
+  // (one set per worker thread, the generator is also created there)
+  runManager->SetUserInitialization( new GateActionInitialization );
+#else
   new GateUserActions( runManager);
+#endif
 
   // Set the Visualization Manager
 #ifdef G4VIS_USE
@@ -301,7 +314,9 @@ int main( int argc, char* argv[] )
   runManager->InitializeAll();
 
   // Incorporate the user actions, set the particles generator
+#ifndef GATE_USE_MT
   runManager->SetUserAction( new GatePrimaryGeneratorAction() );
+#endif
 
   // Create various singleton objets
 #ifdef G4ANALYSIS_USE_GENERAL
@@ -27,7 +27,9 @@ void showhelp(){
  cout<<"  Usage: gjm [-options] your_file.split"<<endl;
  cout<<endl;
  cout<<"  You may give the name of the split file created by gjs (see inside the .Gate directory)."<<endl;
- cout<<"  !! This merger is only designed to ROOT output. !!"<<endl;
+ cout<<"  !! This merger is only designed to ROOT output and to the MHD images of the actors. !!"<<endl;
+ cout<<"  The images are summed, the uncertainty images are computed from the summed images"<<endl;
+ cout<<"  with the number of events given by a SimulationStatisticActor."<<endl;
  cout<<endl;
  cout<<"  Options: "<<endl;
  cout<<"  -outDir path              : where to save the output files default is PWD"<<endl;
@@ -41,6 +43,7 @@ void showhelp(){
  cout<<"  -cleanonlyTest            : just tells you what will be erased by the -cleanonly"<<endl;
  cout<<"  -clean                    : merge and then do the cleanup automatically"<<endl;
  cout<<"  -fastMerge                : correct the output in each file, to be used with a TChain (only for Root output)"<<endl;
+ cout<<"  -j n                      : number of images merged at the same time - 1 default"<<endl;
  cout<<endl;
  cout<<"  Environment variable: "<<endl;
  cout<<"  GC_DOT_GATE_DIR : points to the .Gate directory"<<endl<<endl;
@@ -58,6 +61,7 @@ int main(int argc,char** argv)
   bool          test   = false;
   bool          merge  = true;
   bool       fastMerge = false;
+  int         nThreads = 1;
 
   // Parse the command line
   if (argc==1) showhelp();
@@ -87,6 +91,13 @@ int main(int argc,char** argv)
        test  = true;
     } else if (!strcmp(argv[nextArg],"-fastMerge")){
        fastMerge=true;
+    } else if (!strcmp(argv[nextArg],"-j") && (nextArg+1)<argc){
+       nextArg++;
+       if(!isdigit(argv[nextArg][0]) ) {
+          cout<<"-j "<<argv[nextArg]<<" That's not a number!"<<endl;
+          exit(0);
+       }
+       nThreads=atoi(argv[nextArg]);
     } else if (!strcmp(argv[nextArg],"-cleanonly")){
        clean = true;
        merge = false;
@@ -139,6 +150,7 @@ int main(int argc,char** argv)
 
   //create a merge manager
   GateMergeManager* manager = new GateMergeManager(fastMerge,verboseLevel,forced,maxRoot,outDir);
+  manager->SetNumberOfThreads(nThreads);
 
   if(merge) manager->StartMerging(splitfileName);
   if(clean) manager->StartCleaning(splitfileName,test);
@@ -0,0 +1,69 @@
+/*----------------------
+   GATE version name: gate_v...
+
+   Copyright (C): OpenGATE Collaboration
+
+This software is distributed under the terms
+of the GNU Lesser General  Public Licence (LGPL)
+See GATE/LICENSE.txt for further details
+----------------------*/
+
+
+#ifndef GateMHDMerger_h
+#define GateMHDMerger_h 1
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Header of an uncompressed MHD image (as written by GATE)
+struct GateMHDHeader
+{
+  std::vector<std::string> lines;   // header lines, ElementDataFile excluded
+  std::string        elementType;   // MET_FLOAT, MET_DOUBLE...
+  size_t             elementSize;   // in bytes
+  bool                       msb;   // big endian data
+  long long             nValues;   // number of voxels
+  std::string            rawName;   // data file, with the path of the header
+};
+
+// Sums the MHD images of the parallel jobs, by chunks of voxels so that the
+// memory used does not depend on the image size nor on the number of jobs.
+class GateMHDMerger
+{
+public:
+
+  GateMHDMerger(int verboseLevel,long long chunkSize=1<<20){
+     m_verboseLevel = verboseLevel;
+     m_chunkSize    =    chunkSize;
+  };
+
+  // output = sum of the inputs
+  bool Sum(const std::vector<std::string>& inputs,std::string output);
+
+  // value and squared images are summed and the relative uncertainty is
+  // computed from the sums, as GateImageWithStatistic::UpdateUncertaintyImage.
+  // When the squared images were not saved they are recovered from the
+  // uncertainty images of the jobs, which needs the events of each job.
+  // outSquared and outUncertainty may be empty.
+  bool SumWithUncertainty(const std::vector<std::string>& values,
+                          const std::vector<std::string>& squared,
+                          const std::vector<std::string>& uncertainties,
+                          const std::vector<long long>& nEvents,
+                          std::string outValue,std::string outSquared,std::string outUncertainty);
+
+  static bool ReadHeader(std::string name,GateMHDHeader& header);
+
+private:
+  bool ReadHeaders(const std::vector<std::string>& names,std::vector<GateMHDHeader>& headers);
+  bool ReadChunk(const GateMHDHeader& header,long long first,long long n,std::vector<double>& values);
+  bool WriteChunk(const GateMHDHeader& header,FILE* file,const std::vector<double>& values,long long n);
+  FILE* CreateImage(const GateMHDHeader& header,std::string name);
+  static std::string RawName(std::string name);
+
+  int              m_verboseLevel;
+  long long           m_chunkSize;  // number of voxels read at once
+  std::vector<char>      m_buffer;  // raw data of a chunk
+};
+
+
+#endif
@@ -29,6 +29,8 @@ public:
      m_outDir       =       outDir;
      m_CompLevel    =            1;
      m_fastMerge    =    fastMerge;
+     m_nThreads     =            1;
+     filearr        =            0;
 
      //check if a .Gate directory can be found
      if (!getenv("GC_DOT_GATE_DIR")) {
@@ -64,12 +66,18 @@ public:
 
   // the merging methods
   void MergeRoot();
+  void MergeImages();
+
+  // number of images merged at the same time
+  void SetNumberOfThreads(int n) { m_nThreads = n>0 ? n : 1; };
 
 private:
   void FastMergeRoot(); 
   bool FastMergeGate(std::string name);
   bool FastMergeSing(std::string name);
   bool FastMergeCoin(std::string name); 
+  long long ReadNumberOfEvents(std::string statFileName);
+  std::string OutputName(std::string name);
   bool                 m_forced;             // if to overwrite existing files
   int            m_verboseLevel;  
   TFile**               filearr;
@@ -83,6 +91,12 @@ private:
   TFile*           m_RootTarget;             // root output file
   std::string  m_RootTargetName;             // name of target i.e. root output file
   bool              m_fastMerge;             // fast merge option, corrects the eventIDs locally
+  int                m_nThreads;             // for the image merging
+  std::vector<std::string> m_vActorTypes;    // type of the actors saving a file
+  std::vector<std::string> m_vActorTargetNames;             // original file name of each actor
+  std::vector<std::string> m_vActorNames;                   // name of each actor in the macro
+  std::vector<std::string> m_vNormalisedActors;             // actors normalising their images
+  std::vector<std::vector<std::string> > m_vActorFileNames; // file names of each actor in the jobs
 };
 
 
@@ -0,0 +1,335 @@
+/*----------------------
+   GATE version name: gate_v...
+
+   Copyright (C): OpenGATE Collaboration
+
+This software is distributed under the terms
+of the GNU Lesser General  Public Licence (LGPL)
+See GATE/LICENSE.txt for further details
+----------------------*/
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "GateMHDMerger.hh"
+
+using namespace std;
+
+namespace {
+
+bool HostIsMSB(){
+  const unsigned short one=1;
+  return *((const unsigned char*)&one)==0;
+}
+
+template<class T> void ToDouble(const char* raw,long long n,vector<double>& values){
+  for(long long i=0;i<n;i++){
+     T v;
+     memcpy(&v,raw+i*sizeof(T),sizeof(T));
+     values[i]=(double)v;
+  }
+}
+
+template<class T> void FromDouble(const vector<double>& values,long long n,char* raw){
+  for(long long i=0;i<n;i++){
+     T v;
+     if(std::numeric_limits<T>::is_integer) v=(T)floor(values[i]+0.5);
+     else v=(T)values[i];
+     memcpy(raw+i*sizeof(T),&v,sizeof(T));
+  }
+}
+
+void SwapBytes(char* raw,long long n,size_t size){
+  if(size<2) return;
+  for(long long i=0;i<n;i++) reverse(raw+i*size,raw+(i+1)*size);
+}
+
+}
+
+/************************************************************************************/
+string GateMHDMerger::RawName(string name){
+  const size_t pos=name.rfind('.');
+  const size_t dir=name.rfind('/');
+  if(pos==string::npos || (dir!=string::npos && pos<dir)) return name+".raw";
+  return name.substr(0,pos)+".raw";
+}
+
+/************************************************************************************/
+bool GateMHDMerger::ReadHeader(string name,GateMHDHeader& header){
+
+  ifstream mhd(name.c_str());
+  if(!mhd){
+     cout<<"Can't open image: "<<name<<endl;
+     return false;
+  }
+
+  header.lines.clear();
+  header.elementType="";
+  header.elementSize=0;
+  header.msb=false;
+  header.nValues=0;
+  header.rawName="";
+
+  string line;
+  while(getline(mhd,line)){
+     const size_t eq=line.find('=');
+     if(eq==string::npos) continue;
+     stringstream sskey(line.substr(0,eq));
+     string key;
+     sskey>>key;
+     stringstream ssvalue(line.substr(eq+1));
+     if(key=="ElementDataFile"){
+        string raw;
+        ssvalue>>raw;
+        if(raw=="LOCAL" || raw=="LIST" || raw.find('%')!=string::npos){
+           cout<<"Only images with a separate data file can be merged: "<<name<<endl;
+           return false;
+        }
+        const size_t pos=name.rfind('/');
+        if(raw[0]!='/' && pos!=string::npos) raw=name.substr(0,pos+1)+raw;
+        header.rawName=raw;
+        continue;
+     }
+     header.lines.push_back(line);
+     if(key=="DimSize"){
+        header.nValues=1;
+        long long d;
+        while(ssvalue>>d) header.nValues*=d;
+     } else if(key=="ElementType"){
+        ssvalue>>header.elementType;
+     } else if(key=="BinaryDataByteOrderMSB" || key=="ElementByteOrderMSB"){
+        string v;
+        ssvalue>>v;
+        header.msb=(v=="True"||v=="true"||v=="1");
+     } else if(key=="CompressedData"){
+        string v;
+        ssvalue>>v;
+        if(v=="True"||v=="true"||v=="1"){
+           cout<<"Compressed images can not be merged: "<<name<<endl;
+           return false;
+        }
+     } else if(key=="ElementNumberOfChannels"){
+        int c=1;
+        ssvalue>>c;
+        if(c!=1){
+           cout<<"Only images with one channel can be merged: "<<name<<endl;
+           return false;
+        }
+     }
+  }
+
+  const string& t=header.elementType;
+  if(t=="MET_CHAR"||t=="MET_UCHAR")        header.elementSize=1;
+  else if(t=="MET_SHORT"||t=="MET_USHORT") header.elementSize=2;
+  else if(t=="MET_INT"||t=="MET_UINT")     header.elementSize=4;
+  else if(t=="MET_FLOAT")                  header.elementSize=4;
+  else if(t=="MET_DOUBLE")                 header.elementSize=8;
+  if(header.elementSize==0 || header.nValues<=0 || header.rawName==""){
+     cout<<"Not a supported MHD image: "<<name<<endl;
+     return false;
+  }
+  return true;
+}
+
+/************************************************************************************/
+bool GateMHDMerger::ReadHeaders(const vector<string>& names,vector<GateMHDHeader>& headers){
+  headers.resize(names.size());
+  for(unsigned int i=0;i<names.size();i++){
+     if(!ReadHeader(names[i],headers[i])) return false;
+     if(headers[i].nValues!=headers[0].nValues || headers[i].elementType!=headers[0].elementType){
+        cout<<"Image "<<names[i]<<" does not match "<<names[0]<<endl;
+        return false;
+     }
+  }
+  return true;
+}
+
+/************************************************************************************/
+// writes the header and opens the (empty) data file
+FILE* GateMHDMerger::CreateImage(const GateMHDHeader& header,string name){
+  const string raw=RawName(name);
+  ofstream mhd(name.c_str());
+  if(!mhd){
+     cout<<"Can't create image: "<<name<<endl;
+     return 0;
+  }
+  for(unsigned int i=0;i<header.lines.size();i++) mhd<<header.lines[i]<<endl;
+  const size_t pos=raw.rfind('/');
+  mhd<<"ElementDataFile = "<<(pos==string::npos ? raw : raw.substr(pos+1))<<endl;
+  mhd.close();
+
+  FILE* file=fopen(raw.c_str(),"wb");
+  if(!file) cout<<"Can't create image data: "<<raw<<endl;
+  return file;
+}
+
+/************************************************************************************/
+bool GateMHDMerger::ReadChunk(const GateMHDHeader& header,long long first,long long n,vector<double>& values){
+  // the file is opened for each chunk: there may be more jobs than allowed open files
+  FILE* file=fopen(header.rawName.c_str(),"rb");
+  if(!file){
+     cout<<"Can't open image data: "<<header.rawName<<endl;
+     return false;
+  }
+  m_buffer.resize(n*header.elementSize);
+  bool ok=(fseeko(file,(off_t)(first*header.elementSize),SEEK_SET)==0)
+        &&(fread(&m_buffer[0],header.elementSize,n,file)==(size_t)n);
+  fclose(file);
+  if(!ok){
+     cout<<"Can't read image data: "<<header.rawName<<endl;
+     return false;
+  }
+
+  if(header.msb!=HostIsMSB()) SwapBytes(&m_buffer[0],n,header.elementSize);
+  const string& t=header.elementType;
+  if(t=="MET_FLOAT")       ToDouble<float>(&m_buffer[0],n,values);
+  else if(t=="MET_DOUBLE") ToDouble<double>(&m_buffer[0],n,values);
+  else if(t=="MET_INT")    ToDouble<int>(&m_buffer[0],n,values);
+  else if(t=="MET_UINT")   ToDouble<unsigned int>(&m_buffer[0],n,values);
+  else if(t=="MET_SHORT")  ToDouble<short>(&m_buffer[0],n,values);
+  else if(t=="MET_USHORT") ToDouble<unsigned short>(&m_buffer[0],n,values);
+  else if(t=="MET_CHAR")   ToDouble<signed char>(&m_buffer[0],n,values);
+  else                     ToDouble<unsigned char>(&m_buffer[0],n,values);
+  return true;
+}
+
+/************************************************************************************/
+bool GateMHDMerger::WriteChunk(const GateMHDHeader& header,FILE* file,const vector<double>& values,long long n){
+  m_buffer.resize(n*header.elementSize);
+  const string& t=header.elementType;
+  if(t=="MET_FLOAT")       FromDouble<float>(values,n,&m_buffer[0]);
+  else if(t=="MET_DOUBLE") FromDouble<double>(values,n,&m_buffer[0]);
+  else if(t=="MET_INT")    FromDouble<int>(values,n,&m_buffer[0]);
+  else if(t=="MET_UINT")   FromDouble<unsigned int>(values,n,&m_buffer[0]);
+  else if(t=="MET_SHORT")  FromDouble<short>(values,n,&m_buffer[0]);
+  else if(t=="MET_USHORT") FromDouble<unsigned short>(values,n,&m_buffer[0]);
+  else if(t=="MET_CHAR")   FromDouble<signed char>(values,n,&m_buffer[0]);
+  else                     FromDouble<unsigned char>(values,n,&m_buffer[0]);
+  if(header.msb!=HostIsMSB()) SwapBytes(&m_buffer[0],n,header.elementSize);
+  if(fwrite(&m_buffer[0],header.elementSize,n,file)!=(size_t)n){
+     cout<<"Can't write image data"<<endl;
+     return false;
+  }
+  return true;
+}
+
+/************************************************************************************/
+bool GateMHDMerger::Sum(const vector<string>& inputs,string output){
+
+  vector<GateMHDHeader> headers;
+  if(inputs.empty() || !ReadHeaders(inputs,headers)) return false;
+
+  FILE* out=CreateImage(headers[0],output);
+  if(!out) return false;
+
+  const long long nValues=headers[0].nValues;
+  vector<double> sum(m_chunkSize);
+  vector<double> values(m_chunkSize);
+  bool ok=true;
+  for(long long first=0;ok && first<nValues;first+=m_chunkSize){
+     const long long n=min(m_chunkSize,nValues-first);
+     fill(sum.begin(),sum.begin()+n,0.);
+     for(unsigned int j=0;ok && j<headers.size();j++){
+        ok=ReadChunk(headers[j],first,n,values);
+        for(long long i=0;ok && i<n;i++) sum[i]+=values[i];
+     }
+     if(ok) ok=WriteChunk(headers[0],out,sum,n);
+  }
+  fclose(out);
+  if(ok && m_verboseLevel>1) cout<<"Merged "<<inputs.size()<<" images into "<<output<<endl;
+  return ok;
+}
+
+/************************************************************************************/
+bool GateMHDMerger::SumWithUncertainty(const vector<string>& values,
+                                       const vector<string>& squared,
+                                       const vector<string>& uncertainties,
+                                       const vector<long long>& nEvents,
+                                       string outValue,string outSquared,string outUncertainty){
+
+  const bool hasSquared=!squared.empty();
+  vector<GateMHDHeader> vHeaders, sHeaders, uHeaders;
+  if(values.empty() || !ReadHeaders(values,vHeaders)) return false;
+  if(hasSquared && !ReadHeaders(squared,sHeaders)) return false;
+  if(!uncertainties.empty() && !ReadHeaders(uncertainties,uHeaders)) return false;
+  if(!hasSquared && (uHeaders.size()!=values.size() || nEvents.size()!=values.size())){
+     cout<<"Squared images or uncertainty images and events of each job are needed for "<<outValue<<endl;
+     return false;
+  }
+  if((hasSquared && sHeaders[0].nValues!=vHeaders[0].nValues)
+     ||(!uHeaders.empty() && uHeaders[0].nValues!=vHeaders[0].nValues)){
+     cout<<"Images of different sizes for "<<outValue<<endl;
+     return false;
+  }
+  long long N=0;
+  for(unsigned int j=0;j<nEvents.size();j++) N+=nEvents[j];
+  if(outUncertainty!="" && (N<=0 || uHeaders.empty())){
+     cout<<"Unknown number of events, uncertainty not computed for "<<outValue<<endl;
+     outUncertainty="";
+  }
+
+  FILE* vOut=CreateImage(vHeaders[0],outValue);
+  FILE* sOut=0;
+  FILE* uOut=0;
+  if(vOut && outSquared!="") sOut=CreateImage(hasSquared ? sHeaders[0] : vHeaders[0],outSquared);
+  if(vOut && outUncertainty!="") uOut=CreateImage(uHeaders[0],outUncertainty);
+  bool ok=vOut && (outSquared=="" || sOut) && (outUncertainty=="" || uOut);
+
+  const long long nValues=vHeaders[0].nValues;
+  vector<double> vSum(m_chunkSize), sSum(m_chunkSize), uChunk(m_chunkSize);
+  vector<double> v(m_chunkSize), s(m_chunkSize), u(m_chunkSize);
+  for(long long first=0;ok && first<nValues;first+=m_chunkSize){
+     const long long n=min(m_chunkSize,nValues-first);
+     fill(vSum.begin(),vSum.begin()+n,0.);
+     fill(sSum.begin(),sSum.begin()+n,0.);
+     for(unsigned int j=0;ok && j<vHeaders.size();j++){
+        ok=ReadChunk(vHeaders[j],first,n,v);
+        if(ok && hasSquared) ok=ReadChunk(sHeaders[j],first,n,s);
+        else if(ok){
+           // squared sum recovered from the relative uncertainty of the job:
+           // u^2 = (S/N - (V/N)^2) / ((N-1) (V/N)^2)
+           ok=ReadChunk(uHeaders[j],first,n,u);
+           const double Nj=nEvents[j];
+           for(long long i=0;ok && i<n;i++){
+              if(v[i]==0.)   s[i]=0.;
+              else if(Nj<=1) s[i]=v[i]*v[i];
+              else           s[i]=v[i]*v[i]*(1.0+u[i]*u[i]*(Nj-1.0))/Nj;
+           }
+        }
+        for(long long i=0;ok && i<n;i++){
+           vSum[i]+=v[i];
+           sSum[i]+=s[i];
+        }
+     }
+     if(ok) ok=WriteChunk(vHeaders[0],vOut,vSum,n);
+     if(ok && sOut) ok=WriteChunk(hasSquared ? sHeaders[0] : vHeaders[0],sOut,sSum,n);
+     if(ok && uOut){
+        // same as GateImageWithStatistic::UpdateUncertaintyImage
+        for(long long i=0;i<n;i++){
+           const double mean=vSum[i];
+           const double sq=sSum[i];
+           if(mean!=0.0 && N!=1 && sq!=0.0){
+              const double var=max(0.0,sq/N-pow(mean/N,2));
+              uChunk[i]=sqrt((1.0/(N-1))*var)/(mean/N);
+           }
+           else uChunk[i]=1;
+        }
+        ok=WriteChunk(uHeaders[0],uOut,uChunk,n);
+     }
+  }
+  if(vOut) fclose(vOut);
+  if(sOut) fclose(sOut);
+  if(uOut) fclose(uOut);
+  if(ok && m_verboseLevel>1) cout<<"Merged "<<values.size()<<" images into "<<outValue
+                                 <<(outUncertainty!="" ? " (with uncertainty)" : "")<<endl;
+  return ok;
+}
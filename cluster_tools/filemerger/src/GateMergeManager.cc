@@ -30,7 +30,12 @@ See GATE/LICENSE.txt for further details
 #include <cstdlib>
 #include <cmath>
 
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
 #include "GateMergeManager.hh"
+#include "GateMHDMerger.hh"
 
 using namespace std;
 
@@ -39,8 +44,11 @@ void GateMergeManager::StartMerging(string splitfileName){
   // get the files to merge
   ReadSplitFile(splitfileName);
   //do the merging
-  if (m_fastMerge==true) FastMergeRoot();
-  else MergeRoot();
+  if(m_vRootFileNames.size()>0 || m_vActorTargetNames.size()==0){
+     if (m_fastMerge==true) FastMergeRoot();
+     else MergeRoot();
+  }
+  if(m_vActorTargetNames.size()>0) MergeImages();
 
   //if we are here the merging has been successful
   //we mark the directory as ready for cleanup
@@ -76,8 +84,35 @@ void GateMergeManager::ReadSplitFile(string splitfileName){
 
   // now we look for the file names
   int iRoot=0;
+  vector<string> actorFileNames;
   while(splitfile){
      splitfile.getline(cline,512);
+     // actor output files: one line per actor and per job
+     if(!strncmp(cline,"Original Actor filename:",24)){
+        stringstream ssactor(cline+24);
+        string type, name, actorName;
+        ssactor>>type>>name>>actorName;
+        m_vActorTypes.push_back(type);
+        m_vActorTargetNames.push_back(name);
+        m_vActorNames.push_back(actorName);
+        if(m_verboseLevel>2) cout<<"Actor output file name: "<<name<<endl;
+        continue;
+     }
+     if(!strncmp(cline,"Normalised Actor:",17)){
+        stringstream ssactor(cline+17);
+        string actorName;
+        ssactor>>actorName;
+        m_vNormalisedActors.push_back(actorName);
+        continue;
+     }
+     if(!strncmp(cline,"Actor filename:",15)){
+        stringstream ssactor(cline+15);
+        string type, name;
+        ssactor>>type>>name;
+        actorFileNames.push_back(name);
+        if(m_verboseLevel>2) cout<<"Actor input file name: "<<name<<endl;
+        continue;
+     }
      // check for root
      // input files
      if(!strncmp(cline,"Root filename:",14)){
@@ -106,6 +141,18 @@ void GateMergeManager::ReadSplitFile(string splitfileName){
        cout<<"Inconsistent number of root file entries in split file!"<<endl;
        exit(0);
   }
+
+  // the actors save their files in the same order in each job
+  const unsigned int nActors=m_vActorTargetNames.size();
+  if(actorFileNames.size()!=nActors*m_Nfiles) {
+       if(nActors>0) cout<<"Inconsistent number of actor file entries in split file - actor outputs not merged!"<<endl;
+       m_vActorTypes.clear();
+       m_vActorTargetNames.clear();
+       m_vActorNames.clear();
+  }
+  m_vActorFileNames.assign(m_vActorTargetNames.size(),vector<string>(m_Nfiles));
+  for(unsigned int k=0;k<m_vActorTargetNames.size();k++)
+     for(int j=0;j<m_Nfiles;j++) m_vActorFileNames[k][j]=actorFileNames[j*nActors+k];
 }
 
 /************************************************************************************/
@@ -750,3 +797,205 @@ bool GateMergeManager::MergeCoin(TChain* chainC){
     return true;
 }
 /*******************************************************************************************/
+
+/*******************************************************************************************/
+// replace the path with outDir if the option is used
+string GateMergeManager::OutputName(string name){
+  if(m_outDir=="") return name;
+  size_t pos=name.rfind('/',name.length());
+  if(pos==string::npos) pos=-1;
+  return m_outDir+name.substr(pos+1);
+}
+
+/*******************************************************************************************/
+// number of events of a job, read in the output of a SimulationStatisticActor
+long long GateMergeManager::ReadNumberOfEvents(string statFileName){
+  ifstream stat(statFileName.c_str());
+  string line;
+  while(getline(stat,line)){
+     const size_t pos=line.find("NumberOfEvents");
+     const size_t eq=line.find('=');
+     if(pos!=string::npos && eq!=string::npos && eq>pos) return atoll(line.c_str()+eq+1);
+  }
+  cout<<"Can't read the number of events in "<<statFileName<<endl;
+  return -1;
+}
+
+/*******************************************************************************************/
+// images of the actors (MHD): the images of the jobs are summed voxel by voxel and
+// the uncertainty is computed again from the summed values and squared values, with
+// the total number of events. Each image is merged by one thread.
+struct GateImageMergeTask
+{
+  std::vector<std::string> values;
+  std::vector<std::string> squared;
+  std::vector<std::string> uncertainties;
+  std::string outValue;
+  std::string outSquared;
+  std::string outUncertainty;
+  bool withUncertainty;
+};
+
+void GateMergeManager::MergeImages(){
+
+  // events of each job
+  vector<long long> nEvents;
+  for(unsigned int k=0;k<m_vActorTypes.size() && nEvents.empty();k++){
+     if(m_vActorTypes[k]!="SimulationStatisticActor") continue;
+     nEvents.resize(m_Nfiles);
+     for(int j=0;j<m_Nfiles;j++){
+        nEvents[j]=ReadNumberOfEvents(m_vActorFileNames[k][j]);
+        if(nEvents[j]<0) {
+           nEvents.clear();
+           break;
+        }
+     }
+  }
+  if(nEvents.empty() && m_verboseLevel>0)
+     cout<<"No SimulationStatisticActor output - the uncertainty images will not be merged"<<endl;
+
+  // the images saved by each actor: file name of the actor with an optional suffix (-Dose, -Edep-Squared...)
+  vector<GateImageMergeTask> tasks;
+  int nRefused=0;
+  for(unsigned int k=0;k<m_vActorTargetNames.size();k++){
+     const string& target=m_vActorTargetNames[k];
+     if(target.length()<4 || target.substr(target.length()-4)!=".mhd") {
+        if(m_verboseLevel>1 && m_vActorTypes[k]!="SimulationStatisticActor")
+           cout<<"Not an image, not merged: "<<target<<endl;
+        continue;
+     }
+     // each job divided its image by its own maximum or integral: the
+     // scale of the jobs is lost and their sum is meaningless
+     if(find(m_vNormalisedActors.begin(),m_vNormalisedActors.end(),m_vActorNames[k])!=m_vNormalisedActors.end()){
+        cout<<"The images of the actor "<<m_vActorNames[k]<<" are normalised in each job - "<<target
+            <<" not merged. Disable the normalisation and normalise the merged image."<<endl;
+        nRefused++;
+        continue;
+     }
+     const string targetBase=target.substr(0,target.length()-4);
+     const string firstBase=m_vActorFileNames[k][0].substr(0,m_vActorFileNames[k][0].length()-4);
+
+     vector<string> suffixes;
+     glob_t globbuf;
+     const string pattern=firstBase+"*.mhd";
+     if(glob(pattern.c_str(),0,NULL,&globbuf)==0){
+        for(size_t i=0;i<globbuf.gl_pathc;i++){
+           string suffix=globbuf.gl_pathv[i];
+           suffix=suffix.substr(firstBase.length(),suffix.length()-firstBase.length()-4);
+           // dose1*.mhd also matches dose10-Dose.mhd
+           if(suffix=="" || suffix[0]=='-') suffixes.push_back(suffix);
+        }
+     }
+     globfree(&globbuf);
+     if(suffixes.empty()) {
+        cout<<"No image found for "<<pattern<<endl;
+        continue;
+     }
+
+     // all jobs must have the images of the first job
+     vector<string> complete;
+     for(unsigned int i=0;i<suffixes.size();i++){
+        bool found=true;
+        for(int j=0;j<m_Nfiles && found;j++){
+           const string& name=m_vActorFileNames[k][j];
+           ifstream image((name.substr(0,name.length()-4)+suffixes[i]+".mhd").c_str());
+           if(!image) {
+              cout<<"Missing image "<<name.substr(0,name.length()-4)+suffixes[i]+".mhd"<<" - not merged"<<endl;
+              found=false;
+           }
+        }
+        if(found) complete.push_back(suffixes[i]);
+     }
+
+     const string uncertaintyTag="-Uncertainty";
+     vector<string> grouped;
+     for(unsigned int i=0;i<complete.size();i++){
+        const string& suffix=complete[i];
+        if(suffix.length()<uncertaintyTag.length()
+           || suffix.substr(suffix.length()-uncertaintyTag.length())!=uncertaintyTag) continue;
+        const string valueSuffix=suffix.substr(0,suffix.length()-uncertaintyTag.length());
+        const string squaredSuffix=valueSuffix+"-Squared";
+        const bool hasValue  =find(complete.begin(),complete.end(),valueSuffix)!=complete.end();
+        const bool hasSquared=find(complete.begin(),complete.end(),squaredSuffix)!=complete.end();
+        if(!hasValue) continue;
+
+        GateImageMergeTask task;
+        // without the squared images, the squared sums are recovered from the uncertainties
+        task.withUncertainty=hasSquared || !nEvents.empty();
+        if(!task.withUncertainty && m_verboseLevel>0)
+           cout<<"No squared image nor number of events - "<<targetBase+suffix<<".mhd not merged"<<endl;
+        for(int j=0;j<m_Nfiles;j++){
+           const string base=m_vActorFileNames[k][j].substr(0,m_vActorFileNames[k][j].length()-4);
+           task.values.push_back(base+valueSuffix+".mhd");
+           task.uncertainties.push_back(base+suffix+".mhd");
+           if(hasSquared) task.squared.push_back(base+squaredSuffix+".mhd");
+        }
+        task.outValue=OutputName(targetBase+valueSuffix+".mhd");
+        if(hasSquared) task.outSquared=OutputName(targetBase+squaredSuffix+".mhd");
+        if(!nEvents.empty()) task.outUncertainty=OutputName(targetBase+suffix+".mhd");
+        tasks.push_back(task);
+        grouped.push_back(suffix);
+        grouped.push_back(valueSuffix);
+        if(hasSquared) grouped.push_back(squaredSuffix);
+     }
+
+     // other images are summed
+     for(unsigned int i=0;i<complete.size();i++){
+        const string& suffix=complete[i];
+        if(find(grouped.begin(),grouped.end(),suffix)!=grouped.end()) continue;
+        if(suffix.length()>=uncertaintyTag.length()
+           && suffix.substr(suffix.length()-uncertaintyTag.length())==uncertaintyTag) {
+           cout<<"No value image for "<<targetBase+suffix<<".mhd - not merged"<<endl;
+           continue;
+        }
+        GateImageMergeTask task;
+        task.withUncertainty=false;
+        for(int j=0;j<m_Nfiles;j++){
+           const string base=m_vActorFileNames[k][j].substr(0,m_vActorFileNames[k][j].length()-4);
+           task.values.push_back(base+suffix+".mhd");
+        }
+        task.outValue=OutputName(targetBase+suffix+".mhd");
+        tasks.push_back(task);
+     }
+  }
+
+  // do not overwrite existing images
+  if(!m_forced){
+     for(unsigned int t=0;t<tasks.size();t++){
+        ifstream image(tasks[t].outValue.c_str());
+        if(image){
+           cout<<"The image "<<tasks[t].outValue<<" already exists! Try -f to overwrite the file."<<endl;
+           exit(0);
+        }
+     }
+  }
+
+  atomic<size_t> nextTask(0);
+  atomic<int> nFailed(0);
+  const long long nJobs=m_Nfiles;
+  const int verboseLevel=m_verboseLevel;
+  auto worker=[&](){
+     GateMHDMerger merger(verboseLevel);
+     size_t t;
+     while((t=nextTask++)<tasks.size()){
+        const GateImageMergeTask& task=tasks[t];
+        bool ok;
+        if(task.withUncertainty)
+           ok=merger.SumWithUncertainty(task.values,task.squared,task.uncertainties,nEvents,
+                                        task.outValue,task.outSquared,task.outUncertainty);
+        else ok=merger.Sum(task.values,task.outValue);
+        if(!ok) {
+           cout<<"Failed to merge "<<nJobs<<" images into "<<task.outValue<<endl;
+           nFailed++;
+        }
+     }
+  };
+  const int nThreads=min((int)tasks.size(),m_nThreads);
+  vector<thread> threads;
+  for(int i=1;i<nThreads;i++) threads.push_back(thread(worker));
+  worker();
+  for(unsigned int i=0;i<threads.size();i++) threads[i].join();
+
+  if(m_verboseLevel>0) cout<<"Merged "<<tasks.size()-nFailed<<" images from "<<m_Nfiles<<" jobs"<<endl;
+  if(nFailed>0 || nRefused>0) exit(1);
+}
@@ -925,8 +925,14 @@ void GateMacfileParser::SearchForActors(G4int splitNumber,ofstream& output, ofst
     // If it is the case we registered this actor as enabled and we split its filename
     if (findInList)
     {
+      // the merger (gjm) needs the actor outputs of each job
+      if (splitNumber==1)
+        splitfile<<"Original Actor filename: "<<listOfEnabledActorType.back()<<" "
+                 <<ExtractFileName("/gate/actor/"+actorName+"/save")<<" "<<actorName<<endl;
       AddSplitNumberWithExtension(splitNumber);
       AddPWD("/gate/actor/"+actorName+"/save");
+      splitfile<<"Actor filename: "<<listOfEnabledActorType.back()<<" "
+               <<ExtractFileName("/gate/actor/"+actorName+"/save")<<endl;
     }
     // Else, it is an error, this actor does not exist !
     else
@@ -936,6 +942,29 @@ void GateMacfileParser::SearchForActors(G4int splitNumber,ofstream& output, ofst
       exit(1);
     }
   }
+  else if (macline.contains("/gate/actor/") && splitNumber==1)
+  {
+    // An image normalised to its maximum or integral in each job can not
+    // be summed by the merger (gjm), which has to know it
+    static const char* normalisationCommands[] = { "normaliseDoseToMax", "normaliseDoseToIntegral",
+      "normaliseDoseToWaterToMax", "normaliseDoseToWaterToIntegral",
+      "normaliseDoseToOtherMaterialToMax", "normaliseDoseToOtherMaterialToIntegral",
+      "normaliseDose", "normaliseDoseToWater", "enableNormalise" };
+    G4String tmp = macline;
+    tmp.erase(0,12);
+    size_t pos_slash = tmp.find_first_of("/");
+    size_t pos_space = tmp.find_first_of(" \t");
+    if (pos_slash == string::npos || pos_space == string::npos || pos_space < pos_slash) return;
+    G4String actorName = tmp.substr(0,pos_slash);
+    G4String command = tmp.substr(pos_slash+1,pos_space-pos_slash-1);
+    stringstream ssvalue(tmp.substr(pos_space+1));
+    string value;
+    ssvalue>>value;
+    const bool isEnabled = (value=="true" || value=="1");
+    for (size_t i=0; i<sizeof(normalisationCommands)/sizeof(normalisationCommands[0]); i++)
+      if (command == normalisationCommands[i] && isEnabled)
+        splitfile<<"Normalised Actor: "<<actorName<<endl;
+  }
 
 }
 
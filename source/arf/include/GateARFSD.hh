@@ -23,6 +23,7 @@
 #include "TBranch.h"
 #include "GateProjectionSet.hh"
 #include <map>
+#include <vector>
 
 class G4Step;
 class G4HCofThisEvent;
@@ -51,6 +52,7 @@ class GateARFSDMessenger;
  */
 class GateVVolume;
 class GateARFTableMgr;
+class GateARFTable;
 
 class GateARFData
   {
@@ -118,6 +120,9 @@ public:
   ;
 
   void computeTables();
+  void FillDRFTable(GateARFTable* arfTable,
+                    const std::vector<G4String> & rootNames,
+                    const std::vector<Long64_t> & nbOfEntries);
 
   void AddNewEnergyWindow(const G4String & basename, const G4int & NFiles)
     {
@@ -132,6 +137,18 @@ public:
                             const G4double & weight,
                             bool addEmToArfCount = false,
                             unsigned int newHead = 1);
+  /* same for a set of photons, addEmToArfCount applying to the first one */
+  void ComputeProjectionSet(const std::vector<G4ThreeVector> & positions,
+                            const std::vector<G4ThreeVector> & directions,
+                            const std::vector<G4double> & energies,
+                            const std::vector<G4double> & weights,
+                            bool addEmToArfCount = false,
+                            unsigned int newHead = 1);
+  void FillProjection(const G4ThreeVector & position,
+                      const G4ThreeVector & direction,
+                      const G4double & value,
+                      bool addEmToArfCount,
+                      unsigned int newHead);
 
   void SetDepth(const G4double & aDepth)
     {
@@ -67,6 +67,17 @@ private:
   G4double mTotalNumberOfPhotons; /* total number of simulated photons for this incident energy window */
   long unsigned int mBinnedPhotonCounter; /*  the number of binned photons */
   int mPhiCounts;
+  /* direct lookup of the indexes (see InitializeIndexLookup) */
+  std::vector<short> mThetaLookup;
+  std::vector<G4double> mThetaLookupBound;
+  G4double mThetaLookupHigh[4];
+  G4double mThetaLookupScale[4];
+  G4int mThetaLookupOffset[4];
+  G4int mThetaLookupSize[4];
+  std::vector<short> mPhiLookup;
+  std::vector<G4double> mPhiLookupBound;
+  G4double mPhiLookupScale;
+  G4int mPhiLookupSize;
 
 public:
   GateARFTable(const G4String & aName);
@@ -156,7 +167,17 @@ public:
   void InitializeCosTheta();
   void Describe();
   void Initialize(const G4double & energyLow, const G4double & energyHigh);
-  G4int GetIndexes(const G4double & x, const G4double & y, G4int& theta, G4int& phi);
+  void InitializeIndexLookup();
+  G4int GetIndexes(const G4double & x, const G4double & y, G4int& theta, G4int& phi) const;
+  G4int GetThetaIndex(const G4double & cosTheta) const;
+  G4int GetTanPhiIndex(const G4double & tanPhi) const;
+  /* linearized index (theta + phi * number of cos(theta)) of n photons, -1 out of the table */
+  void GetIndexes(const G4int & n, const G4double* x, const G4double* y, G4int* indexes) const;
+  G4double GetProbability(const G4int & index) const
+    {
+    return _ArfTableVector[index];
+    }
+  ;
   void NormalizeTable();
   G4double RetrieveProbability(const G4double & x, const G4double & y);
   void SetEnergyReso(const G4double & aE);
@@ -171,11 +192,27 @@ public:
     return mEnergyReference;
     }
   ;
-  G4int GetOneDimensionIndex(G4int  x, G4int y);
+  G4int GetOneDimensionIndex(G4int  x, G4int y) const;
   void FillDRFTable(const G4double & meanE, const G4double & X, const G4double & Y);
+  /* fills an accumulator of GetDrfTableSize() values instead of the DRF table (for the worker threads) */
+  void FillDRFTable(const G4double & meanE,
+                    const G4double & X,
+                    const G4double & Y,
+                    G4double* drfTable,
+                    long unsigned int & binnedPhotonCounter) const;
+  void MergeDRFTable(const G4double* drfTable, long unsigned int binnedPhotonCounter);
+  G4int GetDrfTableSize() const
+    {
+    return _DrfTableDimensionX * _DrfTableDimensionY;
+    }
+  ;
   void convertDRF2ARF();
+  /* the steps of convertDRF2ARF: the ARF values of different phi are independent */
+  void SymmetrizeDRFTable();
+  void convertDRF2ARF(G4int phiIndex);
+  void SaveARFfromDRFTable();
 
-  G4double computeARFfromDRF(const G4double & xI, const G4double & yJ, const G4double & cosTheta);
+  G4double computeARFfromDRF(const G4double & xI, const G4double & yJ, const G4double & cosTheta) const;
   void SetDistanceFromSourceToDetector(const G4double & aD)
     {
     _DistanceSourceToImage = aD;
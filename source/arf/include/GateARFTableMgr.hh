@@ -46,6 +46,7 @@ public:
     }
   ;
   void LoadARFFromBinaryFile(const G4String & binaryFilename);
+  G4bool LoadARFFromVersionedFile(const G4String & binaryFilename);
   void SetNBins(const G4int & N);
   G4int GetNBins()
     {
@@ -70,6 +71,7 @@ public:
     }
   ;
   void AddaTable(GateARFTable* aTable);
+  GateARFTable* GetTable(const G4int & index);
   void SetVerboseLevel(const G4int & aL)
     {
     mVerboseLevel = aL;
@@ -101,6 +103,12 @@ public:
   void convertDRF2ARF();
   void CloseARFTablesRootFile();
   G4double ScanTables(const G4double & x, const G4double & y, const G4double & energy);
+  /* probabilities of n photons, the indexes in the tables being computed in one pass */
+  void ScanTables(const G4int & n,
+                  const G4double* x,
+                  const G4double* y,
+                  const G4double* energy,
+                  G4double* arfValues);
   void SetDistanceFromSourceToDetector(const G4double & aD)
     {
     mDistance = aD;
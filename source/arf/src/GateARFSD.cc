@@ -38,7 +38,11 @@
 #include "GateBox.hh"
 #include "GateToProjectionSet.hh"
 #include "GateOutputMgr.hh"
+#include "GateARFTable.hh"
+#include "GateParallelFor.hh"
 #include "TH1D.h"
+#include <algorithm>
+#include <atomic>
 
 /* Name of the hit collection */
 const G4String GateARFSD::mArfHitCollectionName = "ARFCollection";
@@ -247,6 +251,8 @@ void GateARFSD::computeTables()
     {
     return;
     }
+  /* the entries of the ROOT files are read by several threads
+     (ROOT::EnableThreadSafety is called at startup, see Gate.cc) */
   G4double* nbSourcePhotons = new G4double[mEnergyWindows.size()];
   G4int tableIndex = 0;
   G4int totalNumberOfSingles = 0;
@@ -275,6 +281,8 @@ void GateARFSD::computeTables()
     tempNbofStoredPhotons = 0;
     tempInCamera = 0;
     tempOutCamera = 0;
+    std::vector<G4String> rootNames;
+    std::vector<Long64_t> nbOfEntries;
 
     for (G4int i = 0; i < mEnergyWindowsNumberOfPrimaries[numberOfWindows]; i++)
       {
@@ -305,13 +313,23 @@ void GateARFSD::computeTables()
         }
       mFile = new TFile(rootName.c_str(), "READ", "ROOT filefor ARF purpose");
       G4cout << "GateARFSD::computeTables():::::: Reading ROOT File  " << rootName << Gateendl;
+      if (mFile->IsZombie())
+        {
+        G4String msg = "Could not open the ROOT file " + rootName;
+        G4Exception("GateARFSD::computeTables", "computeTables", FatalException, msg);
+        }
       mSinglesTree = (TTree*) (mFile->Get("theTree"));
       G4cout << " m_singlesTree = " << mSinglesTree << Gateendl;
+      mNbOfPhotonsTree = (TTree*) (mFile->Get("theNumberOfPhoton"));
+      G4cout << " m_NbOfPhotonsTree = " << mNbOfPhotonsTree << Gateendl;
+      if (mSinglesTree == 0 || mNbOfPhotonsTree == 0)
+        {
+        G4String msg = "The ROOT file " + rootName + " has no theTree or theNumberOfPhoton tree";
+        G4Exception("GateARFSD::computeTables", "computeTables", FatalException, msg);
+        }
       mSinglesTree->SetBranchAddress("Edep", &mArfData.mDepositedEnergy);
       mSinglesTree->SetBranchAddress("outY", &mArfData.mProjectionPositionY);
       mSinglesTree->SetBranchAddress("outX", &mArfData.mProjectionPositionX);
-      mNbOfPhotonsTree = (TTree*) (mFile->Get("theNumberOfPhoton"));
-      G4cout << " m_NbOfPhotonsTree = " << mNbOfPhotonsTree << Gateendl;
       mNbOfPhotonsTree->SetBranchAddress("NOfOutGoingPhot", &tempNbofGoingOutPhotons);
       mNbOfPhotonsTree->SetBranchAddress("NbOfInGoingPhot", &tempNbofGoingInPhotons);
       mNbOfPhotonsTree->SetBranchAddress("NbOfSourcePhot", &tempNbOfSourcePhotons);
@@ -348,20 +366,21 @@ void GateARFSD::computeTables()
              << " contains "
              << mNbOfPhotonsTree->GetEntries()
              << " entries \n";
-      for (G4int j = 0; j < totalNumberOfSingles; j++)
-        {
-        mSinglesTree->GetEntry(j);
-        /* loop through ARF tables to get the table with the suitable energy window */
-        if (mArfData.mDepositedEnergy / keV - mEnergyDepositionThreshold >= 0.)
-          {
-          mArfTableMgr->FillDRFTable(tableIndex,
-                                     mArfData.mDepositedEnergy,
-                                     mArfData.mProjectionPositionX,
-                                     mArfData.mProjectionPositionY);
-          }
-        }
+      rootNames.push_back(rootName);
+      nbOfEntries.push_back(totalNumberOfSingles);
       mFile->Close();
       }
+    GateARFTable* arfTable = mArfTableMgr->GetTable(tableIndex);
+    if (arfTable != 0)
+      {
+      FillDRFTable(arfTable, rootNames, nbOfEntries);
+      }
+    else
+      {
+      G4cout << " WARNING :: GateARFSD::computeTables : Table # "
+             << tableIndex
+             << " does not exist. Ignored \n";
+      }
     time_t timeAfter = time(NULL);
     nbSourcePhotons[tableIndex] = mNbOfSourcePhotons * mNbOfHeads;
     G4cout << " ARF Table # "
@@ -375,6 +394,83 @@ void GateARFSD::computeTables()
   mArfTableMgr->convertDRF2ARF();
   }
 
+/* fills the DRF table from the singles of the ROOT files of an energy window: the files are
+ cut in chunks of entries, read by several threads, each one filling its own DRF table. The
+ tables of the threads are added at the end. */
+void GateARFSD::FillDRFTable(GateARFTable* arfTable,
+                             const std::vector<G4String> & rootNames,
+                             const std::vector<Long64_t> & nbOfEntries)
+  {
+  const Long64_t chunkSize = 1 << 20;
+  std::vector<std::pair<size_t, Long64_t> > chunks;
+  for (size_t f = 0; f < rootNames.size(); f++)
+    {
+    for (Long64_t first = 0; first < nbOfEntries[f]; first += chunkSize)
+      {
+      chunks.push_back(std::make_pair(f, first));
+      }
+    }
+  if (chunks.empty())
+    {
+    return;
+    }
+
+  const size_t nbOfThreads = GateParallel::GetNumberOfThreads(chunks.size());
+  std::vector<std::vector<G4double> > drfTables(nbOfThreads);
+  std::vector<long unsigned int> binnedPhotonCounters(nbOfThreads, 0);
+  for (size_t t = 0; t < nbOfThreads; t++)
+    {
+    drfTables[t].assign(arfTable->GetDrfTableSize(), 0.);
+    }
+  std::atomic<size_t> failedFile(rootNames.size()); /* a file or its tree cannot be read */
+  const G4double threshold = mEnergyDepositionThreshold;
+  GateParallel::For(chunks.size(), [&](unsigned int t, size_t c)
+    {
+    const size_t f = chunks[c].first;
+    if (failedFile < rootNames.size())
+      {
+      return;
+      }
+    TFile file(rootNames[f].c_str(), "READ", "ROOT filefor ARF purpose");
+    TTree* singlesTree = file.IsZombie() ? 0 : (TTree*) (file.Get("theTree"));
+    if (singlesTree == 0)
+      {
+      /* reported once the loop is done */
+      failedFile = f;
+      return;
+      }
+    GateARFData arfData;
+    singlesTree->SetBranchAddress("Edep", &arfData.mDepositedEnergy);
+    singlesTree->SetBranchAddress("outY", &arfData.mProjectionPositionY);
+    singlesTree->SetBranchAddress("outX", &arfData.mProjectionPositionX);
+    const Long64_t last = std::min(chunks[c].second + chunkSize, nbOfEntries[f]);
+    for (Long64_t j = chunks[c].second; j < last; j++)
+      {
+      singlesTree->GetEntry(j);
+      if (arfData.mDepositedEnergy / keV - threshold >= 0.)
+        {
+        arfTable->FillDRFTable(arfData.mDepositedEnergy,
+                               arfData.mProjectionPositionX,
+                               arfData.mProjectionPositionY,
+                               &drfTables[t][0],
+                               binnedPhotonCounters[t]);
+        }
+      }
+    file.Close();
+    });
+  if (failedFile < rootNames.size())
+    {
+    G4String msg = "Could not read theTree of the ROOT file " + rootNames[failedFile];
+    G4Exception("GateARFSD::FillDRFTable", "FillDRFTable", FatalException, msg);
+    return;
+    }
+
+  for (size_t t = 0; t < nbOfThreads; t++)
+    {
+    arfTable->MergeDRFTable(&drfTables[t][0], binnedPhotonCounters[t]);
+    }
+  }
+
 void GateARFSD::ComputeProjectionSet(const G4ThreeVector & position,
                                      const G4ThreeVector & direction,
                                      const G4double & energy,
@@ -415,6 +511,43 @@ void GateARFSD::ComputeProjectionSet(const G4ThreeVector & position,
    deltaX is the dimension of the detector on the Ox axis
    all these coordinates are relative to the detector frame where the origin of the detector is a t the center */
 
+  FillProjection(position, direction, arfValue * weight, addEmToArfCount, newHead);
+  }
+
+void GateARFSD::ComputeProjectionSet(const std::vector<G4ThreeVector> & positions,
+                                     const std::vector<G4ThreeVector> & directions,
+                                     const std::vector<G4double> & energies,
+                                     const std::vector<G4double> & weights,
+                                     bool addEmToArfCount,
+                                     unsigned int newHead)
+  {
+  /* the probabilities of all the photons are retrieved at once, then projected one by one */
+  const G4int n = positions.size();
+  if (n == 0)
+    {
+    return;
+    }
+  std::vector<G4double> x(n);
+  std::vector<G4double> y(n);
+  std::vector<G4double> arfValues(n);
+  for (G4int i = 0; i < n; i++)
+    {
+    x[i] = directions[i].z();
+    y[i] = directions[i].y();
+    }
+  mArfTableMgr->ScanTables(n, &x[0], &y[0], &energies[0], &arfValues[0]);
+  for (G4int i = 0; i < n; i++)
+    {
+    FillProjection(positions[i], directions[i], arfValues[i] * weights[i], addEmToArfCount && i == 0, newHead);
+    }
+  }
+
+void GateARFSD::FillProjection(const G4ThreeVector & position,
+                               const G4ThreeVector & direction,
+                               const G4double & value,
+                               bool addEmToArfCount,
+                               unsigned int newHead)
+  {
   G4double t = (position.x() - mDetectorXDepth) / direction.x();
   G4double xP = position.z() + t * direction.z();
   G4double yP = position.y() + t * direction.y();
@@ -433,11 +566,11 @@ void GateARFSD::ComputeProjectionSet(const G4ThreeVector & position,
       }
     mProjectionSet = projectionSet->GetProjectionSet();
     }
-  mProjectionSet->FillARF(mHeadID, yP, -xP, arfValue * weight, addEmToArfCount);
+  mProjectionSet->FillARF(mHeadID, yP, -xP, value, addEmToArfCount);
 
   if (mShortcutARF)
     {
-    mProjectionSet->FillARF(newHead, yP, -xP, arfValue * weight, false);
+    mProjectionSet->FillARF(newHead, yP, -xP, value, false);
     }
 
   }
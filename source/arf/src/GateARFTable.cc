@@ -20,6 +20,8 @@
 #include <iostream>
 #include <map>
 #include <utility>
+#include <algorithm>
+#include <cfloat>
 #include "TROOT.h"
 #include "TFile.h"
 #include "TDirectory.h"
@@ -46,6 +48,8 @@ GateARFTable::GateARFTable(const G4String & aName) :
   _TotalNumberbOfThetaPhi = _NumberOfCosTheta * _NumberOfTanPhi;
   mBinnedPhotonCounter = 0;
   mPhiCounts = 0;
+  mPhiLookupScale = 0.;
+  mPhiLookupSize = 0;
   mStep1 = 0.010 / (_NumberOfCosTheta * 0.5);
   mStep2 = 0.040 / _NumberOfTanPhi;
   mStep3 = 0.20 / (_NumberOfTanPhi * 0.5);
@@ -190,6 +194,7 @@ void GateARFTable::Initialize(const G4double & energyLow, const G4double & energ
 
   InitializeCosTheta();
   InitializePhi();
+  InitializeIndexLookup();
 
   if (_ArfTableVector != 0)
     {
@@ -212,11 +217,11 @@ void GateARFTable::Initialize(const G4double & energyLow, const G4double & energ
 
 G4double GateARFTable::RetrieveProbability(const G4double & x, const G4double & y)
   {
-  G4int theta = 0;
-  G4int phi = 0;
-  if (GetIndexes(x, y, theta, phi) == 1)
+  G4int index = 0;
+  GetIndexes(1, &x, &y, &index);
+  if (index >= 0)
     {
-    return _ArfTableVector[theta + phi * _NumberOfCosTheta];
+    return _ArfTableVector[index];
     }
   return 0.;
   }
@@ -231,13 +236,44 @@ void GateARFTable::SetERef(const G4double & aE)
   mEnergyReference = aE;
   }
 
-G4int GateARFTable::GetIndexes(const G4double & x, const G4double & y, G4int& theta, G4int& phi)
+G4int GateARFTable::GetIndexes(const G4double & x, const G4double & y, G4int& theta, G4int& phi) const
   {
   G4double cosTheta = sqrt(1. - x * x - y * y);
   if (cosTheta < 0.2)
     {
     return 0;
     }
+  theta = GetThetaIndex(cosTheta);
+  if (theta == 0)
+    {
+    phi = 0;
+    return 1;
+    }
+  if (fabs(x) <= 1.e-8)
+    {
+    phi = 511;
+    return 1;
+    }
+  G4double tanPhi = y / x;
+  if (tanPhi < 0.0)
+    {
+    tanPhi *= -1.0;
+    }
+
+  if (tanPhi - 1.00 < 0.)
+    {
+    phi = GetTanPhiIndex(tanPhi);
+    }
+  else
+    {
+    phi = 511 - GetTanPhiIndex(fabs(x / y));
+    }
+  return 1;
+  }
+
+G4int GateARFTable::GetThetaIndex(const G4double & cosTheta) const
+  {
+  G4int theta = 0;
   if (cosTheta - 0.99 > 0.)
     {
     theta = G4int((1.0 - cosTheta) * (_NumberOfCosTheta * 0.5) / 0.010);
@@ -263,46 +299,158 @@ G4int GateARFTable::GetIndexes(const G4double & x, const G4double & y, G4int& th
     {
     theta++;
     }
-  if (theta == 0)
-    {
-    phi = 0;
-    return 1;
-    }
-  if (fabs(x) <= 1.e-8)
+  return theta;
+  }
+
+G4int GateARFTable::GetTanPhiIndex(const G4double & tanPhi) const
+  {
+  G4int tanPhiIndex = G4int(tanPhi / mTanPhiStep + 0.5);
+  if (tanPhi - _TanPhiVector[tanPhiIndex] < 0.)
     {
-    phi = 511;
-    return 1;
+    tanPhiIndex--;
     }
-  G4double tanPhi = y / x;
-  if (tanPhi < 0.0)
-    {
-    tanPhi *= -1.0;
+  return tanPhiIndex;
+  }
+
+/* Direct lookup of the indexes: cos(theta) (in each of its 4 ranges) and tan(phi) are cut in
+ cells of 1/4 of a bin. The indexes being monotonic functions of cos(theta) and tan(phi), a
+ cell holds the index at its start and the exact value (found by bisection) from which the
+ next index is taken, if the index changes in the cell. A cell in which the index changes more
+ than once holds -1: the index is then computed by GetIndexes. */
+void GateARFTable::InitializeIndexLookup()
+  {
+  const G4int cellsPerBin = 4;
+  const G4double high[4] = { 1.0, 0.99, 0.95, 0.75 };
+  const G4double low[4] = { 0.99, 0.95, 0.75, 0.2 };
+  const G4int nbOfBins[4] = { G4int(_NumberOfCosTheta * 0.5), _NumberOfTanPhi, G4int(_NumberOfTanPhi * 0.5), G4int(_NumberOfTanPhi * 0.5) };
+  G4int nbOfCells = 0;
+  for (G4int p = 0; p < 4; p++)
+    {
+    mThetaLookupHigh[p] = high[p];
+    mThetaLookupScale[p] = cellsPerBin * nbOfBins[p] / (high[p] - low[p]);
+    mThetaLookupOffset[p] = nbOfCells;
+    mThetaLookupSize[p] = cellsPerBin * nbOfBins[p] + 1;
+    nbOfCells += mThetaLookupSize[p];
+    }
+  mThetaLookup.assign(nbOfCells, -1);
+  mThetaLookupBound.assign(nbOfCells, -DBL_MAX);
+  for (G4int p = 0; p < 4; p++)
+    {
+    /* cells slightly widened, for the rounding of the cell of a photon */
+    const G4double epsilon = 1.e-3 / mThetaLookupScale[p];
+    for (G4int k = 0; k < mThetaLookupSize[p]; k++)
+      {
+      G4double cosThetaHigh = std::min(high[p] - k / mThetaLookupScale[p] + epsilon, 1.0);
+      G4double cosThetaLow = std::max(high[p] - (k + 1) / mThetaLookupScale[p] - epsilon, 0.2 + 1.e-12);
+      const G4int theta = GetThetaIndex(cosThetaHigh);
+      const G4int nextTheta = GetThetaIndex(cosThetaLow);
+      if (nextTheta - theta > 1)
+        {
+        continue;
+        }
+      mThetaLookup[mThetaLookupOffset[p] + k] = theta;
+      if (nextTheta == theta + 1)
+        {
+        /* theta for cos(theta) >= bound, theta + 1 below */
+        G4double middle = 0.5 * (cosThetaHigh + cosThetaLow);
+        while (middle != cosThetaHigh && middle != cosThetaLow)
+          {
+          if (GetThetaIndex(middle) == theta)
+            {
+            cosThetaHigh = middle;
+            }
+          else
+            {
+            cosThetaLow = middle;
+            }
+          middle = 0.5 * (cosThetaHigh + cosThetaLow);
+          }
+        mThetaLookupBound[mThetaLookupOffset[p] + k] = cosThetaHigh;
+        }
+      }
     }
 
-  if (tanPhi - 1.00 < 0.)
+  mPhiLookupScale = cellsPerBin / mTanPhiStep;
+  mPhiLookupSize = G4int(mPhiLookupScale) + 1;
+  mPhiLookup.assign(mPhiLookupSize, -1);
+  mPhiLookupBound.assign(mPhiLookupSize, DBL_MAX);
+  const G4double epsilon = 1.e-3 / mPhiLookupScale;
+  for (G4int k = 0; k < mPhiLookupSize; k++)
     {
-    phi = G4int(tanPhi / mTanPhiStep + 0.5);
-    if (tanPhi - _TanPhiVector[phi] < 0.)
+    G4double tanPhiLow = std::max(k / mPhiLookupScale - epsilon, 0.);
+    G4double tanPhiHigh = std::min((k + 1) / mPhiLookupScale + epsilon, 1.0);
+    const G4int phi = GetTanPhiIndex(tanPhiLow);
+    const G4int nextPhi = GetTanPhiIndex(tanPhiHigh);
+    if (nextPhi - phi > 1)
       {
-      phi--;
+      continue;
+      }
+    mPhiLookup[k] = phi;
+    if (nextPhi == phi + 1)
+      {
+      /* phi for tan(phi) < bound, phi + 1 above */
+      G4double middle = 0.5 * (tanPhiLow + tanPhiHigh);
+      while (middle != tanPhiLow && middle != tanPhiHigh)
+        {
+        if (GetTanPhiIndex(middle) == phi)
+          {
+          tanPhiLow = middle;
+          }
+        else
+          {
+          tanPhiHigh = middle;
+          }
+        middle = 0.5 * (tanPhiLow + tanPhiHigh);
+        }
+      mPhiLookupBound[k] = tanPhiHigh;
       }
     }
-  else
-    {
-    tanPhi = fabs(x / y);
-    G4int tanPhiIndex = G4int(tanPhi / mTanPhiStep + 0.5);
-    if (tanPhi - _TanPhiVector[tanPhiIndex] < 0.)
+  }
+
+void GateARFTable::GetIndexes(const G4int & n, const G4double* x, const G4double* y, G4int* indexes) const
+  {
+  /* the photons are computed without branches (selections only), the photons of the cells
+   holding -1 being marked with -2 for the exact computation */
+  for (G4int i = 0; i < n; i++)
+    {
+    const G4double u = 1. - x[i] * x[i] - y[i] * y[i];
+    const G4double cosTheta = sqrt(u > 0. ? u : 0.);
+    const bool valid = (cosTheta >= 0.2);
+    const G4int p = G4int(cosTheta <= 0.99) + G4int(cosTheta <= 0.95) + G4int(cosTheta <= 0.75);
+    const G4double thetaCell = (mThetaLookupHigh[p] - cosTheta) * mThetaLookupScale[p];
+    const G4int thetaCellIndex = mThetaLookupOffset[p] + std::min(std::max(G4int(thetaCell), 0), mThetaLookupSize[p] - 1);
+    const G4int thetaStart = mThetaLookup[thetaCellIndex];
+    const G4int theta = thetaStart + G4int(cosTheta < mThetaLookupBound[thetaCellIndex]);
+
+    const G4double ax = fabs(x[i]);
+    const G4double ay = fabs(y[i]);
+    const bool onAxis = (ax <= 1.e-8);
+    const G4double tanPhi = onAxis ? 0. : ay / ax;
+    const bool belowOne = (tanPhi < 1.);
+    const G4double key = (onAxis || belowOne) ? tanPhi : ax / ay;
+    const G4int phiCellIndex = std::min(G4int(key * mPhiLookupScale), mPhiLookupSize - 1);
+    const G4int tanPhiStart = mPhiLookup[phiCellIndex];
+    const G4int tanPhiIndex = tanPhiStart + G4int(key >= mPhiLookupBound[phiCellIndex]);
+    const G4int phi = (theta == 0) ? 0 : (onAxis ? 511 : (belowOne ? tanPhiIndex : 511 - tanPhiIndex));
+
+    const bool exact = (thetaStart >= 0) && (theta == 0 || onAxis || tanPhiStart >= 0);
+    indexes[i] = !valid ? -1 : (exact ? theta + phi * _NumberOfCosTheta : -2);
+    }
+
+  for (G4int i = 0; i < n; i++)
+    {
+    if (indexes[i] == -2)
       {
-      tanPhiIndex--;
+      G4int theta = 0;
+      G4int phi = 0;
+      indexes[i] = (GetIndexes(x[i], y[i], theta, phi) == 1) ? theta + phi * _NumberOfCosTheta : -1;
       }
-    phi = 511 - tanPhiIndex;
     }
-  return 1;
   }
 
 G4double GateARFTable::computeARFfromDRF(const G4double & xI,
                                          const G4double & yJ,
-                                         const G4double & cosTheta)
+                                         const G4double & cosTheta) const
   {
   G4int index0 = 0;
   G4int i = 0;
@@ -356,14 +504,23 @@ G4double GateARFTable::computeARFfromDRF(const G4double & xI,
 
   }
 
-G4int GateARFTable::GetOneDimensionIndex(G4int x, G4int y)
+G4int GateARFTable::GetOneDimensionIndex(G4int x, G4int y) const
   {
   return x + y * _DrfTableDimensionX;
   }
 
 void GateARFTable::convertDRF2ARF()
   {
+  SymmetrizeDRFTable();
+  for (G4int phiIndex = 0; phiIndex < _NumberOfTanPhi; phiIndex++)
+    {
+    convertDRF2ARF(phiIndex);
+    }
+  SaveARFfromDRFTable();
+  }
 
+void GateARFTable::SymmetrizeDRFTable()
+  {
   G4int index1 = 0;
   G4int index2 = 0;
   G4int index3 = 0;
@@ -384,6 +541,10 @@ void GateARFTable::convertDRF2ARF()
                                    + _DrfTableVector[index4]);
       }
     }
+  }
+
+void GateARFTable::convertDRF2ARF(G4int phiIndex)
+  {
   G4double cosPhi = 0;
   G4double sinPhi = 0;
   G4double halfTableRangeInCmX = (_DrfTableDimensionX * 0.5 - _AverageNumberOfPixels - 2.0)
@@ -394,62 +555,62 @@ void GateARFTable::convertDRF2ARF()
   G4double yJ = 0;
   G4int index = 0;
   G4double radius = 0;
-  for (G4int phiIndex = 0; phiIndex < _NumberOfTanPhi; phiIndex++)
+  if (phiIndex == 0)
+    {
+    sinPhi = 0.0;
+    cosPhi = 1.0;
+    }
+  else if (phiIndex < G4int(_NumberOfTanPhi * 0.5))
+    {
+    /* in fact, this is the real tan(PHI) */
+    cosPhi = 1.0 / sqrt(1.0 + _TanPhiVector[phiIndex] * _TanPhiVector[phiIndex]);
+    sinPhi = cosPhi * _TanPhiVector[phiIndex];
+
+    }
+  else if (phiIndex == G4int(_NumberOfTanPhi * 0.5))
+    {
+    /* in fact, from 256-511, the actualy PHI value is for ctg, not for tan */
+    sinPhi = sqrt(2.0) * 0.5;
+    cosPhi = sinPhi;
+    }
+  else
     {
-    if (phiIndex == 0)
+    /* the value of dTanPhi is actually the value of ctan of the same angle */
+    sinPhi = 1.0
+             / sqrt(1.0
+                    + _TanPhiVector[_NumberOfTanPhi - phiIndex]
+                      * _TanPhiVector[_NumberOfTanPhi - phiIndex]);
+    cosPhi = sinPhi * _TanPhiVector[_NumberOfTanPhi - phiIndex];
+    }
+  for (G4int thetaIndex = 0; thetaIndex < _NumberOfCosTheta; thetaIndex++)
+    {
+    /* x is cos(Theta), 1.0 --> 0.20 */
+    index = thetaIndex + phiIndex * _NumberOfCosTheta;
+    if (thetaIndex == 0)
       {
-      sinPhi = 0.0;
-      cosPhi = 1.0;
+      xI = 0.0;
+      yJ = 0.0;
       }
-    else if (phiIndex < G4int(_NumberOfTanPhi * 0.5))
+    else
       {
-      /* in fact, this is the real tan(PHI) */
-      cosPhi = 1.0 / sqrt(1.0 + _TanPhiVector[phiIndex] * _TanPhiVector[phiIndex]);
-      sinPhi = cosPhi * _TanPhiVector[phiIndex];
-
+      radius = _DistanceSourceToImage
+               * sqrt(1.0 / (_CosThetaVector[thetaIndex] * _CosThetaVector[thetaIndex]) - 1.0);
+      xI = radius * cosPhi;
+      yJ = radius * sinPhi;
       }
-    else if (phiIndex == G4int(_NumberOfTanPhi * 0.5))
+    if ((xI >= halfTableRangeInCmX) || (yJ >= halfTableRangeInCmY))
       {
-      /* in fact, from 256-511, the actualy PHI value is for ctg, not for tan */
-      sinPhi = sqrt(2.0) * 0.5;
-      cosPhi = sinPhi;
+      _ArfTableVector[index] = 0.0;
       }
     else
       {
-      /* the value of dTanPhi is actually the value of ctan of the same angle */
-      sinPhi = 1.0
-               / sqrt(1.0
-                      + _TanPhiVector[_NumberOfTanPhi - phiIndex]
-                        * _TanPhiVector[_NumberOfTanPhi - phiIndex]);
-      cosPhi = sinPhi * _TanPhiVector[_NumberOfTanPhi - phiIndex];
-      }
-    for (G4int thetaIndex = 0; thetaIndex < _NumberOfCosTheta; thetaIndex++)
-      {
-      /* x is cos(Theta), 1.0 --> 0.20 */
-      index = thetaIndex + phiIndex * _NumberOfCosTheta;
-      if (thetaIndex == 0)
-        {
-        xI = 0.0;
-        yJ = 0.0;
-        }
-      else
-        {
-        radius = _DistanceSourceToImage
-                 * sqrt(1.0 / (_CosThetaVector[thetaIndex] * _CosThetaVector[thetaIndex]) - 1.0);
-        xI = radius * cosPhi;
-        yJ = radius * sinPhi;
-        }
-      if ((xI >= halfTableRangeInCmX) || (yJ >= halfTableRangeInCmY))
-        {
-        _ArfTableVector[index] = 0.0;
-        }
-      else
-        {
-        _ArfTableVector[index] = computeARFfromDRF(xI, yJ, _CosThetaVector[thetaIndex]);
-        }
+      _ArfTableVector[index] = computeARFfromDRF(xI, yJ, _CosThetaVector[thetaIndex]);
       }
     }
+  }
 
+void GateARFTable::SaveARFfromDRFTable()
+  {
   G4String arfDrfTableBinName = GetName() + "_ARFfromDRFTable.bin";
   size_t tableBufferSize = _TotalNumberbOfThetaPhi * sizeof(G4double);
   std::ofstream outputTableBin(arfDrfTableBinName.c_str(), std::ios::out | std::ios::binary);
@@ -459,6 +620,24 @@ void GateARFTable::convertDRF2ARF()
 
 void GateARFTable::FillDRFTable(const G4double & meanE, const G4double & X, const G4double & Y)
   {
+  FillDRFTable(meanE, X, Y, _DrfTableVector, mBinnedPhotonCounter);
+  }
+
+void GateARFTable::MergeDRFTable(const G4double* drfTable, long unsigned int binnedPhotonCounter)
+  {
+  for (G4int i = 0; i < GetDrfTableSize(); i++)
+    {
+    _DrfTableVector[i] += drfTable[i];
+    }
+  mBinnedPhotonCounter += binnedPhotonCounter;
+  }
+
+void GateARFTable::FillDRFTable(const G4double & meanE,
+                                const G4double & X,
+                                const G4double & Y,
+                                G4double* drfTable,
+                                long unsigned int & binnedPhotonCounter) const
+  {
   if (X - _LowX < 0. || X + _LowX > 0.)
     {
     return;
@@ -479,7 +658,7 @@ void GateARFTable::FillDRFTable(const G4double & meanE, const G4double & X, cons
     return;
     }
   G4int index = GetOneDimensionIndex(xIndex, yIndex);
-  mBinnedPhotonCounter++;
+  binnedPhotonCounter++;
   /*
    erf(x)=1/sqrt(PI) * integral(-x,x) of exp(-x^2)
    =2/sqrt(PI) * integral(0,x) of exp(-x^2)
@@ -512,7 +691,7 @@ void GateARFTable::FillDRFTable(const G4double & meanE, const G4double & X, cons
     /* perfect energy resolution*/
     result = 1.0;
     }
-  _DrfTableVector[index] += fabs(result);
+  drfTable[index] += fabs(result);
   }
 
 void GateARFTable::Describe()
@@ -8,6 +8,8 @@
 
 #include "GateConfiguration.h"
 #include "GateMessageManager.hh"
+#include "GateCacheFile.hh"
+#include "GateParallelFor.hh"
 
 #ifdef G4ANALYSIS_USE_ROOT
 
@@ -23,10 +25,22 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include "G4ThreeVector.hh"
 #include "G4RotationMatrix.hh"
 #include "GateARFSD.hh"
 
+/* Binary file of the ARF tables: the magic (with the version of the format),
+ the number of tables, of theta and of phi values, then for each table the 6
+ values of GateARFTable::GetARFAsBinaryBuffer and the table. All the values
+ are 8 bytes long, so that each table is read as is in a buffer of doubles. */
+static const char theARFFileMagic[8] = "GateAF1";
+static const size_t theARFFileHeaderSize = sizeof(theARFFileMagic) + 3 * sizeof(long long);
+static const size_t theARFTableHeaderSize = 6;
+
 GateARFTableMgr::GateARFTableMgr(const G4String & aName, GateARFSD* arfSD)
   {
   mTableName = aName;
@@ -64,6 +78,50 @@ G4double GateARFTableMgr::ScanTables(const G4double & x,
   return 0.;
   }
 
+void GateARFTableMgr::ScanTables(const G4int & n,
+                                 const G4double* x,
+                                 const G4double* y,
+                                 const G4double* energy,
+                                 G4double* arfValues)
+  {
+  if (mArfTableMap.empty())
+    {
+    std::fill(arfValues, arfValues + n, 0.);
+    return;
+    }
+  /* all the tables share the same theta, phi grid: the indexes are computed once */
+  std::vector<G4int> indexes(n);
+  mArfTableMap.begin()->second->GetIndexes(n, x, y, &indexes[0]);
+  std::map<G4int, GateARFTable*>::iterator mapIterator;
+  for (G4int i = 0; i < n; i++)
+    {
+    arfValues[i] = 0.;
+    if (indexes[i] < 0)
+      {
+      continue;
+      }
+    for (mapIterator = mArfTableMap.begin(); mapIterator != mArfTableMap.end(); mapIterator++)
+      {
+      if ((energy[i] - ((*mapIterator).second)->GetElow() > 1.e-8)
+          && (energy[i] - ((*mapIterator).second)->GetEhigh() < 1.e-8))
+        {
+        arfValues[i] = ((*mapIterator).second)->GetProbability(indexes[i]);
+        break;
+        }
+      }
+    }
+  }
+
+GateARFTable* GateARFTableMgr::GetTable(const G4int & index)
+  {
+  std::map<G4int, GateARFTable*>::iterator mapIterator = mArfTableMap.find(index);
+  if (mapIterator == mArfTableMap.end())
+    {
+    return 0;
+    }
+  return (*mapIterator).second;
+  }
+
 void GateARFTableMgr::AddaTable(GateARFTable* arfTable)
   {
   arfTable->SetIndex(mCurrentIndex);
@@ -172,9 +230,27 @@ void GateARFTableMgr::convertDRF2ARF()
   {
   std::map<G4int, GateARFTable*>::iterator mapIterator;
   G4cout << " GateARFTableMgr::convertDRF2ARF()   CONVERTING DRF tables to ARF TABLES\n";
+  std::vector<GateARFTable*> tables;
   for (mapIterator = mArfTableMap.begin(); mapIterator != mArfTableMap.end(); mapIterator++)
     {
-    ((*mapIterator).second)->convertDRF2ARF();
+    ((*mapIterator).second)->SymmetrizeDRFTable();
+    tables.push_back((*mapIterator).second);
+    }
+  if (tables.empty())
+    {
+    return;
+    }
+
+  /* the ARF values of each (table, phi) are independent: computed by all the cores */
+  const size_t nbOfPhi = tables[0]->GetNbofPhi();
+  GateParallel::For(tables.size() * nbOfPhi, [&tables, nbOfPhi](unsigned int, size_t i)
+    {
+    tables[i / nbOfPhi]->convertDRF2ARF(G4int(i % nbOfPhi));
+    });
+
+  for (size_t i = 0; i < tables.size(); i++)
+    {
+    tables[i]->SaveARFfromDRFTable();
     }
   }
 
@@ -216,60 +292,62 @@ void GateARFTableMgr::ListTables()
 
 void GateARFTableMgr::SaveARFToBinaryFile()
   {
-  std::ofstream outputBinaryFile;
-  outputBinaryFile.open(mBinaryFilename.c_str());
-  std::map<G4int, GateARFTable*>::iterator mapIterator;
-  mapIterator = mArfTableMap.begin();
-  outputBinaryFile.seekp(0, std::ios::beg);
-  G4double tableSize = G4double(mArfTableMap.size());
-  outputBinaryFile.write((const char*) (&tableSize), sizeof(G4double));
-  tableSize = G4double(((*mapIterator).second)->GetTotalNb());
-  outputBinaryFile.write((const char*) (&tableSize), sizeof(G4double));
-  G4int bytesNumber = 8 + G4int(tableSize);
-  size_t tableBufferSize = bytesNumber * sizeof(G4double);
-  long writingPosition;
-  for (mapIterator = mArfTableMap.begin(); mapIterator != mArfTableMap.end(); mapIterator++)
+  if (mArfTableMap.empty())
     {
-    G4double* tableBuffer = new G4double[bytesNumber];
-    ((*mapIterator).second)->GetARFAsBinaryBuffer(tableBuffer);
-    writingPosition = outputBinaryFile.tellp();
-    writingPosition++;
-    outputBinaryFile.seekp(writingPosition, std::ios::beg);
-    if (outputBinaryFile.bad())
-      {
-      G4String msg = "Could not locate the position where to write the ARFTable onto the disk (out of disk space?)";
-      G4Exception("GateARFTableMgr::SaveARFToBinaryFile",
-                  "SaveARFToBinaryFile",
-                  FatalException,
-                  msg);
-      }
-    G4cout << " Writing ARF Table "
-           << ((*mapIterator).second)->GetName()
-           << " to file "
-           << mBinaryFilename
-           << " at position "
-           << writingPosition;
-    outputBinaryFile.write((const char*) (tableBuffer), tableBufferSize);
-    G4cout << "...[OK] : " << tableBufferSize << " bytes\n";
-    if (outputBinaryFile.bad())
+    G4cout << " WARNING :: GateARFTableMgr::SaveARFToBinaryFile : no ARF table to save\n";
+    return;
+    }
+  std::map<G4int, GateARFTable*>::iterator mapIterator = mArfTableMap.begin();
+  long long header[3];
+  header[0] = mArfTableMap.size();
+  header[1] = ((*mapIterator).second)->GetNbofTheta();
+  header[2] = ((*mapIterator).second)->GetNbofPhi();
+  G4int bytesNumber = theARFTableHeaderSize + ((*mapIterator).second)->GetTotalNb();
+  size_t tableBufferSize = bytesNumber * sizeof(G4double);
+
+  /* the file is complete or absent */
+  G4double* tableBuffer = new G4double[bytesNumber];
+  const bool isWritten = GateCacheFile::Write(mBinaryFilename, [&](std::ostream & outputBinaryFile) {
+    outputBinaryFile.write(theARFFileMagic, sizeof(theARFFileMagic));
+    outputBinaryFile.write((const char*) (header), sizeof(header));
+    for (mapIterator = mArfTableMap.begin(); mapIterator != mArfTableMap.end(); mapIterator++)
       {
-      G4String msg = "Could not write the ARFTable onto the disk (out of disk space?)";
-      G4Exception("GateARFTableMgr::SaveARFToBinaryFile",
-                  "SaveARFToBinaryFile",
-                  FatalException,
-                  msg);
+      ((*mapIterator).second)->GetARFAsBinaryBuffer(tableBuffer);
+      G4cout << " Writing ARF Table "
+             << ((*mapIterator).second)->GetName()
+             << " to file "
+             << mBinaryFilename
+             << " at position "
+             << outputBinaryFile.tellp();
+      outputBinaryFile.write((const char*) (tableBuffer), tableBufferSize);
+      if (outputBinaryFile.bad())
+        {
+        G4cout << "...[FAILED]\n";
+        return;
+        }
+      G4cout << "...[OK] : " << tableBufferSize << " bytes\n";
       }
-    outputBinaryFile.flush();
-    delete[] tableBuffer;
+    });
+  delete[] tableBuffer;
+  if (!isWritten)
+    {
+    G4String msg = "Could not write the ARF tables to " + mBinaryFilename + " (out of disk space?)";
+    G4Exception("GateARFTableMgr::SaveARFToBinaryFile", "SaveARFToBinaryFile", FatalException, msg);
     }
   G4cout << " All ARF tables have been saved to binary file\n " << mBinaryFilename;
-  outputBinaryFile.close();
   }
 
 void GateARFTableMgr::LoadARFFromBinaryFile(const G4String & binaryFilename)
   {
   mLoadArfTables = 1;
   mCurrentIndex = 0;
+  if (LoadARFFromVersionedFile(binaryFilename))
+    {
+    ListTables();
+    return;
+    }
+
+  /* files written before the versioned format */
   G4String basename = GetName() + "ARFTable_";
   std::ifstream inputBinaryFile;
   inputBinaryFile.open(binaryFilename.c_str(), std::ios::binary);
@@ -327,5 +405,62 @@ void GateARFTableMgr::LoadARFFromBinaryFile(const G4String & binaryFilename)
   ListTables();
   }
 
-#endif
+/* load the tables of a file of the versioned format (false if the file is not of this format) */
 
+G4bool GateARFTableMgr::LoadARFFromVersionedFile(const G4String & binaryFilename)
+  {
+  std::ifstream inputBinaryFile(binaryFilename.c_str(), std::ios::binary);
+  char magic[sizeof(theARFFileMagic)];
+  long long header[3];
+  inputBinaryFile.read(magic, sizeof(magic));
+  inputBinaryFile.read((char*) (header), sizeof(header));
+  if (!inputBinaryFile || memcmp(magic, theARFFileMagic, sizeof(magic)) != 0)
+    {
+    return false;
+    }
+  inputBinaryFile.seekg(0, std::ios::end);
+  size_t fileSize = inputBinaryFile.tellg();
+
+  G4String basename = GetName() + "ARFTable_";
+  GateARFTable checkTable(basename);
+  if (header[1] != checkTable.GetNbofTheta() || header[2] != checkTable.GetNbofPhi())
+    {
+    G4String msg = "The ARF tables of " + binaryFilename + " do not have the expected number of theta and phi values";
+    G4Exception("GateARFTableMgr::LoadARFFromBinaryFile", "LoadARFFromBinaryFile", FatalException, msg);
+    return true;
+    }
+  size_t tableSize = theARFTableHeaderSize + checkTable.GetTotalNb();
+  if (fileSize < theARFFileHeaderSize + header[0] * tableSize * sizeof(G4double))
+    {
+    G4String msg = "The ARF tables file " + binaryFilename + " is truncated";
+    G4Exception("GateARFTableMgr::LoadARFFromBinaryFile", "LoadARFFromBinaryFile", FatalException, msg);
+    return true;
+    }
+
+  inputBinaryFile.seekg(theARFFileHeaderSize, std::ios::beg);
+  std::vector<G4double> buffer(tableSize);
+  for (long long i = 0; i < header[0]; i++)
+    {
+    inputBinaryFile.read((char*) (&buffer[0]), tableSize * sizeof(G4double));
+    if (!inputBinaryFile)
+      {
+      G4String msg = "Could not read the ARF tables of " + binaryFilename;
+      G4Exception("GateARFTableMgr::LoadARFFromBinaryFile", "LoadARFFromBinaryFile", FatalException, msg);
+      return true;
+      }
+    std::ostringstream oss;
+    oss << mCurrentIndex;
+    G4String tableName = basename + oss.str();
+    G4double* tableBuffer = &buffer[0];
+    GateARFTable* arfTable = new GateARFTable(tableName);
+    arfTable->Initialize(tableBuffer[4], tableBuffer[5]);
+    arfTable->SetEnergyReso(tableBuffer[2]);
+    arfTable->SetERef(tableBuffer[3]);
+    arfTable->FillTableFromBuffer(tableBuffer);
+    AddaTable(arfTable);
+    }
+  G4cout << " " << header[0] << " ARF tables read from file " << binaryFilename << Gateendl;
+  return true;
+  }
+
+#endif
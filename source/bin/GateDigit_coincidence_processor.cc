@@ -166,7 +166,7 @@ int main(int argc, char *argv[])
 
            }
            digitizer->ErasePulseListVector();
-
+           GatePulse::ResetPools();
        }
        else{
            //Not good maybe delte GateCoincidnece vector
@@ -0,0 +1,198 @@
+/*
+ *	\file GateDigit_coincidence_sorter_benchmark.cc
+ */
+
+// Replays a recorded singles stream through the coincidence sorter and
+// reports the sorting throughput. The singles are loaded in memory before
+// the timing, so that only the sorter is measured. The printed checksum
+// depends on the content and on the order of the coincidences: two
+// versions of the sorter give identical outputs if the checksums match.
+//
+// Two modes:
+// - cc : Compton camera sorter, singles read by GateCCSinglesFileReader;
+// - pet: standard sorter, singles read from the "Singles" tree written by
+//   the root output. The options macro then describes the geometry and
+//   the system (the sorter needs the system to reject the neighbour
+//   sectors), as in the macro of the simulation.
+
+#include "GateMessageManager.hh"
+#include "G4UImanager.hh"
+#include "GateDigitizer.hh"
+#include "GateCCSinglesFileReader.hh"
+#include "GateRootDefs.hh"
+#include "GateSystemListManager.hh"
+
+//in order to have volumeID Geomtery needed
+#include "GateDetectorConstruction.hh"
+#include "GateRunManager.hh"
+#include "GateSignalHandler.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+static void HashCombine(unsigned long long & h, const void * data, size_t n)
+{
+  // FNV-1a
+  const unsigned char * p = static_cast<const unsigned char*>(data);
+  for(size_t i=0; i<n; i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Singles of the "Singles" tree, one pulse list per event
+static size_t LoadPETSingles(const std::string & fileName, std::vector<GatePulseList*> & events)
+{
+  TFile file(fileName.c_str(), "READ");
+  TTree * tree = file.IsZombie() ? 0 : (TTree*)file.Get("Singles");
+  if (!tree) {
+    std::cout << "No Singles tree in " << fileName << std::endl;
+    exit(-1);
+  }
+  GateRootSingleBuffer buffer;
+  GateSingleTree::SetBranchAddresses(tree, buffer);
+  GatePulseList * list = 0;
+  const Long64_t n = tree->GetEntries();
+  for (Long64_t i = 0; i < n; i++) {
+    tree->GetEntry(i);
+    if (!list || list->front()->GetEventID() != buffer.eventID) {
+      list = new GatePulseList("Singles");
+      events.push_back(list);
+    }
+    GatePulse * pulse = new GatePulse();
+    pulse->SetRunID(buffer.runID);
+    pulse->SetEventID(buffer.eventID);
+    pulse->SetSourceID(buffer.sourceID);
+    pulse->SetSourcePosition(G4ThreeVector(buffer.sourcePosX, buffer.sourcePosY, buffer.sourcePosZ)*mm);
+    pulse->SetTime(buffer.time*s);
+    pulse->SetEnergy(buffer.energy*MeV);
+    pulse->SetGlobalPos(G4ThreeVector(buffer.globalPosX, buffer.globalPosY, buffer.globalPosZ)*mm);
+    GateOutputVolumeID outputVolumeID(ROOT_OUTPUTIDSIZE);
+    for (size_t d = 0; d < ROOT_OUTPUTIDSIZE; d++) outputVolumeID[d] = buffer.outputID[d];
+    pulse->SetOutputVolumeID(outputVolumeID);
+    pulse->SetNPhantomCompton(buffer.comptonPhantom);
+    pulse->SetNCrystalCompton(buffer.comptonCrystal);
+    pulse->SetNPhantomRayleigh(buffer.RayleighPhantom);
+    pulse->SetNCrystalRayleigh(buffer.RayleighCrystal);
+    pulse->SetScannerPos(G4ThreeVector(0., 0., buffer.axialPos*mm));
+    pulse->SetScannerRotAngle(buffer.rotationAngle*deg);
+    list->push_back(pulse);
+  }
+  file.Close();
+  return n;
+}
+//-----------------------------------------------------------------------------
+
+
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateDigit_coincidence_sorter_benchmark" << std::endl
+        << "Replay singles through the coincidence sorter and measure its throughput" << std::endl
+        << "Usage : " << argv[0] << " cc <singlesInput.root> <options.mac> absorberSDVolName" << std::endl
+        << "        " << argv[0] << " pet <singlesInput.root> <options.mac>" << std::endl;
+
+  // Get user parameters
+  const std::string mode = (argc > 1) ? argv[1] : "";
+  const bool IsCCSorter = (mode == "cc");
+  if ((mode != "cc" && mode != "pet") || argc != (IsCCSorter ? 5 : 4)) {
+    std::cout << "Wrong parameters" << std::endl
+              << usage.str() << std::endl;
+    exit(0);
+  }
+  std::string singles_filePathName = argv[2];
+  std::string options_macrofile = argv[3];
+  std::string absorberSDName = IsCCSorter ? argv[4] : "";
+
+  // GATE Initialisation (same as GateDigit_singles_sorter)
+  GateMessageManager* theGateMessageManager = GateMessageManager::GetInstance();
+  G4UImanager::GetUIpointer()->SetCoutDestination( theGateMessageManager );
+  GateSignalHandler::Install();
+  GateRunManager* runManager = new GateRunManager;
+  GateDetectorConstruction* gateDC = new GateDetectorConstruction();
+  runManager->SetUserInitialization( gateDC );
+  runManager->SetUserInitialization( GatePhysicsList::GetInstance() );
+
+  GateDigitizer* digitizer = GateDigitizer::GetInstance();
+  G4double coincidenceWindow = 10.* ns;
+  GateCoincidenceSorter* coincidenceSorter = new GateCoincidenceSorter(digitizer,"Coincidences",coincidenceWindow,
+                                                                       IsCCSorter ? "layers" : "Singles",IsCCSorter);
+  digitizer->StoreNewCoincidenceSorter(coincidenceSorter);
+
+  // Options (window, presort buffer size, policies...)
+  std::cout << "Reading " << options_macrofile << " ..." << std::endl;
+  G4UImanager::GetUIpointer()->ApplyCommand( G4String("/control/execute ") + options_macrofile );
+  if (IsCCSorter) coincidenceSorter->SetAbsorberSDVol(absorberSDName);
+  else {
+    if (!coincidenceSorter->GetSystem() && GateSystemListManager::GetInstance()->size() > 0)
+      coincidenceSorter->SetSystem(GateSystemListManager::GetInstance()->GetSystem(0));
+    if (!coincidenceSorter->GetSystem()) {
+      std::cout << options_macrofile << " does not define a system" << std::endl;
+      exit(-1);
+    }
+  }
+
+  // Load the singles stream in memory
+  std::vector<GatePulseList*> events;
+  size_t nSingles = 0;
+  if (IsCCSorter) {
+    GateCCSinglesFileReader* singlesFileReader = GateCCSinglesFileReader::GetInstance(singles_filePathName);
+    singlesFileReader->PrepareAcquisition();
+    while(singlesFileReader->HasNextEvent()) {
+      singlesFileReader->PrepareNextEvent();
+      GatePulseList * list = singlesFileReader->PrepareEndOfEvent();
+      if (!list) continue;
+      events.push_back(new GatePulseList(*list));
+      nSingles += list->size();
+    }
+    singlesFileReader->TerminateAfterAcquisition();
+  }
+  else nSingles = LoadPETSingles(singles_filePathName, events);
+  std::cout << "Loaded " << nSingles << " singles in " << events.size() << " events" << std::endl;
+
+  // Replay
+  unsigned long long checksum = 14695981039346656037ULL;
+  size_t nCoincidences = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(auto list:events) {
+    digitizer->ErasePulseListVector();
+    coincidenceSorter->ProcessSinglePulseList(list);
+    std::vector<GateCoincidencePulse*> coincPulseVector = digitizer->FindCoincidencePulse("Coincidences");
+    for(auto coincPulse:coincPulseVector) {
+      unsigned int n = coincPulse->size();
+      HashCombine(checksum, &n, sizeof(n));
+      for(unsigned int i=0; i<n; i++) {
+        G4int eventID = coincPulse->at(i)->GetEventID();
+        G4double time = coincPulse->at(i)->GetTime();
+        G4double energy = coincPulse->at(i)->GetEnergy();
+        HashCombine(checksum, &eventID, sizeof(eventID));
+        HashCombine(checksum, &time, sizeof(time));
+        HashCombine(checksum, &energy, sizeof(energy));
+      }
+      nCoincidences++;
+    }
+    GatePulse::ResetPools();
+  }
+  digitizer->ErasePulseListVector();
+  auto stop = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(stop-start).count();
+
+  std::cout << "Coincidences       : " << nCoincidences << std::endl
+            << "Checksum           : " << std::hex << checksum << std::dec << std::endl
+            << "Sorting time (s)   : " << seconds << std::endl
+            << "Singles/s          : " << (seconds > 0 ? nSingles/seconds : 0) << std::endl
+            << "Coincidences/s     : " << (seconds > 0 ? nCoincidences/seconds : 0) << std::endl;
+
+  for(auto list:events) delete list;
+  return 0;
+}
@@ -136,7 +136,7 @@ int main(int argc, char *argv[])
                 }
             }
         }
-
+        GatePulse::ResetPools();
     }
     pTfile->Write();
     m_hitFileReader->TerminateAfterAcquisition();
@@ -0,0 +1,468 @@
+/*
+ *	\file GateDigit_parallel_hits_digitizer.cc
+ */
+
+// Same processing as GateDigit_hits_digitizer (Compton camera hit files)
+// or as the offline mode of Gate with GateHitFileReader (PET hit files,
+// option -p), for large hit files.
+//
+// The hit file is sharded by event range between worker processes. Each
+// worker builds its own digitizer chain from the macro (the digitizer and
+// its pulse processors are singletons configured through messengers, so
+// that one process holds one chain), reads its events with one or more
+// threads (by chunks of events, see GateHitFileStreamReader), digitizes
+// them in file order and writes its singles from another thread. The
+// singles of the workers are then merged in time order into the output
+// file.
+//
+// The shards are cut at event boundaries. Processors that keep a state
+// from one event to the next (dead time, pile-up, buffer) need the hits
+// before the shard: each worker also digitizes the hits within an overlap
+// time before and after its shard (by default, 10 times the longest
+// memory time of the processors, see GateVPulseProcessor::GetMemoryTime),
+// and only keeps the singles of the events of its shard. The duplicated
+// singles of the overlaps are thus dropped, and the processors are in
+// the state of the sequential digitization when the shard starts as soon
+// as the overlap contains a gap of their memory time without pulse.
+//
+// Each worker reseeds the random engine with the seed of the macro plus
+// its index, so that the blurrings of the workers are independent and
+// reproducible. The throughput of each worker and of the whole
+// digitization are printed at the end.
+
+#include "G4SystemOfUnits.hh"
+#include "GateMessageManager.hh"
+#include "G4UImanager.hh"
+#include "GateHitFileStreamReader.hh"
+#include "GateDigitizer.hh"
+#include "GateSingleDigi.hh"
+#include "GateRandomEngine.hh"
+
+#include "GateDetectorConstruction.hh"
+#include "GateRunManager.hh"
+#include "GateSignalHandler.hh"
+
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include "Randomize.hh"
+
+#include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+//-----------------------------------------------------------------------------
+// Writes the singles into the output tree, in its own thread
+template<class SingleBuffer, class SingleTree>
+class SinglesWriter
+{
+public:
+  SinglesWriter(const std::string & fileName) : mFileName(fileName), mDone(false), mNbSingles(0) {}
+
+  void Start() { mThread = std::thread(&SinglesWriter::Write, this); }
+
+  void Push(std::vector<SingleBuffer> & singles)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this] { return mQueue.size() < 8; });
+      mQueue.push_back(std::vector<SingleBuffer>());
+      mQueue.back().swap(singles);
+    }
+    mCondition.notify_all();
+  }
+
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mDone = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+  }
+
+  long long GetNumberOfSingles() const { return mNbSingles; }
+
+protected:
+  void Write()
+  {
+    TFile * pTfile = new TFile(mFileName.c_str(), "RECREATE");
+    SingleTree * singleTree = new SingleTree("Singles");
+    SingleBuffer singlesBuffer;
+    singleTree->Init(singlesBuffer);
+
+    std::vector<SingleBuffer> singles;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this] { return mDone || !mQueue.empty(); });
+        if (mQueue.empty()) break;
+        singles.swap(mQueue.front());
+        mQueue.pop_front();
+      }
+      mCondition.notify_all();
+      for (size_t i = 0; i < singles.size(); i++) {
+        singlesBuffer = singles[i];
+        singleTree->Fill();
+      }
+      mNbSingles += singles.size();
+      singles.clear();
+    }
+    pTfile->Write();
+    delete pTfile;
+  }
+
+  std::string mFileName;
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque< std::vector<SingleBuffer> > mQueue;
+  bool mDone;
+  long long mNbSingles;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Digitizes the events starting in the entries [first, last) of the hit
+// file with a digitizer chain built from the macro, the hits of the
+// overlap before and after being digitized too (overlapTime < 0: 10 times
+// the memory time of the processors). The singles are not written if
+// singlesFileName is empty.
+template<class HitBuffer, class HitTree, class SingleBuffer, class SingleTree>
+static int DigitizeEntries(const std::string & hitsFileName, const std::string & singlesFileName,
+                           const std::string & macroFileName, const G4String & chainName,
+                           int nbThreads, long long chunkSize, Long64_t first, Long64_t last,
+                           G4double overlapTime, int workerIndex, const std::string & workerName)
+{
+  // GATE Initialisation (same as GateDigit_hits_digitizer)
+  GateMessageManager* theGateMessageManager = GateMessageManager::GetInstance();
+  G4UImanager::GetUIpointer()->SetCoutDestination( theGateMessageManager );
+  GateSignalHandler::Install();
+
+  GateRandomEngine* randomEngine = GateRandomEngine::GetInstance();
+
+  GateRunManager* runManager = new GateRunManager;
+  GateDetectorConstruction* gateDC = new GateDetectorConstruction();
+  runManager->SetUserInitialization( gateDC );
+  runManager->SetUserInitialization( GatePhysicsList::GetInstance() );
+
+  GateDigitizer* digitizer = GateDigitizer::GetInstance();
+  GatePulseProcessorChain* chain = new GatePulseProcessorChain(digitizer, chainName);
+  digitizer->StoreNewPulseProcessorChain(chain);
+
+  G4UImanager* UImanager = G4UImanager::GetUIpointer();
+  std::cout << workerName << "Reading " << macroFileName << " ..." << std::endl;
+  G4String command = "/control/execute ";
+  UImanager->ApplyCommand( command + macroFileName );
+  std::cout << workerName << "Done" << std::endl;
+
+  // Random numbers of this worker (the first one as with -j 1)
+  if (workerIndex > 0) G4Random::setTheSeed(G4Random::getTheSeed() + workerIndex);
+
+  // Events of the shard, and entries read with the overlaps
+  typedef GateHitFileStreamReader<HitBuffer, HitTree> Reader;
+  const std::pair<G4int, G4int> firstEvent = Reader::GetEventStartingAt(hitsFileName, first);
+  const std::pair<G4int, G4int> endEvent = Reader::GetEventStartingAt(hitsFileName, last);
+  if (overlapTime < 0) {
+    overlapTime = 0.;
+    for (size_t c = 0; c < digitizer->GetChainNumber(); c++)
+      for (size_t p = 0; p < digitizer->GetChain(c)->GetProcessorNumber(); p++)
+        overlapTime = std::max(overlapTime, 10. * digitizer->GetChain(c)->GetProcessor(p)->GetMemoryTime());
+  }
+  Long64_t readFirst = first;
+  Long64_t readLast = last;
+  if (overlapTime > 0) Reader::ExtendRange(hitsFileName, overlapTime, readFirst, readLast);
+  const bool isOverlapping = (readFirst < first) || (readLast > last);
+
+  // Start the reader and writer threads
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  Reader reader(hitsFileName, nbThreads, chunkSize, 4, readFirst, readLast);
+  reader.Start();
+  SinglesWriter<SingleBuffer, SingleTree> writer(singlesFileName);
+  const bool writeSingles = !singlesFileName.empty();
+  if (writeSingles) writer.Start();
+
+  // Digitize the events in file order
+  long long nbHits = 0;
+  long long nbEvents = 0;
+  long long nbSingles = 0;
+  double digitizerTime = 0.;
+  typename Reader::Batch batch;
+  std::vector<GateCrystalHit*> hits;
+  std::vector<SingleBuffer> singles;
+  SingleBuffer singleBuffer;
+  std::pair<G4int, G4int> lastEvent(INT_MIN, INT_MIN);
+  while (reader.NextBatch(batch)) {
+    const std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+    size_t begin = 0;
+    for (size_t e = 0; e < batch.eventEnds.size(); e++) {
+      const size_t end = batch.eventEnds[e];
+      // the events of the shard are found by their IDs
+      const std::pair<G4int, G4int> event(batch.hits[begin].runID, batch.hits[begin].eventID);
+      if (isOverlapping && !(lastEvent < event)) {
+        GateError("The event IDs do not increase along the hit file (event " << event.second << " of run "
+                  << event.first << "): the shards can not overlap, use -o 0 or -j 1.");
+      }
+      lastEvent = event;
+      for (size_t i = begin; i < end; i++) hits.push_back(batch.hits[i].CreateHit());
+      begin = end;
+
+      digitizer->Digitize(hits);
+      GatePulseList* pPulseList = digitizer->FindPulseList(chainName);
+      if (pPulseList) {
+        for (GatePulseConstIterator iterIn = pPulseList->begin(); iterIn != pPulseList->end(); ++iterIn) {
+          // singles of the events of the overlaps are kept by the other workers
+          const std::pair<G4int, G4int> pulseEvent((*iterIn)->GetRunID(), (*iterIn)->GetEventID());
+          if (isOverlapping && (pulseEvent < firstEvent || !(pulseEvent < endEvent))) continue;
+          GateSingleDigi aSingleDigi(*iterIn);
+          singleBuffer.Fill(&aSingleDigi);
+          singles.push_back(singleBuffer);
+          singleBuffer.Clear();
+        }
+      }
+
+      nbHits += hits.size();
+      for (size_t i = 0; i < hits.size(); i++) delete hits[i];
+      hits.clear();
+      GatePulse::ResetPools();
+    }
+    nbEvents += batch.eventEnds.size();
+    nbSingles += singles.size();
+    if (writeSingles) writer.Push(singles);
+    singles.clear();
+    digitizerTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+  }
+  const double readTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (writeSingles) writer.Stop();
+  reader.Stop();
+  const double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << workerName << "Hits                : " << nbHits << " (entries " << first << " to " << last
+            << ", " << readFirst << " to " << readLast << " with the overlaps of " << overlapTime/ns << " ns)" << std::endl
+            << workerName << "Events              : " << nbEvents << std::endl
+            << workerName << "Singles             : " << nbSingles << std::endl
+            << workerName << "Total time (s)      : " << totalTime << std::endl
+            << workerName << "Digitizer time (s)  : " << digitizerTime << std::endl
+            << workerName << "Waiting readers (s) : " << reader.GetWaitingTime() << std::endl
+            << workerName << "Throughput (hits/s) : " << (readTime > 0 ? nbHits/readTime : 0) << std::endl;
+
+  delete randomEngine;
+  delete runManager;
+  delete digitizer;
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Merges the singles files of the workers in time order (each file is in
+// time order, the order of the files is kept for equal times)
+template<class SingleBuffer, class SingleTree>
+static long long MergeSingles(const std::vector<std::string> & partFileNames, const std::string & fileName)
+{
+  const size_t nbParts = partFileNames.size();
+  std::vector<TFile*> files(nbParts, (TFile*)0);
+  std::vector<TTree*> trees(nbParts, (TTree*)0);
+  std::vector<SingleBuffer> buffers(nbParts);
+  std::vector<Long64_t> entries(nbParts, 0);
+  std::vector<Long64_t> nextEntry(nbParts, 0);
+
+  typedef std::pair<double, size_t> Head; // time of the next single, part
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+  for (size_t p = 0; p < nbParts; p++) {
+    files[p] = TFile::Open(partFileNames[p].c_str(), "READ");
+    if (files[p] && files[p]->IsOpen()) trees[p] = (TTree*)(files[p]->Get("Singles"));
+    if (!trees[p]) {
+      GateError("Could not read the singles of the worker in '" << partFileNames[p] << "'!");
+    }
+    SingleTree::SetBranchAddresses(trees[p], buffers[p]);
+    entries[p] = trees[p]->GetEntries();
+    if (entries[p] > 0) {
+      trees[p]->GetEntry(0);
+      nextEntry[p] = 1;
+      heads.push(Head(buffers[p].time, p));
+    }
+  }
+
+  TFile * pTfile = new TFile(fileName.c_str(), "RECREATE");
+  SingleTree * singleTree = new SingleTree("Singles");
+  SingleBuffer singlesBuffer;
+  singleTree->Init(singlesBuffer);
+  long long nbSingles = 0;
+  while (!heads.empty()) {
+    const size_t p = heads.top().second;
+    heads.pop();
+    singlesBuffer = buffers[p];
+    singleTree->Fill();
+    nbSingles++;
+    if (nextEntry[p] < entries[p]) {
+      trees[p]->GetEntry(nextEntry[p]++);
+      heads.push(Head(buffers[p].time, p));
+    }
+  }
+  pTfile->Write();
+  delete pTfile;
+
+  for (size_t p = 0; p < nbParts; p++) delete files[p];
+  return nbSingles;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Runs the workers (one process per shard) and merges their singles
+template<class HitBuffer, class HitTree, class SingleBuffer, class SingleTree>
+static int Run(const std::string & hitsFileName, const std::string & singlesFileName,
+               const std::string & macroFileName, const G4String & chainName,
+               int nbWorkers, int nbThreads, long long chunkSize, G4double overlapTime, bool writeSingles)
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const Long64_t entries = GateHitFileStreamReader<HitBuffer, HitTree>::GetNumberOfEntries(hitsFileName);
+
+  // A single worker digitizes in this process, and writes the output itself
+  if (nbWorkers == 1)
+    return DigitizeEntries<HitBuffer, HitTree, SingleBuffer, SingleTree>(hitsFileName, writeSingles ? singlesFileName : "",
+                                                                         macroFileName, chainName, nbThreads, chunkSize,
+                                                                         0, entries, 0., 0, "");
+
+  // Shards of entries, the events being shared out at the event boundaries by the readers
+  std::vector<std::string> partFileNames;
+  std::vector<pid_t> workers;
+  for (int w = 0; w < nbWorkers; w++) {
+    std::ostringstream partFileName;
+    partFileName << singlesFileName << ".worker" << w << ".root";
+    partFileNames.push_back(partFileName.str());
+    const Long64_t first = entries * w / nbWorkers;
+    const Long64_t last = entries * (w+1) / nbWorkers;
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) {
+      std::cout << "Could not start the worker " << w << std::endl;
+      exit(-1);
+    }
+    if (pid == 0) {
+      std::ostringstream workerName;
+      workerName << "[worker " << w << "] ";
+      const int status = DigitizeEntries<HitBuffer, HitTree, SingleBuffer, SingleTree>(hitsFileName,
+                                                                                       writeSingles ? partFileNames.back() : "",
+                                                                                       macroFileName, chainName, nbThreads,
+                                                                                       chunkSize, first, last, overlapTime,
+                                                                                       w, workerName.str());
+      std::cout.flush();
+      _exit(status);
+    }
+    workers.push_back(pid);
+  }
+
+  G4bool failed = false;
+  for (size_t w = 0; w < workers.size(); w++) {
+    int status = 0;
+    if (waitpid(workers[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cout << "The worker " << w << " failed" << std::endl;
+      failed = true;
+    }
+  }
+  if (failed) return -1;
+
+  long long nbSingles = 0;
+  if (writeSingles) {
+    nbSingles = MergeSingles<SingleBuffer, SingleTree>(partFileNames, singlesFileName);
+    for (size_t w = 0; w < partFileNames.size(); w++) std::remove(partFileNames[w].c_str());
+  }
+  const double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Workers             : " << nbWorkers << " (" << nbThreads << " reader threads each, "
+            << chunkSize << " hits per chunk)" << std::endl
+            << "Hits                : " << entries << std::endl;
+  if (writeSingles)
+    std::cout << "Singles             : " << nbSingles << std::endl;
+  std::cout << "Total time (s)      : " << totalTime << std::endl
+            << "Throughput (hits/s) : " << (totalTime > 0 ? entries/totalTime : 0) << std::endl;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+
+
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateDigit_parallel_hits_digitizer" << std::endl
+        << "Process hits to provide singles, with several digitizer chains running in parallel" << std::endl
+        << "Usage : " << argv[0] << " [-j workers] [-t threads] [-c entries] [-o ns] [-p] [-n] <hit.root> <singles.root> <options.mac>" << std::endl
+        << "  -j : number of worker processes, each with its own digitizer chain (default 4)" << std::endl
+        << "  -t : number of reader threads of a worker (default 1)" << std::endl
+        << "  -c : number of hits read by a thread at once (default 200000)" << std::endl
+        << "  -o : time (ns) digitized before and after the shard of a worker, for the processors" << std::endl
+        << "       keeping a state between events (default 10 times their dead time, pile-up...)" << std::endl
+        << "  -p : PET hit file (as read by GateHitFileReader, digitizer chain 'Singles')," << std::endl
+        << "       Compton camera hit file otherwise (digitizer chain 'layers')" << std::endl
+        << "  -n : do not write the singles (throughput benchmark)" << std::endl;
+
+  // Get user parameters
+  int nbWorkers = 4;
+  int nbThreads = 1;
+  long long chunkSize = 200000;
+  G4double overlapTime = -1.;
+  bool isPET = false;
+  bool writeSingles = true;
+  int c;
+  while ((c = getopt(argc, argv, "j:t:c:o:pn")) != -1) {
+    switch (c) {
+    case 'j': nbWorkers = atoi(optarg); break;
+    case 't': nbThreads = atoi(optarg); break;
+    case 'c': chunkSize = atoll(optarg); break;
+    case 'o': overlapTime = atof(optarg) * ns; break;
+    case 'p': isPET = true; break;
+    case 'n': writeSingles = false; break;
+    default:
+      std::cout << usage.str() << std::endl;
+      exit(0);
+    }
+  }
+  if (argc - optind != 3 || nbWorkers < 1 || nbThreads < 1 || chunkSize < 1) {
+    std::cout << "Need 3 parameters" << std::endl
+              << usage.str() << std::endl;
+    exit(0);
+  }
+  std::string hits_filePathName = argv[optind];
+  std::string singles_filePathName = argv[optind+1];
+  std::string options_macrofile = argv[optind+2];
+
+  size_t foundPoint = options_macrofile.find_last_of( "." );
+  G4String suffix = "";
+  if( foundPoint != G4String::npos )
+    suffix = options_macrofile.substr( foundPoint + 1 );
+  if( suffix != "mac" ) {
+    std::cout << "problemas last argument is not a macro file" << std::endl;
+    exit(0);
+  }
+
+  // The reader threads open their own TFile
+  ROOT::EnableThreadSafety();
+
+  if (isPET)
+    return Run<GateRootHitBuffer, GateHitTree, GateRootSingleBuffer, GateSingleTree>(hits_filePathName, singles_filePathName,
+                                                                                   options_macrofile, "Singles",
+                                                                                   nbWorkers, nbThreads, chunkSize, overlapTime, writeSingles);
+  return Run<GateCCRootHitBuffer, GateCCHitTree, GateCCRootSingleBuffer, GateCCSingleTree>(hits_filePathName, singles_filePathName,
+                                                                                         options_macrofile, "layers",
+                                                                                         nbWorkers, nbThreads, chunkSize, overlapTime, writeSingles);
+}
@@ -0,0 +1,243 @@
+/*
+ *	\file GateFictitiousMajorant_benchmark.cc
+ */
+
+// Measures the fictitious interaction (Woodcock) tracking of photons in a
+// labelled XCAT-like phantom (soft tissue, lungs, spine and a metal implant
+// in air), with the loop of GateFictitiousFastSimulationModel::VolumeTrace:
+// - with the global majorant (maximal cross section of the whole phantom),
+// - with GateFictitiousMajorantGrid (one majorant per cell of n^3 voxels).
+// Photons of 511 keV start at random points of the body and are tracked
+// until they escape or are absorbed, each real interaction scattering them
+// in a random direction with a lower energy. Both trackings sample the same
+// physics: the number of real interactions by photon must agree within the
+// statistical fluctuations, only the number of fictitious ones differs.
+//
+// The numbers are synthetic: the cross sections are analytic stand-ins
+// (not the G4EmCalculator tables of GateCrossSectionsTable), there is no
+// Geant4 navigation, secondary production nor fast simulation overhead,
+// and the phantom is a toy, not an XCAT one. They compare the two
+// majorants on the same sampling loop; they are not the photons/second
+// gain of a GATE simulation, which has to be measured on a real macro
+// (e.g. the fictitious interaction PET example) with and without the grid.
+
+#include "GateFictitiousMajorantGrid.hh"
+
+#include "G4PhysicsLinearVector.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Synthetic linear attenuation (1/mm) of a material of given density
+// (g/cm3), with a photoelectric term growing with the atomic number
+static G4PhysicsLinearVector * CreateCrossSection(double density, double photoScale,
+                                                  double minEnergy, double maxEnergy, int bins)
+{
+  G4PhysicsLinearVector * vector = new G4PhysicsLinearVector(minEnergy, maxEnergy, bins);
+  for(size_t i=0; i<vector->GetVectorLength(); i++) {
+    const double energy = (minEnergy + (maxEnergy-minEnergy)*i/bins)/MeV;
+    const double muOverRho = 0.02 + 0.06/sqrt(energy) + photoScale*0.0001/(energy*energy*energy); // cm2/g
+    vector->PutValue(i, density*muOverRho/10.);
+  }
+  return vector;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+struct TrackingResult
+{
+  double time;
+  long long nbReal;
+  long long nbFictitious;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+static void SampleDirection(G4ThreeVector & dir)
+{
+  const double cosTheta = 2.0*G4UniformRand()-1.0;
+  const double sinTheta = sqrt(1.0-cosTheta*cosTheta);
+  const double phi = 2.0*M_PI*G4UniformRand();
+  dir.set(sinTheta*cos(phi), sinTheta*sin(phi), cosTheta);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Distance from pos (inside) to the surface of the box of half size half
+static double DistanceToOut(const G4ThreeVector & pos, const G4ThreeVector & dir, const G4ThreeVector & half)
+{
+  double distance = DBL_MAX;
+  for(int a=0; a<3; a++) {
+    if (dir[a] > 0) distance = std::min(distance, (half[a]-pos[a])/dir[a]);
+    else if (dir[a] < 0) distance = std::min(distance, (-half[a]-pos[a])/dir[a]);
+  }
+  return std::max(distance, 0.);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Tracks the photons with the global majorant (grid == 0) or with the grid
+static TrackingResult Track(const std::vector<G4ThreeVector> & starts, const std::vector<int> & labelOfVoxel,
+                            const int resolution[3], double voxelSize,
+                            const std::vector<const G4PhysicsVector*> & crossSectionOfLabel,
+                            const G4PhysicsVector * maxCrossSection,
+                            const GateFictitiousMajorantGrid * grid, long seed)
+{
+  CLHEP::HepRandom::setTheSeed(seed);
+  const G4ThreeVector half(resolution[0]*voxelSize/2., resolution[1]*voxelSize/2., resolution[2]*voxelSize/2.);
+  const double minEnergy = 50.*keV;
+  bool NotUsedAnyMoreIsOutOfRange;
+  TrackingResult result = { 0., 0, 0 };
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(size_t p=0; p<starts.size(); p++) {
+    G4ThreeVector pos = starts[p];
+    G4ThreeVector dir;
+    SampleDirection(dir);
+    double energy = 511.*keV;
+    double distToOut = DistanceToOut(pos, dir, half);
+    while (true) {
+      double invMajorant;
+      double distance;
+      if (grid)
+        distance = grid->SampleDistance(pos, dir, distToOut, energy, invMajorant);
+      else {
+        invMajorant = 1./maxCrossSection->GetValue(energy, NotUsedAnyMoreIsOutOfRange);
+        distance = -log(G4UniformRand())*invMajorant;
+      }
+      if (distance >= distToOut) break; // escapes
+      pos += distance*dir;
+      distToOut -= distance;
+
+      int v[3];
+      for(int a=0; a<3; a++)
+        v[a] = std::max(0, std::min(resolution[a]-1, int(floor((pos[a]+half[a])/voxelSize))));
+      const int label = labelOfVoxel[v[0]+resolution[0]*(v[1]+resolution[1]*v[2])];
+      const double crossSection = crossSectionOfLabel[label]->GetValue(energy, NotUsedAnyMoreIsOutOfRange);
+      if (G4UniformRand() >= crossSection*invMajorant) {
+        result.nbFictitious++;
+        continue;
+      }
+
+      // Real interaction: scattered with a lower energy, absorbed below minEnergy
+      result.nbReal++;
+      energy *= 0.4 + 0.6*G4UniformRand();
+      if (energy < minEnergy) break;
+      SampleDirection(dir);
+      distToOut = DistanceToOut(pos, dir, half);
+    }
+  }
+  result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateFictitiousMajorant_benchmark" << std::endl
+        << "Measure the fictitious interaction tracking with the global and the local majorants" << std::endl
+        << "Usage : " << argv[0] << " [photons (default 200000)] [voxels per axis (default 128)] [voxels per cell (default 8)]" << std::endl;
+  if (argc > 4) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+  const int nbPhotons = (argc > 1) ? atoi(argv[1]) : 200000;
+  const int nbVoxels = (argc > 2) ? atoi(argv[2]) : 128;
+  const int cellSize = (argc > 3) ? atoi(argv[3]) : 8;
+  if (nbPhotons < 1 || nbVoxels < 1 || cellSize < 1) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+
+  // Cross sections (air, soft tissue, lung, cortical bone, titanium implant)
+  const double minEnergy = 10.*keV;
+  const double maxEnergy = 600.*keV;
+  const int bins = 1000;
+  const double densities[5] = { 0.0012, 1.04, 0.3, 1.92, 4.5 };
+  const double photoScales[5] = { 1.0, 1.0, 1.0, 6.0, 60.0 };
+  std::vector<const G4PhysicsVector*> crossSectionOfLabel;
+  for(int l=0; l<5; l++)
+    crossSectionOfLabel.push_back(CreateCrossSection(densities[l], photoScales[l], minEnergy, maxEnergy, bins));
+  G4PhysicsLinearVector * maxCrossSection = new G4PhysicsLinearVector(minEnergy, maxEnergy, bins);
+  for(size_t i=0; i<maxCrossSection->GetVectorLength(); i++) {
+    double b = 0.;
+    for(size_t l=0; l<crossSectionOfLabel.size(); l++) b = std::max(b, (*crossSectionOfLabel[l])[i]);
+    maxCrossSection->PutValue(i, b*1.0001); // same safety factor as GateCrossSectionsTable
+  }
+
+  // Phantom: elliptic body of soft tissue with two lungs and a spine, a
+  // small metal implant at one hip, air around
+  const int resolution[3] = { nbVoxels, nbVoxels, nbVoxels };
+  const double voxelSize = 400.*mm/nbVoxels;
+  std::vector<int> labelOfVoxel(nbVoxels*nbVoxels*nbVoxels);
+  std::vector<G4ThreeVector> bodyVoxels;
+  for(int z=0; z<nbVoxels; z++)
+    for(int y=0; y<nbVoxels; y++)
+      for(int x=0; x<nbVoxels; x++) {
+        const double px = 2.0*(x+0.5)/nbVoxels-1.0;
+        const double py = 2.0*(y+0.5)/nbVoxels-1.0;
+        const double pz = 2.0*(z+0.5)/nbVoxels-1.0;
+        int label = 1;
+        if (px*px/0.8 + py*py/0.5 > 1.0) label = 0;
+        else if (pz > 0.0 && ((px-0.4)*(px-0.4) + py*py < 0.09 || (px+0.4)*(px+0.4) + py*py < 0.09)) label = 2;
+        else if (px*px + (py+0.45)*(py+0.45) < 0.01) label = 3;
+        else if ((px-0.5)*(px-0.5) + py*py + (pz+0.6)*(pz+0.6) < 0.003) label = 4;
+        labelOfVoxel[x+nbVoxels*(y+nbVoxels*z)] = label;
+        if (label != 0)
+          bodyVoxels.push_back(G4ThreeVector((x+0.5)*voxelSize, (y+0.5)*voxelSize, (z+0.5)*voxelSize)
+                               - G4ThreeVector(200.*mm, 200.*mm, 200.*mm));
+      }
+
+  // Starting points, uniform in the body
+  std::vector<G4ThreeVector> starts(nbPhotons);
+  for(int p=0; p<nbPhotons; p++) {
+    const G4ThreeVector & voxel = bodyVoxels[std::min(size_t(G4UniformRand()*bodyVoxels.size()), bodyVoxels.size()-1)];
+    starts[p] = voxel + G4ThreeVector(G4UniformRand()-0.5, G4UniformRand()-0.5, G4UniformRand()-0.5)*voxelSize;
+  }
+
+  // Global majorant, then local majorants
+  TrackingResult result[2];
+  result[0] = Track(starts, labelOfVoxel, resolution, voxelSize, crossSectionOfLabel, maxCrossSection, 0, 1234);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  GateFictitiousMajorantGrid grid(labelOfVoxel, nbVoxels, nbVoxels, nbVoxels,
+                                  G4ThreeVector(voxelSize, voxelSize, voxelSize),
+                                  crossSectionOfLabel, maxCrossSection, cellSize);
+  const double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result[1] = Track(starts, labelOfVoxel, resolution, voxelSize, crossSectionOfLabel, maxCrossSection, &grid, 1234);
+
+  std::cout << "Synthetic cross sections and phantom, no Geant4 tracking (see the header)" << std::endl
+            << "Voxels                        : " << nbVoxels << "^3" << std::endl
+            << "Cells                         : " << grid.GetNumberOfCells() << " of " << cellSize << "^3 voxels, "
+            << grid.GetNumberOfMaterialSets() << " sets of materials (built in " << buildTime << " s)" << std::endl
+            << "Photons                       : " << nbPhotons << std::endl;
+  const char * names[2] = { "Global majorant", "Majorant grid  " };
+  for(int m=0; m<2; m++) {
+    const long long total = result[m].nbReal + result[m].nbFictitious;
+    std::cout << names[m] << " (photons/s)   : " << nbPhotons/result[m].time << std::endl
+              << names[m] << " real/total    : " << (total > 0 ? double(result[m].nbReal)/total : 0) << std::endl
+              << names[m] << " real by photon: " << double(result[m].nbReal)/nbPhotons << std::endl;
+  }
+  std::cout << "Speedup                       : " << (result[1].time > 0 ? result[0].time/result[1].time : 0) << std::endl;
+
+  delete maxCrossSection;
+  for(size_t l=0; l<crossSectionOfLabel.size(); l++) delete crossSectionOfLabel[l];
+  return 0;
+}
+//-----------------------------------------------------------------------------
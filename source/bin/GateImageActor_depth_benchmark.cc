@@ -0,0 +1,114 @@
+/*
+ *	\file GateImageActor_depth_benchmark.cc
+ */
+
+// Measures the lookup, done by the image actors at each step, of the depth
+// of the actor volume in the touchable history. A CT-like geometry is
+// built (world / container / ct / replicas along z, y and x) and random
+// points in the ct are located once. The depth of the ct is then searched
+// for these touchables with the former walk (names compared at each depth)
+// and with GateVImageActor::GetAncestorDepth. Several actors attached to the
+// same ct multiply the per-step cost of the walk.
+
+#include "GateVImageActor.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4NistManager.hh"
+#include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4TouchableHistory.hh"
+#include "Randomize.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+static int WalkByName(const G4LogicalVolume * target, const G4VTouchable * touchable)
+{
+  int maxDepth = touchable->GetHistoryDepth();
+  G4LogicalVolume * currentVol = touchable->GetVolume(0)->GetLogicalVolume();
+  int depth = 0;
+  while((depth<maxDepth) && (currentVol->GetName() != target->GetName())) {
+    depth++;
+    currentVol = touchable->GetVolume(depth)->GetLogicalVolume();
+  }
+  if(depth>=maxDepth) return -1;
+  return depth;
+}
+//-----------------------------------------------------------------------------
+
+
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateImageActor_depth_benchmark" << std::endl
+        << "Measure the ancestor depth lookup of the image actors" << std::endl
+        << "Usage : " << argv[0] << " [lookups (default 10000000)] [voxels per axis (default 64)]" << std::endl;
+  if (argc > 3) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+  const long long nbLookups = (argc > 1) ? atoll(argv[1]) : 10000000;
+  const int nbVoxels = (argc > 2) ? atoi(argv[2]) : 64;
+  if (nbLookups < 1 || nbVoxels < 1) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+
+  // Geometry
+  G4Material * water = G4NistManager::Instance()->FindOrBuildMaterial("G4_WATER");
+  const G4double halfSize = 100*mm;
+  const G4double voxelHalf = halfSize/nbVoxels;
+  G4LogicalVolume * world = new G4LogicalVolume(new G4Box("world", 1*m, 1*m, 1*m), water, "world");
+  G4LogicalVolume * container = new G4LogicalVolume(new G4Box("container", 0.5*m, 0.5*m, 0.5*m), water, "container");
+  G4LogicalVolume * ct = new G4LogicalVolume(new G4Box("ct", halfSize, halfSize, halfSize), water, "ct");
+  G4LogicalVolume * sliceZ = new G4LogicalVolume(new G4Box("sliceZ", halfSize, halfSize, voxelHalf), water, "sliceZ");
+  G4LogicalVolume * rowY = new G4LogicalVolume(new G4Box("rowY", halfSize, voxelHalf, voxelHalf), water, "rowY");
+  G4LogicalVolume * voxel = new G4LogicalVolume(new G4Box("voxel", voxelHalf, voxelHalf, voxelHalf), water, "voxel");
+  G4VPhysicalVolume * worldPV = new G4PVPlacement(0, G4ThreeVector(), world, "world", 0, false, 0);
+  new G4PVPlacement(0, G4ThreeVector(), container, "container", world, false, 0);
+  new G4PVPlacement(0, G4ThreeVector(), ct, "ct", container, false, 0);
+  new G4PVReplica("sliceZ", sliceZ, ct, kZAxis, nbVoxels, 2*voxelHalf);
+  new G4PVReplica("rowY", rowY, sliceZ, kYAxis, nbVoxels, 2*voxelHalf);
+  new G4PVReplica("voxel", voxel, rowY, kXAxis, nbVoxels, 2*voxelHalf);
+
+  // Touchables of random points in the ct
+  const int nbTouchables = 1024;
+  G4Navigator navigator;
+  navigator.SetWorldVolume(worldPV);
+  std::vector<G4TouchableHistory*> touchables;
+  for(int i=0; i<nbTouchables; i++) {
+    G4ThreeVector p((2*G4UniformRand()-1)*halfSize, (2*G4UniformRand()-1)*halfSize, (2*G4UniformRand()-1)*halfSize);
+    navigator.LocateGlobalPointAndSetup(p);
+    touchables.push_back(navigator.CreateTouchableHistory());
+  }
+
+  // Lookups
+  long long checksum[2] = {0, 0};
+  double time[2];
+  for(int method=0; method<2; method++) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long long i=0; i<nbLookups; i++) {
+      const G4VTouchable * t = touchables[i % nbTouchables];
+      checksum[method] += (method == 0) ? WalkByName(ct, t) : GateVImageActor::GetAncestorDepth(ct, t, true);
+    }
+    time[method] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  std::cout << "History depth         : " << touchables[0]->GetHistoryDepth() << std::endl
+            << "Depth of the ct       : " << WalkByName(ct, touchables[0]) << std::endl
+            << "Lookups               : " << nbLookups << std::endl
+            << "Walk by name (ns)     : " << 1e9*time[0]/nbLookups << std::endl
+            << "Cached lookup (ns)    : " << 1e9*time[1]/nbLookups << std::endl
+            << "Speedup               : " << (time[1] > 0 ? time[0]/time[1] : 0) << std::endl
+            << "Same depths           : " << (checksum[0] == checksum[1] ? "yes" : "NO") << std::endl;
+
+  for(size_t i=0; i<touchables.size(); i++) delete touchables[i];
+  return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ *	\file GateMaterialDatabase_startup_benchmark.cc
+ */
+
+// Measures the reading of the material database at startup, for a
+// Hounsfield (Schneider) material table. As GateHounsfieldToMaterialsBuilder
+// does, a database of generated materials is written, then each material and
+// its elements are read from GateMaterials.db and the generated database:
+// - with the former reading (rewind and scan of the file for each item),
+// - with GateMDBFile, the index being built from the text (no cache),
+// - with GateMDBFile, the index being mapped from the cache.
+// Finally the G4Materials are built by GateMaterialDatabase::GetMaterial.
+
+#include "GateMaterialDatabase.hh"
+#include "GateMDBFile.hh"
+#include "GateMDBFileIndex.hh"
+#include "GateTokenizer.hh"
+
+#include "G4Material.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+static const char * theElements[] = { "Hydrogen", "Carbon", "Nitrogen", "Oxygen", "Sodium",
+                                      "Magnesium", "Phosphor", "Sulfur", "Chlorine", "Argon",
+                                      "Potassium", "Calcium", "Titanium", "Iron" };
+static const int theNbOfElements = 14;
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Former reading of GateMDBFile: rewind and scan the file for each item
+class FormerMDBReader
+{
+public:
+  FormerMDBReader(const std::string & fileName) : mStream(fileName.c_str()) {}
+
+  // Definition line of the item and the next lines (components)
+  bool ReadItem(const std::string & section, const std::string & item, int nbNextLines)
+  {
+    if (!LookForText("[" + section + "]")) return false;
+    const std::string text = item + ":";
+    G4String line;
+    do {
+      if (ReadNonEmptyLine(line)) return false;
+      if (line.at(0) == '[') return false;
+    } while (strncmp(text.c_str(), line.c_str(), text.length()) != 0);
+    for (int i = 0; i < nbNextLines; i++) ReadNonEmptyLine(line);
+    return true;
+  }
+
+protected:
+  bool LookForText(const std::string & text)
+  {
+    mStream.clear();
+    mStream.seekg(0, std::ios::beg);
+    G4String line;
+    while (!mStream.eof()) {
+      if (ReadLine(line)) return false;
+      if (strncmp(text.c_str(), line.c_str(), text.length()) == 0) return true;
+    }
+    return false;
+  }
+  int ReadNonEmptyLine(G4String & line)
+  {
+    do {
+      if (ReadLine(line)) return 1;
+      GateTokenizer::CleanUpString(line);
+    } while (line == "");
+    return 0;
+  }
+  int ReadLine(G4String & line)
+  {
+    char buffer[256];
+    mStream.getline(buffer, 256);
+    if (mStream.eof()) return 1;
+    line = G4String(buffer);
+    return 0;
+  }
+  std::ifstream mStream;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+static double Elapsed(const std::chrono::steady_clock::time_point & start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+//-----------------------------------------------------------------------------
+
+
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateMaterialDatabase_startup_benchmark" << std::endl
+        << "Measure the reading of the material database for a Hounsfield material table" << std::endl
+        << "Usage : " << argv[0] << " [GateMaterials.db (default GateMaterials.db)]"
+        << " [number of materials (default 300)] [generated database (default HUmaterials_benchmark.db)]" << std::endl;
+  if (argc > 4) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+  const std::string mainDB = (argc > 1) ? argv[1] : "GateMaterials.db";
+  const int n = (argc > 2) ? atoi(argv[2]) : 300;
+  const std::string huDB = (argc > 3) ? argv[3] : "HUmaterials_benchmark.db";
+  if (n < 1) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+
+  // Generated materials, as GateHounsfieldMaterialTable::WriteMaterialDatabase
+  std::vector<std::string> names;
+  {
+    std::ofstream os(huDB.c_str());
+    if (!os) {
+      std::cout << "Cannot write " << huDB << std::endl;
+      exit(-1);
+    }
+    os << "[Materials]\n";
+    for (int i = 0; i < n; i++) {
+      std::ostringstream name;
+      name << "Schneider_HU_" << i;
+      names.push_back(name.str());
+      const double density = 0.00121 + 2.0*i/n;
+      os << "# Material corresponding to H=[ " << -1000+10*i << ";" << -990+10*i << " ]\n";
+      os << name.str() << ": d=" << density << " g/cm3; n=" << theNbOfElements << "; \n";
+      double sum = 0;
+      std::vector<double> fractions(theNbOfElements);
+      for (int j = 0; j < theNbOfElements; j++) sum += (fractions[j] = 1.0 + (i*7 + j*13) % 17);
+      for (int j = 0; j < theNbOfElements; j++)
+        os << "+el: name=" << theElements[j] << "; f=" << fractions[j]/sum << "\n";
+      os << "\n";
+    }
+  }
+  const std::string files[2] = { mainDB, huDB };
+  // the index is cached in the current directory
+  const std::string cacheDirectory = ".";
+  std::remove(GateMDBFileIndex::GetCacheFileName(mainDB, cacheDirectory).c_str());
+  std::remove(GateMDBFileIndex::GetCacheFileName(huDB, cacheDirectory).c_str());
+
+  // Former reading: each material in each file, then each of its
+  // elements in each file (once, the elements are then in the G4 table)
+  double former = 0;
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FormerMDBReader reader0(mainDB);
+    FormerMDBReader reader1(huDB);
+    FormerMDBReader * readers[2] = { &reader0, &reader1 };
+    int found = 0;
+    for (int i = 0; i < n; i++)
+      for (int f = 0; f < 2; f++)
+        found += readers[f]->ReadItem("Materials", names[i], theNbOfElements);
+    for (int j = 0; j < theNbOfElements; j++)
+      for (int f = 0; f < 2; f++)
+        found += readers[f]->ReadItem("Elements", theElements[j], 0);
+    former = Elapsed(start);
+    if (found != n + theNbOfElements) {
+      std::cout << "Former reading: " << found << " items found instead of " << n + theNbOfElements << std::endl;
+      exit(-1);
+    }
+  }
+
+  // GateMDBFile, without then with the cache
+  GateMaterialDatabase db;
+  db.SetCacheDirectory(cacheDirectory);
+  double current[2];
+  for (int pass = 0; pass < 2; pass++) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GateMDBFile file0(&db, mainDB);
+    GateMDBFile file1(&db, huDB);
+    GateMDBFile * mdbFiles[2] = { &file0, &file1 };
+    for (int i = 0; i < n; i++)
+      for (int f = 0; f < 2; f++)
+        delete mdbFiles[f]->ReadMaterial(names[i]);
+    for (int j = 0; j < theNbOfElements; j++)
+      for (int f = 0; f < 2; f++)
+        delete mdbFiles[f]->ReadElement(theElements[j]);
+    current[pass] = Elapsed(start);
+  }
+
+  // Whole startup: G4Materials built by the database
+  double build = 0;
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GateMaterialDatabase database;
+    database.SetCacheDirectory(cacheDirectory);
+    database.AddMDBFile(mainDB);
+    database.AddMDBFile(huDB);
+    for (int i = 0; i < n; i++) database.GetMaterial(names[i]);
+    build = Elapsed(start);
+  }
+
+  std::cout << n << " materials of " << theNbOfElements << " elements" << std::endl
+            << "  former reading (ms)        : " << 1e3*former << std::endl
+            << "  index from the text (ms)   : " << 1e3*current[0] << std::endl
+            << "  index from the cache (ms)  : " << 1e3*current[1] << std::endl
+            << "  speedup (cache)            : " << (current[1] > 0 ? former/current[1] : 0) << std::endl
+            << "  G4Materials built (ms)     : " << 1e3*build << std::endl
+            << "  materials in the G4 table  : " << G4Material::GetNumberOfMaterials() << std::endl;
+  return 0;
+}
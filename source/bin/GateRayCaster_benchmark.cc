@@ -0,0 +1,242 @@
+/*
+ *	\file GateRayCaster_benchmark.cc
+ */
+
+// Measures the ray-casting of the track-length estimators (SETLE) in a
+// labelled CT-like image (water, with lung, bone and air regions). Rays
+// start at random points in the image, with random directions and energies,
+// and their dose is scored in a dose array:
+// - with the former ray-casting of GateSETLEDoseActor (one ray after the
+//   other, a mu table by voxel),
+// - with GateRayCaster (packets of rays, mu and dose factor by label
+//   computed once by ray).
+
+#include "GateRayCaster.hh"
+#include "GateMuTables.hh"
+
+#include "G4MaterialCutsCouple.hh"
+#include "G4NistManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Former ray-casting of GateSETLEDoseActor::RayCast
+static double FormerRayCast(const std::vector<GateMuTable*> & muTableOfVoxel, const int resolution[3],
+                            const double voxelSize[3], double energy, double weight,
+                            const double position[3], const double momentum[3], std::vector<double> & dose)
+{
+  double halfSize[3];
+  int incr[3], v[3];
+  double L[3], R[3];
+  double totalLength = 1.0e15;
+  for(int a=0; a<3; a++) {
+    halfSize[a] = resolution[a]*voxelSize[a]/2.0;
+    incr[a] = (momentum[a] > 0.0) ? 1 : -1;
+    L[a] = incr[a]*voxelSize[a]/momentum[a];
+    v[a] = (int)floor((position[a]+halfSize[a])/voxelSize[a]);
+    if (v[a] < 0) v[a] = 0;
+    else if (v[a] >= resolution[a]) v[a] = resolution[a]-1;
+    double exit = 1.0e15;
+    if (momentum[a] > 0.0) {
+      R[a] = (-halfSize[a] + (v[a]+1)*voxelSize[a] - position[a])/momentum[a];
+      exit = (halfSize[a] - position[a])/momentum[a];
+    }
+    else if (momentum[a] < 0.0) {
+      R[a] = incr[a]*(position[a] - (-halfSize[a] + v[a]*voxelSize[a]))/momentum[a];
+      exit = (-halfSize[a] - position[a])/momentum[a];
+    }
+    else R[a] = 2.0e15;
+    if (exit < totalLength) totalLength = exit;
+  }
+
+  const int lineSize = resolution[0];
+  const int planeSize = resolution[0]*resolution[1];
+  double length = 0.0;
+  double delta_in = weight;
+  double delta_out = 0.0;
+  while(length < totalLength-0.00001) {
+    const int index = v[0]+v[1]*lineSize+v[2]*planeSize;
+    const double mu = muTableOfVoxel[index]->GetMu(energy);
+    const double muenOverRho = muTableOfVoxel[index]->GetMuEnOverRho(energy);
+    int a = 2;
+    if (R[0] < R[1] && R[0] < R[2]) a = 0;
+    else if (R[1] < R[2]) a = 1;
+    const double step = R[a];
+    delta_out = delta_in*exp(-mu*step/10.);
+    length += step;
+    for(int b=0; b<3; b++) R[b] -= step;
+    R[a] = L[a];
+    v[a] += incr[a];
+    dose[index] += energy*muenOverRho*(delta_in-delta_out)/mu;
+    delta_in = delta_out;
+    if (v[a] < 0 || v[a] >= resolution[a]) break;
+  }
+  return delta_out;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Synthetic mu/muen table (log storage, as GateMaterialMuHandler)
+static GateMuTable * CreateMuTable(const G4MaterialCutsCouple * couple, double scale)
+{
+  const int size = 64;
+  GateMuTable * table = new GateMuTable(couple, size);
+  for(int i=0; i<size; i++) {
+    const double energy = 0.001*pow(10.0, 4.0*i/(size-1)); // 1 keV - 10 MeV
+    const double muOverRho = scale*(0.02 + 0.2/sqrt(energy) + 0.001/(energy*energy*energy));
+    table->PutValue(i, log(energy), log(muOverRho), log(0.5*muOverRho));
+  }
+  return table;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateRayCaster_benchmark" << std::endl
+        << "Measure the ray-casting of the track-length estimators" << std::endl
+        << "Usage : " << argv[0] << " [rays (default 200000)] [voxels per axis (default 128)]" << std::endl;
+  if (argc > 3) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+  const int nbRays = (argc > 1) ? atoi(argv[1]) : 200000;
+  const int nbVoxels = (argc > 2) ? atoi(argv[2]) : 128;
+  if (nbRays < 1 || nbVoxels < 1) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+
+  // Materials and mu tables
+  const char * materials[4] = { "G4_WATER", "G4_LUNG_ICRP", "G4_BONE_CORTICAL_ICRP", "G4_AIR" };
+  const double scales[4] = { 1.0, 0.95, 1.3, 1.0 };
+  std::vector<GateMuTable*> muTableOfLabel;
+  for(int m=0; m<4; m++) {
+    G4Material * material = G4NistManager::Instance()->FindOrBuildMaterial(materials[m]);
+    muTableOfLabel.push_back(CreateMuTable(new G4MaterialCutsCouple(material), scales[m]));
+  }
+
+  // Image: water, two lungs, a spine and air around
+  const int resolution[3] = { nbVoxels, nbVoxels, nbVoxels };
+  const double voxelSize[3] = { 256.0*mm/nbVoxels, 256.0*mm/nbVoxels, 256.0*mm/nbVoxels };
+  const int nbOfVoxels = nbVoxels*nbVoxels*nbVoxels;
+  std::vector<int> labelOfVoxel(nbOfVoxels);
+  std::vector<GateMuTable*> muTableOfVoxel(nbOfVoxels);
+  for(int z=0; z<nbVoxels; z++)
+    for(int y=0; y<nbVoxels; y++)
+      for(int x=0; x<nbVoxels; x++) {
+        const double px = 2.0*(x+0.5)/nbVoxels-1.0;
+        const double py = 2.0*(y+0.5)/nbVoxels-1.0;
+        int label = 0;
+        if (px*px/0.8 + py*py/0.5 > 1.0) label = 3;
+        else if ((px-0.4)*(px-0.4) + py*py < 0.09 || (px+0.4)*(px+0.4) + py*py < 0.09) label = 1;
+        else if (px*px + (py+0.45)*(py+0.45) < 0.01) label = 2;
+        const int index = x + y*nbVoxels + z*nbVoxels*nbVoxels;
+        labelOfVoxel[index] = label;
+        muTableOfVoxel[index] = muTableOfLabel[label];
+      }
+
+  // Rays
+  std::vector<double> rays(7*nbRays);
+  for(int r=0; r<nbRays; r++) {
+    double * ray = &rays[7*r];
+    for(int a=0; a<3; a++) ray[a] = (G4UniformRand()-0.5)*resolution[a]*voxelSize[a];
+    const double cosTheta = 2.0*G4UniformRand()-1.0;
+    const double sinTheta = sqrt(1.0-cosTheta*cosTheta);
+    const double phi = 2.0*M_PI*G4UniformRand();
+    ray[3] = sinTheta*cos(phi);
+    ray[4] = sinTheta*sin(phi);
+    ray[5] = cosTheta;
+    ray[6] = 0.02 + 0.2*G4UniformRand(); // MeV
+  }
+
+  // Former ray-casting
+  std::vector<double> dose[2];
+  double time[2];
+  long long nbSegments = 0;
+  dose[0].assign(nbOfVoxels, 0.0);
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int r=0; r<nbRays; r++) {
+      const double * ray = &rays[7*r];
+      FormerRayCast(muTableOfVoxel, resolution, voxelSize, ray[6], 1.0, ray, ray+3, dose[0]);
+    }
+    time[0] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // GateRayCaster
+  dose[1].assign(nbOfVoxels, 0.0);
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GateRayCaster caster;
+    caster.SetGrid(G4ThreeVector(resolution[0], resolution[1], resolution[2]),
+                   G4ThreeVector(voxelSize[0], voxelSize[1], voxelSize[2]));
+    caster.SetLabels(labelOfVoxel);
+    GateRayCaster::Packet packet;
+    std::vector<double> mu[GateRayCaster::PacketSize];
+    std::vector<double> doseFactor[GateRayCaster::PacketSize];
+    std::vector<GateRaySegment> segments;
+    for(int l=0; l<GateRayCaster::PacketSize; l++) {
+      mu[l].resize(muTableOfLabel.size());
+      doseFactor[l].resize(muTableOfLabel.size());
+    }
+    for(int r=0; r<nbRays; r+=GateRayCaster::PacketSize) {
+      packet.size = std::min(GateRayCaster::PacketSize, nbRays-r);
+      for(int l=0; l<packet.size; l++) {
+        const double * ray = &rays[7*(r+l)];
+        for(int a=0; a<3; a++) {
+          packet.position[a][l] = ray[a];
+          packet.direction[a][l] = ray[3+a];
+        }
+        packet.weight[l] = 1.0;
+        for(size_t label=0; label<muTableOfLabel.size(); label++) {
+          const double muLabel = muTableOfLabel[label]->GetMu(ray[6]);
+          mu[l][label] = muLabel/10.;
+          doseFactor[l][label] = ray[6]*muTableOfLabel[label]->GetMuEnOverRho(ray[6])/muLabel;
+        }
+        packet.mu[l] = &mu[l][0];
+      }
+      segments.clear();
+      caster.Trace(packet, segments);
+      for(size_t s=0; s<segments.size(); s++) {
+        const GateRaySegment & segment = segments[s];
+        dose[1][segment.index] += doseFactor[segment.ray][segment.label]*(segment.weightIn-segment.weightOut);
+      }
+      nbSegments += segments.size();
+    }
+    time[1] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  double total[2] = { 0.0, 0.0 };
+  double maxDifference = 0.0;
+  for(int i=0; i<nbOfVoxels; i++) {
+    total[0] += dose[0][i];
+    total[1] += dose[1][i];
+    maxDifference = std::max(maxDifference, fabs(dose[0][i]-dose[1][i]));
+  }
+
+  std::cout << "Voxels                : " << nbVoxels << "^3" << std::endl
+            << "Rays                  : " << nbRays << std::endl
+            << "Segments by ray       : " << double(nbSegments)/nbRays << std::endl
+            << "Former (rays/s)       : " << nbRays/time[0] << std::endl
+            << "GateRayCaster (rays/s): " << nbRays/time[1] << std::endl
+            << "Speedup               : " << (time[1] > 0 ? time[0]/time[1] : 0) << std::endl
+            << "Total dose            : " << total[0] << " / " << total[1] << std::endl
+            << "Max voxel difference  : " << maxDifference << std::endl;
+
+  for(size_t m=0; m<muTableOfLabel.size(); m++) delete muTableOfLabel[m];
+  return 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,295 @@
+/*
+ *	\file GateSourcePhaseSpace_read_benchmark.cc
+ */
+
+// Measures the reading of the particles of a phase space by the phase space
+// source. A phase space of random gammas and electrons is written in root,
+// npy, gtc (chunked, compressed) and IAEA formats. The root, npy and gtc
+// files are read entry by entry with a search of the particle definition for
+// each entry (former reading), and with the read-ahead thread and the cached
+// particle definition. The IAEA file is read with
+// iaea_record_type::read_particle (fread) and with GateIAEAMappedFile. An
+// optional busy loop per particle stands for the tracking, which the
+// read-ahead thread overlaps with the reading.
+
+#include "GateIAEAMappedFile.hh"
+#include "GateIAEARecord.h"
+#include "GatePhaseSpacePrefetcher.hh"
+#include "GateTreeFileManager.hh"
+
+#include "G4Electron.hh"
+#include "G4Gamma.hh"
+#include "G4ParticleTable.hh"
+#include "Randomize.hh"
+
+#include "TROOT.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+static volatile double gWorkSink = 0;
+
+// Busy loop of about ns nanoseconds, standing for the simulation of a particle
+static void Work(int ns)
+{
+  if (ns <= 0) return;
+  const std::chrono::steady_clock::time_point end =
+    std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+  double s = 0;
+  while (std::chrono::steady_clock::now() < end) s += 1.;
+  gWorkSink = gWorkSink + s;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+static void BindEntry(GateInputTreeFileChain & chain, GatePhaseSpaceEntry & e)
+{
+  chain.read_variable("ParticleName", e.particleName, 64);
+  chain.read_variable("Ekine", &e.energy);
+  chain.read_variable("X", &e.x);
+  chain.read_variable("Y", &e.y);
+  chain.read_variable("Z", &e.z);
+  chain.read_variable("dX", &e.dx);
+  chain.read_variable("dY", &e.dy);
+  chain.read_variable("dZ", &e.dz);
+  chain.read_variable("Weight", &e.weight);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Time (s) to read the file entry by entry, searching the particle for each entry
+static double ReadEntries(const std::string & fileName, const std::string & kind,
+                          long long n, int work, double & checksum)
+{
+  GateInputTreeFileChain chain;
+  chain.add_file(fileName, kind);
+  chain.set_tree_name("PhaseSpace");
+  chain.read_header();
+  GatePhaseSpaceEntry e;
+  BindEntry(chain, e);
+  G4ParticleTable * table = G4ParticleTable::GetParticleTable();
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (long long i = 0; i < n; i++) {
+    chain.read_entrie(i);
+    const G4ParticleDefinition * p = table->FindParticle(e.particleName);
+    checksum += e.energy + e.x + p->GetPDGMass();
+    Work(work);
+  }
+  const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  chain.close();
+  return time;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Time (s) to read the file with the read-ahead thread and the cached particle
+static double ReadAhead(const std::string & fileName, const std::string & kind,
+                        long long n, int blockSize, int work, double & checksum)
+{
+  GateInputTreeFileChain chain;
+  chain.add_file(fileName, kind);
+  chain.set_tree_name("PhaseSpace");
+  chain.read_header();
+  GatePhaseSpaceEntry e;
+  BindEntry(chain, e);
+  G4ParticleTable * table = G4ParticleTable::GetParticleTable();
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double waiting = 0;
+  {
+    GatePhaseSpacePrefetcher prefetcher([&chain, &e](G4long i, GatePhaseSpaceEntry & out) {
+        chain.read_entrie(i);
+        out = e;
+      }, n, blockSize);
+    prefetcher.Start(0);
+    std::string name;
+    const G4ParticleDefinition * p = 0;
+    for (long long i = 0; i < n; i++) {
+      const GatePhaseSpaceEntry & entry = prefetcher.GetEntry(i);
+      if (!p || name != entry.particleName) {
+        p = table->FindParticle(entry.particleName);
+        name = entry.particleName;
+      }
+      checksum += entry.energy + entry.x + p->GetPDGMass();
+      Work(work);
+    }
+    waiting = prefetcher.GetWaitingTime();
+  }
+  const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "  (waiting for the thread: " << waiting << " s)" << std::endl;
+  chain.close();
+  return time;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+static void InitializeIAEARecord(iaea_record_type & record, FILE * file)
+{
+  // contents of iaea_record_type::initialize, with the w director cosine
+  memset(&record, 0, sizeof(record));
+  record.p_file = file;
+  record.ix = record.iy = record.iz = 1;
+  record.iu = record.iv = record.iw = 1;
+  record.iweight = 1;
+  record.iextrafloat = 0;
+  record.iextralong = 1;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+static void Report(const std::string & title, long long n, double former, double current)
+{
+  std::cout << title << std::endl
+            << "  former (Mparticles/s) : " << 1e-6*n/former << std::endl
+            << "  new (Mparticles/s)    : " << 1e-6*n/current << std::endl
+            << "  speedup               : " << (current > 0 ? former/current : 0) << std::endl;
+}
+//-----------------------------------------------------------------------------
+
+
+int main(int argc, char *argv[])
+{
+  // Usage
+  std::ostringstream usage;
+  usage << std::endl
+        << "GateSourcePhaseSpace_read_benchmark" << std::endl
+        << "Measure the reading of the phase space source" << std::endl
+        << "Usage : " << argv[0] << " [particles (default 2000000)] [read-ahead block size (default 10000)]"
+        << " [work per particle in ns (default 0)] [file prefix (default phsp_benchmark)]" << std::endl;
+  if (argc > 5) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+  const long long n = (argc > 1) ? atoll(argv[1]) : 2000000;
+  const int blockSize = (argc > 2) ? atoi(argv[2]) : 10000;
+  const int work = (argc > 3) ? atoi(argv[3]) : 0;
+  const std::string prefix = (argc > 4) ? argv[4] : "phsp_benchmark";
+  if (n < 1 || blockSize < 1 || work < 0) {
+    std::cout << usage.str() << std::endl;
+    exit(0);
+  }
+
+  ROOT::EnableThreadSafety();
+  const G4ParticleDefinition * gamma = G4Gamma::Gamma();
+  const G4ParticleDefinition * electron = G4Electron::Electron();
+
+  // Phase space: 90% gammas
+  {
+    GateOutputTreeFileManager out;
+    out.add_file(prefix + ".root", "root");
+    out.add_file(prefix + ".npy", "npy");
+    out.add_file(prefix + ".gtc", "gtc");
+    out.set_tree_name("PhaseSpace");
+    char name[64];
+    float energy, x, y, z, dx, dy, dz, weight = 1.f;
+    out.write_variable("ParticleName", name, sizeof(name));
+    out.write_variable("Ekine", &energy);
+    out.write_variable("X", &x);
+    out.write_variable("Y", &y);
+    out.write_variable("Z", &z);
+    out.write_variable("dX", &dx);
+    out.write_variable("dY", &dy);
+    out.write_variable("dZ", &dz);
+    out.write_variable("Weight", &weight);
+    out.write_header();
+
+    FILE * iaea = fopen((prefix + ".IAEAphsp").c_str(), "wb");
+    if (!iaea) {
+      std::cout << "Cannot write " << prefix << ".IAEAphsp" << std::endl;
+      exit(-1);
+    }
+    iaea_record_type record;
+    InitializeIAEARecord(record, iaea);
+
+    memset(name, 0, sizeof(name));
+    for (long long i = 0; i < n; i++) {
+      const bool isGamma = G4UniformRand() < 0.9;
+      strcpy(name, isGamma ? gamma->GetParticleName().c_str() : electron->GetParticleName().c_str());
+      energy = 6*G4UniformRand();
+      x = 200*G4UniformRand() - 100;
+      y = 200*G4UniformRand() - 100;
+      z = 100;
+      dx = 0.2*G4UniformRand() - 0.1;
+      dy = 0.2*G4UniformRand() - 0.1;
+      dz = sqrt(1 - dx*dx - dy*dy);
+      out.fill();
+
+      record.particle = isGamma ? 1 : 2;
+      record.IsNewHistory = 0;
+      record.energy = energy;
+      record.x = x/10;
+      record.y = y/10;
+      record.z = z/10;
+      record.u = dx;
+      record.v = dy;
+      record.w = dz;
+      record.weight = weight;
+      record.extralong[0] = i;
+      record.write_particle();
+    }
+    out.close();
+    fclose(iaea);
+  }
+
+  // root, npy and gtc
+  const char * kinds[3] = { "root", "npy", "gtc" };
+  for (int k = 0; k < 3; k++) {
+    double checksum[2] = { 0, 0 };
+    const std::string fileName = prefix + "." + kinds[k];
+    const double former = ReadEntries(fileName, kinds[k], n, work, checksum[0]);
+    const double current = ReadAhead(fileName, kinds[k], n, blockSize, work, checksum[1]);
+    Report(fileName, n, former, current);
+    std::cout << "  same particles        : " << (checksum[0] == checksum[1] ? "yes" : "NO") << std::endl;
+    std::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+    std::cout << "  file size (MB)        : " << 1e-6*file.tellg() << std::endl;
+  }
+
+  // IAEA
+  {
+    const std::string fileName = prefix + ".IAEAphsp";
+    double checksum[2] = { 0, 0 };
+    double time[2];
+    iaea_record_type record;
+
+    FILE * file = fopen(fileName.c_str(), "rb");
+    InitializeIAEARecord(record, file);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < n; i++) {
+      record.read_particle();
+      checksum[0] += record.energy + record.x + record.w;
+      Work(work);
+    }
+    time[0] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fclose(file);
+
+    InitializeIAEARecord(record, 0);
+    GateIAEAMappedFile mapped;
+    if (!mapped.Open(fileName, &record, 0)) {
+      std::cout << "Cannot map " << fileName << std::endl;
+      exit(-1);
+    }
+    start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < n; i++) {
+      mapped.ReadParticle(&record);
+      checksum[1] += record.energy + record.x + record.w;
+      Work(work);
+    }
+    time[1] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Report(fileName, n, time[0], time[1]);
+    std::cout << "  same particles        : " << (checksum[0] == checksum[1] ? "yes" : "NO") << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateActionInitialization
+  \brief  Creates the Gate user actions for the master and for each
+  worker thread (GATE_USE_MT only, the sequential build registers them
+  directly in Gate.cc).
+
+  The master owns the run action and, unregistered, a stepping action
+  and a primary generator action, so that their messengers exist and
+  the settings of the macro are stored. The workers get a full set of
+  actions; their stepping action copies the settings of the master.
+*/
+
+#ifndef GATEACTIONINITIALIZATION_HH
+#define GATEACTIONINITIALIZATION_HH
+
+#include "G4VUserActionInitialization.hh"
+
+class GateSteppingAction;
+class GatePrimaryGeneratorAction;
+
+//-----------------------------------------------------------------------------
+class GateActionInitialization : public G4VUserActionInitialization
+{
+public:
+  GateActionInitialization();
+  virtual ~GateActionInitialization() {}
+
+  virtual void BuildForMaster() const;
+  virtual void Build() const;
+  virtual G4VSteppingVerbose * InitializeSteppingVerbose() const;
+
+protected:
+  mutable GateSteppingAction * mMasterSteppingAction;
+  mutable GatePrimaryGeneratorAction * mMasterPrimaryGeneratorAction;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEACTIONINITIALIZATION_HH */
@@ -63,7 +63,7 @@ private:
 
   G4int runIDcounter;
   G4bool flagBasicOutput;
-  static GateRunAction* prunAction;
+  static G4ThreadLocal GateRunAction* prunAction;
 };
 //-----------------------------------------------------------------------------
 
@@ -93,7 +93,7 @@ private:
   GateUserActions* pCallbackMan;
 
   G4bool flagBasicOutput;
-  static GateEventAction* peventAction;
+  static G4ThreadLocal GateEventAction* peventAction;
 };
 //-----------------------------------------------------------------------------
 
@@ -158,9 +158,14 @@ public :
   G4int NoMoreTracksData()  { return ( m_currentN == m_Nfiles - 1 ); };
   void ShowG4TrackInfos( G4String  outF, G4Track* aTrack);
 
+  static inline GateSteppingAction* GetSteppingAction() { return pSteppingAction; };
+  /// Copy the settings of the master action (set by the messenger) to a worker action
+  void CopySettings(const GateSteppingAction & a);
+
   //-----------------------------------------------------------------------------
 private:
   GateSteppingAction() {}
+  static G4ThreadLocal GateSteppingAction* pSteppingAction;
   GateUserActions* pCallbackMan;
   G4int m_drawTrjLevel;
   G4int m_verboseLevel;
@@ -116,7 +116,7 @@ protected:
   std::vector<GateVActor*> theListOfActorsEnabledForRecordEndOfAcquisition;
 
   GateActorManagerMessenger* pActorManagerMessenger;  //pointer to the Messenger
-  G4int mCurrentEventId;
+  static G4ThreadLocal G4int mCurrentEventId; // event of the calling thread
 
 private:
   int IsInitialized;
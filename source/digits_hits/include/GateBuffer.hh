@@ -40,6 +40,9 @@ class GateBuffer : public GateVPulseProcessor
     void SetDepth(size_t depth);
     virtual void DescribeMyself(size_t indent);
 
+    //! Time to read a full buffer
+    virtual G4double GetMemoryTime() const { return (m_bufferSize+1)/m_readFrequency; }
+
   protected:
     //! Implementation of the pure virtual method declared by the base class GateVPulseProcessor
     //! This methods processes one input-pulse
@@ -12,8 +12,8 @@ See LICENSE.md for further details
 
 #include "globals.hh"
 #include <iostream>
-#include <list>
 #include <deque>
+#include <vector>
 #include "G4ThreeVector.hh"
 
 #include "GateCoincidencePulse.hh"
@@ -188,7 +188,20 @@ private:
     //! \name Work storage variable
     //@{
 
-    std::list<GatePulse*> m_presortBuffer;      // incoming pulses are presorted and buffered
+    // Incoming pulses are presorted and buffered in a binary min-heap on
+    // (time, arrival order): insertion and extraction are O(log N), and
+    // pulses with the same time leave the buffer in arrival order.
+    struct PresortEntry {
+      G4double   time;
+      G4long     order;
+      GatePulse* pulse;
+    };
+    struct PresortEntryIsLater {
+      inline bool operator()(const PresortEntry& a, const PresortEntry& b) const
+      { return a.time > b.time || (a.time == b.time && a.order > b.order); }
+    };
+    std::vector<PresortEntry> m_presortBuffer;
+    G4long                m_presortOrder;       // arrival counter
     G4int                 m_presortBufferSize;
     G4bool                m_presortWarning;     // avoid repeat warnings
     bool                m_CCSorter;     // compton camera sorter
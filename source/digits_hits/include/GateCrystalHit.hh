@@ -22,6 +22,7 @@ See LICENSE.md for further details
 
 #include "GateVolumeID.hh"
 #include "GateOutputVolumeID.hh"
+#include "GateInternedString.hh"
 
 /*! \class  GateCrystalHit
     \brief  Stores hit information for a hit taking place in a volume connected to a system
@@ -64,7 +65,7 @@ private:
   G4double m_posz;
   G4ThreeVector m_momDir;        // momentum Direction of the current hit
   G4ThreeVector m_localPos;   // position of the current hit
-  G4String m_process;         // process on the current hit
+  GateInternedString m_process; // process on the current hit
   G4int m_PDGEncoding;        // G4 PDGEncoding
   G4int m_trackID;            // track ID
   G4int m_parentID;           // parent track ID
@@ -75,8 +76,8 @@ private:
   G4int m_nCrystalCompton;    // # of compton processes in the crystal occurred to the photon
   G4int m_nPhantomRayleigh;    // # of Rayleigh processes in the phantom occurred to the photon
   G4int m_nCrystalRayleigh;    // # of Rayleigh processes in the crystal occurred to the photon
-  G4String m_comptonVolumeName; // name of the volume of the last (if any) compton scattering
-  G4String m_RayleighVolumeName; // name of the volume of the last (if any) Rayleigh scattering
+  GateInternedString m_comptonVolumeName; // name of the volume of the last (if any) compton scattering
+  GateInternedString m_RayleighVolumeName; // name of the volume of the last (if any) Rayleigh scattering
   G4int m_primaryID;          // primary that caused the hit
   G4int m_eventID;            // eventID
   G4int m_runID;              // runID
@@ -94,7 +95,7 @@ private:
 
 
 // AE : Added for IdealComptonPhot adder which take into account several Comptons in the same volume
-  G4String m_Postprocess;         // PostStep process 
+  GateInternedString m_Postprocess; // PostStep process 
   G4double m_energyIniTrack;         // Initial energy of the track
   G4double m_energyFin;         // final energy of the particle
   G4double m_sourceEnergy;//AE
@@ -134,8 +135,8 @@ private:
       inline const G4ThreeVector& GetLocalPos() const             { return m_localPos; }
 
 
-      inline void     SetProcess(G4String proc) { m_process = proc; }
-      inline G4String GetProcess() const             { return m_process; }
+      inline void     SetProcess(const G4String& proc) { m_process = proc; }
+      inline const G4String& GetProcess() const { return m_process; }
 
       inline void  SetPDGEncoding(G4int j)      { m_PDGEncoding = j; }
       inline G4int GetPDGEncoding() const            { return m_PDGEncoding; }
@@ -167,11 +168,11 @@ private:
       inline void  SetNCrystalRayleigh(G4int j)  { m_nCrystalRayleigh = j; }
       inline G4int GetNCrystalRayleigh() const        { return m_nCrystalRayleigh; }
 
-      inline void     SetComptonVolumeName(G4String name) { m_comptonVolumeName = name; }
-      inline G4String GetComptonVolumeName() const        { return m_comptonVolumeName; }
+      inline void     SetComptonVolumeName(const G4String& name) { m_comptonVolumeName = name; }
+      inline const G4String& GetComptonVolumeName() const { return m_comptonVolumeName; }
 
-      inline void     SetRayleighVolumeName(G4String name) { m_RayleighVolumeName = name; }
-      inline G4String GetRayleighVolumeName() const        { return m_RayleighVolumeName; }
+      inline void     SetRayleighVolumeName(const G4String& name) { m_RayleighVolumeName = name; }
+      inline const G4String& GetRayleighVolumeName() const { return m_RayleighVolumeName; }
 
       inline void  SetPrimaryID(G4int j)        { m_primaryID = j; }
       inline G4int GetPrimaryID() const              { return m_primaryID; }
@@ -209,8 +210,8 @@ private:
 
 
       // AE : Added for IdealComptonPhot adder which take into account several Comptons in the same volume 
-      inline void     SetPostStepProcess(G4String proc) { m_Postprocess = proc; }
-      inline G4String GetPostStepProcess() const             { return m_Postprocess; }
+      inline void     SetPostStepProcess(const G4String& proc) { m_Postprocess = proc; }
+      inline const G4String& GetPostStepProcess() const { return m_Postprocess; }
      
       inline void SetEnergyIniTrack(G4double eIni)          { m_energyIniTrack = eIni; }
       inline G4double GetEnergyIniTrack() const                { return m_energyIniTrack; }
@@ -257,18 +258,20 @@ private:
 
 typedef G4THitsCollection<GateCrystalHit> GateCrystalHitsCollection;
 
-extern G4Allocator<GateCrystalHit> GateCrystalHitAllocator;
+// One pool per thread: hits are created by the sensitive detectors and
+// deleted with the hits collections of the event, in the same thread
+extern G4ThreadLocal G4Allocator<GateCrystalHit> * GateCrystalHitAllocator;
 
 inline void* GateCrystalHit::operator new(size_t)
 {
-  void *aHit;
-  aHit = (void *) GateCrystalHitAllocator.MallocSingle();
-  return aHit;
+  if (!GateCrystalHitAllocator)
+    GateCrystalHitAllocator = new G4Allocator<GateCrystalHit>;
+  return (void *) GateCrystalHitAllocator->MallocSingle();
 }
 
 inline void GateCrystalHit::operator delete(void *aHit)
 {
-  GateCrystalHitAllocator.FreeSingle((GateCrystalHit*) aHit);
+  GateCrystalHitAllocator->FreeSingle((GateCrystalHit*) aHit);
 }
 
 #endif
@@ -89,6 +89,8 @@ class GateCrystalSD : public G4VSensitiveDetector
 
       static const G4String theCrystalCollectionName; //! Name of the hit collection
 
+      G4int m_profilerCounter;                        //! GateProfiler counter of ProcessHits
+
 };
 
 
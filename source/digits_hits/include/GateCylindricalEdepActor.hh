@@ -58,6 +58,8 @@ class GateCylindricalEdepActor : public GateVImageActor
   virtual void UserPreTrackActionInVoxel(const int /*index*/, const G4Track* track);
   virtual void UserPostTrackActionInVoxel(const int /*index*/, const G4Track* /*t*/) {}
 
+  virtual bool SupportsMultithreading() const { return true; }
+
   //  Saves the data collected to the file
   virtual void SaveData();
   virtual void ResetData();
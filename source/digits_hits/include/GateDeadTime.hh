@@ -56,6 +56,9 @@ public:
   //! Set the deadTime
   void SetDeadTime(G4double val) { m_deadTime = (unsigned long long int)(val/picosecond); }
 
+  //! A pulse keeps its volume dead during the dead time
+  virtual G4double GetMemoryTime() const { return m_deadTime*picosecond; }
+
   //! Set the deadTime mode ; candidates : paralysable nonparalysable
   void SetDeadTimeMode(G4String val);
   //! Set the buffer mode ;
@@ -30,6 +30,7 @@
 #include "GateImageWithStatistic.hh"
 #include "GateVoxelizedMass.hh"
 #include "GateRegionDoseStat.hh"
+#include "GateStoppingPowerRatioTable.hh"
 
 class G4EmCalculator;
 
@@ -71,11 +72,15 @@ public:
   void EnableDoseToOtherMaterialNormalisationToMax(bool b);
   void EnableDoseToOtherMaterialNormalisationToIntegral(bool b);
   void SetOtherMaterial(G4String b) { mOtherMaterial = b; }
+  //Stopping power ratio tables (DoseToWater, DoseToOtherMaterial)
+  void EnableStoppingPowerRatioTable(bool b) { mIsStoppingPowerRatioTableEnabled = b; }
+  void SetStoppingPowerRatioTolerance(double t) { mStoppingPowerRatioTolerance = t; }
   //Others
   void EnableNumberOfHitsImage(bool b) { mIsNumberOfHitsImageEnabled = b; }
   void SetDoseAlgorithmType(G4String b) { mDoseAlgorithmType = b; }
   void ImportMassImage(G4String b) { mImportMassImage = b; }
   void ExportMassImage(G4String b) { mExportMassImage = b; }
+  void SetMassCacheDirectory(G4String b) { mMassCacheDirectory = b; }
   void VolumeFilter(G4String b) { mVolumeFilter = b; }
   void MaterialFilter(G4String b) { mMaterialFilter = b; }
   void setTestFlag(bool b) { mTestFlag = b; }
@@ -91,6 +96,8 @@ public:
   virtual void UserPreTrackActionInVoxel(const int /*index*/, const G4Track* track);
   virtual void UserPostTrackActionInVoxel(const int /*index*/, const G4Track* /*t*/) {}
 
+  virtual bool SupportsMultithreading() const { return true; }
+
   //  Saves the data collected to the file
   virtual void SaveData();
   virtual void ResetData();
@@ -157,6 +164,18 @@ protected:
   G4String mDoseToOtherMaterialFilename;
   GateImageWithStatistic mDoseToOtherMaterialImage;
   G4String mOtherMaterial;
+  G4Material * pOtherMaterial;
+  //Stopping power ratio tables
+  bool mIsStoppingPowerRatioTableEnabled;
+  double mStoppingPowerRatioTolerance;
+  double mStoppingPowerRatioMaxDeviation;
+  GateStoppingPowerRatioTable mDoseToWaterRatioTable;
+  GateStoppingPowerRatioTable mDoseToOtherMaterialRatioTable;
+  void BuildStoppingPowerRatioTables();
+  double GetStoppingPowerRatio(GateStoppingPowerRatioTable & table,
+                               const G4ParticleDefinition * p,
+                               const G4Material * m,
+                               double energy);
   //Hits
   G4String mNbOfHitsFilename;
   GateImageInt mNumberOfHitsImage;
@@ -175,11 +194,24 @@ protected:
   G4String mDoseAlgorithmType;
   G4String mImportMassImage;
   G4String mExportMassImage;
+  G4String mMassCacheDirectory;
   G4String mVolumeFilter;
   G4String mMaterialFilter;
 
   G4EmCalculator* emcalc;
 
+#ifdef GATE_USE_MT
+  // Last hit event and number of hits of each worker thread (the edep
+  // and dose images are accumulated by GateVImageActor)
+  struct ThreadHits {
+    std::vector<int> mLastHitEvent;
+    std::vector<int> mNumberOfHits;
+  };
+  std::vector<ThreadHits> mThreadHits;
+  virtual void AllocateThreadBuffers(int nbOfThreads);
+  virtual void MergeThreadBuffers();
+#endif
+
 };
 
 MAKE_AUTO_CREATOR_ACTOR(DoseActor,GateDoseActor)
@@ -18,6 +18,7 @@
 
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
 #include "GateImageActorMessenger.hh"
 
 class GateDoseActor;
@@ -59,11 +60,14 @@ protected:
   G4UIcmdWithABool * pEnableDoseToOtherMaterialNormToMaxCmd;
   G4UIcmdWithABool * pEnableDoseToOtherMaterialNormToIntegralCmd;
   G4UIcmdWithAString * pSetOtherMaterialCmd;
+  G4UIcmdWithABool * pEnableStoppingPowerRatioTableCmd;
+  G4UIcmdWithADouble * pSetStoppingPowerRatioToleranceCmd;
   //Others
   G4UIcmdWithABool * pEnableNumberOfHitsCmd;
   G4UIcmdWithAString * pSetDoseAlgorithmCmd;
   G4UIcmdWithAString * pImportMassImageCmd;
   G4UIcmdWithAString * pExportMassImageCmd;
+  G4UIcmdWithAString * pMassCacheDirectoryCmd;
   G4UIcmdWithAString * pVolumeFilterCmd;
   G4UIcmdWithAString * pMaterialFilterCmd;
   G4UIcmdWithABool * pTestFlagCmd;
@@ -0,0 +1,94 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateEventPool
+  \brief  Per-thread arena of fixed size objects, reset at the end of each event.
+
+  Objects are allocated by bumping a pointer in aligned chunks owned by
+  the thread, and are never reused one by one: each chunk counts its
+  live objects, and Reset() (at the end of the event, by the owner
+  thread) rewinds the chunks whose objects are all deleted. The few
+  objects kept from an event to the next (coincidence sorter, pile-up
+  buffers) only keep their own chunk busy until they are deleted.
+
+  An object may be deleted by any thread (e.g. a pulse buffered by the
+  shared coincidence sorter): Free() only decrements the counter of the
+  chunk, found from the address, which is atomic. The chunks are never
+  given back to the system.
+*/
+
+#ifndef GATEEVENTPOOL_HH
+#define GATEEVENTPOOL_HH
+
+#include "globals.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+class GateEventPool
+{
+public:
+  explicit GateEventPool(size_t objectSize);
+
+  //! Memory for one object, in the current chunk of the calling thread
+  inline void * Allocate();
+
+  //! Release an object allocated by any pool, from any thread
+  static inline void Free(void * object);
+
+  //! Rewind the chunks without live objects (end of event, owner thread)
+  void Reset();
+
+  //! Number of chunks allocated from the system (diagnostics)
+  size_t GetNumberOfChunks() const { return mChunks.size(); }
+
+  static const size_t ChunkSize = 64*1024; //!< bytes, power of 2
+
+protected:
+  struct Chunk {
+    std::atomic<long> nAlive;
+    char * next;
+  };
+  static inline Chunk * ChunkOf(void * object)
+  { return reinterpret_cast<Chunk *>(reinterpret_cast<uintptr_t>(object) & ~uintptr_t(ChunkSize-1)); }
+  void NewChunk();
+
+  size_t mSlotSize;
+  size_t mFirstSlot;              //!< offset of the first object in a chunk
+  Chunk * mCurrent;
+  char * mEnd;                    //!< end of the current chunk
+  std::vector<Chunk *> mChunks;   //!< all the chunks of the pool
+  std::vector<Chunk *> mFree;     //!< chunks without live objects, rewound
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline void * GateEventPool::Allocate()
+{
+  if (mCurrent == 0 || mCurrent->next + mSlotSize > mEnd) NewChunk();
+  char * object = mCurrent->next;
+  mCurrent->next += mSlotSize;
+  mCurrent->nAlive.fetch_add(1, std::memory_order_relaxed);
+  return object;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline void GateEventPool::Free(void * object)
+{
+  ChunkOf(object)->nAlive.fetch_sub(1, std::memory_order_release);
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEEVENTPOOL_HH */
@@ -0,0 +1,140 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateHitFileStreamReader
+  \brief  Reads a ROOT hit file with several threads, for offline digitization
+
+  - HitBuffer/HitTree are GateRootHitBuffer/GateHitTree for the hit files
+  of GateHitFileReader (PET), GateCCRootHitBuffer/GateCCHitTree for the
+  hit files of GateCCHitFileReader (Compton camera).
+
+  - The entries of the hit tree (or of the range of entries given to the
+  constructor) are divided into chunks of consecutive entries. Each reader
+  thread opens its own copy of the file and reads the chunks i, i+n,
+  i+2n... (n threads), with a large tree cache so that the baskets are
+  read and decompressed in bulk.
+
+  - A chunk owns the events that start inside it: the first entries of a
+  chunk that belong to an event started in the previous chunk are
+  skipped, and the last event is read until its end, even past the end
+  of the chunk. A batch therefore only contains complete events, and
+  readers of contiguous ranges of entries share out the events exactly.
+
+  - NextBatch() returns the batches in file order, so that a single
+  (non thread-safe) digitizer can process them as with GateCCHitFileReader.
+  The number of batches waiting per thread is bounded.
+
+  - The reader threads open their own TFile: ROOT::EnableThreadSafety()
+  must have been called by the program before Start().
+
+  \sa GateHitFileReader, GateCCHitFileReader, GateDigit_parallel_hits_digitizer
+*/
+
+#ifndef GateHitFileStreamReader_h
+#define GateHitFileStreamReader_h 1
+
+#include "GateConfiguration.h"
+
+#ifdef G4ANALYSIS_USE_ROOT
+
+#include "globals.hh"
+#include "GateRootDefs.hh"
+#include "GateCCRootDefs.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class TFile;
+class TTree;
+
+//-----------------------------------------------------------------------------
+template<class HitBuffer>
+struct GateHitBatch
+{
+  std::vector<HitBuffer> hits;      //!< hits of complete events, in file order
+  std::vector<size_t>    eventEnds; //!< index (in hits) after the last hit of each event
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+template<class HitBuffer, class HitTree>
+class GateHitFileStreamReader
+{
+public:
+  typedef GateHitBatch<HitBuffer> Batch;
+
+  //! Read the entries [firstEntry, lastEntry) of the file (lastEntry < 0: until the end)
+  GateHitFileStreamReader(const G4String & fileName,
+                          G4int nbThreads,
+                          Long64_t chunkSize = 200000,
+                          G4int maxQueuedChunks = 4,
+                          Long64_t firstEntry = 0,
+                          Long64_t lastEntry = -1);
+  ~GateHitFileStreamReader();
+
+  //! Number of entries of the hit tree of a file
+  static Long64_t GetNumberOfEntries(const G4String & fileName);
+
+  //! Extend the range of entries [first, last) by the hits within
+  //! overlapTime before its first hit and after its last one (the hits
+  //! being in time order, as written by GATE)
+  static void ExtendRange(const G4String & fileName, G4double overlapTime,
+                          Long64_t & first, Long64_t & last);
+
+  //! Run and event IDs of the first event starting at or after the entry,
+  //! (INT_MAX, INT_MAX) after the last event
+  static std::pair<G4int, G4int> GetEventStartingAt(const G4String & fileName, Long64_t entry);
+
+  //! Open the file, and start the reader threads
+  void Start();
+
+  //! Next batch in file order. Return false at the end of the range.
+  G4bool NextBatch(Batch & batch);
+
+  //! Stop the reader threads (called by the destructor)
+  void Stop();
+
+  Long64_t GetNumberOfEntries() const { return m_entries; }
+  //! Time spent by NextBatch waiting for the reader threads (in seconds)
+  G4double GetWaitingTime() const { return m_waitingTime; }
+
+protected:
+  void ReadChunks(G4int threadIndex);
+  void ReadChunk(TTree * tree, HitBuffer & buffer,
+                 Long64_t first, Long64_t last, Batch & batch);
+  static TTree * OpenTree(const G4String & fileName, TFile * & file);
+
+  G4String m_fileName;
+  G4int    m_nbThreads;
+  Long64_t m_chunkSize;
+  G4int    m_maxQueuedChunks;
+  Long64_t m_firstEntry;
+  Long64_t m_lastEntry;
+  Long64_t m_entries;      //!< entries of the whole tree
+  Long64_t m_nbChunks;
+  Long64_t m_nextChunk;    //!< next chunk returned by NextBatch
+  G4double m_waitingTime;
+
+  std::vector<std::thread> m_threads;
+  std::vector< std::deque<Batch> > m_queues; //!< one per thread, in chunk order
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  G4bool m_stop;
+};
+//-----------------------------------------------------------------------------
+
+#include "GateHitFileStreamReader.icc"
+
+#endif
+#endif
@@ -18,6 +18,7 @@ See LICENSE.md for further details
 #define GATEIMAGEWITHSTATISTIC_HH
 
 #include "GateImage.hh"
+#include "GateMTHelper.hh"
 
 //-----------------------------------------------------------------------------
 /// \brief
@@ -69,7 +70,22 @@ class GateImageWithStatistic
   void SetOverWriteFilesFlag(bool b) { mOverWriteFilesFlag = b; }
   void SetTransformMatrix(const G4RotationMatrix & m);
 
+  // Multithreading: each worker thread accumulates in its own buffers
+  // (Add* functions). MergeThreadImages, called on the master at the
+  // end of the run, adds them to the images in thread index order
+  // (see GateVImageActor::AddThreadImage).
+  void AllocateThreadImages(int nbOfThreads);
+  void MergeThreadImages();
+
   protected:
+  struct ThreadImages {
+    std::vector<double> mValue;
+    std::vector<double> mSquared;
+    std::vector<double> mTemp;
+  };
+  std::vector<ThreadImages> mThreadImages;
+  inline ThreadImages * GetThreadImages();
+
   GateImageDouble mValueImage;
   GateImageDouble mSquaredImage;
   GateImageDouble mTempImage;
@@ -100,4 +116,13 @@ class GateImageWithStatistic
 
 }; // end class GateImageWithStatistic
 
+//-----------------------------------------------------------------------------
+inline GateImageWithStatistic::ThreadImages * GateImageWithStatistic::GetThreadImages() {
+  if (mThreadImages.empty()) return 0;
+  const int i = GateMTHelper::GetThreadIndex();
+  if (i < 0) return 0;
+  return &mThreadImages[i];
+}
+//-----------------------------------------------------------------------------
+
 #endif /* end #define GATEIMAGEWITHSTATISTIC_HH */
@@ -0,0 +1,61 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateInternedString
+  \brief  Handle on a string stored once in a global table.
+
+  Hits and pulses carry process and volume names that take only a few
+  distinct values. They are stored as a pointer into a table shared by
+  all objects, so that copying a pulse or a hit does not copy (nor
+  allocate) any string, and two names are compared by their address.
+
+  The table is never cleared: the references returned by str() stay
+  valid until the end of the program. Each thread keeps a small cache in
+  front of the table, so that the global lock (GATE_USE_MT) is only taken
+  the first time a thread sees a given name.
+*/
+
+#ifndef GATEINTERNEDSTRING_HH
+#define GATEINTERNEDSTRING_HH
+
+#include "GateConfiguration.h"
+#include "globals.hh"
+
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+class GateInternedString
+{
+public:
+  GateInternedString() : mString(Empty()) {}
+  GateInternedString(const G4String & s) : mString(Intern(s)) {}
+  GateInternedString(const char * s) : mString(Intern(G4String(s))) {}
+
+  const G4String & str() const { return *mString; }
+  operator const G4String & () const { return *mString; }
+
+  bool operator==(const GateInternedString & s) const { return mString == s.mString; }
+  bool operator!=(const GateInternedString & s) const { return mString != s.mString; }
+  bool operator==(const char * s) const { return *mString == s; }
+  bool operator!=(const char * s) const { return *mString != s; }
+
+  friend std::ostream & operator<<(std::ostream & os, const GateInternedString & s)
+  { return os << *s.mString; }
+
+  /// Address of the unique copy of s. When s is itself a string
+  /// returned by str(), it is returned without any lookup.
+  static const G4String * Intern(const G4String & s);
+
+protected:
+  static const G4String * Empty();
+  const G4String * mString;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEINTERNEDSTRING_HH */
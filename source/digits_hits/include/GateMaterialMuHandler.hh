@@ -10,6 +10,17 @@ See LICENSE.md for further details
 /*!
   \class  GateMaterialMuHandler
   \author fabien.baldacci@creatis.insa-lyon.fr
+
+  When a cache directory is set, the mu/muen table of each material is
+  stored in <dir>/GateMuTable_<key>.bin, the key being a hash of the
+  material composition, the database, the energy grid and (simulated
+  database) the gamma physics and cut. Tables found in the cache are
+  read at the first request for their couple; the others are built at
+  initialization, in parallel for the tabulated databases.
+
+  The handler may be queried from several threads: the initialization
+  is done once (std::call_once), the tables of the couples are looked
+  up under a mutex, and the last couple used is cached per thread.
  */
 
 #ifndef GATEMATERIALMUHANDLER_HH
@@ -24,6 +35,7 @@ See LICENSE.md for further details
 #include "G4LossTableManager.hh"
 
 #include <map>
+#include <mutex>
 
 
 using std::map;
@@ -83,6 +95,7 @@ public:
   void SetENumber(int n) { mEnergyNumber = n; }
   void SetAtomicShellEMin(double e) { mAtomicShellEnergyMin = e; }
   void SetPrecision(double p) { mPrecision = p; }
+  void SetCacheDirectory(G4String dir) { mCacheDirectory = dir; }
 
 private:
 
@@ -92,20 +105,31 @@ private:
   void Initialize();
   // - Precalculated coefficients (by element)
   void InitElementTable();
-  void ConstructMaterial(const G4MaterialCutsCouple *);
+  GateMuTable *ConstructMaterial(const G4MaterialCutsCouple *);
   // - Complete simulation of coefficients
-  void SimulateMaterialTable();
+  GateMuTable *SimulateCouple(const G4MaterialCutsCouple *);
   void ConstructEnergyList(std::vector<MuStorageStruct> *, const G4Material *);
   void MergeAtomicShell(std::vector<MuStorageStruct> *);
   double ProcessOneShot(G4VEmModel *,std::vector<G4DynamicParticle*> *, const G4MaterialCutsCouple *, const G4DynamicParticle *);
   double SquaredSigmaOnMean(double , double , double);
+  void PrintTable(GateMuTable *);
+
+  // Cache of the tables
+  GateMuTable *GetCoupleTable(const G4MaterialCutsCouple *);
+  unsigned long long ComputeTableKey(const G4MaterialCutsCouple *);
+  G4String GetCacheFileName(unsigned long long);
+  bool IsCached(unsigned long long);
+  GateMuTable *ReadTable(const G4MaterialCutsCouple *, unsigned long long);
+  void WriteTable(unsigned long long, GateMuTable *);
 
   map<const G4MaterialCutsCouple *, GateMuTable*> mCoupleTable;
   GateMuTable** mElementsTable;
   int mElementNumber;
   G4String mDatabaseName;
-
-  bool mIsInitialized;
+  G4String mCacheDirectory;
+  map<unsigned long long, GateMuTable *> mKeyTable; // tables shared by the couples of the same key
+  std::mutex mMutex;              // protects mCoupleTable and mKeyTable
+  std::once_flag mInitializeFlag;
   double mEnergyMin;
   double mEnergyMax;
   int mEnergyNumber;
@@ -114,10 +138,8 @@ private:
 
   static GateMaterialMuHandler *singleton_MaterialMuHandler;
   
-  // - fast acces
-  void CheckLastCall(const G4MaterialCutsCouple *);
-  const G4MaterialCutsCouple *mLastCouple;
-  GateMuTable *mLastMuTable;
+  // - fast acces (last couple of the calling thread)
+  GateMuTable *CheckLastCall(const G4MaterialCutsCouple *);
 
 };
 
@@ -147,6 +147,9 @@ protected :
   //! List of the output modules
   std::vector<GateVOutputModule*>   m_outputModules;
 
+  //! GateProfiler counters of RecordEndOfEvent, one per output module
+  std::vector<G4int>                m_profilerCounters;
+
   //! messenger for the Mgr specific commands
   GateOutputMgrMessenger*    m_messenger;
 
@@ -14,6 +14,7 @@ See LICENSE.md for further details
 #include "G4Allocator.hh"
 #include "G4ThreeVector.hh"
 #include "GateConfiguration.h"
+#include "GateInternedString.hh"
 
 class GatePhantomHit : public G4VHit
 {
@@ -34,12 +35,12 @@ private:
   G4double m_stepLength; // length of the step for the current hit
   G4double m_time;       // time of the current hit
   G4ThreeVector m_pos;   // position of the current hit
-  G4String m_process;    // process on the current hit
+  GateInternedString m_process; // process on the current hit
   G4int m_trackID;       // track ID
   G4int m_parentID;      // parent track ID
 
   G4int  m_voxelCoordinates;  //  voxellized phantom voxel number
-  G4String m_physVolName;
+  GateInternedString m_physVolName;
 
 // v. cuplov - optical photons
 //  static const G4String theOutputAlias;
@@ -60,8 +61,8 @@ private:
       inline void          SetPos(G4ThreeVector xyz)     { m_pos = xyz; }
       inline G4ThreeVector GetPos()                     { return m_pos; }
 
-      inline void     SetProcess(G4String proc) { m_process = proc; }
-      inline G4String GetProcess()              { return m_process; }
+      inline void     SetProcess(const G4String& proc) { m_process = proc; }
+      inline const G4String& GetProcess() const { return m_process; }
 
       inline void  SetPDGEncoding(G4int j)      { m_PDGEncoding = j; }
       inline G4int GetPDGEncoding()            { return m_PDGEncoding; }
@@ -75,8 +76,8 @@ private:
       inline void SetVoxelCoordinates(G4int c)  { m_voxelCoordinates = c ;   }
       inline G4int  GetVoxelCoordinates()const  { return m_voxelCoordinates; }
 
-      inline void SetPhysVolName(G4String name) { m_physVolName = name ;   }
-      inline G4String GetPhysVolName()const     { return m_physVolName; }
+      inline void SetPhysVolName(const G4String& name) { m_physVolName = name ;   }
+      inline const G4String& GetPhysVolName()const { return m_physVolName; }
 
 // v. cuplov - optical photons
       inline G4bool GoodForAnalysis() const
@@ -89,18 +90,19 @@ private:
 
 typedef G4THitsCollection<GatePhantomHit> GatePhantomHitsCollection;
 
-extern G4Allocator<GatePhantomHit> GatePhantomHitAllocator;
+// One pool per thread (see GateCrystalHit)
+extern G4ThreadLocal G4Allocator<GatePhantomHit> * GatePhantomHitAllocator;
 
 inline void* GatePhantomHit::operator new(size_t)
 {
-  void *aHit;
-  aHit = (void *) GatePhantomHitAllocator.MallocSingle();
-  return aHit;
+  if (!GatePhantomHitAllocator)
+    GatePhantomHitAllocator = new G4Allocator<GatePhantomHit>;
+  return (void *) GatePhantomHitAllocator->MallocSingle();
 }
 
 inline void GatePhantomHit::operator delete(void *aHit)
 {
-  GatePhantomHitAllocator.FreeSingle((GatePhantomHit*) aHit);
+  GatePhantomHitAllocator->FreeSingle((GatePhantomHit*) aHit);
 }
 
 #endif
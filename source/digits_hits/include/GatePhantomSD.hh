@@ -38,6 +38,8 @@ class GatePhantomSD : public G4VSensitiveDetector
       GatePhantomHitsCollection * phantomCollection;
       static const G4String thePhantomCollectionName; //! Name of the hit collection
 
+      G4int m_profilerCounter;                        //! GateProfiler counter of ProcessHits
+
 };
 
 
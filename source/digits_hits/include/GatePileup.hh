@@ -60,6 +60,9 @@ class GatePileup : public GateVPulseProcessor
     //! Set the time of the Pileup
     inline void  SetPileup(G4double aPileup)         { m_pileup = aPileup; }
 
+    //! A pulse waits for the next ones during the pile-up time
+    virtual G4double GetMemoryTime() const           { return m_pileup; }
+
   protected:
     //! Implementation of the pure virtual method declared by the base class GateVPulseProcessor
     //! This methods processes one input-pulse
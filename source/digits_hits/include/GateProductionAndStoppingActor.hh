@@ -50,6 +50,8 @@ public:
   virtual void UserSteppingActionInVoxel(const int index, const G4Step* step) ;
   virtual void UserPostTrackActionInVoxel(const int index, const G4Track* t) ;
 
+  virtual bool SupportsMultithreading() const { return true; }
+
   /// Saves the data collected to the file
   virtual void SaveData();
   virtual void ResetData();
@@ -60,6 +60,9 @@ public:
   // Return the gamma energy spectrum for the proton at given energy,
   // for the given material
   TH1D * GetGammaEnergySpectrum(const int & matIndex, const double & energy); //backward compat.
+  // Same, for the given proton energy bin (from 1 to GetProtonNbBins())
+  TH1D * GetGammaEnergySpectrumOfBin(const int & matIndex, const int & bin);
+  int GetProtonEnergyBin(const double & energy);
   TH2D * GetGammaM(const int & materialIndex);
   TH2D * GetNgammaM(const int & materialIndex);
   bool DataForMaterialExist(const int & materialIndex);
@@ -44,6 +44,7 @@ public:
 
   void EnableDebugOutput(bool b) { mIsDebugOutputEnabled = b; }
   void EnableOutputMatch(bool b) { mIsOutputMatchEnabled = b; }
+  void EnableDeferredSpectrum(bool b) { mIsDeferredSpectrumEnabled = b; }
   //void EnableSysVarianceImage(bool b) { mIsSysVarianceImageEnabled = b; }
   //void EnableIntermediaryUncertaintyOutput(bool b) { mIsIntermediaryUncertaintyOutputEnabled = b; }
 
@@ -57,6 +58,7 @@ protected:
 
   bool mIsDebugOutputEnabled;
   bool mIsOutputMatchEnabled;
+  bool mIsDeferredSpectrumEnabled;
 
   //helper functions
   void SetTrackIoH(GateImageOfHistograms*&);
@@ -64,6 +66,8 @@ protected:
   GateVImageVolume* GetPhantom();
   void BuildVarianceOutput(); //converts trackl,tracklsq into mImageGamma and tlevar per voxel. Not used.
   //void BuildSysVarianceOutput(); //converts trackl into mImageGamma and tlesysvarv. Not used.
+  void AddDeferredTrackLength(int index, int materialIndex, int protonBin, double value);
+  void ApplyDeferredSpectrum(); //adds the gamma spectra of the deferred track lengths to mImageGamma
 
   //used and reset each track
   GateImageOfHistograms * tmptrackl;    //l_i
@@ -78,6 +82,13 @@ protected:
   GateImageOfHistograms * tlesysvar;    //systematic variance per voxel, per E_gamma. Not used.
   GateImageOfHistograms * tlevariance;  //uncertainty per voxel, per E_gamma. Not used.
 
+  //deferred spectrum: weighted track length times density, per voxel, material and E_proton.
+  //Stored by blocks of E_proton bins, only for the (voxel, material) reached by protons.
+  std::vector<int> mDeferredFirstBlock;     //first block of each voxel, -1 if none
+  std::vector<int> mDeferredBlockMaterial;  //material index of each block
+  std::vector<int> mDeferredBlockNext;      //next block of the same voxel, -1 if none
+  std::vector<double> mDeferredTrackLength; //GetProtonNbBins() values per block
+
   GateImageInt mLastHitEventImage;      //store eventID when last updated.
   int mCurrentEvent;                    //monitor event. TODO: not sure if necesary
 };
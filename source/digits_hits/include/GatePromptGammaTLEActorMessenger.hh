@@ -32,6 +32,7 @@ protected:
   G4UIcmdWithAString * pSetInputDataFileCmd;
   G4UIcmdWithABool * pEnableDebugOutputCmd;
   G4UIcmdWithABool * pEnableOutputMatchCmd;
+  G4UIcmdWithABool * pEnableDeferredSpectrumCmd;
 };
 //-----------------------------------------------------------------------------
 
@@ -18,6 +18,8 @@ See LICENSE.md for further details
 
 #include "GateVolumeID.hh"
 #include "GateOutputVolumeID.hh"
+#include "GateInternedString.hh"
+#include "GateEventPool.hh"
 
 /*! \class  GatePulse
     \brief  Class for storing a 'pulse' (luminous or electronic) derived from one or more hits
@@ -50,6 +52,13 @@ public:
     //! Destructor
     virtual inline ~GatePulse() {}
 
+    //! Pulses are taken from a per-thread arena (see GatePulsePool)
+    inline void* operator new(size_t size);
+    inline void operator delete(void* aPulse, size_t size);
+
+    //! Rewind the arenas of the thread (end of event)
+    static void ResetPools();
+
 public:
     //! \name getters and setters to acces the content of the pulse
     //@{
@@ -97,10 +106,10 @@ public:
     inline G4int GetNCrystalRayleigh() const        { return m_nCrystalRayleigh; }
 
     inline void     SetComptonVolumeName(const G4String& name) { m_comptonVolumeName = name; }
-    inline G4String GetComptonVolumeName() const        { return m_comptonVolumeName; }
+    inline const G4String& GetComptonVolumeName() const { return m_comptonVolumeName; }
 
     inline void     SetRayleighVolumeName(const G4String& name) { m_RayleighVolumeName = name; }
-    inline G4String GetRayleighVolumeName() const        { return m_RayleighVolumeName; }
+    inline const G4String& GetRayleighVolumeName() const { return m_RayleighVolumeName; }
 
     inline void  SetVolumeID(const GateVolumeID& volumeID)            { m_volumeID = volumeID; }
     inline const GateVolumeID& GetVolumeID() const                  	{ return m_volumeID; }
@@ -135,8 +144,8 @@ public:
 
 
     // AE : Added for IdealComptonPhot adder which take into account several Comptons in the same volume
-    inline void     SetPostStepProcess(G4String proc) { m_Postprocess = proc; }
-    inline G4String GetPostStepProcess() const             { return m_Postprocess; }
+    inline void     SetPostStepProcess(const G4String& proc) { m_Postprocess = proc; }
+    inline const G4String& GetPostStepProcess() const { return m_Postprocess; }
 
     inline void SetEnergyIniTrack(G4double eIni)          { m_energyIniTrack = eIni; }
     inline G4double GetEnergyIniTrack() const                { return m_energyIniTrack; }
@@ -154,8 +163,8 @@ public:
     inline G4int GetNCrystalConv() const                { return m_nCrystalConv; }
 
 
-    inline void     SetProcessCreator(G4String proc) { m_processCreator = proc; }
-    inline G4String GetProcessCreator() const             { return m_processCreator; }
+    inline void     SetProcessCreator(const G4String& proc) { m_processCreator = proc; }
+    inline const G4String& GetProcessCreator() const { return m_processCreator; }
 
     inline void SetTrackID(G4int trkID)          { m_trackID = trkID; }
     inline G4int GetTrackID() const                { return m_trackID; }
@@ -208,8 +217,8 @@ private:
     G4int m_nCrystalCompton;    	  //!< # of compton processes in the crystal occurred to the photon
     G4int m_nPhantomRayleigh;    	  //!< # of Rayleigh processes in the phantom occurred to the photon
     G4int m_nCrystalRayleigh;    	  //!< # of Rayleigh processes in the crystal occurred to the photon
-    G4String m_comptonVolumeName;   //!< name of the volume of the last (if any) compton scattering
-    G4String m_RayleighVolumeName;   //!< name of the volume of the last (if any) Rayleigh scattering
+    GateInternedString m_comptonVolumeName;   //!< name of the volume of the last (if any) compton scattering
+    GateInternedString m_RayleighVolumeName;   //!< name of the volume of the last (if any) Rayleigh scattering
     GateVolumeID m_volumeID;        //!< Volume ID in the world volume tree
     G4ThreeVector m_scannerPos; 	  //!< Position of the scanner
     G4double m_scannerRotAngle; 	  //!< Rotation angle of the scanner
@@ -221,10 +230,10 @@ private:
 
     // AE : Added for IdealComptonPhot adder which take into account several Comptons in the same volume
     //These variables no sense for a general pulse but I need them to  process idealy the hits. or create another structure
-    G4String m_Postprocess;         // PostStep process
+    GateInternedString m_Postprocess;         // PostStep process
     G4double m_energyIniTrack;         // Initial energy of the track
     G4double m_energyFin;         // final energy of the particle
-    G4String m_processCreator;
+    GateInternedString m_processCreator;
     G4int m_trackID;
     G4int m_parentID;
 
@@ -266,6 +275,10 @@ public:
     GatePulseList(const GatePulseList& src);
     virtual ~GatePulseList();
 
+    //! Pulse lists are taken from a per-thread arena (see GatePulseListPool)
+    inline void* operator new(size_t size);
+    inline void operator delete(void* aList, size_t size);
+
     //! Return the min-time of all pulses
     virtual GatePulse* FindFirstPulse() const ;
     virtual G4double ComputeStartTime() const ;
@@ -279,7 +292,7 @@ public:
     void SetName(const G4String& name){m_name=name;}
 
 protected:
-    G4String m_name;
+    GateInternedString m_name;
 };
 
 
@@ -291,4 +304,42 @@ typedef GatePulseList::iterator GatePulseIterator;
 typedef GatePulseList::const_iterator GatePulseConstIterator;
 
 
+/* Pulses and pulse lists are created and deleted by the thousands at
+   each event by the digitizer chain: they are allocated in per-thread
+   arenas (GateEventPool), rewound by GatePulse::ResetPools() at the end
+   of each event (see GateEventAction::EndOfEventAction). A pulse kept
+   from an event to the next (coincidence sorter buffers) keeps its
+   chunk and may be deleted by another thread. Derived classes with a
+   different size (e.g. GateCoincidencePulse) use the global heap.
+*/
+extern G4ThreadLocal GateEventPool * GatePulsePool;
+extern G4ThreadLocal GateEventPool * GatePulseListPool;
+
+inline void* GatePulse::operator new(size_t size)
+{
+    if (size != sizeof(GatePulse)) return ::operator new(size);
+    if (!GatePulsePool) GatePulsePool = new GateEventPool(sizeof(GatePulse));
+    return GatePulsePool->Allocate();
+}
+
+inline void GatePulse::operator delete(void* aPulse, size_t size)
+{
+    if (size != sizeof(GatePulse)) ::operator delete(aPulse);
+    else GateEventPool::Free(aPulse);
+}
+
+inline void* GatePulseList::operator new(size_t size)
+{
+    if (size != sizeof(GatePulseList)) return ::operator new(size);
+    if (!GatePulseListPool) GatePulseListPool = new GateEventPool(sizeof(GatePulseList));
+    return GatePulseListPool->Allocate();
+}
+
+inline void GatePulseList::operator delete(void* aList, size_t size)
+{
+    if (size != sizeof(GatePulseList)) ::operator delete(aList);
+    else GateEventPool::Free(aList);
+}
+
+
 #endif
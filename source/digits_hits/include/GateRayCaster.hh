@@ -0,0 +1,87 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateRayCaster
+  \brief  Traces packets of rays through a labelled voxel grid, with attenuation
+
+  - The grid is a box centered on the origin (frame of the image
+  volume), the voxels being numbered x first. Each voxel has a label,
+  and each ray has its own attenuation coefficient for each label, so
+  that no mu table is searched per voxel.
+
+  - The rays of a packet (up to PacketSize) are stepped together from
+  voxel boundary to voxel boundary. The state of the rays is stored by
+  lane and updated without branches, so that the loops on the lanes are
+  vectorized by the compiler.
+
+  - Each step is returned as a segment (ray, voxel, label, length,
+  weights at the entrance and at the exit of the voxel), scored by the
+  caller.
+
+  \sa GateSETLEDoseActor
+*/
+
+#ifndef GATERAYCASTER_HH
+#define GATERAYCASTER_HH
+
+#include "G4ThreeVector.hh"
+
+#include <vector>
+
+//-----------------------------------------------------------------------------
+struct GateRaySegment
+{
+  int ray;          //!< index of the ray in the packet
+  int index;        //!< voxel index
+  int label;        //!< voxel label
+  double length;    //!< length in the voxel
+  double weightIn;  //!< weight at the entrance of the voxel
+  double weightOut; //!< weight at the exit of the voxel
+};
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+class GateRayCaster
+{
+public:
+  static const int PacketSize = 8;
+
+  struct Packet
+  {
+    int size;
+    double position[3][PacketSize];  //!< in the grid (or on its border)
+    double direction[3][PacketSize]; //!< unit vectors
+    double weight[PacketSize];       //!< weight at the position, then at the exit of the grid
+    const double * mu[PacketSize];   //!< attenuation coefficient (mm-1) of each label
+    double length[PacketSize];       //!< output: length from the position to the exit of the grid
+  };
+
+  GateRayCaster();
+
+  /// Grid of the voxels: resolution, size of the voxels
+  void SetGrid(const G4ThreeVector & resolution, const G4ThreeVector & voxelSize);
+  /// Label (>= 0) of each voxel
+  void SetLabels(const std::vector<int> & labelOfVoxel) { mLabels = labelOfVoxel; }
+  int GetNumberOfVoxels() const { return mPlaneSize*mResolution[2]; }
+
+  /// Traces the rays of the packet up to the exit of the grid, the
+  /// segments being appended to segments (step after step)
+  void Trace(Packet & packet, std::vector<GateRaySegment> & segments) const;
+
+protected:
+  int mResolution[3];
+  double mVoxelSize[3];
+  double mHalfSize[3];
+  int mLineSize;
+  int mPlaneSize;
+  std::vector<int> mLabels;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATERAYCASTER_HH */
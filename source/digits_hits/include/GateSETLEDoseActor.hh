@@ -26,6 +26,7 @@ See LICENSE.md for further details
 #include "GateSETLEMultiplicityActor.hh"
 #include "GateImageWithStatistic.hh"
 #include "GateMaterialMuHandler.hh"
+#include "GateRayCaster.hh"
 #include "G4SteppingManager.hh"
 
 class GateSETLEDoseActor : public GateVImageActor
@@ -70,6 +71,9 @@ class GateSETLEDoseActor : public GateVImageActor
   void InitializeMaterialAndMuTable();
   bool IntersectionBox(G4ThreeVector, G4ThreeVector);
   double RayCast(bool, double, double, G4ThreeVector, G4ThreeVector);
+  void AddRayToPacket(bool, double, double, G4ThreeVector, G4ThreeVector);
+  void TracePacket();
+  void ScoreSegment(const GateRaySegment &);
  /// Saves the data collected to the file
   virtual void SaveData();
   virtual void ResetData();
@@ -118,7 +122,7 @@ protected:
   std::vector<RaycastingStruct> *mListOfRaycasting;
 
   bool mIsMuTableInitialized;
-  std::vector<GateMuTable *> mListOfMuTable;
+  std::vector<GateMuTable *> mListOfMuTable; // by label of the ray caster
   
   int mCurrentEvent;
   G4SteppingManager *mSteppingManager;
@@ -135,6 +139,19 @@ protected:
   double mTotalLength;
   int mLineSize;
   int mPlaneSize;
+
+  // packet of rays; the mu (mm-1) and dose factor of each label are
+  // computed once by energy, in one of PacketSize slots kept from a
+  // packet to the next (the rays of a split photon share its energy)
+  GateRayCaster mRayCaster;
+  GateRayCaster::Packet mPacket;
+  bool mPacketIsPrimary[GateRayCaster::PacketSize];
+  int mPacketSlot[GateRayCaster::PacketSize];
+  double mSlotEnergy[GateRayCaster::PacketSize];
+  int mNextSlot;
+  std::vector<double> mSlotMu[GateRayCaster::PacketSize];
+  std::vector<double> mSlotDoseFactor[GateRayCaster::PacketSize];
+  std::vector<GateRaySegment> mSegments;
 };
 
 MAKE_AUTO_CREATOR_ACTOR(SETLEDoseActor,GateSETLEDoseActor)
@@ -21,6 +21,8 @@ See LICENSE.md for further details
 #include "GateConfiguration.h"
 #include "globals.hh"
 #include <fstream>
+#include <vector>
+#include <unordered_map>
 
 /*! \class  GateSinogram
     \brief  Structure to store the sinogram sets from a PET simulation
@@ -30,12 +32,18 @@ See LICENSE.md for further details
     - This structure is generated during a PET simulation by GateToSinogram. It can be stored
       into an output file using a set-writer such as GateSinoToEcat7
 
+    - The counts (32 bits) are stored in blocks of a few views of a 2D sinogram, allocated
+      at the first count: the blocks of the sinograms that receive no coincidence are never
+      allocated. The sinograms can have several time-of-flight (TOF) bins and can be compressed
+      while they are filled: the views are mashed, and with a span > 1 the ring pairs of a
+      segment (group of ring differences) with the same axial position share a 2D sinogram
+
     \sa GateToSinogram, GateSinoToEcat7
 */
 class GateSinogram
 {
   public:
-    typedef unsigned short SinogramDataType;
+    typedef G4int SinogramDataType;
 
   public:
 
@@ -48,12 +56,15 @@ class GateSinogram
     //! Clear the matrix and prepare a new run
     void ClearData(size_t frameID, size_t gateID, size_t dataID, size_t bedID);
 
+    //! Free the blocks of the 2D sinograms
+    void FreeBlocks();
+
     //! Apply spatial blurring to hited crystal
     void CrystalBlurring( G4int *ringID, G4int *crystalID, G4double ringResolution,
                           G4double crystalResolution );
 
     //! Store a digi into a projection
-    G4int Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int crystal2ID, int signe);
+    G4int Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int crystal2ID, int signe, G4int tofBinID=0);
 
     //! Store a digi into randoms array
     G4int FillRandoms( G4int ring1ID, G4int ring2ID);
@@ -61,6 +72,17 @@ class GateSinogram
     //! Returns the 2D sino ID for a given pair of rings
     G4int GetSinoID( G4int ring1ID, G4int ring2ID);
 
+    //! Returns the 2D sino ID of a segment (group of ring differences) and an axial position (ring1+ring2), with a span > 1
+    G4int GetCompressedSinoID( G4int segment, G4int axialPosition) const;
+
+    //! Returns one view of a 2D sinogram (a row of zeros if it has no count)
+    const SinogramDataType* GetView(size_t sinoID, size_t viewID, size_t tofBinID=0) const;
+
+    //! Returns the memory used by the allocated blocks (bytes)
+    size_t GetAllocatedBytes() const;
+    //! Returns the memory that the sinograms would use with all their blocks allocated (bytes)
+    double GetDenseBytes() const;
+
     //! \name getters and setters
     //@{
 
@@ -88,6 +110,29 @@ class GateSinogram
       { m_virtualCrystalPerBlockNb = aNb;}
 
 
+    //! Returns the number of time-of-flight bins
+    inline size_t GetTOFBinNb() const
+      { return m_tofBinNb;}
+    //! Set the number of time-of-flight bins
+    inline void SetTOFBinNb(size_t aNb)
+      { m_tofBinNb = aNb;}
+
+    //! Returns the span (1: one 2D sinogram per ring pair)
+    inline size_t GetSpan() const
+      { return m_span;}
+    //! Returns the mashing factor of the views
+    inline size_t GetMashing() const
+      { return m_mashing;}
+    //! Returns the maximum ring difference stored with a span > 1
+    inline size_t GetMaxRingDiff() const
+      { return m_maxRingDiff;}
+    //! Set the compression of the sinograms (applied at the next Reset)
+    inline void SetCompression(size_t span, size_t mashing, size_t maxRingDiff)
+      { m_span = span; m_mashing = mashing; m_maxRingDiff = maxRingDiff;}
+    //! Returns true if the sinograms are compressed while they are filled
+    inline G4bool IsCompressed() const
+      { return m_span > 1 || m_mashing > 1;}
+
      //! Returns the number of radial sinogram bins
      inline size_t GetRadialElemNb() const
        { return  m_radialElemNb;}
@@ -109,9 +154,13 @@ class GateSinogram
     inline void SetCrystalNb(size_t aNb)
       { m_crystalNb = aNb;}
 
-     //! Returns the data pointer
-    inline SinogramDataType** GetData() const
-      { return m_data;}
+     //! Returns true if the sinograms are ready to be filled
+    inline G4bool IsAllocated() const
+      { return !m_zeroView.empty();}
+
+    //! Returns the number of views (azimuthal bins) per 2D sinogram
+    inline size_t GetViewNb() const
+      { return m_viewNb;}
 
     //! Returns the randoms pointer
     inline SinogramDataType* GetRandoms() const
@@ -121,13 +170,9 @@ class GateSinogram
     virtual void SetVerboseLevel(G4int val)
       { nVerboseLevel = val; };
 
-    //! Returns a 2D sinogram from the set
-    inline SinogramDataType* GetSinogram(size_t sinoID) const
-      { return m_data[sinoID];}
-
     //! Returns the number of pixels per 2D sinogram
     inline G4int PixelsPerSinogram() const
-      { return m_radialElemNb * m_crystalNb / 2;}
+      { return m_radialElemNb * m_viewNb;}
 
      //! Returns the number of bytes per 2D sinogram
     inline G4int BytesPerSinogram() const
@@ -160,15 +205,26 @@ class GateSinogram
 
       	\param dest:    	  the destination stream
       	\param sinoID:    	  the 2D sinogram to stream-out
+      	\param seekID:    	  the position of the 2D sinogram in the stream
+      	\param tofBinID:    	  the time-of-flight bin to stream-out
     */
-    void StreamOut(std::ofstream& dest, size_t sinoID, size_t seekID);
+    void StreamOut(std::ofstream& dest, size_t sinoID, size_t seekID, size_t tofBinID=0);
 
     //! \name Data fields
     //@{
 
     size_t                m_ringNb;                             //!< Nb of crystal rings
     size_t		  m_crystalNb;                          //!< Nb of crystals per crystal ring
-    SinogramDataType    **m_data;                               //!< Array of 2D sinograms
+    std::unordered_map<size_t,SinogramDataType*> m_blocks;      //!< Allocated blocks of views of the 2D sinograms, by block ID
+    std::vector<SinogramDataType>  m_zeroView;                  //!< View returned for the blocks never allocated
+    size_t                m_viewNb;                             //!< Nb of views per 2D sinogram (after mashing)
+    size_t                m_viewsPerBlock;                      //!< Nb of views per block
+    size_t                m_blocksPerSinogram;                  //!< Nb of blocks per 2D sinogram
+    size_t                m_tofBinNb;                           //!< Nb of time-of-flight bins
+    size_t                m_span;                               //!< Span (ring differences grouped in a 2D sinogram)
+    size_t                m_mashing;                            //!< Nb of views summed in a view
+    size_t                m_maxRingDiff;                        //!< Maximum ring difference stored, with a span > 1
+    G4int                 m_segmentNb;                          //!< Nb of positive segments, with a span > 1
     G4int                 m_currentFrameID;                     //!< ID of the current frame (dynamique acquisitions)
     G4int                 m_currentGateID;                      //!< ID of the current gate (synchronized acquisitions)
     G4int 	          m_currentDataID;                      //!< ID of the current coincidence type (prompts or trues, delayed, LowEnergy, ...)
@@ -195,7 +251,14 @@ class GateSinogram
 inline GateSinogram::GateSinogram()
   : m_ringNb(0)
   , m_crystalNb(0)
-  , m_data(0)
+  , m_viewNb(0)
+  , m_viewsPerBlock(8)
+  , m_blocksPerSinogram(0)
+  , m_tofBinNb(1)
+  , m_span(1)
+  , m_mashing(1)
+  , m_maxRingDiff(0)
+  , m_segmentNb(0)
   , m_currentFrameID(-1)
   , m_currentGateID(-1)
   , m_currentDataID(-1)
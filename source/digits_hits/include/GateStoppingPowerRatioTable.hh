@@ -0,0 +1,122 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateStoppingPowerRatioTable
+  \brief  Tabulated ratio of total stopping powers between a reference
+  material and the materials of a scored volume.
+
+  The ratio DEDX(reference)/DEDX(material) is stored per (particle,
+  material) on a logarithmic energy grid. The grid of each table is
+  refined at build time until linear interpolation between two nodes
+  reproduces the exact G4EmCalculator value within the requested
+  relative tolerance. Energies outside the grid, or bins where one of
+  the stopping powers vanishes on a single side, fall back to the exact
+  computation.
+*/
+
+#ifndef GATESTOPPINGPOWERRATIOTABLE_HH
+#define GATESTOPPINGPOWERRATIOTABLE_HH
+
+#include "GateMessageManager.hh"
+
+#include <G4Material.hh>
+#include <G4ParticleDefinition.hh>
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+class G4EmCalculator;
+
+//-----------------------------------------------------------------------------
+class GateStoppingPowerRatioTable
+{
+public:
+
+  GateStoppingPowerRatioTable();
+  ~GateStoppingPowerRatioTable();
+
+  void SetReferenceMaterial(G4Material * m) { mReferenceMaterial = m; }
+  G4Material * GetReferenceMaterial() const { return mReferenceMaterial; }
+  void SetEnergyRange(double emin, double emax);
+  void SetTolerance(double t) { mTolerance = t; }
+  double GetTolerance() const { return mTolerance; }
+
+  /// Remove all tables (needed when materials or cuts change between runs)
+  void Clear();
+
+  /// Build the tables for all pairs (particles, materials)
+  void Build(const std::vector<const G4ParticleDefinition*> & particles,
+             const std::vector<G4Material*> & materials);
+
+  /// DEDX(reference)/DEDX(material), 0 when one of them is 0.
+  /// Missing tables are built on first use.
+  inline double GetRatio(const G4ParticleDefinition * p,
+                         const G4Material * m,
+                         double energy);
+
+  /// Exact value, computed with G4EmCalculator
+  double ComputeRatio(const G4ParticleDefinition * p,
+                      const G4Material * m,
+                      double energy);
+
+  int GetNumberOfTables() const { return mNumberOfTables; }
+  int GetNumberOfNodes() const { return mNumberOfNodes; }
+
+protected:
+
+  struct RatioTable {
+    double mInvLogStep;
+    std::vector<double> mRatio; // negative value = zero DEDX at this node
+  };
+  typedef std::vector<RatioTable*> MaterialTablesType; // by G4Material index
+
+  RatioTable * BuildTable(const G4ParticleDefinition * p, const G4Material * m);
+  RatioTable * FindOrBuildTable(const G4ParticleDefinition * p, const G4Material * m);
+  double ComputeNodeRatio(const G4ParticleDefinition * p, const G4Material * m, double energy);
+
+  G4EmCalculator * mEmCalculator;
+  G4Material * mReferenceMaterial;
+  double mTolerance;
+  double mEnergyMin;
+  double mEnergyMax;
+  double mLogEnergyMin;
+  int mNumberOfTables;
+  int mNumberOfNodes;
+
+  std::map<const G4ParticleDefinition*, MaterialTablesType> mTables;
+  const G4ParticleDefinition * mLastParticle;
+  MaterialTablesType * mLastTables;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline double GateStoppingPowerRatioTable::GetRatio(const G4ParticleDefinition * p,
+                                                    const G4Material * m,
+                                                    double energy)
+{
+  if (energy < mEnergyMin || energy >= mEnergyMax) return ComputeRatio(p, m, energy);
+
+  RatioTable * t = 0;
+  if (p == mLastParticle && m->GetIndex() < mLastTables->size())
+    t = (*mLastTables)[m->GetIndex()];
+  if (!t) t = FindOrBuildTable(p, m);
+
+  const double x = (std::log(energy) - mLogEnergyMin) * t->mInvLogStep;
+  const size_t i = (size_t)x;
+  const double r0 = t->mRatio[i];
+  const double r1 = t->mRatio[i+1];
+  if (r0 >= 0.0 && r1 >= 0.0) return r0 + (r1-r0)*(x-i);
+  if (r0 < 0.0 && r1 < 0.0) return 0.0;
+  return ComputeRatio(p, m, energy); // threshold inside the bin
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATESTOPPINGPOWERRATIOTABLE_HH */
@@ -63,6 +63,9 @@ public:
     //! \brief Writes the projection sets onto an output stream
     void StreamOut(std::ofstream& dest);
 
+    //! Writes a set of 2D sinograms in a raw file (.ima), with its .info and .dim files
+    void WriteRawSinograms(GateSinogram* sinogram, const G4String& frameFileName, const G4String& description);
+
     //! Returns the value of the raw ouptut enabled/disabled status flag
     inline virtual G4bool IsRawOutputEnabled() const
     	  { return m_flagIsRawOutputEnabled;}
@@ -200,6 +203,29 @@ public:
      inline void SetAxialCrystalResolution(G4double aNb)
        { m_axialCrystalResolution = aNb;}
 
+     //! Returns the number of time-of-flight bins
+     inline size_t GetTOFBinNb() const
+       { return m_tofBinNb;}
+     //! Set the number of time-of-flight bins
+     inline void SetTOFBinNb(size_t aNb)
+       { m_tofBinNb = aNb;}
+     //! Returns the size of the time-of-flight bins
+     inline G4double GetTOFBinSize() const
+       { return m_tofBinSize;}
+     //! Set the size of the time-of-flight bins
+     inline void SetTOFBinSize(G4double aSize)
+       { m_tofBinSize = aSize;}
+
+     //! Set the span of the sinograms (ring differences grouped while filling)
+     inline void SetSpan(size_t aNb)
+       { m_span = aNb;}
+     //! Set the mashing factor of the views (views summed while filling)
+     inline void SetMashing(size_t aNb)
+       { m_mashing = aNb;}
+     //! Set the maximum ring difference stored with a span > 1 (0: all)
+     inline void SetMaxRingDiff(size_t aNb)
+       { m_maxRingDiff = aNb;}
+
      //! Returns the nb of bytes per pixel;
     inline size_t BytesPerPixel() const
       { return m_sinogram->BytesPerPixel();}
@@ -244,6 +270,12 @@ protected:
   // C. Comtat, February 2011: Required to simulate Biograph output sinograms with virtual crystals
   size_t              m_virtualRingPerBlockNb;     //! < Number of virtual axial crystals in one block, i.e. Biograph
   size_t              m_virtualCrystalPerBlockNb;  //! < Number of virtual transaxial crystals in one block, i.e. Biograph
+
+  size_t              m_tofBinNb;                  //!< Number of time-of-flight bins
+  G4double            m_tofBinSize;                //!< Size of the time-of-flight bins
+  size_t              m_span;                      //!< Span of the sinograms (1: one 2D sinogram per ring pair)
+  size_t              m_mashing;                   //!< Mashing factor of the views
+  size_t              m_maxRingDiff;               //!< Maximum ring difference stored with a span > 1 (0: all)
   // std::ofstream     m_dataFile;   	      	   //!< Output stream for the data file
 
 };
@@ -50,6 +50,12 @@ class GateToSinogramMessenger: public GateOutputModuleMessenger
     G4UIcmdWithAnInteger*       SetVirtualRingCmd;       //!< The UI command "set the number of virtual rings between blocks (Biograph, for example)
     G4UIcmdWithAnInteger*       SetVirtualCrystalCmd;    //!< The UI command "set the number of virtual crystals between radial blocks (Biograph, for example)
 
+    G4UIcmdWithAnInteger*       SetTOFBinNbCmd;          //!< The UI command "set the number of time-of-flight bins"
+    G4UIcmdWithADoubleAndUnit*  SetTOFBinSizeCmd;        //!< The UI command "set the size of the time-of-flight bins"
+    G4UIcmdWithAnInteger*       SetSpanCmd;              //!< The UI command "set the span of the sinograms"
+    G4UIcmdWithAnInteger*       SetMashingCmd;           //!< The UI command "set the mashing factor of the views"
+    G4UIcmdWithAnInteger*       SetMaxRingDiffCmd;       //!< The UI command "set the maximum ring difference stored with a span > 1"
+
 };
 
 #endif
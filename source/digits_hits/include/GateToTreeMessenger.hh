@@ -21,6 +21,7 @@ class GateToTree;
 class G4UIcmdWithAString;
 class G4UIcmdWithABool;
 class G4UIcmdWithoutParameter;
+class G4UIcmdWithAnInteger;
 
 
 class GateToTreeMessenger : public GateOutputModuleMessenger
@@ -42,6 +43,8 @@ private:
   G4UIcmdWithoutParameter *m_disableOpticalDataOutput;
 
   G4UIcmdWithAString* m_addCollectionCmd;
+  G4UIcmdWithAnInteger* m_setChunkSizeCmd;
+  G4UIcmdWithAString* m_setCompressionCmd;
   GateToTree *m_gateToTree;
 
   std::unordered_map<G4UIcmdWithoutParameter*, G4String> m_maphits_cmdParameter_toTreeParameter;
@@ -44,6 +44,9 @@ class G4SliceTimer;
 class GateUserActions
 {
 public:
+  /// Creates the Run/Event/Tracking/Stepping actions and sets them to the
+  /// run manager. With m==0 (GATE_USE_MT), the actions are created and set
+  /// by GateActionInitialization, one GateUserActions per thread.
   GateUserActions(GateRunManager* m);
   ~GateUserActions();
 
@@ -119,7 +122,7 @@ protected:
   long int mStepNumberInCurrentTrack;
   //-----------------------------------------------------------------------------
 
-  static GateUserActions* pUserActions;
+  static G4ThreadLocal GateUserActions* pUserActions;
 
 
   GateRunAction* runAction;
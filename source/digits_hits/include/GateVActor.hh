@@ -32,6 +32,7 @@
 #include "GateFilterManager.hh"
 #include "GateObjectStore.hh"
 #include "GateVVolume.hh"
+#include "GateProfiler.hh"
 #include "G4VPrimitiveScorer.hh"
 #include "G4THitsMap.hh"
 #include "G4TouchableHistory.hh"
@@ -112,12 +113,29 @@ public:
   void EnableSaveEveryNSeconds(int n) { mSaveEveryNSeconds = n; }
   void SetOverWriteFilesFlag(bool b) { mOverWriteFilesFlag = b; }
   void EnableResetDataAtEachRun(bool b) { mResetDataAtEachRun = b; }
+  bool IsSaveEveryNEnabled() const { return mSaveEveryNEvents != 0 || mSaveEveryNSeconds != 0; }
+  //-----------------------------------------------------------------------------
+
+  //-----------------------------------------------------------------------------
+  /// With GATE_USE_MT, the event, track and step callbacks are called
+  /// concurrently by the worker threads; run callbacks and SaveData only
+  /// by the master. Actors that handle this must return true.
+  virtual bool SupportsMultithreading() const { return false; }
   //-----------------------------------------------------------------------------
 
   G4String GetVolumeName(){return mVolumeName;}
   GateVVolume * GetVolume(){return mVolume;}
   void SetVolumeName(G4String name){mVolumeName = name;}
 
+  //-----------------------------------------------------------------------------
+  /// Counters of the callbacks for GateProfiler (-1 if not registered)
+  enum ProfiledCallback { kBeginOfRun, kEndOfRun, kBeginOfEvent, kEndOfEvent,
+                          kPreUserTracking, kPostUserTracking, kUserStepping,
+                          kRecordEndOfAcquisition, kNumberOfProfiledCallbacks };
+  void RegisterProfilerCounters();
+  G4int GetProfilerCounter(ProfiledCallback c) const { return mProfilerCounters[c]; }
+  //-----------------------------------------------------------------------------
+
   GateFilterManager * GetFilterManager(){return pFilterManager;}
   G4int GetNumberOfFilters() {return mNumOfFilters;}
   void IncNumberOfFilters() {mNumOfFilters++;}
@@ -129,7 +147,11 @@ protected:
 
   GateFilterManager * pFilterManager;
 
-  virtual G4bool ProcessHits(G4Step * step, G4TouchableHistory *) { UserSteppingAction(0, step); return true; }
+  virtual G4bool ProcessHits(G4Step * step, G4TouchableHistory *) {
+    GateProfilerScope profilerScope(mProfilerCounters[kUserStepping]);
+    UserSteppingAction(0, step);
+    return true;
+  }
 
   G4int mNumOfFilters;
 
@@ -155,6 +177,8 @@ protected:
   struct timeval mTimeOfLastSaveEvent;
   //-----------------------------------------------------------------------------
 
+  G4int mProfilerCounters[kNumberOfProfiledCallbacks];
+
 };
 //-----------------------------------------------------------------------------
 
@@ -21,6 +21,7 @@ See LICENSE.md for further details
 #include "GateVVolume.hh"
 #include "GateImageWithStatistic.hh"
 #include "Randomize.hh"
+#include "G4VTouchable.hh"
 
 //-----------------------------------------------------------------------------
 /// \brief Base (virtual) class for sensor storing data in a 3D matrix
@@ -90,6 +91,33 @@ public :
                                        const G4ThreeVector mPosition,
                                        const StepHitType mStepHitType);
 
+  /// Depth, in the touchable history, of the ancestor of the current
+  /// volume whose logical volume is target, or only has the name of
+  /// target if byName (-1 if none). The step position used names, the
+  /// track position pointers. The depth is cached per thread for the
+  /// last (target, physical volume) pairs, and checked on each call with
+  /// a pointer comparison.
+  static int GetAncestorDepth(const G4LogicalVolume * target, const G4VTouchable * touchable,
+                              G4bool byName);
+
+  //-----------------------------------------------------------------------------
+  /// Multithreading (GATE_USE_MT). The worker threads accumulate in their
+  /// own buffers: event counter, step hit type of the current track and
+  /// the thread images of the GateImageWithStatistic registered with
+  /// AddThreadImage. The actor allocates them in BeginOfRunAction
+  /// (AllocateThreadData) and merges them in SaveData (MergeThreadData).
+  /// In a sequential run, there are no thread buffers: CountEvent and
+  /// GetCurrentStepHitType act on the actor itself.
+  void AddThreadImage(GateImageWithStatistic & image);
+  void AllocateThreadData();
+  /// Adds the thread buffers to the images, in thread index order, and
+  /// returns the number of events processed since the last merge
+  int MergeThreadData();
+  /// Counts a new event (in currentEvent for a sequential run)
+  void CountEvent(int & currentEvent);
+  /// Step hit type used for the current track of the calling thread
+  StepHitType & GetCurrentStepHitType();
+
 protected:
 
   //-----------------------------------------------------------------------------
@@ -110,6 +138,19 @@ protected:
   bool           mHalfSizeIsSet;
   bool           mPositionIsSet;
 
+  struct ThreadState {
+    int mCurrentEvent;   // event counter of the thread (never reset)
+    int mNumberOfEvents; // events since the last merge
+    StepHitType mStepHitType;
+  };
+  std::vector<ThreadState> mThreadStates;
+  std::vector<GateImageWithStatistic*> mThreadImageList;
+  /// State of the calling worker thread (0 if the run is sequential)
+  ThreadState * GetThreadState();
+  /// Per-thread buffers of the derived actors, other than the images
+  virtual void AllocateThreadBuffers(int /*nbOfThreads*/) {}
+  virtual void MergeThreadBuffers() {}
+
   int GetIndexFromTrackPosition(const GateVVolume *, const G4Track * track);
   int GetIndexFromStepPosition(const GateVVolume *, const G4Step  * step);
 
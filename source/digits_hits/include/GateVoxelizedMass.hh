@@ -57,6 +57,7 @@ class GateVoxelizedMass
   void    SetMaterialFilter   (G4String);
   void    SetVolumeFilter     (G4String);
   void    SetExternalMassImage(G4String);
+  void    SetMassCacheDirectory(G4String dir) { mMassCacheDirectory = dir; }
 
   pair<double,double> VoxelIteration(const G4VPhysicalVolume*,int, G4RotationMatrix, G4ThreeVector,int index);
 
@@ -69,11 +70,20 @@ class GateVoxelizedMass
   bool IsLVParameterized(const G4LogicalVolume*);
 
   void GenerateVectors();
+  void GenerateVectorsInParallel();
   void GenerateVoxels();
-  void GenerateDosels(int index);
+  void GenerateDosels(int index, double doselMin[3], double doselMax[3]);
+  void GenerateLabelTables();
+  inline int GetLabelIndex(const unsigned long int x, const unsigned long int y, const unsigned long int z);
 
   pair<double,double> ParameterizedVolume(int index);
 
+  // Mass cache, keyed by a hash of the geometry and of the dosels
+  unsigned long long ComputeCacheKey();
+  G4String GetCacheFileName(unsigned long long key);
+  bool ReadMassCache();
+  void WriteMassCache();
+
   GateVImageVolume* imageVolume;
   const G4VPhysicalVolume* DAPV;
   const G4LogicalVolume* DALV;
@@ -94,12 +104,16 @@ class GateVoxelizedMass
   std::vector<std::vector<std::pair<G4String,double> > > mMass;
   std::vector<std::vector<std::pair<G4String,double> > > mEdep;
 
-  //std::vector<double> doselReconstructedCubicVolume;
+  std::vector<double> doselReconstructedCubicVolume;
   std::vector<double> doselReconstructedMass;
-  std::vector<double> doselMin;
-  std::vector<double> doselMax;
   std::vector<double> doselExternalMass;
 
+  // Density of the material of each label of the image, and whether
+  // it passes the material filter (index: label - mLabelOffset)
+  std::vector<double> mLabelDensity;
+  std::vector<char>   mLabelIsFiltered;
+  int mLabelOffset;
+
   double voxelCubicVolume;
   double mFilteredVolumeMass;
   double mFilteredVolumeCubicVolume;
@@ -111,6 +125,7 @@ class GateVoxelizedMass
   G4String mMassFile;
   G4String mMaterialFilter;
   G4String mVolumeFilter;
+  G4String mMassCacheDirectory;
 
   bool mIsInitialized;
   bool mIsParameterised;
@@ -123,4 +138,11 @@ class GateVoxelizedMass
   int seconds;
 };
 
+//-----------------------------------------------------------------------------
+inline int GateVoxelizedMass::GetLabelIndex(const unsigned long int x, const unsigned long int y, const unsigned long int z)
+{
+  return (int)imageVolume->GetImage()->GetValue(x,y,z) - mLabelOffset;
+}
+//-----------------------------------------------------------------------------
+
 #endif
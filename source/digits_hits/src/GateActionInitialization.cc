@@ -0,0 +1,60 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateActionInitialization.hh"
+#include "GateActions.hh"
+#include "GateUserActions.hh"
+#include "GatePrimaryGeneratorAction.hh"
+#include "GateSteppingVerbose.hh"
+#include "GateMessageManager.hh"
+
+//-----------------------------------------------------------------------------
+GateActionInitialization::GateActionInitialization()
+  : mMasterSteppingAction(0), mMasterPrimaryGeneratorAction(0)
+{
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateActionInitialization::BuildForMaster() const
+{
+  GateMessage("Core", 4, "GateActionInitialization::BuildForMaster\n");
+  GateUserActions * userActions = new GateUserActions(0);
+  SetUserAction(new GateRunAction(userActions));
+  mMasterSteppingAction = new GateSteppingAction(userActions);
+  mMasterPrimaryGeneratorAction = new GatePrimaryGeneratorAction();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateActionInitialization::Build() const
+{
+  GateMessage("Core", 4, "GateActionInitialization::Build (worker)\n");
+  GateUserActions * userActions = new GateUserActions(0);
+  SetUserAction(new GateRunAction(userActions));
+  SetUserAction(new GateEventAction(userActions));
+  SetUserAction(new GateTrackingAction(userActions));
+  GateSteppingAction * steppingAction = new GateSteppingAction(userActions);
+  if (mMasterSteppingAction) steppingAction->CopySettings(*mMasterSteppingAction);
+  SetUserAction(steppingAction);
+  GatePrimaryGeneratorAction * generator = new GatePrimaryGeneratorAction();
+  if (mMasterPrimaryGeneratorAction)
+    generator->SetVerboseLevel(mMasterPrimaryGeneratorAction->GetVerboseLevel());
+  SetUserAction(generator);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4VSteppingVerbose * GateActionInitialization::InitializeSteppingVerbose() const
+{
+  return new GateSteppingVerbose;
+}
+//-----------------------------------------------------------------------------
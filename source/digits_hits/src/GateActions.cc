@@ -27,6 +27,7 @@
 #endif
 #include "GateARFDataToRoot.hh"
 #include "GateVolumeID.hh"
+#include "GatePulse.hh"
 #include "GateToRoot.hh"
 #include "GateSPECTHeadSystem.hh"
 #include "GateSystemListManager.hh"
@@ -50,9 +51,12 @@
 
 #include "GateSteppingActionMessenger.hh"
 #include "GateCrystalSD.hh"
+#include "GateMTHelper.hh"
+#include "GatePrimaryGeneratorAction.hh"
 
-GateRunAction* GateRunAction::prunAction=0;
-GateEventAction* GateEventAction::peventAction=0;
+G4ThreadLocal GateRunAction* GateRunAction::prunAction=0;
+G4ThreadLocal GateEventAction* GateEventAction::peventAction=0;
+G4ThreadLocal GateSteppingAction* GateSteppingAction::pSteppingAction=0;
 
 //-----------------------------------------------------------------------------
 GateRunAction::GateRunAction(GateUserActions * cbm)
@@ -75,13 +79,19 @@ void GateRunAction::BeginOfRunAction(const G4Run* aRun)
 
 #ifdef G4ANALYSIS_USE_GENERAL
   // Here we fill the histograms of the Analysis manager
-  if(GateApplicationMgr::GetInstance()->GetOutputMode()){
+  // (output modules are shared, the run is recorded by the master only)
+  if(GateApplicationMgr::GetInstance()->GetOutputMode() && !GateMTHelper::IsWorkerThread()){
     GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
     outputMgr->RecordBeginOfRun(aRun);
   }
 #endif
 
   pCallbackMan->BeginOfRunAction(aRun);
+
+#ifdef GATE_USE_MT
+  // Sources are prepared by the master, before the workers start the run
+  if (!GateMTHelper::IsWorkerThread()) GatePrimaryGeneratorAction::PrepareNextRun(aRun);
+#endif
 }
 //-----------------------------------------------------------------------------
 
@@ -95,7 +105,7 @@ inline void GateRunAction::EndOfRunAction(const G4Run* aRun)
 
 #ifdef G4ANALYSIS_USE_GENERAL
   // Here we fill the histograms of the Analysis manager
-  if(GateApplicationMgr::GetInstance()->GetOutputMode()){
+  if(GateApplicationMgr::GetInstance()->GetOutputMode() && !GateMTHelper::IsWorkerThread()){
     GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
     outputMgr->RecordEndOfRun(aRun);
   }
@@ -119,14 +129,15 @@ inline void GateEventAction::BeginOfEventAction(const G4Event* anEvent)
 {
   GateMessage("Core", 2, "Begin Of Event " << anEvent->GetEventID() << "\n");
 
-  TrackingMode theMode =( (GateSteppingAction *)(GateRunManager::GetRunManager()->GetUserSteppingAction() ) )->GetMode();
+  TrackingMode theMode =( GateSteppingAction::GetSteppingAction() )->GetMode();
   if ( theMode != TrackingMode::kTracker )
     {
 
 
 #ifdef G4ANALYSIS_USE_GENERAL
       // Here we fill the histograms of the OutputMgr manager
-      if(GateApplicationMgr::GetInstance()->GetOutputMode()){
+      // (output modules are refused with GATE_USE_MT, see GateOutputMgr)
+      if(GateApplicationMgr::GetInstance()->GetOutputMode() && !GateMTHelper::IsWorkerThread()){
         GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
         outputMgr->RecordBeginOfEvent(anEvent);
       }
@@ -143,12 +154,10 @@ inline void GateEventAction::EndOfEventAction(const G4Event* anEvent)
 {
   GateMessage("Core", 2, "End Of Event " << anEvent->GetEventID() << "\n");
 
-
-
 #ifdef G4ANALYSIS_USE_GENERAL
   // Here we fill the histograms of the OutputMgr manager
   // Pre-digitalisation outputMgr (hits)
-  if(GateApplicationMgr::GetInstance()->GetOutputMode()){
+  if(GateApplicationMgr::GetInstance()->GetOutputMode() && !GateMTHelper::IsWorkerThread()){
     GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
     outputMgr->RecordEndOfEvent(anEvent);
   }
@@ -156,7 +165,7 @@ inline void GateEventAction::EndOfEventAction(const G4Event* anEvent)
 
   /* PY Descourt 08/09/2009 */
 
-  GateSteppingAction* myAction = ( (GateSteppingAction *)(GateRunManager::GetRunManager()->GetUserSteppingAction() ) );
+  GateSteppingAction* myAction = ( GateSteppingAction::GetSteppingAction() );
   TrackingMode theMode = myAction->GetMode();
 
   if ( theMode == TrackingMode::kTracker )
@@ -188,8 +197,10 @@ inline void GateEventAction::EndOfEventAction(const G4Event* anEvent)
       // se charge de remplir les histos      : steppingAction contient la colllection de tracks
     }//tracker mode
 
-
   if(anEvent->GetNumberOfPrimaryVertex() > 0) pCallbackMan->EndOfEventAction(anEvent);
+
+  // the pulses of the event are deleted
+  GatePulse::ResetPools();
 }
 //-----------------------------------------------------------------------------
 
@@ -213,7 +224,7 @@ void GateTrackingAction::PreUserTrackingAction(const G4Track* a)
 
   /* PY Descourt 08/09/2009 */
 
-  GateSteppingAction*  myAction = (GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()) ;
+  GateSteppingAction*  myAction = GateSteppingAction::GetSteppingAction() ;
 
   TrackingMode theMode = myAction->GetMode();
 
@@ -301,7 +312,7 @@ void GateTrackingAction::PostUserTrackingAction(const G4Track* aTrack)
       dummy_step_vector.clear();
     }
 
-  GateSteppingAction*  myAction = (GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()) ;
+  GateSteppingAction*  myAction = GateSteppingAction::GetSteppingAction() ;
   TrackingMode theMode = myAction->GetMode();
   if ( theMode == TrackingMode::kDetector )
     {
@@ -524,6 +535,27 @@ GateSteppingAction::GateSteppingAction(GateUserActions * cbm)
   fStartVolumeIsPhantomSD = false;
   m_energyThreshold = 0.;
   /* PY Descourt 18/12/2008 */
+  pSteppingAction = this;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateSteppingAction::CopySettings(const GateSteppingAction & a)
+{
+  m_drawTrjLevel = a.m_drawTrjLevel;
+  m_verboseLevel = a.m_verboseLevel;
+  m_trackingMode = a.m_trackingMode;
+  Boundary = a.Boundary;
+  fStpAKill = a.fStpAKill;
+  fKeepOnlyP = a.fKeepOnlyP;
+  fKeepOnlyPhotons = a.fKeepOnlyPhotons;
+  fKeepOnlyElectrons = a.fKeepOnlyElectrons;
+  TxtOn = a.TxtOn;
+  m_Nfiles = a.m_Nfiles;
+  m_NfilesRS = a.m_NfilesRS;
+  m_StartingVolName = a.m_StartingVolName;
+  m_energyThreshold = a.m_energyThreshold;
 }
 //-----------------------------------------------------------------------------
 void GateSteppingAction::SetEnergyThreshold(G4double aE){ m_energyThreshold = aE; }
@@ -586,6 +618,10 @@ void GateSteppingAction::StopAndKill(G4String aString )
 }
 void GateSteppingAction::SetMode( TrackingMode aMode)
 {
+  // Tracker/detector modes write and read the tracks of each event in
+  // files, they are sequential only
+  if (GateMTHelper::IsMultithreaded() && aMode != TrackingMode::kBoth)
+    GateError("Tracker and detector modes cannot be used with multithreading (GATE_USE_MT).");
   m_trackingMode = aMode;
 }
 
@@ -766,7 +802,7 @@ void GateSteppingAction::UserSteppingAction(const G4Step* theStep)
   if (m_trackingMode == TrackingMode::kTracker )
     {
       G4int EventID = G4EventManager::GetEventManager()->GetNonconstCurrentEvent()->GetEventID();
-      G4int RunID   = GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+      G4int RunID   = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
       G4Track * fTrack = theStep->GetTrack();
       G4int ParentID  =  fTrack->GetParentID();
       G4int TrackID = fTrack->GetTrackID();
@@ -987,8 +1023,10 @@ void GateSteppingAction::UserSteppingAction(const G4Step* theStep)
 #ifdef G4ANALYSIS_USE_GENERAL
   // Here we fill the histograms of the OutputMgr manager
   // Pre-digitalisation outputMgr (hits)
-  GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
-  outputMgr->RecordStepWithVolume(0,theStep);
+  if(!GateMTHelper::IsWorkerThread()){
+    GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
+    outputMgr->RecordStepWithVolume(0,theStep);
+  }
 #endif
 
   pCallbackMan->UserSteppingAction(theStep);
@@ -1007,7 +1045,7 @@ void GateSteppingAction::UserSteppingAction(const GateVVolume *v, const G4Step*
 
 #ifdef G4ANALYSIS_USE_GENERAL
   // Here we fill the histograms of the Analysis manager
-  if(GateApplicationMgr::GetInstance()->GetOutputMode()){
+  if(GateApplicationMgr::GetInstance()->GetOutputMode() && !GateMTHelper::IsWorkerThread()){
     GateOutputMgr* outputMgr = GateOutputMgr::GetInstance();
     outputMgr->RecordStepWithVolume(v, theStep);
   }
@@ -1016,7 +1054,7 @@ void GateSteppingAction::UserSteppingAction(const GateVVolume *v, const G4Step*
   G4bool drawTrj = false;
   if (m_drawTrjLevel == 0) {
   } else if (m_drawTrjLevel == 1) {
-    G4int currentEvent = GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
+    G4int currentEvent = G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
     if (currentEvent <= 10) {
       drawTrj = true;
     }
@@ -1228,7 +1266,7 @@ void GateSteppingAction::UserSteppingAction(const GateVVolume *v, const G4Step*
   if (m_trackingMode == TrackingMode::kTracker )
     {
       G4int EventID = G4EventManager::GetEventManager()->GetNonconstCurrentEvent()->GetEventID();
-      G4int RunID   = GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+      G4int RunID   = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
       G4Track * fTrack = theStep->GetTrack();
       G4int ParentID  =  fTrack->GetParentID();
       G4int TrackID = fTrack->GetTrackID();
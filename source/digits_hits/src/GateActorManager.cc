@@ -13,6 +13,9 @@
 #include "GateActorManager.hh"
 #include "GateVActor.hh"
 #include "GateMultiSensitiveDetector.hh"
+#include "GateMTHelper.hh"
+
+G4ThreadLocal G4int GateActorManager::mCurrentEventId = 0;
 
 //-----------------------------------------------------------------------------
 GateActorManager::GateActorManager()
@@ -92,6 +95,19 @@ void GateActorManager::CreateListsOfEnabledActors()
     //GateMessage("Core", 0, "Actor = " << (*sit)->GetObjectName() << Gateendl);
 
     (*sit)->Construct();
+    (*sit)->RegisterProfilerCounters();
+    if (GateMTHelper::IsMultithreaded() && IsInitialized<2) {
+      if (!(*sit)->SupportsMultithreading())
+        GateError("Actor " << (*sit)->GetObjectName() << " (" << (*sit)->GetTypeName()
+                  << ") cannot be used with multithreading (GATE_USE_MT).");
+      if ((*sit)->GetNumberOfFilters() > 0)
+        GateError("Actor " << (*sit)->GetObjectName()
+                  << ": filters cannot be used with multithreading (GATE_USE_MT).");
+      if ((*sit)->IsSaveEveryNEnabled())
+        GateError("Actor " << (*sit)->GetObjectName()
+                  << ": saveEveryNEvents/saveEveryNSeconds cannot be used with multithreading"
+                  << " (GATE_USE_MT), the data are saved at the end of each run.");
+    }
     if ((*sit)->IsBeginOfRunActionEnabled()       && IsInitialized<2) theListOfActorsEnabledForBeginOfRun.push_back( (*sit) );
     if ((*sit)->IsEndOfRunActionEnabled()         && IsInitialized<2) theListOfActorsEnabledForEndOfRun.push_back( (*sit) );
     if ((*sit)->IsBeginOfEventActionEnabled()     && IsInitialized<2) theListOfActorsEnabledForBeginOfEvent.push_back( (*sit) );
@@ -148,11 +164,15 @@ std::vector<GateVActor*> GateActorManager::ReturnListOfActors()
 //-----------------------------------------------------------------------------
 void GateActorManager::BeginOfRunAction(const G4Run* run)
 {
+  // In MT mode, the actors are prepared and saved by the master only
+  if (GateMTHelper::IsWorkerThread()) return;
   std::vector<GateVActor*>::iterator sit;
 
   //GateMessage("Core", 0, "Run " << run->GetRunID() << " is starting.\n");
-  for (sit = theListOfActorsEnabledForBeginOfRun.begin(); sit!=theListOfActorsEnabledForBeginOfRun.end(); ++sit)
+  for (sit = theListOfActorsEnabledForBeginOfRun.begin(); sit!=theListOfActorsEnabledForBeginOfRun.end(); ++sit) {
+    GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kBeginOfRun));
     (*sit)->BeginOfRunAction(run);
+  }
 
 }
 //-----------------------------------------------------------------------------
@@ -160,9 +180,12 @@ void GateActorManager::BeginOfRunAction(const G4Run* run)
 //-----------------------------------------------------------------------------
 void GateActorManager::EndOfRunAction(const G4Run* run)
 {
+  if (GateMTHelper::IsWorkerThread()) return;
   std::vector<GateVActor*>::iterator sit;
-  for (sit = theListOfActorsEnabledForEndOfRun.begin(); sit!=theListOfActorsEnabledForEndOfRun.end(); ++sit)
+  for (sit = theListOfActorsEnabledForEndOfRun.begin(); sit!=theListOfActorsEnabledForEndOfRun.end(); ++sit) {
+    GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kEndOfRun));
     (*sit)->EndOfRunAction(run);
+  }
   //GateMessage("Core", 0, "Run " << run->GetRunID() << " is ending.\n");
 }
 //-----------------------------------------------------------------------------
@@ -172,8 +195,10 @@ void GateActorManager::BeginOfEventAction(const G4Event* evt)
 {
   if (evt) mCurrentEventId = evt->GetEventID();
   std::vector<GateVActor*>::iterator sit;
-  for (sit = theListOfActorsEnabledForBeginOfEvent.begin(); sit!=theListOfActorsEnabledForBeginOfEvent.end(); ++sit)
+  for (sit = theListOfActorsEnabledForBeginOfEvent.begin(); sit!=theListOfActorsEnabledForBeginOfEvent.end(); ++sit) {
+    GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kBeginOfEvent));
     (*sit)->BeginOfEventAction(evt);
+  }
 }
 //-----------------------------------------------------------------------------
 
@@ -181,8 +206,10 @@ void GateActorManager::BeginOfEventAction(const G4Event* evt)
 void GateActorManager::EndOfEventAction(const G4Event* evt)
 {
   std::vector<GateVActor*>::iterator sit;
-  for (sit = theListOfActorsEnabledForEndOfEvent.begin(); sit!=theListOfActorsEnabledForEndOfEvent.end(); ++sit)
+  for (sit = theListOfActorsEnabledForEndOfEvent.begin(); sit!=theListOfActorsEnabledForEndOfEvent.end(); ++sit) {
+    GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kEndOfEvent));
     (*sit)->EndOfEventAction(evt);
+  }
 }
 //-----------------------------------------------------------------------------
 
@@ -196,6 +223,7 @@ void GateActorManager::PreUserTrackingAction(const G4Track* track)
     {
       if ((*sit)->GetNumberOfFilters()!=0)
         if (!(*sit)->GetFilterManager()->Accept(track) ) continue;
+      GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kPreUserTracking));
       (*sit)->PreUserTrackingAction(0,track);
     }
 }
@@ -209,6 +237,7 @@ void GateActorManager::PostUserTrackingAction(const G4Track* track)
     {
       if ((*sit)->GetNumberOfFilters()!=0)
         if (!(*sit)->GetFilterManager()->Accept(track) ) continue;
+      GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kPostUserTracking));
       (*sit)->PostUserTrackingAction(0,track);
     }
 }
@@ -225,6 +254,7 @@ void GateActorManager::UserSteppingAction(const G4Step* step)
       if ((*sit)->GetNumberOfFilters()!=0){
         if (!(*sit)->GetFilterManager()->Accept(step) ) continue;
       }
+      GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kUserStepping));
       (*sit)->UserSteppingAction(0, step);
     }
 }
@@ -238,6 +268,7 @@ void GateActorManager::RecordEndOfAcquisition()
   for (sit = theListOfActorsEnabledForRecordEndOfAcquisition.begin(); sit!=theListOfActorsEnabledForRecordEndOfAcquisition.end(); ++sit)
     {
       // GateDebugMessage("Actor", 1, "Step for " << (*sit)->GetObjectName());
+      GateProfilerScope profilerScope((*sit)->GetProfilerCounter(GateVActor::kRecordEndOfAcquisition));
       (*sit)->RecordEndOfAcquisition();
     }
 }
@@ -123,7 +123,7 @@ void GateAnalysis::RecordEndOfEvent(const G4Event* event)
     m_trajectoryNavigator->SetTrajectoryContainer(trajectoryContainer);
 
   G4int eventID = event->GetEventID();
-  G4int runID   = GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  G4int runID   = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
   //G4cout << "GateAnalysis::EventID et RunID :  " <<eventID<<" - "<<runID<< Gateendl;
 
   //G4int i;
@@ -316,7 +316,7 @@ void GateAnalysis::RecordEndOfEvent(const G4Event* event)
                 }
             } // end loop NpHits
 
-          TrackingMode theMode =( (GateSteppingAction *)(GateRunManager::GetRunManager()->GetUserSteppingAction() ) )->GetMode();
+          TrackingMode theMode =( GateSteppingAction::GetSteppingAction() )->GetMode();
 
 
           if (  theMode == TrackingMode::kTracker ) // in tracker mode we store the infos about the number of compton and rayleigh
@@ -24,6 +24,8 @@ See LICENSE.md for further details
 #include "GateVSystem.hh"
 #include "GateCoincidenceDigiMaker.hh"
 
+#include <algorithm>
+
 //#include <map>
 
 //------------------------------------------------------------------------------------------------------
@@ -47,6 +49,7 @@ GateCoincidenceSorter::GateCoincidenceSorter(GateDigitizer* itsDigitizer,
     m_allPulseOpenCoincGate(false),
     m_depth(1),
     m_presortBufferSize(256),
+    m_presortOrder(0),
     m_presortWarning(false),
     m_CCSorter(IsCCSorter),
     m_triggerOnlyByAbsorber(0),
@@ -70,7 +73,7 @@ GateCoincidenceSorter::~GateCoincidenceSorter()
   while(m_presortBuffer.size() > 0)
   {
      // G4cout<<"[GateCoincidenceSorter::~GateCoincidenceSorter()] m_presortBuffer.size="<<m_presortBuffer.size()<<G4endl;
-    delete m_presortBuffer.back();
+    delete m_presortBuffer.back().pulse;
     m_presortBuffer.pop_back();
   }
 
@@ -152,7 +155,7 @@ void GateCoincidenceSorter::SetAcceptancePolicy4CC(const G4String &policy)
 void GateCoincidenceSorter::ProcessSinglePulseList(GatePulseList* inp)
 {
   GatePulse* pulse;
-  std::list<GatePulse*>::iterator buf_iter;                // presort buffer iterator
+  PresortEntry entry;                                      // presort buffer element
   std::deque<GateCoincidencePulse*>::iterator coince_iter; // coincidence list iterator
 
   G4bool inCoincidence;
@@ -244,26 +247,21 @@ void GateCoincidenceSorter::ProcessSinglePulseList(GatePulseList* inp)
       // make a copy of the pulse
       pulse = new GatePulse(**gpl_iter);
 
-      if(m_presortBuffer.empty())
-          m_presortBuffer.push_back(pulse);
-      else if(pulse->GetTime() < m_presortBuffer.back()->GetTime())    // check that even isn't earlier than the earliest event in the buffer
+      // check that event isn't earlier than the earliest event in the buffer
+      // (it is still sorted correctly, but coincidences may be missed)
+      if(!m_presortBuffer.empty() && pulse->GetTime() < m_presortBuffer.front().time)
       {
           if(!m_presortWarning)
               GateWarning("Event is earlier than earliest event in coincidence presort buffer. Consider using a larger buffer.");
           m_presortWarning = true;
-          m_presortBuffer.push_back(pulse); // this will probably not cause a problem, but coincidences may be missed
-      }
-      else // put the event into the presort buffer in the right place
-      {
-          buf_iter = m_presortBuffer.begin();
-          while(pulse->GetTime() < (*buf_iter)->GetTime())
-              buf_iter++;
-          m_presortBuffer.insert(buf_iter, pulse);
-          //      G4cout<<"presortBuffer filled in position "<<std::distance(m_presortBuffer.begin(),buf_iter)<<G4endl;
-          //      G4cout<<"pulseTime "<<pulse->GetTime()<<G4endl;
-          //      G4cout<<"pulseTime "<<pulse->GetTime()/ns<<G4endl;
       }
 
+      // put the event into the presort buffer
+      entry.time = pulse->GetTime();
+      entry.order = m_presortOrder++;
+      entry.pulse = pulse;
+      m_presortBuffer.push_back(entry);
+      std::push_heap(m_presortBuffer.begin(), m_presortBuffer.end(), PresortEntryIsLater());
   }
 
 
@@ -271,7 +269,8 @@ void GateCoincidenceSorter::ProcessSinglePulseList(GatePulseList* inp)
   for(G4int i = m_presortBuffer.size();i > m_presortBufferSize;i--)
   {
 
-    pulse = m_presortBuffer.back();
+    std::pop_heap(m_presortBuffer.begin(), m_presortBuffer.end(), PresortEntryIsLater());
+    pulse = m_presortBuffer.back().pulse;
     m_presortBuffer.pop_back();
 
     // process completed coincidence pulse window at front of list
@@ -17,7 +17,7 @@ See LICENSE.md for further details
 #include "GateCrystalHit.hh"
 
 
-G4Allocator<GateCrystalHit> GateCrystalHitAllocator;
+G4ThreadLocal G4Allocator<GateCrystalHit> * GateCrystalHitAllocator = 0;
 
 //---------------------------------------------------------------------
 GateCrystalHit::GateCrystalHit()
@@ -28,6 +28,7 @@
 
 
 #include "GateObjectStore.hh"
+#include "GateProfiler.hh"
 #include "GateEmittedGammaInformation.hh"
 
 // Name of the hit collection
@@ -41,6 +42,7 @@ GateCrystalSD::GateCrystalSD(const G4String& name)
 :G4VSensitiveDetector(name),m_system(0)
 {
   collectionName.insert(theCrystalCollectionName);
+  m_profilerCounter = GateProfiler::Register("SD", name, "ProcessHits");
 }
 //------------------------------------------------------------------------------
 
@@ -98,6 +100,7 @@ void GateCrystalSD::Initialize(G4HCofThisEvent*HCE)
 //G4bool GateCrystalSD::ProcessHits(G4Step*aStep,G4TouchableHistory*ROhist)
 G4bool GateCrystalSD::ProcessHits(G4Step*aStep, G4TouchableHistory*)
 {
+  GateProfilerScope profilerScope(m_profilerCounter);
 
   // Get the track information
   G4Track* aTrack       = aStep->GetTrack();
@@ -82,12 +82,14 @@ void GateCylindricalEdepActor::Construct() {
     mEdepImage.SetResolutionAndHalfSizeCylinder(mResolution, mHalfSize, mPosition);
     mEdepImage.Allocate();
     mEdepImage.SetFilename(mEdepFilename);
+    AddThreadImage(mEdepImage);
   }
  
   if (mIsDoseImageEnabled) {
     mDoseImage.SetResolutionAndHalfSize(mResolution, mHalfSize, mPosition);
     mDoseImage.Allocate();
     mDoseImage.SetFilename(mDoseFilename);
+    AddThreadImage(mDoseImage);
     G4cout<< "allocate dose image and set resolution and file name" <<G4endl<<G4endl;
   }
  
@@ -95,6 +97,7 @@ void GateCylindricalEdepActor::Construct() {
     mFluenceImage.SetResolutionAndHalfSizeCylinder(mResolution, mHalfSize, mPosition);
     mFluenceImage.Allocate();
     mFluenceImage.SetFilename(mFluenceFilename);
+    AddThreadImage(mFluenceImage);
   }
   // Print information
   //GateMessage("Actor", 1,
@@ -127,6 +130,7 @@ void GateCylindricalEdepActor::Construct() {
 /// Save data
 void GateCylindricalEdepActor::SaveData() {
   GateVActor::SaveData(); // (not needed because done into GateImageWithStatistic)
+  mCurrentEvent += MergeThreadData();
 
   if (mIsEdepImageEnabled) mEdepImage.SaveData(mCurrentEvent+1);
   if (mIsFluenceImageEnabled) mFluenceImage.SaveData(mCurrentEvent+1);
@@ -153,7 +157,7 @@ void GateCylindricalEdepActor::BeginOfRunAction(const G4Run * r) {
   GateVActor::BeginOfRunAction(r);
   GateDebugMessage("Actor", 3, "GateCylindricalEdepActor -- Begin of Run\n");
   // ResetData(); // Do no reset here !! (when multiple run);
-  //
+  AllocateThreadData();
 }
 //-----------------------------------------------------------------------------
  
@@ -162,7 +166,7 @@ void GateCylindricalEdepActor::BeginOfRunAction(const G4Run * r) {
 // Callback at each event
 void GateCylindricalEdepActor::BeginOfEventAction(const G4Event * e) {
   GateVActor::BeginOfEventAction(e);
-  mCurrentEvent++;
+  CountEvent(mCurrentEvent);
   GateDebugMessage("Actor", 3, "GateCylindricalEdepActor -- Begin of Event: "<<mCurrentEvent << Gateendl);
 }
 //-----------------------------------------------------------------------------
@@ -171,8 +175,9 @@ void GateCylindricalEdepActor::BeginOfEventAction(const G4Event * e) {
 //-----------------------------------------------------------------------------
 void GateCylindricalEdepActor::UserPreTrackActionInVoxel(const int /*index*/, const G4Track* track)
 {
-  if(track->GetDefinition()->GetParticleName() == "gamma") { mStepHitType = PostStepHitTypeCylindricalCS; }
-  else { mStepHitType = RandomStepHitTypeCylindricalCS; }
+  StepHitType & type = GetCurrentStepHitType();
+  if(track->GetDefinition()->GetParticleName() == "gamma") { type = PostStepHitTypeCylindricalCS; }
+  else { type = RandomStepHitTypeCylindricalCS; }
 }
 //-----------------------------------------------------------------------------
 
@@ -14,6 +14,7 @@
 // gate
 #include "GateDoseActor.hh"
 #include "GateMiscFunctions.hh"
+#include "GateVImageVolume.hh"
 
 // g4
 #include <G4EmCalculator.hh>
@@ -30,6 +31,10 @@
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ProcessManager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include <algorithm>
 
 //-----------------------------------------------------------------------------
 GateDoseActor::GateDoseActor(G4String name, G4int depth):
@@ -60,12 +65,18 @@ GateDoseActor::GateDoseActor(G4String name, G4int depth):
   mIsDoseToOtherMaterialUncertaintyImageEnabled = false;
   mIsDoseToOtherMaterialNormalisationEnabled = false;
   mOtherMaterial = "G4Water";
+  pOtherMaterial = 0;
+  //Stopping power ratio tables
+  mIsStoppingPowerRatioTableEnabled = false;
+  mStoppingPowerRatioTolerance = 1e-4;
+  mStoppingPowerRatioMaxDeviation = 0.0;
   //Others
   mIsNumberOfHitsImageEnabled = false;
   mIsLastHitEventImageEnabled = false;
   mDoseAlgorithmType = "VolumeWeighting";
   mImportMassImage = "";
   mExportMassImage = "";
+  mMassCacheDirectory = "";
   mVolumeFilter = "";
   mMaterialFilter = "";
   mTestFlag = false;
@@ -233,6 +244,7 @@ void GateDoseActor::Construct() {
     mEdepImage.SetResolutionAndHalfSize(mResolution, mHalfSize, mPosition);
     mEdepImage.Allocate();
     mEdepImage.SetFilename(mEdepFilename);
+    AddThreadImage(mEdepImage);
   }
   //Dose
   if (mIsDoseImageEnabled) {
@@ -244,6 +256,7 @@ void GateDoseActor::Construct() {
     if (mIsDoseUncertaintyImageEnabled) mDoseImage.EnableSquaredImage(true);
     mDoseImage.Allocate();
     mDoseImage.SetFilename(mDoseFilename);
+    AddThreadImage(mDoseImage);
   }
   //DoseToWater
   if (mIsDoseToWaterImageEnabled) {
@@ -329,6 +342,7 @@ void GateDoseActor::Construct() {
     mVoxelizedMass.SetMaterialFilter(mMaterialFilter);
     mVoxelizedMass.SetVolumeFilter(mVolumeFilter);
     mVoxelizedMass.SetExternalMassImage(mImportMassImage);
+    mVoxelizedMass.SetMassCacheDirectory(mMassCacheDirectory);
     mVoxelizedMass.Initialize(mVolumeName, &mDoseImage.GetValueImage());
     if (mExportMassImage != "") {
       mMassImage.SetResolutionAndHalfSize(mResolution, mHalfSize, mPosition);
@@ -366,6 +380,17 @@ void GateDoseActor::Construct() {
     GateRegionDoseStat::AddAggregatedRegion(mMapIdToSingleRegion, mMapLabelToSeveralRegions, mMapIdToLabels);
   }
 
+#ifdef GATE_USE_MT
+  // These options use shared caches (G4EmCalculator, stopping power
+  // tables, material database, regions) that are not thread safe.
+  if (mIsDoseToWaterImageEnabled || mIsDoseToOtherMaterialImageEnabled ||
+      mDoseAlgorithmType == "MassWeighting" || mVolumeFilter != "" || mMaterialFilter != "" ||
+      mDoseByRegionsFlag || mTestFlag) {
+    GateError("DoseActor " << GetObjectName() << ": with multithreading, only the edep, dose"
+              << " (volume weighting) and number of hits images are available.");
+  }
+#endif
+
   // Print information
   GateMessage("Actor", 1,
               "Dose DoseActor    = '" << GetObjectName() << "'\n" <<
@@ -375,6 +400,8 @@ void GateDoseActor::Construct() {
               "\tDose to water image        = " << mIsDoseToWaterImageEnabled << Gateendl <<
               "\tDose to water squared      = " << mIsDoseToWaterSquaredImageEnabled << Gateendl <<
               "\tDose to water uncertainty  = " << mIsDoseToWaterUncertaintyImageEnabled << Gateendl <<
+              "\tStopping power ratio table = " << mIsStoppingPowerRatioTableEnabled
+              << " (tolerance " << mStoppingPowerRatioTolerance << ")" << Gateendl <<
               "\tEdep image        = " << mIsEdepImageEnabled << Gateendl <<
               "\tEdep squared      = " << mIsEdepSquaredImageEnabled << Gateendl <<
               "\tEdep uncertainty  = " << mIsEdepUncertaintyImageEnabled << Gateendl <<
@@ -401,6 +428,7 @@ void GateDoseActor::Construct() {
 /// Save data
 void GateDoseActor::SaveData() {
   GateVActor::SaveData(); // (not needed because done into GateImageWithStatistic)
+  mCurrentEvent += MergeThreadData();
   //Edep
   if (mIsEdepImageEnabled) mEdepImage.SaveData(mCurrentEvent+1);
   //Dose
@@ -429,6 +457,17 @@ void GateDoseActor::SaveData() {
     mLastHitEventImage.Fill(-1); // reset
   }
 
+  if (mTestFlag && mIsStoppingPowerRatioTableEnabled &&
+      (mIsDoseToWaterImageEnabled || mIsDoseToOtherMaterialImageEnabled)) {
+    GateMessage("Actor", 0, "[DoseActor] " << GetObjectName()
+                << " max relative deviation of tabulated stopping power ratio = "
+                << mStoppingPowerRatioMaxDeviation
+                << " (tolerance " << mStoppingPowerRatioTolerance << ")" << Gateendl);
+    if (mStoppingPowerRatioMaxDeviation > mStoppingPowerRatioTolerance) {
+      GateWarning("Tabulated stopping power ratio exceeds the tolerance, use a smaller 'setStoppingPowerRatioTolerance'.");
+    }
+  }
+
   if (mIsNumberOfHitsImageEnabled) {
     G4String f = mNbOfHitsFilename;
     if (!mOverWriteFilesFlag) {
@@ -496,6 +535,111 @@ void GateDoseActor::BeginOfRunAction(const G4Run * r) {
   GateDebugMessage("Actor", 3, "GateDoseActor -- Begin of Run\n");
   mDose2WaterWarningFlag = true;
   // ResetData(); // Do no reset here !! (when multiple run);
+
+  if (mIsDoseToWaterImageEnabled || mIsDoseToOtherMaterialImageEnabled)
+    BuildStoppingPowerRatioTables();
+  AllocateThreadData();
+}
+//-----------------------------------------------------------------------------
+
+
+#ifdef GATE_USE_MT
+//-----------------------------------------------------------------------------
+void GateDoseActor::AllocateThreadBuffers(int nbOfThreads) {
+  const int nbOfValues = mImage.GetNumberOfValues();
+  mThreadHits.resize(nbOfThreads);
+  for(auto & t:mThreadHits) {
+    t.mLastHitEvent.assign(mIsLastHitEventImageEnabled ? nbOfValues:0, -1);
+    t.mNumberOfHits.assign(mIsNumberOfHitsImageEnabled ? nbOfValues:0, 0);
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateDoseActor::MergeThreadBuffers() {
+  for(auto & t:mThreadHits) {
+    for(size_t i=0; i<t.mNumberOfHits.size(); i++) {
+      mNumberOfHitsImage.AddValue(i, t.mNumberOfHits[i]);
+      t.mNumberOfHits[i] = 0;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Stopping power ratio tables are built for the materials of the
+// attached volume and the most common charged particles. Other
+// (particle, material) pairs are added on first use during tracking.
+// Tables are rebuilt at each run because cuts or materials may change.
+void GateDoseActor::BuildStoppingPowerRatioTables() {
+  if (mIsDoseToOtherMaterialImageEnabled) {
+    // check if the material has already been created in the simulation
+    pOtherMaterial = G4Material::GetMaterial(mOtherMaterial, false);
+    if (!pOtherMaterial) {
+      //FIXME
+      //CREATE THE MISSING MATERIAL (look into the Gate db)
+      GateError("Material not defined - abort simulation");
+    }
+  }
+  if (!mIsStoppingPowerRatioTableEnabled) return;
+
+  // List the materials of the scored volume
+  std::vector<G4Material*> materials;
+  GateVImageVolume * imageVolume = dynamic_cast<GateVImageVolume*>(mVolume);
+  if (imageVolume) imageVolume->BuildLabelToG4MaterialVector(materials);
+  std::vector<G4LogicalVolume*> lvs;
+  lvs.push_back(mVolume->GetLogicalVolume());
+  while (!lvs.empty()) {
+    G4LogicalVolume * lv = lvs.back();
+    lvs.pop_back();
+    if (lv->GetMaterial()) materials.push_back(lv->GetMaterial());
+    for(size_t i=0; i<lv->GetNoDaughters(); i++)
+      lvs.push_back(lv->GetDaughter(i)->GetLogicalVolume());
+  }
+  std::sort(materials.begin(), materials.end());
+  materials.erase(std::unique(materials.begin(), materials.end()), materials.end());
+
+  std::vector<const G4ParticleDefinition*> particles;
+  particles.push_back(G4Electron::Electron());
+  particles.push_back(G4Positron::Positron());
+  particles.push_back(G4Proton::Proton());
+  particles.push_back(G4Deuteron::Deuteron());
+
+  if (mIsDoseToWaterImageEnabled) {
+    mDoseToWaterRatioTable.Clear();
+    mDoseToWaterRatioTable.SetReferenceMaterial(G4NistManager::Instance()->FindOrBuildMaterial("G4_WATER"));
+    mDoseToWaterRatioTable.SetTolerance(mStoppingPowerRatioTolerance);
+    mDoseToWaterRatioTable.Build(particles, materials);
+  }
+  if (mIsDoseToOtherMaterialImageEnabled) {
+    mDoseToOtherMaterialRatioTable.Clear();
+    mDoseToOtherMaterialRatioTable.SetReferenceMaterial(pOtherMaterial);
+    mDoseToOtherMaterialRatioTable.SetTolerance(mStoppingPowerRatioTolerance);
+    mDoseToOtherMaterialRatioTable.Build(particles, materials);
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+double GateDoseActor::GetStoppingPowerRatio(GateStoppingPowerRatioTable & table,
+                                            const G4ParticleDefinition * p,
+                                            const G4Material * m,
+                                            double energy) {
+  if (!mIsStoppingPowerRatioTableEnabled) return table.ComputeRatio(p, m, energy);
+  const double ratio = table.GetRatio(p, m, energy);
+  if (mTestFlag) {
+    // Validation: compare with the exact computation
+    const double exact = table.ComputeRatio(p, m, energy);
+    if (exact != 0.0) {
+      const double d = fabs(ratio-exact)/exact;
+      if (d > mStoppingPowerRatioMaxDeviation) mStoppingPowerRatioMaxDeviation = d;
+    }
+  }
+  return ratio;
 }
 //-----------------------------------------------------------------------------
 
@@ -504,7 +648,7 @@ void GateDoseActor::BeginOfRunAction(const G4Run * r) {
 // Callback at each event
 void GateDoseActor::BeginOfEventAction(const G4Event * e) {
   GateVActor::BeginOfEventAction(e);
-  mCurrentEvent++;
+  CountEvent(mCurrentEvent);
   GateDebugMessage("Actor", 3, "GateDoseActor -- Begin of Event: "<< mCurrentEvent << Gateendl);
 }
 //-----------------------------------------------------------------------------
@@ -513,8 +657,9 @@ void GateDoseActor::BeginOfEventAction(const G4Event * e) {
 //-----------------------------------------------------------------------------
 void GateDoseActor::UserPreTrackActionInVoxel(const int /*index*/, const G4Track* track)
 {
-  if(track->GetDefinition() == G4Gamma::Gamma()) { mStepHitType = PostStepHitType; }
-  else { mStepHitType = mUserStepHitType; }
+  StepHitType & type = GetCurrentStepHitType();
+  if(track->GetDefinition() == G4Gamma::Gamma()) { type = PostStepHitType; }
+  else { type = mUserStepHitType; }
 }
 //-----------------------------------------------------------------------------
 
@@ -553,6 +698,14 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
   // compute sameEvent
   // sameEvent is false the first time some energy is deposited for each primary particle
   bool sameEvent=true;
+#ifdef GATE_USE_MT
+  const ThreadState & threadState = *GetThreadState();
+  ThreadHits & threadHits = mThreadHits[GateMTHelper::GetThreadIndex()];
+  if (mIsLastHitEventImageEnabled && threadState.mCurrentEvent != threadHits.mLastHitEvent[index]) {
+    sameEvent = false;
+    threadHits.mLastHitEvent[index] = threadState.mCurrentEvent;
+  }
+#else
   if (mIsLastHitEventImageEnabled) {
     GateDebugMessage("Actor", 2,  "GateDoseActor -- UserSteppingActionInVoxel: Last event in index = " << mLastHitEventImage.GetValue(index) << Gateendl);
     if (mCurrentEvent != mLastHitEventImage.GetValue(index)) {
@@ -560,6 +713,7 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
       mLastHitEventImage.SetValue(index, mCurrentEvent);
     }
   }
+#endif
 
   //---------------------------------------------------------------------------------
   // Volume weighting
@@ -680,28 +834,16 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
   double doseToWater = 0;
   if (mIsDoseToWaterImageEnabled)
     {
-      double cut =  DBL_MAX;
-      // dedx
-      double DEDX=0, DEDX_Water=0;
-      //other material
-      static G4Material * water = G4NistManager::Instance()->FindOrBuildMaterial("G4_WATER");
-
-
       //Accounting for particles with dedx=0; i.e. gamma and neutrons
       //For gamma we consider the dedx of electrons instead - testing with 1.3 MeV photon beam or 150 MeV protons or 1500 MeV carbon ion beam showed that the error induced is 0
       //		when comparing dose and dosetowater in the material G4_WATER
       //For neutrons the dose is neglected - testing with 1.3 MeV photon beam or 150 MeV protons or 1500 MeV carbon ion beam showed that the error induced is < 0.01%
       //		when comparing dose and dosetowater in the material G4_WATER (we are systematically missing a little bit of dose of course with this solution)
       if (p == G4Gamma::Gamma())  p = G4Electron::Electron();
-      DEDX = emcalc->ComputeTotalDEDX(energy, p, current_material, cut);
-      DEDX_Water = emcalc->ComputeTotalDEDX(energy, p, water, cut);
-      //In current implementation, dose deposited directly by neutrons is neglected - the below lines prevent "inf or NaN"
-      if (DEDX==0 || DEDX_Water==0){
-      	doseToWater=0;
-      }
-      else{
-        doseToWater = dose*(DEDX_Water/1.0)/(DEDX/(density*e_SI));
-      }
+      // DEDX_Water/DEDX, from the precomputed table
+      //In current implementation, dose deposited directly by neutrons is neglected - the ratio is 0 to prevent "inf or NaN"
+      const double ratio = GetStoppingPowerRatio(mDoseToWaterRatioTable, p, current_material, energy);
+      doseToWater = dose*ratio*(density*e_SI);
 
 //G4cout<<"Dose To Water " << doseToWater << G4endl;
 
@@ -744,27 +886,8 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
   double DoseToOtherMaterial = 0;
   if (mIsDoseToOtherMaterialImageEnabled){
     double cut = DBL_MAX;
-    G4String material;
-    const G4MaterialTable* matTbl = G4Material::GetMaterialTable();
-    bool IsMaterialInMDB = false;
-    double Density_OtherMaterial = 1;
-
-    // check if the material has already been created in the simulation
-    for(size_t k=0; k < G4Material::GetNumberOfMaterials(); k++){
-      material = (*matTbl)[k]->GetName();
-      if(material==mOtherMaterial){
-        IsMaterialInMDB=true;
-        Density_OtherMaterial = (*matTbl)[k]->GetDensity();
-        k=G4Material::GetNumberOfMaterials();
-      }
-    }
-    // create the material if not already created in the simulation
-    if(!IsMaterialInMDB){
-      //FIXME
-      //CREATE THE MISSING MATERIAL (look into the Gate db)
-      GateError("Material not defined - abort simulation");
-    }
-
+    // pOtherMaterial is looked up once at BeginOfRunAction
+    double Density_OtherMaterial = pOtherMaterial->GetDensity();
 
     //deterimine density ratio for dose to other material
     //in case geometric and scoring voxels are not the same
@@ -776,15 +899,11 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
     //current material
     double current_density = density;
 
-    //other material
-    static G4Material* OtherMaterial = G4Material::GetMaterial(mOtherMaterial,true);
-
-
     if(mTestFlag){
       // DISPLAY parameters of particles having DEDX=0
       // Mainly gamma and neutron
       DEDX = emcalc->ComputeTotalDEDX(energy, p, current_material, cut);
-      DEDX_OtherMaterial = emcalc->ComputeTotalDEDX(energy, p, OtherMaterial, cut);
+      DEDX_OtherMaterial = emcalc->ComputeTotalDEDX(energy, p, pOtherMaterial, cut);
       if(DEDX==0){
         G4cout<<"Particle : "<<p->GetParticleName()<<"\t energy : "<<energy<<"\t current material : "<<current_material->GetName()<<"\t dedx : "<<DEDX<<"\t density : "<<current_density*e_SI<<"\t dose : "<<dose<<G4endl;
         G4cout<<"Particle : "<<p->GetParticleName()<<"\t energy : "<<energy<<"\t other material : "<<mOtherMaterial<<"\t dedx other : "<<DEDX_OtherMaterial<<"\t density other : "<<Density_OtherMaterial*e_SI<<"\t dose to other: "<<DoseToOtherMaterial<<G4endl;
@@ -804,15 +923,10 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
     //For neutrons the dose is neglected - testing with 1.3 MeV photon beam or 150 MeV protons or 1500 MeV carbon ion beam showed that the error induced is < 0.01%
     //		we are systematically missing a little bit of dose of course with this solution
     if (p == G4Gamma::Gamma())  p = G4Electron::Electron();
-    DEDX = emcalc->ComputeTotalDEDX(energy, p, current_material, cut);
-    DEDX_OtherMaterial = emcalc->ComputeTotalDEDX(energy, p, OtherMaterial, cut);
-    //In current implementation, dose deposited directly by neutrons is neglected - the below lines prevent "inf or NaN"
-    if (DEDX==0 || DEDX_OtherMaterial==0){
-      DoseToOtherMaterial=0;
-    }
-    else{
-      DoseToOtherMaterial = dose*(DEDX_OtherMaterial/(Density_OtherMaterial*e_SI))/(DEDX/(current_density*e_SI));
-    }
+    // DEDX_OtherMaterial/DEDX, from the precomputed table
+    //In current implementation, dose deposited directly by neutrons is neglected - the ratio is 0 to prevent "inf or NaN"
+    const double ratio = GetStoppingPowerRatio(mDoseToOtherMaterialRatioTable, p, current_material, energy);
+    DoseToOtherMaterial = dose*ratio*(current_density*e_SI)/(Density_OtherMaterial*e_SI);
 
     GateDebugMessage("Actor", 2,  "GateDoseActor -- UserSteppingActionInVoxel:\tdose to OtherMaterial = "
                      << G4BestUnit(DoseToOtherMaterial, "Dose to OtherMaterial")
@@ -868,7 +982,11 @@ void GateDoseActor::UserSteppingActionInVoxel(const int index, const G4Step* ste
       else mDoseToOtherMaterialImage.AddValue(index, DoseToOtherMaterial);
     }
 
+#ifdef GATE_USE_MT
+  if (mIsNumberOfHitsImageEnabled) threadHits.mNumberOfHits[index] += (int)weight;
+#else
   if (mIsNumberOfHitsImageEnabled) mNumberOfHitsImage.AddValue(index, weight);
+#endif
 
   //Dose regions
   if (mDoseByRegionsFlag) {
@@ -42,11 +42,15 @@ GateDoseActorMessenger::GateDoseActorMessenger(GateDoseActor* sensor)
   pEnableDoseToOtherMaterialNormToIntegralCmd= 0;
   pEnableDoseToOtherMaterialSquaredCmd= 0;
   pEnableDoseToOtherMaterialUncertaintyCmd= 0;
+  pSetOtherMaterialCmd= 0;
+  pEnableStoppingPowerRatioTableCmd= 0;
+  pSetStoppingPowerRatioToleranceCmd= 0;
   //Others
   pEnableNumberOfHitsCmd= 0;
   pSetDoseAlgorithmCmd= 0;
   pImportMassImageCmd= 0;
   pExportMassImageCmd= 0;
+  pMassCacheDirectoryCmd= 0;
   pVolumeFilterCmd= 0;
   pMaterialFilterCmd= 0;
   pTestFlagCmd= 0;
@@ -88,11 +92,14 @@ GateDoseActorMessenger::~GateDoseActorMessenger()
   if(pEnableDoseToOtherMaterialSquaredCmd) delete pEnableDoseToOtherMaterialSquaredCmd;
   if(pEnableDoseToOtherMaterialUncertaintyCmd) delete pEnableDoseToOtherMaterialUncertaintyCmd;
   if(pSetOtherMaterialCmd) delete pSetOtherMaterialCmd;
+  if(pEnableStoppingPowerRatioTableCmd) delete pEnableStoppingPowerRatioTableCmd;
+  if(pSetStoppingPowerRatioToleranceCmd) delete pSetStoppingPowerRatioToleranceCmd;
   //Others
   if(pEnableNumberOfHitsCmd) delete pEnableNumberOfHitsCmd;
   if(pSetDoseAlgorithmCmd) delete pSetDoseAlgorithmCmd;
   if(pImportMassImageCmd) delete pImportMassImageCmd;
   if(pExportMassImageCmd) delete pExportMassImageCmd;
+  if(pMassCacheDirectoryCmd) delete pMassCacheDirectoryCmd;
 
   if(pVolumeFilterCmd) delete pVolumeFilterCmd;
   if(pMaterialFilterCmd) delete pMaterialFilterCmd;
@@ -206,6 +213,18 @@ void GateDoseActorMessenger::BuildCommands(G4String base)
   guid = G4String("Set Other Material Name");
   pSetOtherMaterialCmd->SetGuidance(guid);
 
+  //Stopping power ratio tables
+  n = base+"/enableStoppingPowerRatioTable";
+  pEnableStoppingPowerRatioTableCmd = new G4UIcmdWithABool(n, this);
+  guid = G4String("Use precomputed stopping power ratio tables for dose to water/other material (default false)");
+  pEnableStoppingPowerRatioTableCmd->SetGuidance(guid);
+  n = base+"/setStoppingPowerRatioTolerance";
+  pSetStoppingPowerRatioToleranceCmd = new G4UIcmdWithADouble(n, this);
+  guid = G4String("Set the relative interpolation tolerance of the stopping power ratio tables (default 1e-4)");
+  pSetStoppingPowerRatioToleranceCmd->SetGuidance(guid);
+  pSetStoppingPowerRatioToleranceCmd->SetParameterName("Tolerance",false);
+  pSetStoppingPowerRatioToleranceCmd->SetRange("Tolerance>0");
+
   //Others
   n = base+"/enableNumberOfHits";
   pEnableNumberOfHitsCmd = new G4UIcmdWithABool(n, this);
@@ -230,6 +249,12 @@ void GateDoseActorMessenger::BuildCommands(G4String base)
   pExportMassImageCmd->SetGuidance(guid);
   pExportMassImageCmd->SetParameterName("Export mass image",false);
 
+  n = base+"/setMassCacheDirectory";
+  pMassCacheDirectoryCmd = new G4UIcmdWithAString(n, this);
+  guid = G4String("Directory where the computed dosel masses are cached (reused when the geometry and the dose grid are unchanged)");
+  pMassCacheDirectoryCmd->SetGuidance(guid);
+  pMassCacheDirectoryCmd->SetParameterName("Mass cache directory",false);
+
 
   n = base+"/setVolumeFilter";
   pVolumeFilterCmd = new G4UIcmdWithAString(n, this);
@@ -300,11 +325,14 @@ void GateDoseActorMessenger::SetNewValue(G4UIcommand* cmd, G4String newValue)
   if (cmd == pEnableDoseToOtherMaterialNormToMaxCmd) pDoseActor->EnableDoseToOtherMaterialNormalisationToMax(pEnableDoseToOtherMaterialNormToMaxCmd->GetNewBoolValue(newValue));
   if (cmd == pEnableDoseToOtherMaterialNormToIntegralCmd) pDoseActor->EnableDoseToOtherMaterialNormalisationToIntegral(pEnableDoseToOtherMaterialNormToIntegralCmd->GetNewBoolValue(newValue));
   if (cmd == pSetOtherMaterialCmd) pDoseActor->SetOtherMaterial(newValue);
+  if (cmd == pEnableStoppingPowerRatioTableCmd) pDoseActor->EnableStoppingPowerRatioTable(pEnableStoppingPowerRatioTableCmd->GetNewBoolValue(newValue));
+  if (cmd == pSetStoppingPowerRatioToleranceCmd) pDoseActor->SetStoppingPowerRatioTolerance(pSetStoppingPowerRatioToleranceCmd->GetNewDoubleValue(newValue));
   //Others
   if (cmd == pEnableNumberOfHitsCmd) pDoseActor->EnableNumberOfHitsImage(pEnableNumberOfHitsCmd->GetNewBoolValue(newValue));
   if (cmd == pSetDoseAlgorithmCmd) pDoseActor->SetDoseAlgorithmType(newValue);
   if (cmd == pImportMassImageCmd) pDoseActor->ImportMassImage(newValue);
   if (cmd == pExportMassImageCmd) pDoseActor->ExportMassImage(newValue);
+  if (cmd == pMassCacheDirectoryCmd) pDoseActor->SetMassCacheDirectory(newValue);
   if (cmd == pVolumeFilterCmd) pDoseActor->VolumeFilter(newValue);
   if (cmd == pMaterialFilterCmd) pDoseActor->MaterialFilter(newValue);
   if (cmd ==pTestFlagCmd) pDoseActor->setTestFlag(pTestFlagCmd->GetNewBoolValue(newValue));
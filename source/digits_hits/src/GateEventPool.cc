@@ -0,0 +1,71 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateEventPool.hh"
+
+#include "G4Exception.hh"
+
+#include <cstdlib>
+#include <new>
+
+//-----------------------------------------------------------------------------
+static size_t AlignSize(size_t size)
+{
+  const size_t alignment = 16;
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateEventPool::GateEventPool(size_t objectSize)
+  : mSlotSize(AlignSize(objectSize)), mFirstSlot(AlignSize(sizeof(Chunk))),
+    mCurrent(0), mEnd(0)
+{
+  if (mFirstSlot + mSlotSize > ChunkSize)
+    G4Exception("GateEventPool::GateEventPool", "ObjectTooLarge", FatalException,
+                "The objects do not fit in a chunk of the pool.");
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateEventPool::NewChunk()
+{
+  Chunk * chunk = 0;
+  if (!mFree.empty()) {
+    chunk = mFree.back();
+    mFree.pop_back();
+  }
+  else {
+    // aligned on its size, so that Free() finds the chunk of an object
+    void * memory = 0;
+    if (posix_memalign(&memory, ChunkSize, ChunkSize) != 0) throw std::bad_alloc();
+    chunk = new (memory) Chunk;
+    chunk->nAlive.store(0, std::memory_order_relaxed);
+    mChunks.push_back(chunk);
+  }
+  chunk->next = reinterpret_cast<char *>(chunk) + mFirstSlot;
+  mCurrent = chunk;
+  mEnd = reinterpret_cast<char *>(chunk) + ChunkSize;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateEventPool::Reset()
+{
+  // only the owner allocates in its chunks: a chunk without live objects
+  // stays so, and can be rewound
+  mFree.clear();
+  for (size_t i = 0; i < mChunks.size(); i++)
+    if (mChunks[i]->nAlive.load(std::memory_order_acquire) == 0) mFree.push_back(mChunks[i]);
+  mCurrent = 0;
+  mEnd = 0;
+}
+//-----------------------------------------------------------------------------
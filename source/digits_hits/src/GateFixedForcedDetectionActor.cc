@@ -757,7 +757,7 @@ void GateFixedForcedDetectionActor::UserSteppingAction(const GateVVolume * v, co
           && step->GetTrack()->GetDefinition()->GetParticleName() == "gamma")
         {
 
-        ForceDetectionOfInteraction(GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
+        ForceDetectionOfInteraction(G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
                                     G4String("IsotropicPrimary"),
                                     step->GetPreStepPoint()->GetPosition(),
                                     step->GetPreStepPoint()->GetMomentumDirection(),
@@ -799,7 +799,7 @@ void GateFixedForcedDetectionActor::UserSteppingAction(const GateVVolume * v, co
         if (nameSecondary == G4String("gamma"))
           {
 
-          ForceDetectionOfInteraction(GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
+          ForceDetectionOfInteraction(G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
                                       process->GetProcessName(),
                                       step->GetPostStepPoint()->GetPosition(),
                                       (*list)[i]->GetMomentumDirection(),
@@ -815,7 +815,7 @@ void GateFixedForcedDetectionActor::UserSteppingAction(const GateVVolume * v, co
       }
     else
       {
-      ForceDetectionOfInteraction(GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
+      ForceDetectionOfInteraction(G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID(),
                                   process->GetProcessName(),
                                   step->GetPostStepPoint()->GetPosition(),
                                   step->GetPreStepPoint()->GetMomentumDirection(),
@@ -953,8 +953,12 @@ void GateFixedForcedDetectionActor::ConnectARF(const unsigned int & numberOfThre
 {
   GateARFSD* arfSD = GateDetectorConstruction::GetGateDetectorConstruction()->GetARFSD();
   arfSD->SetCopyNo(0);
+  /* the photons of all the threads are projected at once */
+  std::vector<G4ThreeVector> positions;
+  std::vector<G4ThreeVector> directions;
+  std::vector<G4double> energies;
+  std::vector<G4double> weights;
   G4ThreeVector position;
-  bool addEmToArfCount = false;
   for (unsigned int thread = 0; thread < numberOfThreads; thread++)
     {
     for (unsigned int photonId = 0; photonId < photonList[thread].size(); photonId++)
@@ -964,24 +968,15 @@ void GateFixedForcedDetectionActor::ConnectARF(const unsigned int & numberOfThre
       position[2] = photonList[thread][photonId].position[2] + mInteractionPosition[2];
       position = m_SourceToDetector.TransformAxis(position);
       position[0] = arfSD->GetDepth();
-
-      if (thread == 0 && photonId == 0 && newHead == ISOTROPICPRIMARY)
-        {
-        addEmToArfCount = true;
-        }
-      else
-        {
-        addEmToArfCount = false;
-        }
-      arfSD->ComputeProjectionSet(position,
-                                  m_WorldToDetector.TransformAxis(photonList[thread][photonId].direction),
-                                  photonList[thread][photonId].energy,
-                                  photonList[thread][photonId].weight,
-                                  addEmToArfCount,
-                                  newHead + 1);
-
+      positions.push_back(position);
+      directions.push_back(m_WorldToDetector.TransformAxis(photonList[thread][photonId].direction));
+      energies.push_back(photonList[thread][photonId].energy);
+      weights.push_back(photonList[thread][photonId].weight);
       }
     }
+  /* the first photon of thread 0 counts the emission */
+  const bool addEmToArfCount = (newHead == ISOTROPICPRIMARY && numberOfThreads > 0 && photonList[0].size() > 0);
+  arfSD->ComputeProjectionSet(positions, directions, energies, weights, addEmToArfCount, newHead + 1);
 }
 
 template<ProcessType VProcess, class TProjectorType>
@@ -191,6 +191,8 @@ void GateImageWithStatistic::SetValue(const int index, double value) {
 //-----------------------------------------------------------------------------
 void GateImageWithStatistic::AddValue(const int index, double value) {
   GateDebugMessage("Actor", 2, "AddValue index=" << index << " value=" << value << Gateendl);
+  ThreadImages * t = GetThreadImages();
+  if (t) { t->mValue[index] += value; return; }
   mValueImage.AddValue(index, value);
 }
 //-----------------------------------------------------------------------------
@@ -199,6 +201,8 @@ void GateImageWithStatistic::AddValue(const int index, double value) {
 //-----------------------------------------------------------------------------
 void GateImageWithStatistic::AddTempValue(const int index, double value) {
   GateDebugMessage("Actor", 2, "AddTempValue index=" << index << " value=" << value << Gateendl);
+  ThreadImages * t = GetThreadImages();
+  if (t) { t->mTemp[index] += value; return; }
   mTempImage.AddValue(index, value);
 }
 //-----------------------------------------------------------------------------
@@ -208,6 +212,15 @@ void GateImageWithStatistic::AddTempValue(const int index, double value) {
 void GateImageWithStatistic::AddValueAndUpdate(const int index, double value) {
 
   GateDebugMessageInc("Actor", 2, "AddValue and update -- start: "<<mTempImage.GetSize() << Gateendl);
+  ThreadImages * t = GetThreadImages();
+  if (t) {
+    double tmp = t->mTemp[index];
+    t->mValue[index] += tmp;
+    if (mIsSquaredImageEnabled || mIsUncertaintyImageEnabled) t->mSquared[index] += tmp*tmp;
+    t->mTemp[index] = value;
+    GateDebugMessageDec("Actor", 2, "AddValue and update -- end"<< Gateendl);
+    return;
+  }
   double tmp = mTempImage.GetValue(index);
   mValueImage.AddValue(index, tmp);
   if (mIsSquaredImageEnabled || mIsUncertaintyImageEnabled) mSquaredImage.AddValue(index, tmp*tmp);
@@ -389,4 +402,44 @@ void GateImageWithStatistic::UpdateUncertaintyImage(int numberOfEvents)
 }
 //-----------------------------------------------------------------------------
 
+
+//-----------------------------------------------------------------------------
+void GateImageWithStatistic::AllocateThreadImages(int nbOfThreads) {
+  const bool withTemp = mIsSquaredImageEnabled || mIsUncertaintyImageEnabled;
+  const size_t n = mValueImage.GetNumberOfValues();
+  mThreadImages.resize(nbOfThreads);
+  for(auto & t:mThreadImages) {
+    t.mValue.assign(n, 0.0);
+    t.mSquared.assign(withTemp ? n:0, 0.0);
+    t.mTemp.assign(withTemp ? n:0, 0.0);
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateImageWithStatistic::MergeThreadImages() {
+  const bool withTemp = mIsSquaredImageEnabled || mIsUncertaintyImageEnabled;
+  for(auto & t:mThreadImages) {
+    // Flush the last event of each voxel (as UpdateImage and
+    // UpdateSquaredImage do for the sequential case)
+    GateImageDouble::iterator pi = mValueImage.begin();
+    for(size_t i=0; i<t.mValue.size(); i++, ++pi) {
+      double v = t.mValue[i];
+      if (withTemp) v += t.mTemp[i];
+      *pi += v;
+      t.mValue[i] = 0.0;
+    }
+    if (withTemp) {
+      GateImageDouble::iterator ps = mSquaredImage.begin();
+      for(size_t i=0; i<t.mTemp.size(); i++, ++ps) {
+        *ps += t.mSquared[i] + t.mTemp[i]*t.mTemp[i];
+        t.mSquared[i] = 0.0;
+        t.mTemp[i] = 0.0;
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+
 #endif /* end #define GATEIMAGEWITHSTATISTIC_CC */
@@ -0,0 +1,90 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateInternedString.hh"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef GATE_USE_MT
+#include <mutex>
+#endif
+
+namespace {
+
+  struct GateInternedStringTable {
+    std::unordered_map<std::string, const G4String*> mByName;
+    std::unordered_set<const G4String*> mAddresses;
+
+    const G4String * Find(const G4String & s) const {
+      if (mAddresses.count(&s)) return &s;
+      std::unordered_map<std::string, const G4String*>::const_iterator it = mByName.find(s);
+      return (it == mByName.end()) ? 0 : it->second;
+    }
+    void Insert(const G4String * s) {
+      mByName[*s] = s;
+      mAddresses.insert(s);
+    }
+  };
+
+  // Strings are allocated once and never deleted
+  GateInternedStringTable & GetGlobalTable()
+  {
+    static GateInternedStringTable table;
+    return table;
+  }
+
+#ifdef GATE_USE_MT
+  std::mutex & GetGlobalTableMutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+  G4ThreadLocal GateInternedStringTable * tLocalTable = 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+const G4String * GateInternedString::Intern(const G4String & s)
+{
+#ifdef GATE_USE_MT
+  if (!tLocalTable) tLocalTable = new GateInternedStringTable;
+  const G4String * name = tLocalTable->Find(s);
+  if (name) return name;
+  {
+    std::lock_guard<std::mutex> lock(GetGlobalTableMutex());
+    GateInternedStringTable & table = GetGlobalTable();
+    name = table.Find(s);
+    if (!name) {
+      name = new G4String(s);
+      table.Insert(name);
+    }
+  }
+  tLocalTable->Insert(name);
+  return name;
+#else
+  GateInternedStringTable & table = GetGlobalTable();
+  const G4String * name = table.Find(s);
+  if (!name) {
+    name = new G4String(s);
+    table.Insert(name);
+  }
+  return name;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+const G4String * GateInternedString::Empty()
+{
+  static const G4String * empty = Intern(G4String(""));
+  return empty;
+}
+//-----------------------------------------------------------------------------
@@ -5,7 +5,13 @@
 #include "GateMuTables.hh"
 #include "GateMuDatabase.hh"
 #include "GateMiscFunctions.hh"
+#include "GateCacheFile.hh"
+#include "GateParallelFor.hh"
 #include "GateConfiguration.h"
+#include "G4Version.hh"
+#include <cstring>
+#include <iomanip>
+#include <set>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -19,21 +25,28 @@ using std::string;
 GateMaterialMuHandler *GateMaterialMuHandler::singleton_MaterialMuHandler = 0;
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+namespace {
+  const char theMuTableMagic[8] = "GateMT1";
+
+  // Last couple asked by each thread, and its table
+  thread_local const G4MaterialCutsCouple *theLastCouple = 0;
+  thread_local GateMuTable *theLastMuTable = 0;
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 GateMaterialMuHandler::GateMaterialMuHandler()
 {
-  mIsInitialized = false;
   mElementNumber = -1;
   mElementsTable = 0;
   mDatabaseName = "EPDL";
+  mCacheDirectory = "";
   mEnergyMin = 250. * eV;
   mEnergyMax = 1. * MeV;
   mEnergyNumber = 40;
   mAtomicShellEnergyMin = 1. * keV;
   mPrecision = 0.01;
-
-  mLastCouple = 0;
-  mLastMuTable = 0;
 }
 //-----------------------------------------------------------------------------
 
@@ -45,62 +58,57 @@ GateMaterialMuHandler::~GateMaterialMuHandler()
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-void GateMaterialMuHandler::CheckLastCall(const G4MaterialCutsCouple* couple)
+GateMuTable *GateMaterialMuHandler::CheckLastCall(const G4MaterialCutsCouple* couple)
 {
-  if(!mIsInitialized) { Initialize(); }
+  std::call_once(mInitializeFlag, &GateMaterialMuHandler::Initialize, this);
 
-  if(couple != mLastCouple) {
-    mLastCouple = couple;
-    mLastMuTable = mCoupleTable[mLastCouple];
+  if(couple != theLastCouple) {
+    theLastMuTable = GetCoupleTable(couple);
+    theLastCouple = couple;
   }
+  return theLastMuTable;
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 double GateMaterialMuHandler::GetDensity(const G4MaterialCutsCouple* couple)
 {
-  CheckLastCall(couple);
-  return mLastMuTable->GetDensity();
+  return CheckLastCall(couple)->GetDensity();
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 double GateMaterialMuHandler::GetMuEnOverRho(const G4MaterialCutsCouple* couple, double energy)
 {
-  CheckLastCall(couple);
-  return mLastMuTable->GetMuEnOverRho(energy);
+  return CheckLastCall(couple)->GetMuEnOverRho(energy);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 double GateMaterialMuHandler::GetMuEn(const G4MaterialCutsCouple* couple, double energy)
 {
-  CheckLastCall(couple);
-  return mLastMuTable->GetMuEn(energy);
+  return CheckLastCall(couple)->GetMuEn(energy);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 double GateMaterialMuHandler::GetMuOverRho(const G4MaterialCutsCouple* couple, double energy)
 {
-  CheckLastCall(couple);
-  return mLastMuTable->GetMuOverRho(energy);
+  return CheckLastCall(couple)->GetMuOverRho(energy);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 double GateMaterialMuHandler::GetMu(const G4MaterialCutsCouple* couple, double energy)
 {
-  CheckLastCall(couple);
-  return mLastMuTable->GetMu(energy);
+  return CheckLastCall(couple)->GetMu(energy);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 GateMuTable *GateMaterialMuHandler::GetMuTable(const G4MaterialCutsCouple *couple)
 {
-  CheckLastCall(couple);
-  return mLastMuTable;
+  return CheckLastCall(couple);
 }
 //-----------------------------------------------------------------------------
 
@@ -113,58 +121,113 @@ inline double interpolation(double Xa,double Xb,double Ya,double Yb,double x){
 //-----------------------------------------------------------------------------
 void GateMaterialMuHandler::Initialize()
 {
-  if(mDatabaseName == "simulated")
+  if(mDatabaseName == "NIST" || mDatabaseName == "EPDL")
     {
-      SimulateMaterialTable();
+      InitElementTable();
     }
-  else if(mDatabaseName == "NIST" || mDatabaseName == "EPDL")
+  else if(mDatabaseName != "simulated")
     {
-      InitElementTable();
+      GateError("GateMaterialMuHandler -- mu/muen database option '" << mDatabaseName << "' doesn't exist. Available database are 'NIST', 'EPDL' and 'user'");
+    }
 
-      G4ProductionCutsTable *productionCutList = G4ProductionCutsTable::GetProductionCutsTable();
-      map<const G4MaterialCutsCouple *, GateMuTable *>::iterator it;
+  // The couples whose table is in the cache get an empty entry (table
+  // read at the first request), the tables of the others are built now,
+  // once for all the couples of the same key
+  G4ProductionCutsTable *productionCutList = G4ProductionCutsTable::GetProductionCutsTable();
+  map<const G4MaterialCutsCouple *, unsigned long long> coupleKeys;
+  std::vector<const G4MaterialCutsCouple *> couplesToBuild;
+  std::set<unsigned long long> keysToBuild;
 
-      for(unsigned int m=0; m<productionCutList->GetTableSize(); m++)
+  for(unsigned int m=0; m<productionCutList->GetTableSize(); m++)
+    {
+      const G4MaterialCutsCouple *couple = productionCutList->GetMaterialCutsCouple(m);
+      if(mCoupleTable.find(couple) != mCoupleTable.end()) { continue; }
+
+      unsigned long long key = ComputeTableKey(couple);
+      if(mKeyTable.find(key) == mKeyTable.end() && IsCached(key))
         {
-          const G4MaterialCutsCouple *couple = productionCutList->GetMaterialCutsCouple(m);
-          it = mCoupleTable.find(couple);
-          if(it == mCoupleTable.end())
-            {
-              const G4Material *material = couple->GetMaterial();
-              bool materialNotExist = true;
-              map<const G4MaterialCutsCouple *, GateMuTable *>::iterator it2 = mCoupleTable.begin();
+          mCoupleTable[couple] = 0;
+          continue;
+        }
+      coupleKeys[couple] = key;
+      if(mKeyTable.find(key) == mKeyTable.end() && keysToBuild.insert(key).second) { couplesToBuild.push_back(couple); }
+    }
 
-              while(it2 != mCoupleTable.end())
-                {
-                  if(it2->first->GetMaterial() == material)
-                    {
-                      mCoupleTable.insert(std::pair<const G4MaterialCutsCouple *, GateMuTable *>(couple,it2->second));
-                      materialNotExist = false;
-                      break;
-                    }
-                  it2++;
-                }
+  std::vector<GateMuTable *> tables(couplesToBuild.size(), 0);
+  if(mDatabaseName == "simulated")
+    {
+      // The physics models share the random engine and their particle
+      // change: the simulated tables are built one after the other
+      for(size_t i=0; i<couplesToBuild.size(); i++)
+        tables[i] = SimulateCouple(couplesToBuild[i]);
+    }
+  else if(!couplesToBuild.empty())
+    {
+      // Mixtures of the element tables, independent of each other
+      for(size_t i=0; i<couplesToBuild.size(); i++)
+        GateMessage("Physic",1,"Construction of mu/mu_en table for " << couplesToBuild[i]->GetMaterial()->GetName() << Gateendl);
 
-              if(materialNotExist) { ConstructMaterial(couple); }
-            }
-        }
+      GateParallel::For(couplesToBuild.size(), [this, &tables, &couplesToBuild](unsigned int, size_t i) {
+          tables[i] = ConstructMaterial(couplesToBuild[i]);
+        });
+
+      for(size_t i=0; i<tables.size(); i++) { PrintTable(tables[i]); }
     }
-  else
+
+  for(size_t i=0; i<couplesToBuild.size(); i++)
     {
-      GateError("GateMaterialMuHandler -- mu/muen database option '" << mDatabaseName << "' doesn't exist. Available database are 'NIST', 'EPDL' and 'user'");
+      unsigned long long key = coupleKeys[couplesToBuild[i]];
+      mKeyTable[key] = tables[i];
+      WriteTable(key, tables[i]);
+    }
+  map<const G4MaterialCutsCouple *, unsigned long long>::iterator it;
+  for(it = coupleKeys.begin(); it != coupleKeys.end(); it++)
+    mCoupleTable[it->first] = mKeyTable[it->second];
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+GateMuTable *GateMaterialMuHandler::GetCoupleTable(const G4MaterialCutsCouple *couple)
+{
+  // Called on a change of couple only (CheckLastCall): the lookup is
+  // done under the lock, other threads may insert meanwhile
+  std::lock_guard<std::mutex> lock(mMutex);
+  GateMuTable *&table = mCoupleTable[couple];
+  if(table) { return table; }
+
+  // Table in the cache, or couple created after the initialization
+
+  unsigned long long key = ComputeTableKey(couple);
+  map<unsigned long long, GateMuTable *>::iterator itKey = mKeyTable.find(key);
+  if(itKey != mKeyTable.end())
+    {
+      table = itKey->second;
+      return table;
     }
 
-  mIsInitialized = true;
+  table = ReadTable(couple, key);
+  if(!table)
+    {
+      if(mDatabaseName == "simulated") { table = SimulateCouple(couple); }
+      else
+        {
+          GateMessage("Physic",1,"Construction of mu/mu_en table for " << couple->GetMaterial()->GetName() << Gateendl);
+          table = ConstructMaterial(couple);
+          PrintTable(table);
+        }
+      WriteTable(key, table);
+    }
+  mKeyTable[key] = table;
+  return table;
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-void GateMaterialMuHandler::ConstructMaterial(const G4MaterialCutsCouple *couple)
+GateMuTable *GateMaterialMuHandler::ConstructMaterial(const G4MaterialCutsCouple *couple)
 {
+  // Only reads the element tables: called by several threads (Initialize)
   const G4Material *material = couple->GetMaterial();
 
-  GateMessage("Physic",1,"Construction of mu/mu_en table for " << material->GetName() << Gateendl);
-
   int nb_e = 0;
   int nb_of_elements = material->GetNumberOfElements();
   for(int i = 0; i < nb_of_elements; i++)
@@ -249,16 +312,9 @@ void GateMaterialMuHandler::ConstructMaterial(const G4MaterialCutsCouple *couple
   }
 
   GateMuTable * table = new GateMuTable(couple, nb_e);
-
-  GateMessage("Physic",3," \n");
-  GateMessage("Physic",3," E(MeV)  mu(cm2/g)  muen(cm2/g)\n");
   for(int i = 0; i < nb_e; i++){
-    GateMessage("Physic",3," " << energies[i] << " " << Mu[i] << " " << MuEn[i] << " \n");
     table->PutValue(i, log(energies[i]), log(Mu[i]), log(MuEn[i]));
   }
-  GateMessage("Physic",3," \n");
-
-  mCoupleTable.insert(std::pair<const G4MaterialCutsCouple *, GateMuTable *>(couple,table));
 
   delete [] energies;
   delete [] index;
@@ -267,6 +323,20 @@ void GateMaterialMuHandler::ConstructMaterial(const G4MaterialCutsCouple *couple
   delete [] muen_tables;
   delete [] MuEn;
   delete [] Mu;
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateMaterialMuHandler::PrintTable(GateMuTable *table)
+{
+  GateMessage("Physic",3," \n");
+  GateMessage("Physic",3," E(MeV)  mu(cm2/g)  muen(cm2/g)\n");
+  for(int i = 0; i < table->GetSize(); i++){
+    GateMessage("Physic",3," " << exp(table->GetEnergies()[i]) << " " << exp(table->GetMuTable()[i]) << " " << exp(table->GetMuEnTable()[i]) << " \n");
+  }
+  GateMessage("Physic",3," \n");
 }
 //-----------------------------------------------------------------------------
 
@@ -308,7 +378,7 @@ void GateMaterialMuHandler::InitElementTable()
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-void GateMaterialMuHandler::SimulateMaterialTable()
+GateMuTable *GateMaterialMuHandler::SimulateCouple(const G4MaterialCutsCouple *couple)
 {
   // Get process list for gamma
   G4ProcessVector *processListForGamma = G4Gamma::Gamma()->GetProcessManager()->GetProcessList();
@@ -326,7 +396,6 @@ void GateMaterialMuHandler::SimulateMaterialTable()
   // Useful members for the loops
   // - cuts and materials
   G4ProductionCutsTable *productionCutList = G4ProductionCutsTable::GetProductionCutsTable();
-  G4String materialName;
 
   // - particles
   G4DynamicParticle primary(gamma,G4ThreeVector(1.,0.,0.));
@@ -334,7 +403,6 @@ void GateMaterialMuHandler::SimulateMaterialTable()
   double incidentEnergy;
 
   // - (mu ; muen) calculations
-  map<const G4MaterialCutsCouple *, GateMuTable *>::iterator it;
   double totalFluoPE;
   double totalFluoCS;
   double totalScatterCS;
@@ -359,167 +427,157 @@ void GateMaterialMuHandler::SimulateMaterialTable()
   // - loops options
   std::vector<MuStorageStruct> muStorage;
 
-  // Loop on material
-  for(unsigned int m=0; m<productionCutList->GetTableSize(); m++)
-    {
-      const G4MaterialCutsCouple *couple = productionCutList->GetMaterialCutsCouple(m);
-      const G4Material *material = couple->GetMaterial();
-      materialName = material->GetName();
-      it = mCoupleTable.find(couple);
-      if(it == mCoupleTable.end())
-        {
-          double energyCutForGamma = productionCutList->ConvertRangeToEnergy(gamma,material,couple->GetProductionCuts()->GetProductionCut("gamma"));
-          GateMessage("Physic",1,"Construction of mu/mu_en table for " << material->GetName() << " with gammaCut = " << energyCutForGamma << " MeV\n");
+  const G4Material *material = couple->GetMaterial();
+  double energyCutForGamma = productionCutList->ConvertRangeToEnergy(gamma,material,couple->GetProductionCuts()->GetProductionCut("gamma"));
+  GateMessage("Physic",1,"Construction of mu/mu_en table for " << material->GetName() << " with gammaCut = " << energyCutForGamma << " MeV\n");
 
-          // Construc energy list (energy, atomicShellEnergy)
-          ConstructEnergyList(&muStorage,material);
+  // Construc energy list (energy, atomicShellEnergy)
+  ConstructEnergyList(&muStorage,material);
 
-          // Loop on energy
-          for(unsigned int e=0; e<muStorage.size(); e++)
-            {
-              incidentEnergy = muStorage[e].energy;
-              primary.SetKineticEnergy(incidentEnergy);
+  // Loop on energy
+  for(unsigned int e=0; e<muStorage.size(); e++)
+    {
+      incidentEnergy = muStorage[e].energy;
+      primary.SetKineticEnergy(incidentEnergy);
 
-              // find the physical models according to the gamma energy
-              for(unsigned int i=0; i<processListForGamma->size(); i++)
-                {
-                  size_t physicRegionNumber = 0;
-                  G4String processName = (*processListForGamma)[i]->GetProcessName();
-                  if(processName == "PhotoElectric" || processName == "phot") {
-                    modelPE = (dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]))->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
-                  }
-                  else if(processName == "Compton" || processName == "compt") {
-                    G4VEmProcess *processCS = dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]);
-                    modelCS = processCS->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
-
-                    // Get the G4VParticleChange of compton scattering by running a fictive step (no simple 'get' function available)
-                    G4Track myTrack(new G4DynamicParticle(gamma,G4ThreeVector(1.,0.,0.),0.01),0.,G4ThreeVector(0.,0.,0.));
-                    myTrack.SetTrackStatus(fStopButAlive); // to get a fast return (see G4VEmProcess::PostStepDoIt(...))
-                    G4Step myStep;
-                    particleChangeCS = dynamic_cast<G4ParticleChangeForGamma *>(processCS->PostStepDoIt((const G4Track)(myTrack), myStep));
-                  }
-                  else if(processName == "RayleighScattering" || processName == "Rayl") {
-                    modelRS = (dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]))->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
-                  }
-                }
+      // find the physical models according to the gamma energy
+      for(unsigned int i=0; i<processListForGamma->size(); i++)
+        {
+          size_t physicRegionNumber = 0;
+          G4String processName = (*processListForGamma)[i]->GetProcessName();
+          if(processName == "PhotoElectric" || processName == "phot") {
+            modelPE = (dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]))->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
+          }
+          else if(processName == "Compton" || processName == "compt") {
+            G4VEmProcess *processCS = dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]);
+            modelCS = processCS->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
+
+            // Get the G4VParticleChange of compton scattering by running a fictive step (no simple 'get' function available)
+            G4Track myTrack(new G4DynamicParticle(gamma,G4ThreeVector(1.,0.,0.),0.01),0.,G4ThreeVector(0.,0.,0.));
+            myTrack.SetTrackStatus(fStopButAlive); // to get a fast return (see G4VEmProcess::PostStepDoIt(...))
+            G4Step myStep;
+            particleChangeCS = dynamic_cast<G4ParticleChangeForGamma *>(processCS->PostStepDoIt((const G4Track)(myTrack), myStep));
+          }
+          else if(processName == "RayleighScattering" || processName == "Rayl") {
+            modelRS = (dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]))->SelectModelForMaterial(incidentEnergy, physicRegionNumber);
+          }
+        }
 
-              // Cross section calculation
-              double density = material->GetDensity() / (g/cm3);
-              crossSectionPE = 0.;
-              crossSectionCS = 0.;
-              crossSectionRS = 0.;
-              if(modelPE) { crossSectionPE = modelPE->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
-              if(modelCS) { crossSectionCS = modelCS->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
-              if(modelRS) { crossSectionRS = modelRS->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
-
-              // muen and uncertainty calculation
-              squaredFluoPE = 0.;
-              squaredFluoCS = 0.;
-              squaredScatterCS = 0.;
-              totalFluoPE = 0.;
-              totalFluoCS = 0.;
-              totalScatterCS = 0.;
-              shotNumberPE = 0;
-              shotNumberCS = 0;
-              squaredSigmaPE = 0.;
-              squaredSigmaCS = 0.;
-              fPE = 1.;
-              fCS = 1.;
-              double trialFluoEnergy;
-              double precision = 10e6;
-              int initialShotNumber = 100;
-              int initialShotNumberPE = int(initialShotNumber / 2);
-
-              int variableShotNumberPE = 0;
-              if(modelPE && isFluoActive) { variableShotNumberPE = initialShotNumberPE; }
-
-              int variableShotNumberCS = 0;
-              if(modelCS) { variableShotNumberCS = initialShotNumber - variableShotNumberPE; }
-
-              // Loop on shot
-              while(precision > mPrecision)
-                {
-                  // photoElectric shots to get the mean fluorescence photon energy
-                  for(int iPE = 0; iPE<variableShotNumberPE; iPE++)
-                    {
-                      trialFluoEnergy = ProcessOneShot(modelPE,&secondaries,couple,&primary);
-                      shotNumberPE++;
+      // Cross section calculation
+      double density = material->GetDensity() / (g/cm3);
+      crossSectionPE = 0.;
+      crossSectionCS = 0.;
+      crossSectionRS = 0.;
+      if(modelPE) { crossSectionPE = modelPE->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
+      if(modelCS) { crossSectionCS = modelCS->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
+      if(modelRS) { crossSectionRS = modelRS->CrossSectionPerVolume(material,gamma,incidentEnergy,energyCutForGamma,10.) * cm / density; }
+
+      // muen and uncertainty calculation
+      squaredFluoPE = 0.;
+      squaredFluoCS = 0.;
+      squaredScatterCS = 0.;
+      totalFluoPE = 0.;
+      totalFluoCS = 0.;
+      totalScatterCS = 0.;
+      shotNumberPE = 0;
+      shotNumberCS = 0;
+      squaredSigmaPE = 0.;
+      squaredSigmaCS = 0.;
+      fPE = 1.;
+      fCS = 1.;
+      double trialFluoEnergy;
+      double precision = 10e6;
+      int initialShotNumber = 100;
+      int initialShotNumberPE = int(initialShotNumber / 2);
+
+      int variableShotNumberPE = 0;
+      if(modelPE && isFluoActive) { variableShotNumberPE = initialShotNumberPE; }
+
+      int variableShotNumberCS = 0;
+      if(modelCS) { variableShotNumberCS = initialShotNumber - variableShotNumberPE; }
+
+      // Loop on shot
+      while(precision > mPrecision)
+        {
+          // photoElectric shots to get the mean fluorescence photon energy
+          for(int iPE = 0; iPE<variableShotNumberPE; iPE++)
+            {
+              trialFluoEnergy = ProcessOneShot(modelPE,&secondaries,couple,&primary);
+              shotNumberPE++;
 
-                      totalFluoPE += trialFluoEnergy;
-                      squaredFluoPE += (trialFluoEnergy * trialFluoEnergy);
-                    }
+              totalFluoPE += trialFluoEnergy;
+              squaredFluoPE += (trialFluoEnergy * trialFluoEnergy);
+            }
 
-                  // compton shots to get the mean fluorescence and scatter photon energy
-                  for(int iCS = 0; iCS<variableShotNumberCS; iCS++)
-                    {
-                      trialFluoEnergy = ProcessOneShot(modelCS,&secondaries,couple,&primary);
-                      shotNumberCS++;
-
-                      totalFluoCS += trialFluoEnergy;
-                      squaredFluoCS += (trialFluoEnergy * trialFluoEnergy);
-                      double trialScatterEnergy = particleChangeCS->GetProposedKineticEnergy();
-                      totalScatterCS += trialScatterEnergy;
-                      squaredScatterCS += (trialScatterEnergy * trialScatterEnergy);
-                    }
+          // compton shots to get the mean fluorescence and scatter photon energy
+          for(int iCS = 0; iCS<variableShotNumberCS; iCS++)
+            {
+              trialFluoEnergy = ProcessOneShot(modelCS,&secondaries,couple,&primary);
+              shotNumberCS++;
+
+              totalFluoCS += trialFluoEnergy;
+              squaredFluoCS += (trialFluoEnergy * trialFluoEnergy);
+              double trialScatterEnergy = particleChangeCS->GetProposedKineticEnergy();
+              totalScatterCS += trialScatterEnergy;
+              squaredScatterCS += (trialScatterEnergy * trialScatterEnergy);
+            }
 
-                  // average fractions of the incident energy E that is transferred to kinetic energy of charged particles (for muen)
-                  if(shotNumberPE) {
-                    fPE = 1. - ((totalFluoPE / double(shotNumberPE)) / incidentEnergy);
-                    squaredSigmaPE = SquaredSigmaOnMean(squaredFluoPE,totalFluoPE,shotNumberPE) * crossSectionPE * crossSectionPE;
-                  }
-                  if(shotNumberCS) {
-                    fCS = 1. - (((totalScatterCS + totalFluoCS) / double(shotNumberCS)) / incidentEnergy);
-                    squaredSigmaCS = (SquaredSigmaOnMean(squaredFluoCS,totalFluoCS,shotNumberCS) + SquaredSigmaOnMean(squaredScatterCS,totalScatterCS,shotNumberCS)) * crossSectionCS * crossSectionCS;
-                  }
-
-                  // mu/rho and muen/rho calculation
-                  muen = fPE * crossSectionPE + fCS * crossSectionCS;
-
-                  // uncertainty calculation
-                  squaredSigmaMuen = (squaredSigmaPE + squaredSigmaCS) / (incidentEnergy * incidentEnergy);
-                  precision = sqrt(squaredSigmaMuen) / muen;
-
-                  if(modelPE && isFluoActive) {
-                    if(squaredSigmaPE > 0) { variableShotNumberPE = (int)floor(0.5 + double(initialShotNumber) * sqrt(squaredSigmaPE / (squaredSigmaPE + squaredSigmaCS))); }
-                    else { variableShotNumberPE = initialShotNumberPE; }
-                  }
-                  if(modelCS) { variableShotNumberCS = initialShotNumber - variableShotNumberPE; }
-                }
+          // average fractions of the incident energy E that is transferred to kinetic energy of charged particles (for muen)
+          if(shotNumberPE) {
+            fPE = 1. - ((totalFluoPE / double(shotNumberPE)) / incidentEnergy);
+            squaredSigmaPE = SquaredSigmaOnMean(squaredFluoPE,totalFluoPE,shotNumberPE) * crossSectionPE * crossSectionPE;
+          }
+          if(shotNumberCS) {
+            fCS = 1. - (((totalScatterCS + totalFluoCS) / double(shotNumberCS)) / incidentEnergy);
+            squaredSigmaCS = (SquaredSigmaOnMean(squaredFluoCS,totalFluoCS,shotNumberCS) + SquaredSigmaOnMean(squaredScatterCS,totalScatterCS,shotNumberCS)) * crossSectionCS * crossSectionCS;
+          }
+
+          // mu/rho and muen/rho calculation
+          muen = fPE * crossSectionPE + fCS * crossSectionCS;
+
+          // uncertainty calculation
+          squaredSigmaMuen = (squaredSigmaPE + squaredSigmaCS) / (incidentEnergy * incidentEnergy);
+          precision = sqrt(squaredSigmaMuen) / muen;
+
+          if(modelPE && isFluoActive) {
+            if(squaredSigmaPE > 0) { variableShotNumberPE = (int)floor(0.5 + double(initialShotNumber) * sqrt(squaredSigmaPE / (squaredSigmaPE + squaredSigmaCS))); }
+            else { variableShotNumberPE = initialShotNumberPE; }
+          }
+          if(modelCS) { variableShotNumberCS = initialShotNumber - variableShotNumberPE; }
+        }
 
-              mu = crossSectionPE + crossSectionCS + crossSectionRS;
+      mu = crossSectionPE + crossSectionCS + crossSectionRS;
 
-              GateMessage("Physic",4,"  \n");
-              GateMessage("Physic",4,"    csPE = " << crossSectionPE << "   csCo = " << crossSectionCS << " csRa = " << crossSectionRS << " cm2.g-1\n");
-              GateMessage("Physic",4,"  fluoPE = " << totalFluoPE / double(shotNumberPE) << " fluoCo = " << totalFluoCS / double(shotNumberCS) << " scCo = " << totalScatterCS / double(shotNumberCS) << " MeV\n");
-              GateMessage("Physic",4,"     fPE = " << fPE            << "    fCo = " << fCS << Gateendl);
-              GateMessage("Physic",4,"     cut = " << energyCutForGamma << "    iPE = " << shotNumberPE << " iCS = " << shotNumberCS << Gateendl);
-              GateMessage("Physic",4," " << incidentEnergy << " MeV - muen = " << muen << " +/- " << sqrt(squaredSigmaMuen) << " (" << precision * 100. << " %)\n");
-              GateMessage("Physic",4,"   sigPE = " << sqrt(squaredSigmaPE) << "    sigCS = " << sqrt(squaredSigmaCS) << Gateendl);
-              GateMessage("Physic",4,"   nPE = " << variableShotNumberPE << " nCS = " << variableShotNumberCS << " nPEtot = " << shotNumberPE << " nCStot = " << shotNumberCS << Gateendl);
+      GateMessage("Physic",4,"  \n");
+      GateMessage("Physic",4,"    csPE = " << crossSectionPE << "   csCo = " << crossSectionCS << " csRa = " << crossSectionRS << " cm2.g-1\n");
+      GateMessage("Physic",4,"  fluoPE = " << totalFluoPE / double(shotNumberPE) << " fluoCo = " << totalFluoCS / double(shotNumberCS) << " scCo = " << totalScatterCS / double(shotNumberCS) << " MeV\n");
+      GateMessage("Physic",4,"     fPE = " << fPE            << "    fCo = " << fCS << Gateendl);
+      GateMessage("Physic",4,"     cut = " << energyCutForGamma << "    iPE = " << shotNumberPE << " iCS = " << shotNumberCS << Gateendl);
+      GateMessage("Physic",4," " << incidentEnergy << " MeV - muen = " << muen << " +/- " << sqrt(squaredSigmaMuen) << " (" << precision * 100. << " %)\n");
+      GateMessage("Physic",4,"   sigPE = " << sqrt(squaredSigmaPE) << "    sigCS = " << sqrt(squaredSigmaCS) << Gateendl);
+      GateMessage("Physic",4,"   nPE = " << variableShotNumberPE << " nCS = " << variableShotNumberCS << " nPEtot = " << shotNumberPE << " nCStot = " << shotNumberCS << Gateendl);
 
-              muStorage[e].mu = mu;
-              muStorage[e].muen = muen;
-            }
+      muStorage[e].mu = mu;
+      muStorage[e].muen = muen;
+    }
 
-          GateMessage("Physic",4," -------------------------------------------------------- \n");
-          GateMessage("Physic",4," \n");
+  GateMessage("Physic",4," -------------------------------------------------------- \n");
+  GateMessage("Physic",4," \n");
 
-          // Interpolation of mu,muen for energy bordering an atomic transition (see ConstructEnergyList(...))
-          MergeAtomicShell(&muStorage);
+  // Interpolation of mu,muen for energy bordering an atomic transition (see ConstructEnergyList(...))
+  MergeAtomicShell(&muStorage);
 
-          // Fill mu,muen table for this material
-          GateMuTable *table = new GateMuTable(couple, muStorage.size());
-          GateMessage("Physic",3," \n");
-          GateMessage("Physic",3," E(MeV)  mu(cm2/g)  muen(cm2/g)\n");
-          for(unsigned int e=0; e<muStorage.size(); e++)
-            {
-              table->PutValue(e, log(muStorage[e].energy), log(muStorage[e].mu), log(muStorage[e].muen));
-              GateMessage("Physic",3," " << muStorage[e].energy << " " << muStorage[e].mu << " " << muStorage[e].muen << Gateendl);
-            }
-          GateMessage("Physic",3," \n");
-          mCoupleTable.insert(std::pair<const G4MaterialCutsCouple *, GateMuTable *>(couple,table));
-        }
+  // Fill mu,muen table for this material
+  GateMuTable *table = new GateMuTable(couple, muStorage.size());
+  GateMessage("Physic",3," \n");
+  GateMessage("Physic",3," E(MeV)  mu(cm2/g)  muen(cm2/g)\n");
+  for(unsigned int e=0; e<muStorage.size(); e++)
+    {
+      table->PutValue(e, log(muStorage[e].energy), log(muStorage[e].mu), log(muStorage[e].muen));
+      GateMessage("Physic",3," " << muStorage[e].energy << " " << muStorage[e].mu << " " << muStorage[e].muen << Gateendl);
     }
+  GateMessage("Physic",3," \n");
+  return table;
 }
 //-----------------------------------------------------------------------------
 
@@ -621,4 +679,144 @@ void GateMaterialMuHandler::MergeAtomicShell(std::vector<MuStorageStruct> *muSto
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+unsigned long long GateMaterialMuHandler::ComputeTableKey(const G4MaterialCutsCouple *couple)
+{
+  const G4Material *material = couple->GetMaterial();
+
+  GateCacheKey key;
+  key.Add(string("GateMuTable"));
+  key.Add(mDatabaseName);
+
+  // Composition
+  key.Add(material->GetDensity());
+  key.Add(double(material->GetNumberOfElements()));
+  for(unsigned int i=0; i<material->GetNumberOfElements(); i++)
+    {
+      key.Add(material->GetElement(i)->GetZ());
+      key.Add(material->GetElement(i)->GetN());
+      key.Add(material->GetFractionVector()[i]);
+    }
+
+  if(mDatabaseName == "simulated")
+    {
+      // Energy grid
+      key.Add(mEnergyMin);
+      key.Add(mEnergyMax);
+      key.Add(double(mEnergyNumber));
+      key.Add(mAtomicShellEnergyMin);
+      key.Add(mPrecision);
+
+      // Physics: Geant4 version, gamma cut, fluorescence and gamma models
+      G4ParticleDefinition *gamma = G4Gamma::Gamma();
+      G4ProductionCutsTable *productionCutList = G4ProductionCutsTable::GetProductionCutsTable();
+      key.Add(double(G4VERSION_NUMBER));
+      key.Add(productionCutList->ConvertRangeToEnergy(gamma,material,couple->GetProductionCuts()->GetProductionCut("gamma")));
+      bool isFluoActive = false;
+      if(G4LossTableManager::Instance()->AtomDeexcitation()) { isFluoActive = G4LossTableManager::Instance()->AtomDeexcitation()->IsFluoActive();}
+      key.Add(double(isFluoActive));
+
+      G4ProcessVector *processListForGamma = gamma->GetProcessManager()->GetProcessList();
+      for(unsigned int i=0; i<processListForGamma->size(); i++)
+        {
+          key.Add((*processListForGamma)[i]->GetProcessName());
+          G4VEmProcess *process = dynamic_cast<G4VEmProcess *>((*processListForGamma)[i]);
+          if(process)
+            {
+              size_t physicRegionNumber = 0;
+              G4VEmModel *modelMin = process->SelectModelForMaterial(mEnergyMin, physicRegionNumber);
+              G4VEmModel *modelMax = process->SelectModelForMaterial(mEnergyMax, physicRegionNumber);
+              if(modelMin) { key.Add(modelMin->GetName()); }
+              if(modelMax) { key.Add(modelMax->GetName()); }
+            }
+        }
+    }
+
+  return key.Get();
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+G4String GateMaterialMuHandler::GetCacheFileName(unsigned long long key)
+{
+  std::ostringstream name;
+  name << mCacheDirectory << "/GateMuTable_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+  return name.str();
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool GateMaterialMuHandler::IsCached(unsigned long long key)
+{
+  if(mCacheDirectory == "") { return false; }
+
+  std::ifstream is(GetCacheFileName(key).c_str(), std::ios::binary);
+  char magic[8];
+  unsigned long long fileKey = 0;
+  is.read(magic, sizeof(magic));
+  is.read((char *)&fileKey, sizeof(fileKey));
+  return is && memcmp(magic, theMuTableMagic, sizeof(magic)) == 0 && fileKey == key;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+GateMuTable *GateMaterialMuHandler::ReadTable(const G4MaterialCutsCouple *couple, unsigned long long key)
+{
+  if(mCacheDirectory == "") { return 0; }
+
+  G4String fileName = GetCacheFileName(key);
+  std::ifstream is(fileName.c_str(), std::ios::binary);
+  if(!is) { return 0; }
+
+  char magic[8];
+  unsigned long long fileKey = 0;
+  int size = 0;
+  is.read(magic, sizeof(magic));
+  is.read((char *)&fileKey, sizeof(fileKey));
+  is.read((char *)&size, sizeof(size));
+  if(!is || memcmp(magic, theMuTableMagic, sizeof(magic)) != 0 || fileKey != key || size < 1)
+    {
+      GateWarning("GateMaterialMuHandler -- " << fileName << " is not a valid mu/muen table, the table is built.");
+      return 0;
+    }
+
+  std::vector<double> values(3*size);
+  is.read((char *)&values[0], values.size()*sizeof(double));
+  if(!is)
+    {
+      GateWarning("GateMaterialMuHandler -- " << fileName << " is truncated, the table is built.");
+      return 0;
+    }
+
+  GateMuTable *table = new GateMuTable(couple, size);
+  for(int i=0; i<size; i++) { table->PutValue(i, values[i], values[size+i], values[2*size+i]); }
+
+  GateMessage("Physic",1,"mu/mu_en table for " << couple->GetMaterial()->GetName() << " read from " << fileName << Gateendl);
+  return table;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateMaterialMuHandler::WriteTable(unsigned long long key, GateMuTable *table)
+{
+  if(mCacheDirectory == "") { return; }
+
+  G4String fileName = GetCacheFileName(key);
+  int size = table->GetSize();
+
+  const bool isWritten = GateCacheFile::Write(fileName, [&](std::ostream & os) {
+      os.write(theMuTableMagic, sizeof(theMuTableMagic));
+      os.write((const char *)&key, sizeof(key));
+      os.write((const char *)&size, sizeof(size));
+      os.write((const char *)table->GetEnergies(), size*sizeof(double));
+      os.write((const char *)table->GetMuTable(), size*sizeof(double));
+      os.write((const char *)table->GetMuEnTable(), size*sizeof(double));
+    });
+  if(!isWritten)
+    {
+      GateWarning("GateMaterialMuHandler -- cannot write the mu/muen table " << fileName);
+    }
+}
+//-----------------------------------------------------------------------------
+
 #endif
@@ -12,6 +12,7 @@
 #include "GateVOutputModule.hh"
 #include "GateOutputMgrMessenger.hh"
 #include "GateConfiguration.h"
+#include "GateProfiler.hh"
 #include "GateAnalysis.hh"
 #ifdef GATE_USE_OPTICAL
 #include "GateFastAnalysis.hh"
@@ -150,6 +151,7 @@ void GateOutputMgr::AddOutputModule(GateVOutputModule* module)
     G4cout << "GateOutputMgr::AddOutputModule\n";
 
   m_outputModules.push_back(module);
+  m_profilerCounters.push_back(GateProfiler::Register("Output", module->GetName(), "RecordEndOfEvent"));
 }
 //----------------------------------------------------------------------------------
 
@@ -181,6 +183,7 @@ void GateOutputMgr::RecordEndOfEvent(const G4Event* event)
   for (size_t iMod=0; iMod<m_outputModules.size(); iMod++) {
     if ( m_outputModules[iMod]->IsEnabled() )
       {
+        GateProfilerScope profilerScope(m_profilerCounters[iMod]);
         m_outputModules[iMod]->RecordEndOfEvent(event);
       }
   }
@@ -439,6 +442,13 @@ void GateOutputMgr::CheckFileNameForAllOutput()
             }
           else if ((*aIt)->GiveNameOfFile()!="  ") nbModuleEnabled++; // Output modules with nofileName return 2 spaces
         }
+#ifdef GATE_USE_MT
+      // The output modules and the digitizer are not called by the worker
+      // threads. 'analysis' and 'digi' are enabled by default but only
+      // process the hits of the crystal/phantom SD, which are refused too.
+      if ( (*aIt)->IsEnabled() && (*aIt)->GetName() != "analysis" && (*aIt)->GetName() != "digi" )
+        GateError("Output module '" << (*aIt)->GetName() << "' cannot be used with multithreading (GATE_USE_MT), only actors.");
+#endif
     }
   if (nbActor==0 && nbModuleEnabled==0)
     {
@@ -14,7 +14,7 @@ See LICENSE.md for further details
 #include "GateConfiguration.h"
 #include "GateMessageManager.hh"
 
-G4Allocator<GatePhantomHit> GatePhantomHitAllocator;
+G4ThreadLocal G4Allocator<GatePhantomHit> * GatePhantomHitAllocator = 0;
 
 GatePhantomHit::GatePhantomHit()
 {;}
@@ -9,6 +9,7 @@
 #include "GateMessageManager.hh"
 #include "GatePhantomSD.hh"
 #include "GatePhantomHit.hh"
+#include "GateProfiler.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
 #include "G4VPhysicalVolume.hh"
@@ -28,6 +29,7 @@ GatePhantomSD::GatePhantomSD(const G4String& name)
 :G4VSensitiveDetector(name)
 {
   collectionName.insert(thePhantomCollectionName);
+  m_profilerCounter = GateProfiler::Register("SD", name, "ProcessHits");
 }
 //------------------------------------------------------------------------------
 
@@ -71,6 +73,7 @@ void GatePhantomSD::Initialize(G4HCofThisEvent*HCE)
 }
 
 G4bool GatePhantomSD::ProcessHits(G4Step* aStep,G4TouchableHistory* /*ROhist*/) {
+  GateProfilerScope profilerScope(m_profilerCounter);
   G4Track* aTrack       = aStep->GetTrack();
   G4int    trackID      = aTrack->GetTrackID();
   G4int    parentID     = aTrack->GetParentID();
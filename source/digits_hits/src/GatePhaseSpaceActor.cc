@@ -173,6 +173,8 @@ void GatePhaseSpaceActor::Construct() {
             mFileType = "rootFile";
         } else if (extension == "npy") {
             mFileType = "npyFile";
+        } else if (extension == "gtc") {
+            mFileType = "gtcFile";
         } else if (extension == "txt") {
             mFileType = "txtFile";
         } else
@@ -190,6 +192,8 @@ void GatePhaseSpaceActor::InitTree() {
         mFile->add_file(mSaveFilename, "root");
     if (mFileType == "txtFile")
         mFile->add_file(mSaveFilename, "txt");
+    if (mFileType == "gtcFile")
+        mFile->add_file(mSaveFilename, "gtc");
 
     mFile->set_tree_name("PhaseSpace");
 
@@ -471,8 +475,8 @@ void GatePhaseSpaceActor::UserSteppingAction(const GateVVolume *, const G4Step *
 
     trackid = step->GetTrack()->GetTrackID();
     parentid = step->GetTrack()->GetParentID();
-    eventid = GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
-    runid = GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    eventid = G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
+    runid = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
 
     x = localPosition.x();
     y = localPosition.y();
@@ -560,7 +564,7 @@ void GatePhaseSpaceActor::UserSteppingAction(const GateVVolume *, const G4Step *
     fTimeFromBeginOfEvent = step->GetTrack()->GetGlobalTime() - fBeginOfEventTime;
     /*
     std::cout << "Step " << GetName() << " "
-              << GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID() << " "
+              << G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID() << " "
               << "global = " << G4BestUnit(step->GetTrack()->GetGlobalTime(), "Time")
               << " fbeg = " << G4BestUnit(fBeginOfEventTime, "Time")
               << " timefrom = " << G4BestUnit(fTimeFromBeginOfEvent, "Time")
@@ -631,8 +635,8 @@ void GatePhaseSpaceActor::UserSteppingAction(const GateVVolume *, const G4Step *
         << " local=" << G4BestUnit(stepPoint->GetLocalTime(), "Time") << Gateendl);
     GateDebugMessage("Actor", 4, "trackid="
         << step->GetTrack()->GetParentID()
-        << " event=" << GateRunManager::GetRunManager()->GetCurrentEvent()->GetEventID()
-        << " run=" << GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID() << Gateendl);
+        << " event=" << G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID()
+        << " run=" << G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID() << Gateendl);
     GateDebugMessage("Actor", 4, "pos = " << x << " " << y << " " << z << Gateendl);
     GateDebugMessage("Actor", 4, "E = " << G4BestUnit(stepPoint->GetKineticEnergy(), "Energy") << Gateendl);
 
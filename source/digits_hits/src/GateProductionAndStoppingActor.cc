@@ -71,12 +71,14 @@ void GateProductionAndStoppingActor::Construct() {
   mProdImage.SetResolutionAndHalfSize(mResolution, mHalfSize, mPosition);
   mProdImage.Allocate();
   mProdImage.SetFilename(mProdFilename);
+  AddThreadImage(mProdImage);
 
   mStopImage.EnableSquaredImage(false);
   mStopImage.EnableUncertaintyImage(false);
   mStopImage.SetResolutionAndHalfSize(mResolution, mHalfSize, mPosition);
   mStopImage.Allocate();
   mStopImage.SetFilename(mStopFilename);
+  AddThreadImage(mStopImage);
 
   ResetData();
   GateMessageDec("Actor", 4, "GateProductionAndStoppingActor -- Construct - end\n");
@@ -87,6 +89,7 @@ void GateProductionAndStoppingActor::Construct() {
 //-----------------------------------------------------------------------------
 /// Save data
 void GateProductionAndStoppingActor::SaveData() {
+  mCurrentEvent += MergeThreadData();
   mProdImage.SaveData(mCurrentEvent+1);
   mStopImage.SaveData(mCurrentEvent+1);
 }
@@ -104,13 +107,14 @@ void GateProductionAndStoppingActor::ResetData() {
 void GateProductionAndStoppingActor::BeginOfRunAction(const G4Run * ) {
   GateDebugMessage("Actor", 3, "GateProductionAndStoppingActor -- Begin of Run\n");
   ResetData();
+  AllocateThreadData();
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 // Callback at each event
 void GateProductionAndStoppingActor::BeginOfEventAction(const G4Event * ) {
-  mCurrentEvent++;
+  CountEvent(mCurrentEvent);
   GateDebugMessage("Actor", 3, "GateProductionAndStoppingActor -- Begin of Event: "<<mCurrentEvent << Gateendl);
 }
 //-----------------------------------------------------------------------------
@@ -411,10 +411,10 @@ TH1D * GatePromptGammaData::GetGammaEnergySpectrum(const int & materialIndex,
   }
 
   // Get the index of the energy bin
-  int binX = pHEp->FindFixBin(energy/MeV);
+  int binX = GetProtonEnergyBin(energy);
 
   // Get the projected histogram of the material
-  TH1D * h = mGammaEnergyHistoByMaterialByProtonEnergy[materialIndex][binX];
+  TH1D * h = GetGammaEnergySpectrumOfBin(materialIndex, binX);
 
   /* //DEBUG: verified that these two output the same (modulus density)
   TFile f1("histos1.root","new");
@@ -431,6 +431,23 @@ TH1D * GatePromptGammaData::GetGammaEnergySpectrum(const int & materialIndex,
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+TH1D * GatePromptGammaData::GetGammaEnergySpectrumOfBin(const int & materialIndex,
+                                                        const int & bin)
+{
+  return mGammaEnergyHistoByMaterialByProtonEnergy[materialIndex][bin];
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+int GatePromptGammaData::GetProtonEnergyBin(const double & energy)
+{
+  return pHEp->FindFixBin(energy/MeV);
+}
+//-----------------------------------------------------------------------------
+
+
 //-----------------------------------------------------------------------------
 TH2D* GatePromptGammaData::GetNgammaM(const int & materialIndex)
 {
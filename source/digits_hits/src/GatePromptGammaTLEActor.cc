@@ -17,6 +17,9 @@
 #include <G4Proton.hh>
 #include <G4VProcess.hh>
 
+#include <algorithm>
+#include <map>
+
 //-----------------------------------------------------------------------------
 GatePromptGammaTLEActor::GatePromptGammaTLEActor(G4String name, G4int depth):
   GateVImageActor(name, depth)
@@ -27,6 +30,7 @@ GatePromptGammaTLEActor::GatePromptGammaTLEActor(G4String name, G4int depth):
   mCurrentEvent = -1;
   mIsDebugOutputEnabled = false;
   mIsOutputMatchEnabled = false;
+  mIsDeferredSpectrumEnabled = false;
   alreadyHere = false;
 }
 //-----------------------------------------------------------------------------
@@ -64,8 +68,11 @@ void GatePromptGammaTLEActor::Construct()
   data.Read(mInputDataFilename);
   data.InitializeMaterial(mIsDebugOutputEnabled);
 
-  //set up and allocate runtime images.
-  SetTLEIoH(mImageGamma);
+  //set up and allocate runtime images. With the deferred spectrum, mImageGamma is only allocated at the end.
+  if (mIsDeferredSpectrumEnabled) {
+    mDeferredFirstBlock.assign((size_t)(mResolution.x()*mResolution.y()*mResolution.z()), -1);
+  }
+  else SetTLEIoH(mImageGamma);
   if (mIsDebugOutputEnabled){
     //set up and allocate lasthiteventimage
     SetOriginTransformAndFlagToImage(mLastHitEventImage);
@@ -98,6 +105,10 @@ void GatePromptGammaTLEActor::ResetData()
   trackl->Reset();
   tracklsq->Reset();
   mLastHitEventImage.Fill(-1);
+  std::fill(mDeferredFirstBlock.begin(), mDeferredFirstBlock.end(), -1);
+  mDeferredBlockMaterial.clear();
+  mDeferredBlockNext.clear();
+  mDeferredTrackLength.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -112,6 +123,11 @@ void GatePromptGammaTLEActor::SaveData()
 
   //GateVImageActor::SaveData();  //What does this do?
 
+  if (mIsDeferredSpectrumEnabled) {
+    SetTLEIoH(mImageGamma);
+    ApplyDeferredSpectrum();
+  }
+
   // Number of primaries for normalisation, so that we have the number per proton, which is easier to use.
   mImageGamma->Scale(1./(GateActorManager::GetInstance()->GetCurrentEventId() + 1));// +1 because start at zero
   mImageGamma->Write(mSaveFilename);
@@ -209,13 +225,24 @@ void GatePromptGammaTLEActor::UserSteppingActionInVoxel(int index, const G4Step
     material = GateDetectorConstruction::GetGateDetectorConstruction()->mMaterialDatabase.GetMaterial(materialname);
   }
 
+  // Also take the particle weight into account
+  double w = step->GetTrack()->GetWeight();
+
+  // Deferred spectrum: only the track length is stored, the spectra are added at the end
+  if (mIsDeferredSpectrumEnabled) {
+    if (!data.DataForMaterialExist(material->GetIndex())) {
+      GateError("Error in GatePromptGammaData for TLE, the material " << material->GetName()
+                << " is not in the DB. materialIndex: " << material->GetIndex());
+    }
+    AddDeferredTrackLength(index, material->GetIndex(), data.GetProtonEnergyBin(particle_energy),
+                           w * distance * material->GetDensity() / (g / cm3));
+    return;
+  }
+
   // Get value from histogram. We do not check the material index, and
   // assume everything exist (has been computed by InitializeMaterial)
   TH1D *h = data.GetGammaEnergySpectrum(material->GetIndex(), particle_energy);
 
-  // Also take the particle weight into account
-  double w = step->GetTrack()->GetWeight();
-
   // Do not scale h directly because it will be reused
   mImageGamma->AddValueDouble(index, h, w * distance * material->GetDensity() / (g / cm3));
   // (material is converted from internal units to g/cm3)
@@ -223,6 +250,68 @@ void GatePromptGammaTLEActor::UserSteppingActionInVoxel(int index, const G4Step
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+void GatePromptGammaTLEActor::AddDeferredTrackLength(int index, int materialIndex, int protonBin, double value)
+{
+  // proton bins are numbered from 1 (TH1 convention), the under/overflow bins have no spectrum
+  const int nbProtonBins = data.GetProtonNbBins();
+  if (protonBin < 1 || protonBin > nbProtonBins) return;
+
+  // block of this material in the voxel (usually the first one)
+  int b = mDeferredFirstBlock[index];
+  while (b >= 0 && mDeferredBlockMaterial[b] != materialIndex) b = mDeferredBlockNext[b];
+  if (b < 0) {
+    b = mDeferredBlockMaterial.size();
+    mDeferredBlockMaterial.push_back(materialIndex);
+    mDeferredBlockNext.push_back(mDeferredFirstBlock[index]);
+    mDeferredFirstBlock[index] = b;
+    mDeferredTrackLength.resize(mDeferredTrackLength.size() + nbProtonBins, 0.);
+  }
+  mDeferredTrackLength[(long)b*nbProtonBins + protonBin-1] += value;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePromptGammaTLEActor::ApplyDeferredSpectrum()
+{
+  const int nbProtonBins = data.GetProtonNbBins();
+  const int nbGammaBins = data.GetGammaNbBins();
+
+  // Gamma spectra of each material, as a dense [E_proton][E_gamma] matrix
+  std::map<int, std::vector<double> > spectra;
+  for (size_t b = 0; b < mDeferredBlockMaterial.size(); b++) {
+    const int m = mDeferredBlockMaterial[b];
+    if (spectra.count(m)) continue;
+    std::vector<double> & s = spectra[m];
+    s.resize((long)nbProtonBins*nbGammaBins);
+    for (int pi = 0; pi < nbProtonBins; pi++) {
+      TH1D * h = data.GetGammaEnergySpectrumOfBin(m, pi+1);
+      for (int gi = 0; gi < nbGammaBins; gi++) s[(long)pi*nbGammaBins + gi] = h->GetBinContent(gi+1);
+    }
+  }
+
+  // Per voxel: spectrum += sum over E_proton of tracklength * spectrum(E_proton)
+  double * output = mImageGamma->GetDataDoublePointer();
+  for (size_t vi = 0; vi < mDeferredFirstBlock.size(); vi++) {
+    double * o = output + vi*nbGammaBins;
+    for (int b = mDeferredFirstBlock[vi]; b >= 0; b = mDeferredBlockNext[b]) {
+      const double * s = &spectra[mDeferredBlockMaterial[b]][0];
+      const double * l = &mDeferredTrackLength[(long)b*nbProtonBins];
+      for (int pi = 0; pi < nbProtonBins; pi++) {
+        if (l[pi] == 0.) continue;
+        const double li = l[pi];
+        const double * si = s + (long)pi*nbGammaBins;
+        for (int gi = 0; gi < nbGammaBins; gi++) o[gi] += li * si[gi];
+      }
+    }
+  }
+  GateMessage("Actor", 1, "GatePromptGammaTLEActor -- deferred spectrum: " << mDeferredBlockMaterial.size()
+              << " (voxel, material) reached out of " << mDeferredFirstBlock.size() << " voxels" << G4endl);
+}
+//-----------------------------------------------------------------------------
+
+
 //-----------------------------------------------------------------------------
 void GatePromptGammaTLEActor::BuildVarianceOutput() {
   //nr primaries, +1 because start at zero, double because we will divide by it.
@@ -28,6 +28,8 @@ GatePromptGammaTLEActorMessenger::~GatePromptGammaTLEActorMessenger()
   DD("GatePromptGammaTLEActorMessenger destructor");
   delete pSetInputDataFileCmd;
   delete pEnableDebugOutputCmd;
+  delete pEnableOutputMatchCmd;
+  delete pEnableDeferredSpectrumCmd;
   //delete pEnableSysVarianceCmd;
   //delete pEnableIntermediaryUncertaintyOutputCmd;
 }
@@ -52,6 +54,11 @@ void GatePromptGammaTLEActorMessenger::BuildCommands(G4String base)
   guidance = G4String("Enable this too make sure the regular TLE output and debug output match. In corner cases where voxels of the image and TLE actor don't match, DebugOutput will take the material at the voxel center, while regular TLE will take the material at the interaction point. Enabling this will force regular TLE to also look at the voxel center.");
   pEnableOutputMatchCmd->SetGuidance(guidance);
 
+  bb = base+"/enableDeferredSpectrum";
+  pEnableDeferredSpectrumCmd = new G4UIcmdWithABool(bb, this);
+  guidance = G4String("Only store the track length per voxel, material and E_proton during the simulation, and add the gamma spectra when the output is saved. Each step costs a single addition instead of a full spectrum, and only the voxels reached by protons use memory.");
+  pEnableDeferredSpectrumCmd->SetGuidance(guidance);
+
 }
 //-----------------------------------------------------------------------------
 
@@ -62,6 +69,7 @@ void GatePromptGammaTLEActorMessenger::SetNewValue(G4UIcommand* cmd, G4String ne
   if (cmd == pSetInputDataFileCmd) pTLEActor->SetInputDataFilename(newValue);
   if (cmd == pEnableDebugOutputCmd) pTLEActor->EnableDebugOutput(pEnableDebugOutputCmd->GetNewBoolValue(newValue));
   if (cmd == pEnableOutputMatchCmd) pTLEActor->EnableOutputMatch(pEnableOutputMatchCmd->GetNewBoolValue(newValue));
+  if (cmd == pEnableDeferredSpectrumCmd) pTLEActor->EnableDeferredSpectrum(pEnableDeferredSpectrumCmd->GetNewBoolValue(newValue));
   //if (cmd == pEnableSysVarianceCmd) pTLEActor->EnableSysVarianceImage(pEnableSysVarianceCmd->GetNewBoolValue(newValue));
   //if (cmd == pEnableIntermediaryUncertaintyOutputCmd) pTLEActor->EnableIntermediaryUncertaintyOutput(pEnableIntermediaryUncertaintyOutputCmd->GetNewBoolValue(newValue));
   GateImageActorMessenger::SetNewValue(cmd,newValue);
@@ -12,6 +12,15 @@ See LICENSE.md for further details
 
 #include "G4UnitsTable.hh"
 
+G4ThreadLocal GateEventPool * GatePulsePool = 0;
+G4ThreadLocal GateEventPool * GatePulseListPool = 0;
+
+void GatePulse::ResetPools()
+{
+  if (GatePulsePool) GatePulsePool->Reset();
+  if (GatePulseListPool) GatePulseListPool->Reset();
+}
+
 GatePulse::GatePulse(const void* itsMother)
     : m_runID(-1),
       m_eventID(-1),
@@ -0,0 +1,152 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateRayCaster.hh"
+
+#include <cmath>
+#include <limits>
+
+//-----------------------------------------------------------------------------
+GateRayCaster::GateRayCaster()
+{
+  for(int a=0; a<3; a++) {
+    mResolution[a] = 0;
+    mVoxelSize[a] = 0.0;
+    mHalfSize[a] = 0.0;
+  }
+  mLineSize = 0;
+  mPlaneSize = 0;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateRayCaster::SetGrid(const G4ThreeVector & resolution, const G4ThreeVector & voxelSize)
+{
+  for(int a=0; a<3; a++) {
+    mResolution[a] = (int)lrint(resolution[a]);
+    mVoxelSize[a] = voxelSize[a];
+    mHalfSize[a] = mResolution[a]*mVoxelSize[a]/2.0;
+  }
+  mLineSize = mResolution[0];
+  mPlaneSize = mResolution[0]*mResolution[1];
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateRayCaster::Trace(Packet & packet, std::vector<GateRaySegment> & segments) const
+{
+  const double infinity = std::numeric_limits<double>::max();
+
+  // State of the rays, by lane. The lanes beyond packet.size are
+  // inactive from the beginning, and an inactive lane keeps a valid voxel.
+  int    voxel[3][PacketSize];
+  int    increment[3][PacketSize];
+  double crossing[3][PacketSize];  // length to cross a voxel along each axis
+  double remaining[3][PacketSize]; // length to the next voxel boundary along each axis
+  double travelled[PacketSize];
+  double total[PacketSize];
+  double weight[PacketSize];
+  double weightOut[PacketSize];
+  const double * mu[PacketSize];
+  int active[PacketSize];
+
+  for(int l=0; l<PacketSize; l++) {
+    const bool isRay = (l < packet.size);
+    total[l] = infinity;
+    for(int a=0; a<3; a++) {
+      const double p = isRay ? packet.position[a][l] : 0.0;
+      const double d = isRay ? packet.direction[a][l] : 1.0;
+      increment[a][l] = (d > 0.0) ? 1 : -1;
+      crossing[a][l] = increment[a][l]*mVoxelSize[a]/d;
+
+      // Security on matrix boundaries
+      int v = (int)floor((p + mHalfSize[a])/mVoxelSize[a]);
+      if (v < 0) v = 0;
+      else if (v >= mResolution[a]) v = mResolution[a] - 1;
+      voxel[a][l] = v;
+
+      double exit = infinity;
+      if (d > 0.0) {
+        remaining[a][l] = (-mHalfSize[a] + (v+1)*mVoxelSize[a] - p)/d;
+        exit = (mHalfSize[a] - p)/d;
+      }
+      else if (d < 0.0) {
+        remaining[a][l] = -(p - (-mHalfSize[a] + v*mVoxelSize[a]))/d;
+        exit = (-mHalfSize[a] - p)/d;
+      }
+      else remaining[a][l] = infinity;
+      if (exit < total[l]) total[l] = exit;
+    }
+    if (!isRay) total[l] = 0.0;
+    travelled[l] = 0.0;
+    weight[l] = isRay ? packet.weight[l] : 0.0;
+    weightOut[l] = 0.0;
+    mu[l] = isRay ? packet.mu[l] : packet.mu[0];
+    active[l] = (travelled[l] < total[l] - 0.00001);
+  }
+
+  const int * labels = &mLabels[0];
+  GateRaySegment step[PacketSize];
+  int wasActive[PacketSize];
+  int nbActive = 0;
+  for(int l=0; l<PacketSize; l++) nbActive += active[l];
+
+  while(nbActive > 0) {
+    // One step of each ray (branch free)
+    for(int l=0; l<PacketSize; l++) {
+      const int index = voxel[0][l] + voxel[1][l]*mLineSize + voxel[2][l]*mPlaneSize;
+      const int label = labels[index];
+      const bool cx = (remaining[0][l] < remaining[1][l]) && (remaining[0][l] < remaining[2][l]);
+      const bool cy = !cx && (remaining[1][l] < remaining[2][l]);
+      const bool cz = !cx && !cy;
+      const double length = cx ? remaining[0][l] : (cy ? remaining[1][l] : remaining[2][l]);
+      const double wIn = weight[l];
+      const double wOut = wIn*exp(-mu[l][label]*length);
+
+      step[l].ray = l;
+      step[l].index = index;
+      step[l].label = label;
+      step[l].length = length;
+      step[l].weightIn = wIn;
+      step[l].weightOut = wOut;
+
+      const bool a = active[l];
+      wasActive[l] = a;
+      weight[l] = a ? wOut : wIn;
+      weightOut[l] = a ? wOut : weightOut[l];
+      travelled[l] = a ? travelled[l] + length : travelled[l];
+      remaining[0][l] = a ? (cx ? crossing[0][l] : remaining[0][l] - length) : remaining[0][l];
+      remaining[1][l] = a ? (cy ? crossing[1][l] : remaining[1][l] - length) : remaining[1][l];
+      remaining[2][l] = a ? (cz ? crossing[2][l] : remaining[2][l] - length) : remaining[2][l];
+
+      // Next voxel, the ray stopping at the border of the grid
+      const int nx = voxel[0][l] + ((a && cx) ? increment[0][l] : 0);
+      const int ny = voxel[1][l] + ((a && cy) ? increment[1][l] : 0);
+      const int nz = voxel[2][l] + ((a && cz) ? increment[2][l] : 0);
+      const bool inside = (nx >= 0) && (nx < mResolution[0]) &&
+        (ny >= 0) && (ny < mResolution[1]) &&
+        (nz >= 0) && (nz < mResolution[2]);
+      voxel[0][l] = inside ? nx : voxel[0][l];
+      voxel[1][l] = inside ? ny : voxel[1][l];
+      voxel[2][l] = inside ? nz : voxel[2][l];
+      active[l] = a && inside && (travelled[l] < total[l] - 0.00001);
+    }
+
+    nbActive = 0;
+    for(int l=0; l<PacketSize; l++) {
+      if (wasActive[l]) segments.push_back(step[l]);
+      nbActive += active[l];
+    }
+  }
+
+  for(int l=0; l<packet.size; l++) {
+    packet.weight[l] = weightOut[l];
+    packet.length[l] = total[l];
+  }
+}
+//-----------------------------------------------------------------------------
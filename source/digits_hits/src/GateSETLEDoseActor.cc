@@ -32,6 +32,7 @@
 #include "G4PhysicalConstants.hh"
 
 #include <typeinfo>
+#include <map>
 //-----------------------------------------------------------------------------
 GateSETLEDoseActor::GateSETLEDoseActor(G4String name, G4int depth) :
   GateVImageActor(name,depth) {
@@ -53,6 +54,7 @@ GateSETLEDoseActor::GateSETLEDoseActor(G4String name, G4int depth) :
 
   mIsHybridinoEnabled = false;
   mIsMuTableInitialized = false;
+  mNextSlot = 0;
 
   // Create a 'MultiplicityActor' if not exist
   GateActorManager *actorManager = GateActorManager::GetInstance();
@@ -174,6 +176,8 @@ void GateSETLEDoseActor::Construct() {
   mBoxMax[2] = mHalfSize.z();
   mLineSize = (int)lrint(mResolution.x());
   mPlaneSize = (int)lrint(mResolution.x()*mResolution.y());
+  mRayCaster.SetGrid(mResolution, mVoxelSize);
+  mPacket.size = 0;
 
   ConversionFactor = e_SI * 1.0e12;
   VoxelVolume = GetDoselVolume();
@@ -190,7 +194,11 @@ void GateSETLEDoseActor::InitializeMaterialAndMuTable()
       int planeSize = (int)lrint(mResolution.x()*mResolution.y());
       int voxelIndex = -1;
 
-      mListOfMuTable.resize(mResolution.x()*mResolution.y()*mResolution.z());
+      // One mu table by label of the image, the ray caster storing the
+      // (contiguous) label of each voxel
+      std::vector<int> labelOfVoxel(mResolution.x()*mResolution.y()*mResolution.z());
+      std::map<int, int> labels;
+      mListOfMuTable.clear();
 
       GateVImageVolume* volume = dynamic_cast<GateVImageVolume*>(GetVolume());
       G4Region *region = G4RegionStore::GetInstance()->GetRegion(volume->GetObjectName());
@@ -202,11 +210,26 @@ void GateSETLEDoseActor::InitializeMaterialAndMuTable()
               for(int z=0; z<mResolution.z(); z++)
                 {
                   voxelIndex = x+y*lineSize+z*planeSize;
-                  G4Material *material = detectorConstruction->mMaterialDatabase.GetMaterial(volume->GetMaterialNameFromLabel(volume->GetImage()->GetValue(x,y,z)));
-                  mListOfMuTable[voxelIndex] = mMaterialHandler->GetMuTable(region->FindCouple(material));
+                  int imageLabel = (int)lrint(volume->GetImage()->GetValue(x,y,z));
+                  std::map<int, int>::iterator it = labels.find(imageLabel);
+                  if(it == labels.end())
+                    {
+                      G4Material *material = detectorConstruction->mMaterialDatabase.GetMaterial(volume->GetMaterialNameFromLabel(imageLabel));
+                      it = labels.insert(std::make_pair(imageLabel, (int)mListOfMuTable.size())).first;
+                      mListOfMuTable.push_back(mMaterialHandler->GetMuTable(region->FindCouple(material)));
+                    }
+                  labelOfVoxel[voxelIndex] = it->second;
                 }
             }
         }
+      mRayCaster.SetLabels(labelOfVoxel);
+      for(int l=0; l<GateRayCaster::PacketSize; l++)
+        {
+          mSlotMu[l].resize(mListOfMuTable.size());
+          mSlotDoseFactor[l].resize(mListOfMuTable.size());
+          mSlotEnergy[l] = -1.;
+        }
+      mNextSlot = 0;
 
       mIsMuTableInitialized = true;
     }
@@ -341,9 +364,11 @@ void GateSETLEDoseActor::UserSteppingAction(const GateVVolume *v, const G4Step*
                   mNearestDistance = 0.0;
                 }
 
-              weight = RayCast(isPrimary, energy, weight, position, momentum);
+              AddRayToPacket(isPrimary, energy, weight, position, momentum);
+              if(mPacket.size == GateRayCaster::PacketSize) { TracePacket(); }
             }
         }
+      if(mPacket.size > 0) { TracePacket(); }
 
       mListOfRaycasting->clear();
     }
@@ -387,113 +412,82 @@ void GateSETLEDoseActor::UserSteppingActionInVoxel(const int /*index*/, const G4
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-static inline int getIncrement(double value)
+double GateSETLEDoseActor::RayCast(bool isPrimary, double energy, double weight, G4ThreeVector position, G4ThreeVector momentum)
 {
-  if (value > 0.0)
-    return 1;
-  return -1;
+  // Packet of one ray, the length to the exit of the volume is kept for
+  // the hybridino
+  AddRayToPacket(isPrimary, energy, weight, position, momentum);
+  TracePacket();
+  mTotalLength = mPacket.length[0];
+  return mPacket.weight[0];
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-double GateSETLEDoseActor::RayCast(bool isPrimary, double energy, double weight, G4ThreeVector position, G4ThreeVector momentum)
+void GateSETLEDoseActor::AddRayToPacket(bool isPrimary, double energy, double weight, G4ThreeVector position, G4ThreeVector momentum)
 {
-  //   GateMessage("Actor", 0, "  \n";);
-  //   GateMessage("Actor", 0, " halfSize " << mHalfSize << " resolution " << mResolution << " voxelSize " << mVoxSize << Gateendl);
-
-  int xincr = getIncrement(momentum.x());
-  int yincr = getIncrement(momentum.y());
-  int zincr = getIncrement(momentum.z());
-
-  //Momentum norm have to be 1
-  //double norm = momentum.mag();
-  double Lx = xincr * mVoxelSize.x() / momentum.x(); //*norm
-  double Ly = yincr * mVoxelSize.y() / momentum.y(); //*norm
-  double Lz = zincr * mVoxelSize.z() / momentum.z(); //*norm
-  //Coordinates
-  int x, y, z;
-  //Because GateImage is shit
-  //mImage.GetCoordinatesFromPosition(position, x, y, z);
-  double xtemp = (position.x()+mHalfSize.x())/mVoxelSize.x();
-  double ytemp = (position.y()+mHalfSize.y())/mVoxelSize.y();
-  double ztemp = (position.z()+mHalfSize.z())/mVoxelSize.z();
-  x = (int) floor(xtemp);
-  y = (int) floor(ytemp);
-  z = (int) floor(ztemp);
-
-  //Security on matrix boundaries
-  if(x < 0) { x = 0; }
-  else if(x >= mResolution.x()) { x = mResolution.x()-1; }
-
-  if(y < 0) { y = 0; }
-  else if(y >= mResolution.y()) { y = mResolution.y()-1; }
-
-  if(z < 0) { z = 0; }
-  else if(z >= mResolution.z()) { z = mResolution.z()-1; }
-
-  //Remaining and Total lengths
-  double Rx = 1.0e15;
-  double Ry = 1.0e15;
-  double Rz = 1.0e15;
-
-  mTotalLength = 2.0*mHalfSize.x()*mHalfSize.y()*mHalfSize.z();
-  double Ltmp = mTotalLength;
-
-  //   GateMessage("Actor", 0, "increment " << xincr << " " << yincr << " " << zincr << Gateendl);
-
-  if(xincr > 0){
-    Rx = xincr * (-mHalfSize.x() + (x+1)*mVoxelSize.x() - position.x())/momentum.x();
-    mTotalLength = (mHalfSize.x() - position.x())/momentum.x();
-  }
-  else if (momentum.x() < 0){
-    Rx = xincr * (position.x() - (-mHalfSize.x() + x*mVoxelSize.x()))/momentum.x();
-    mTotalLength = (-mHalfSize.x() - position.x())/momentum.x();
-  }
-  else {Rx = 2*mTotalLength;}
-
-  if(yincr > 0){
-    Ry = yincr * (-mHalfSize.y() + (y+1)*mVoxelSize.y() - position.y())/momentum.y();
-    Ltmp = (mHalfSize.y() - position.y())/momentum.y();
-  }
-  else if(momentum.y() < 0){
-    Ry = yincr * (position.y() - (-mHalfSize.y() + y*mVoxelSize.y()))/momentum.y();
-    Ltmp = (-mHalfSize.y() - position.y())/momentum.y();
-  }
-  else {Ry = 2*mTotalLength;}
-  if (Ltmp < mTotalLength) {mTotalLength = Ltmp;}
-
-  if(zincr > 0){
-    Rz = zincr * (-mHalfSize.z() + (z+1)*mVoxelSize.z() - position.z())/momentum.z();
-    Ltmp = (mHalfSize.z() - position.z())/momentum.z();
-  }
-  else if (momentum.z() < 0)  {
-    Rz = zincr * (position.z() - (-mHalfSize.z() + z*mVoxelSize.z()))/momentum.z();
-    Ltmp = (-mHalfSize.z() - position.z())/momentum.z();
-  }
-  else {Rz = 2*mTotalLength;}
-
-  if (Ltmp < mTotalLength) {mTotalLength = Ltmp;}
+  int l = mPacket.size++;
+  mPacketIsPrimary[l] = isPrimary;
+  for(int a=0; a<3; a++)
+    {
+      mPacket.position[a][l] = position[a];
+      mPacket.direction[a][l] = momentum[a];
+    }
+  mPacket.weight[l] = weight;
 
-  //   GateMessage("Actor", 0, "Lx : " << Lx << " Ly " << Ly << " Lz " << Lz << Gateendl);
-  //   GateMessage("Actor", 0, "Rx : " << Rx << " Ry " << Ry << " Rz " << Rz << Gateendl);
-  //   GateMessage("Actor", 0, "entry index " << x << " " << y << " " << z << Gateendl);
-  //   GateMessage("Actor", 0, "LTot" << mTotalLength << Gateendl);
+  // mu (mm-1) and dose factor of each label at the energy of the ray,
+  // computed unless a slot already has them
+  int slot = 0;
+  while(slot < GateRayCaster::PacketSize && mSlotEnergy[slot] != energy) { slot++; }
+  if(slot == GateRayCaster::PacketSize)
+    {
+      // next slot not used by the previous rays of the packet (there is
+      // one, the packet has less than PacketSize rays)
+      bool isUsed = true;
+      while(isUsed)
+        {
+          slot = mNextSlot;
+          mNextSlot = (mNextSlot+1) % GateRayCaster::PacketSize;
+          isUsed = false;
+          for(int r=0; r<l; r++) { if(mPacketSlot[r] == slot) { isUsed = true; } }
+        }
+      std::vector<double> &mu = mSlotMu[slot];
+      std::vector<double> &doseFactor = mSlotDoseFactor[slot];
+      for(size_t label=0; label<mListOfMuTable.size(); label++)
+        {
+          double muLabel = mListOfMuTable[label]->GetMu(energy);
+          double muenOverRho = mListOfMuTable[label]->GetMuEnOverRho(energy);
+          mu[label] = muLabel/10.;
+          doseFactor[label] = ConversionFactor*energy*muenOverRho/muLabel/VoxelVolume;
+        }
+      mSlotEnergy[slot] = energy;
+    }
+  mPacketSlot[l] = slot;
+  mPacket.mu[l] = &mSlotMu[slot][0];
+}
+//-----------------------------------------------------------------------------
 
-  int index = 0;
-  double dose = 0.0;
-  double L = 0.0;
+//-----------------------------------------------------------------------------
+void GateSETLEDoseActor::TracePacket()
+{
+  mSegments.clear();
+  mRayCaster.Trace(mPacket, mSegments);
+  for(size_t s=0; s<mSegments.size(); s++) { ScoreSegment(mSegments[s]); }
+  mPacket.size = 0;
+}
+//-----------------------------------------------------------------------------
 
-  double delta_in  = weight;
-  double delta_out(0.0);
-  double mu(0.0);
-  double muenOverRho(0.0);
+//-----------------------------------------------------------------------------
+void GateSETLEDoseActor::ScoreSegment(const GateRaySegment &segment)
+{
+  int index = segment.index;
 
   // test on dose contribution: primary or secondary ?
   GateImageWithStatistic *currentDoseImage = 0;
   GateImage *currentLastHitImage = 0;
   bool isCurrentLastHitImageEnabled = false;
   bool isCurrentDoseUncertaintyEnabled = false;
-  if(isPrimary)
+  if(mPacketIsPrimary[segment.ray])
     {
       if(mIsPrimaryDoseImageEnabled)
         {
@@ -511,93 +505,49 @@ double GateSETLEDoseActor::RayCast(bool isPrimary, double energy, double weight,
       currentLastHitImage = &mSecondaryLastHitEventImage;
     }
 
-  while(L < mTotalLength-0.00001)
+  bool sameEvent = true;
+  if(mIsLastHitEventImageEnabled)
     {
-      //     GateMessage("Actor", 0, " index " << x << " " << y << " " << z << " | Rest " << Rx << " " << Ry << " " << Rz << " | L " << L << " mTotalLength " << mTotalLength << Gateendl);
-      //     GateMessage("Actor", 0, " Rest  " << Rx << " " << Ry << " " << Rz << Gateendl);
-      //     GateMessage("Actor", 0, "L " << L << " mTotalLength " << mTotalLength << Gateendl);
-      //     GateMessage("Actor", 0, "Volume = " << GetVolume()->GetLogicalVolumeName() << Gateendl);
-      //     GateMessage("Actor", 0, "material 1 : " << volume->GetMaterialNameFromLabel(volume->GetImage()->GetValue(x,y,z)) << Gateendl);
-      //     GateMessage("Actor", 0, "label : " << volume->GetImage()->GetValue(0,0,0) << " " << volume->GetMaterialNameFromLabel(volume->GetImage()->GetValue(0,0,0)) << Gateendl);
-
-      index = x+y*mLineSize+z*mPlaneSize;
-
-      bool sameEvent = true;
-      if(mIsLastHitEventImageEnabled)
+      GateDebugMessage("Actor", 2,  "GateSETLEDoseActor -- ScoreSegment: Last event in index = " << mLastHitEventImage.GetValue(index) << Gateendl);
+      if(mCurrentEvent != mLastHitEventImage.GetValue(index))
         {
-          GateDebugMessage("Actor", 2,  "GateSETLEDoseActor -- UserSteppingActionInVoxel: Last event in index = " << mLastHitEventImage.GetValue(index) << Gateendl);
-          if(mCurrentEvent != mLastHitEventImage.GetValue(index))
-            {
-              sameEvent = false;
-              mLastHitEventImage.SetValue(index, mCurrentEvent);
-            }
+          sameEvent = false;
+          mLastHitEventImage.SetValue(index, mCurrentEvent);
         }
+    }
 
-      bool currentContributionSameEvent = true;
-      if(isCurrentLastHitImageEnabled)
+  bool currentContributionSameEvent = true;
+  if(isCurrentLastHitImageEnabled)
+    {
+      GateDebugMessage("Actor", 2,  "GateSETLEDoseActor -- ScoreSegment: Last event in index = " << currentLastHitImage->GetValue(index) << Gateendl);
+      if(mCurrentEvent != currentLastHitImage->GetValue(index))
         {
-          GateDebugMessage("Actor", 2,  "GateSETLEDoseActor -- UserSteppingActionInVoxel: Last event in index = " << currentLastHitImage->GetValue(index) << Gateendl);
-          if(mCurrentEvent != currentLastHitImage->GetValue(index))
-            {
-              currentContributionSameEvent = false;
-              currentLastHitImage->SetValue(index, mCurrentEvent);
-            }
+          currentContributionSameEvent = false;
+          currentLastHitImage->SetValue(index, mCurrentEvent);
         }
+    }
 
-      mu = mListOfMuTable[index]->GetMu(energy);
-      muenOverRho = mListOfMuTable[index]->GetMuEnOverRho(energy);
-
-      if(Rx < Ry && Rx < Rz){
-        delta_out = delta_in*exp(-mu*Rx/10.);
-        L+=Rx;
-        Ry-=Rx;
-        Rz-=Rx;
-        Rx=Lx;
-        x+=xincr;
-      }
-      else if (Ry < Rz){
-        delta_out = delta_in*exp(-mu*Ry/10.);
-        L+=Ry;
-        Rx-=Ry;
-        Rz-=Ry;
-        Ry=Ly;
-        y+=yincr;
-      }
-      else{
-        delta_out = delta_in*exp(-mu*Rz/10.);
-        L+=Rz;
-        Rx-=Rz;
-        Ry-=Rz;
-        Rz=Lz;
-        z+=zincr;
-      }
-
-      dose = ConversionFactor*energy*muenOverRho*(delta_in-delta_out)/mu/VoxelVolume;
+  double dose = mSlotDoseFactor[mPacketSlot[segment.ray]][segment.label]*(segment.weightIn-segment.weightOut);
 
-      if(mIsDoseImageEnabled)
+  if(mIsDoseImageEnabled)
+    {
+      if(mIsDoseUncertaintyImageEnabled)
         {
-          if(mIsDoseUncertaintyImageEnabled)
-            {
-              if(sameEvent) { mDoseImage.AddTempValue(index, dose); }
-              else { mDoseImage.AddValueAndUpdate(index, dose); }
-            }
-          else { mDoseImage.AddValue(index, dose); }
+          if(sameEvent) { mDoseImage.AddTempValue(index, dose); }
+          else { mDoseImage.AddValueAndUpdate(index, dose); }
         }
+      else { mDoseImage.AddValue(index, dose); }
+    }
 
-      if(currentDoseImage)
+  if(currentDoseImage)
+    {
+      if(isCurrentDoseUncertaintyEnabled)
         {
-          if(isCurrentDoseUncertaintyEnabled)
-            {
-              if(currentContributionSameEvent) { currentDoseImage->AddTempValue(index, dose); }
-              else { currentDoseImage->AddValueAndUpdate(index, dose); }
-            }
-          else { currentDoseImage->AddValue(index, dose); }
+          if(currentContributionSameEvent) { currentDoseImage->AddTempValue(index, dose); }
+          else { currentDoseImage->AddValueAndUpdate(index, dose); }
         }
-
-      delta_in = delta_out;
+      else { currentDoseImage->AddValue(index, dose); }
     }
-
-  return delta_out;
 }
 //-----------------------------------------------------------------------------
 
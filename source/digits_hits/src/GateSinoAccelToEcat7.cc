@@ -290,11 +290,12 @@ void GateSinoAccelToEcat7::FillData()
   GateToSinoAccel* setMaker = m_system->GetSinogramMaker();
   G4int  bin,seg,segment_occurance,data_size,nz,frame,plane,gate,data,bed,matnum,
          nblks,tot_data_size,blkno,file_pos,offset,csize,ringdiff,ring_1_min,ring_1_max,
-	 view,ring_1,ring_2,elem,z,sinoID,bin_sdata,bin_m_data;
+	 view,ring_1,ring_2,elem,z,sinoID,bin_sdata;
   short  *sdata;
   char   *cdata;
   struct MatDir matdir, dir_entry;
-  GateSinogram::SinogramDataType *m_data, *m_randoms;
+  const GateSinogram::SinogramDataType *m_data;
+  GateSinogram::SinogramDataType *m_randoms;
 
   // Fill subheader
   seg = 0;
@@ -391,10 +392,9 @@ void GateSinoAccelToEcat7::FillData()
             G4cout << "    rings " << ring_1 << "," << ring_2  << " give sino ID " << sinoID << Gateendl;
 	  }
           //  m_system->GetProjectionSetMaker()->GetProjectionSet()->StreamOut( m_dataFile , headID );
-          m_data = setMaker->GetSinogram()->GetSinogram(sinoID);
-	  bin_m_data = view * setMaker->GetRadialElemNb(); // sinogram ordering
+          m_data = setMaker->GetSinogram()->GetView(sinoID,view);
 	  bin_sdata = z * sh->num_r_elements + view / m_mashing * nz * sh->num_r_elements; // view ordering
-	  for (elem=0; elem<sh->num_r_elements; elem++) sdata[bin_sdata+elem] += (short int) m_data[bin_m_data+elem];
+	  for (elem=0; elem<sh->num_r_elements; elem++) sdata[bin_sdata+elem] += (short int) m_data[elem];
 	}
       }
       for (ring_1 = ring_1_min; ring_1 <= ring_1_max; ++ring_1) {
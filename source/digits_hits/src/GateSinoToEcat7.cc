@@ -358,7 +358,8 @@ void GateSinoToEcat7::FillData(GateSinogram* setSino)
   GateToSinogram* setMaker = m_system->GetSinogramMaker();
   G4int  bin,seg,segment_occurance,data_size,nz,frame,data,
          tot_data_size,file_pos,offset,ringdiff,ring_1_min,ring_1_max,
-	 view,ring_1,ring_2,elem,z,sinoID,bin_sdata,bin_m_data,nsino;
+	 view,ring_1,ring_2,elem,z,sinoID,bin_sdata,nsino,sinoMashing;
+  size_t tofBinID;
 #ifdef GATE_USE_ECAT7
   G4int  plane,gate,bed,csize;
   char   *cdata=NULL;
@@ -372,7 +373,17 @@ void GateSinoToEcat7::FillData(GateSinogram* setSino)
   struct MatDir matdir, dir_entry;
   int    matnum,nblks,blkno;
   #endif
-  GateSinogram::SinogramDataType *m_data, *m_randoms;
+  const GateSinogram::SinogramDataType *m_data;
+  GateSinogram::SinogramDataType *m_randoms;
+
+  // Sinograms compressed while filled: their mashing and span must fit the ecat7 ones
+  if (m_mashing % setSino->GetMashing() != 0) {
+    G4Exception("GateSinoToEcat7::FillData", "FillData", FatalException, "The ecat7 mashing must be a multiple of the sinogram mashing");
+  }
+  sinoMashing = m_mashing / setSino->GetMashing();
+  if (setSino->GetSpan() > 1 && (setSino->GetSpan() != (size_t) m_span || (size_t) m_maxRingDiff > setSino->GetMaxRingDiff())) {
+    G4Exception("GateSinoToEcat7::FillData", "FillData", FatalException, "The ecat7 span must be the sinogram span, with a maximum ring difference stored in the sinograms");
+  }
 
   // Fill subheader
   frame = setSino->GetCurrentFrameID();
@@ -489,6 +500,31 @@ void GateSinoToEcat7::FillData(GateSinogram* setSino)
     }
     data_size = nz * sh->num_r_elements * sh->num_angles;
     for (bin=0;bin<data_size;bin++) sdata[bin] = 0;
+    if (setSino->GetSpan() > 1) {
+      // 2D sinograms already grouped by segment while filled
+      for (view=0;view<sh->num_angles*sinoMashing;view++) {
+        for (z=0; z<nz; z++) {
+	  sinoID = setSino->GetCompressedSinoID(m_segment[segment_occurance], z + m_zMinSeg[segment_occurance]);
+	  if (sinoID < 0 || sinoID >= (G4int) setSino->GetSinogramNb()) {
+	    G4Exception("GateToSinogram::FillData", "FillData", FatalException, "Wrong 2D sinogram ID");
+	  }
+          if (m_ecatVersion == 7) {
+	    bin_sdata = z * sh->num_r_elements + view / sinoMashing * nz * sh->num_r_elements; // view ordering
+          } else {
+	    bin_sdata = view / sinoMashing * sh->num_r_elements + z * sh->num_angles * sh->num_r_elements; // sino ordering
+          }
+	  for (tofBinID=0; tofBinID<setSino->GetTOFBinNb(); tofBinID++) {
+	    m_data = setSino->GetView(sinoID,view,tofBinID);
+	    for (elem=0; elem<sh->num_r_elements; elem++) sdata[bin_sdata+elem] += (short int) m_data[elem];
+	  }
+	}
+      }
+      m_randoms = setSino->GetRandoms();
+      for (z=0; z<nz; z++) {
+	sinoID = setSino->GetCompressedSinoID(m_segment[segment_occurance], z + m_zMinSeg[segment_occurance]);
+        if (data == 0) sh->delayed += (short int) m_randoms[sinoID];
+      }
+    } else
     // loop on the ring differences
     for (ringdiff = m_delRingMinSeg[segment_occurance]; ringdiff <= m_delRingMaxSeg[segment_occurance]; ringdiff++) {
       if (ringdiff <= 0) {
@@ -499,7 +535,7 @@ void GateSinoToEcat7::FillData(GateSinogram* setSino)
         ring_1_max = setMaker->GetRingNb() - ringdiff -1;
       }
       // loop on the azimuthal angle
-      for (view=0;view<sh->num_angles*m_mashing;view++) {
+      for (view=0;view<sh->num_angles*sinoMashing;view++) {
         // loop on the axial position
 	for (ring_1 = ring_1_min; ring_1 <= ring_1_max; ++ring_1) {
 	  ring_2 = ring_1 + ringdiff;
@@ -513,23 +549,24 @@ void GateSinoToEcat7::FillData(GateSinogram* setSino)
             G4cout << " >> ring difference " << ringdiff << ", slice " << z << Gateendl;
             G4cout << "    rings " << ring_1 << "," << ring_2  << " give sino ID " << sinoID << Gateendl;
 	  }
-          m_data = setSino->GetSinogram(sinoID);
-	  bin_m_data = view * setMaker->GetRadialElemNb(); // sino ordering
           // CC, 10.02.2011 : allows for span 1
           if (m_span == 1) {
             if (m_ecatVersion == 7) {
-	      bin_sdata = (z/2) * sh->num_r_elements + view / m_mashing * nz * sh->num_r_elements; // view ordering
+	      bin_sdata = (z/2) * sh->num_r_elements + view / sinoMashing * nz * sh->num_r_elements; // view ordering
             } else {
-	      bin_sdata = view / m_mashing * sh->num_r_elements + (z/2) * sh->num_angles * sh->num_r_elements; // sino ordering
+	      bin_sdata = view / sinoMashing * sh->num_r_elements + (z/2) * sh->num_angles * sh->num_r_elements; // sino ordering
             }
           } else {
             if (m_ecatVersion == 7) {
- 	      bin_sdata = z * sh->num_r_elements + view / m_mashing * nz * sh->num_r_elements; // view ordering
+ 	      bin_sdata = z * sh->num_r_elements + view / sinoMashing * nz * sh->num_r_elements; // view ordering
             } else {
-	      bin_sdata = view / m_mashing * sh->num_r_elements + z * sh->num_angles * sh->num_r_elements; // sino ordering
+	      bin_sdata = view / sinoMashing * sh->num_r_elements + z * sh->num_angles * sh->num_r_elements; // sino ordering
             }
           }
-	  for (elem=0; elem<sh->num_r_elements; elem++) sdata[bin_sdata+elem] += (short int) m_data[bin_m_data+elem];
+	  for (tofBinID=0; tofBinID<setSino->GetTOFBinNb(); tofBinID++) {
+	    m_data = setSino->GetView(sinoID,view,tofBinID);
+	    for (elem=0; elem<sh->num_r_elements; elem++) sdata[bin_sdata+elem] += (short int) m_data[elem];
+	  }
 	}
       }
       for (ring_1 = ring_1_min; ring_1 <= ring_1_max; ++ring_1) {
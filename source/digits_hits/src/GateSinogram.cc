@@ -26,20 +26,15 @@ See LICENSE.md for further details
 
 // for std::abs
 #include <cmath>
+#include <climits>
+#include <algorithm>
 
 // Reset the matrix and prepare a new acquisition
 void GateSinogram::Reset(size_t ringNumber, size_t crystalNumber, size_t radialElemNb, size_t virtualRingNumber, size_t virtualCrystalPerBlockNumber)
 {
-   size_t sinoID;
-
   // Fist clean-up the result of a previous acqisition (if any)
-  if (m_data) {
-    for (sinoID=0;sinoID<m_sinogramNb;sinoID++) {
-      free(m_data[sinoID]);
-    }
-    free(m_data);
-    m_data=0;
-  }
+  FreeBlocks();
+  m_zeroView.clear();
   if (m_randomsNb) {
     free(m_randomsNb);
     m_randomsNb=0;
@@ -63,21 +58,29 @@ void GateSinogram::Reset(size_t ringNumber, size_t crystalNumber, size_t radialE
     return;
   }
 
-  if (nVerboseLevel > 2) {
-    G4cout << " >> Allocating " << m_sinogramNb << " 2D sinograms of " << m_radialElemNb <<
-              " radial element X " << m_crystalNb/2 << " views each\n";
+  // Compression: views mashed, ring differences grouped by segments of span ring differences
+  if (m_tofBinNb < 1) m_tofBinNb = 1;
+  if (m_mashing < 1) m_mashing = 1;
+  if (m_span < 1) m_span = 1;
+  if ((m_crystalNb/2) % m_mashing != 0) {
+    G4Exception( "GateSinogram::Reset", "Reset", FatalException, "The number of views is not a multiple of the mashing factor\n");
   }
-  // Allocate the data pointer
-  m_data = (SinogramDataType**) malloc( m_sinogramNb * sizeof(SinogramDataType*) );
-  if (!m_data) {
-    G4Exception( "GateSinogram::Reset", "Reset", FatalException, "Could not allocate a 2D sinogram set (out of memory?)\n");
+  if (m_span > 1 && m_span % 2 == 0) {
+    G4Exception( "GateSinogram::Reset", "Reset", FatalException, "The span factor must be odd\n");
   }
-  // Do the allocations for each 2D sinogram
-  for (sinoID=0;sinoID<m_sinogramNb;sinoID++) {
-    m_data[sinoID] = (SinogramDataType*) malloc( BytesPerSinogram() );
-    if (!(m_data[sinoID])) {
-     G4Exception( "GateSinogram::Reset", "Reset", FatalException, "Could not allocate a new 2D sinogram (out of memory?)\n");
-    }
+  m_viewNb = m_crystalNb/2/m_mashing;
+  if (m_span > 1) {
+    if (m_maxRingDiff == 0 || m_maxRingDiff >= m_ringNb) m_maxRingDiff = m_ringNb-1;
+    m_segmentNb = (m_maxRingDiff + (m_span-1)/2)/m_span;
+    m_sinogramNb = (2*m_segmentNb+1)*(2*m_ringNb-1);
+  }
+  m_viewsPerBlock = std::min<size_t>(8, m_viewNb);
+  m_blocksPerSinogram = (m_viewNb + m_viewsPerBlock - 1)/m_viewsPerBlock;
+  m_zeroView.assign(m_radialElemNb, 0);
+
+  if (nVerboseLevel > 2) {
+    G4cout << " >> Preparing " << m_sinogramNb << " 2D sinograms of " << m_radialElemNb <<
+              " radial element X " << m_viewNb << " views each, for " << m_tofBinNb << " TOF bins\n";
   }
   // Allocate the randoms pointer
   m_randomsNb = (SinogramDataType*) calloc( m_sinogramNb , sizeof(SinogramDataType) );
@@ -85,26 +88,63 @@ void GateSinogram::Reset(size_t ringNumber, size_t crystalNumber, size_t radialE
 }
 
 
+// Free the blocks of the 2D sinograms
+void GateSinogram::FreeBlocks()
+{
+  for (std::unordered_map<size_t,SinogramDataType*>::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    free(it->second);
+  m_blocks.clear();
+}
+
+
 // Clear the matrix and prepare a new run
 void GateSinogram::ClearData(size_t frameID, size_t gateID, size_t dataID, size_t bedID)
 {
-  size_t sinoID;
-
   // Store the 4D sinogram ID
   m_currentFrameID = frameID;
   m_currentGateID = gateID;
   m_currentDataID = dataID;
   m_currentBedID = bedID;
 
-  // Clear the data sets
+  // Clear the data sets: the blocks are allocated again at their first count
   if (nVerboseLevel > 2) {
     G4cout << " >> Reseting " << m_sinogramNb << " 2D sinograms to 0 \n";
     G4cout << "    for frame " << m_currentFrameID << ", gate " << m_currentGateID <<
               ", data " << m_currentDataID << ", bed " << m_currentBedID << Gateendl;
   }
-  for (sinoID=0;sinoID<m_sinogramNb;sinoID++)
-    memset(m_data[sinoID],0, BytesPerSinogram() );
-  memset(m_randomsNb,0,m_sinogramNb * sizeof(SinogramDataType));
+  FreeBlocks();
+  if (m_randomsNb) memset(m_randomsNb,0,m_sinogramNb * sizeof(SinogramDataType));
+}
+
+
+// Returns the memory used by the allocated blocks (bytes)
+size_t GateSinogram::GetAllocatedBytes() const
+{
+  return m_blocks.size() * m_viewsPerBlock * m_radialElemNb * sizeof(SinogramDataType);
+}
+
+
+// Returns the memory that the sinograms would use with all their blocks allocated (bytes)
+double GateSinogram::GetDenseBytes() const
+{
+  return (double) m_tofBinNb * m_sinogramNb * PixelsPerSinogram() * sizeof(SinogramDataType);
+}
+
+
+// Returns one view of a 2D sinogram (a row of zeros if it has no count)
+const GateSinogram::SinogramDataType* GateSinogram::GetView(size_t sinoID, size_t viewID, size_t tofBinID) const
+{
+  size_t blockID = (tofBinID * m_sinogramNb + sinoID) * m_blocksPerSinogram + viewID / m_viewsPerBlock;
+  std::unordered_map<size_t,SinogramDataType*>::const_iterator it = m_blocks.find(blockID);
+  if (it == m_blocks.end()) return &m_zeroView[0];
+  return it->second + (viewID % m_viewsPerBlock) * m_radialElemNb;
+}
+
+
+// Returns the 2D sino ID of a segment and an axial position (ring1+ring2), with a span > 1
+G4int GateSinogram::GetCompressedSinoID( G4int segment, G4int axialPosition) const
+{
+  return (segment + m_segmentNb) * (2*m_ringNb-1) + axialPosition;
 }
 
 G4int GateSinogram::GetSinoID( G4int ring1ID, G4int ring2ID)
@@ -124,6 +164,13 @@ G4int GateSinogram::GetSinoID( G4int ring1ID, G4int ring2ID)
   // original: sinoID = ring1ID + ring2ID*m_ringNb;
   DeltaZ = ring2ID-ring1ID;
   if (DeltaZ < 0) ADeltaZ = -DeltaZ; else ADeltaZ = DeltaZ;
+  if (m_span > 1) {
+    // segment of the ring difference, as in GateSinoToEcat7
+    if (ADeltaZ > (G4int) m_maxRingDiff) return -3;
+    G4int segment = (ADeltaZ + ((G4int) m_span-1)/2)/(G4int) m_span;
+    if (DeltaZ < 0) segment = -segment;
+    return GetCompressedSinoID(segment, ring1ID+ring2ID);
+  }
   sinoID = (ring1ID+ring2ID-ADeltaZ)/2;
   if (ADeltaZ > 0) sinoID += m_ringNb;
   if (ADeltaZ > 1) for (i=1;i<ADeltaZ;i++) sinoID += 2*(m_ringNb-i);
@@ -135,6 +182,8 @@ G4int GateSinogram::FillRandoms( G4int ring1ID, G4int ring2ID)
 {
   G4int sinoID;
   sinoID = GetSinoID(ring1ID,ring2ID);
+  // Ring difference not stored (span > 1)
+  if (sinoID == -3) return -9;
   // Check that the ID is valid
   if ( (sinoID<0) || (sinoID>=(G4int) m_sinogramNb) ) {
     G4cerr << "[GateToSinogram::FillRandoms]:\n"
@@ -142,10 +191,10 @@ G4int GateSinogram::FillRandoms( G4int ring1ID, G4int ring2ID)
     return -2;
   }
   SinogramDataType& dest = m_randomsNb[sinoID];
-  if (dest<SHRT_MAX) {
+  if (dest<INT_MAX) {
     dest++;
   } else {
-    G4cerr  << "[GateSinogram]: bin of 2D sinogram " << sinoID << " for randoms has reached its maximum value (" << SHRT_MAX
+    G4cerr  << "[GateSinogram]: bin of 2D sinogram " << sinoID << " for randoms has reached its maximum value (" << INT_MAX
             << "): hit will be lost!\n";
     return -7;
   }
@@ -169,7 +218,7 @@ void GateSinogram::CrystalBlurring( G4int *ringID, G4int *crystalID, G4double ri
 }
 
 // Store a digi into a projection
-G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int crystal2ID, int signe)
+G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int crystal2ID, int signe, G4int tofBinID)
 {
 
   size_t  binElemID, binViewID;
@@ -179,6 +228,8 @@ G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int
   if (nVerboseLevel > 3) {
     G4cout << " >> [GateSinogram::Fill]: rings " << ring1ID << "," << ring2ID  << " give sino ID " << sinoID << Gateendl;
   }
+  // Ring difference not stored (span > 1)
+  if (sinoID == -3) return -9;
   // Check that the IDs are valid
   if ( (sinoID<0) || (sinoID>=(G4int) m_sinogramNb) ) {
     G4cerr << "[GateSinogram::Fill]:\n"
@@ -238,7 +289,21 @@ G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int
       G4cout << " >> [GateSinogram::Fill]: binning LOR at (" <<  crystal1ID << "," << ring1ID << ")-(" << crystal2ID  << ","
       << ring2ID << ") into sinogram bin (" << binElemID << "," << binViewID <<
       ") of 2D sinogram (" << ring1ID+ring2ID << "," << ring2ID-ring1ID << ")\n";
-  SinogramDataType& dest = m_data[sinoID][ binElemID + binViewID * m_radialElemNb];
+  if ( (tofBinID<0) || (tofBinID>=(G4int) m_tofBinNb) ) {
+    G4cerr << "[GateSinogram::Fill]:\n"
+      	   << "Received a hit with a wrong TOF bin ID (" << tofBinID << "): ignored!\n";
+    return -10;
+  }
+
+  // Block of the view, allocated at its first count
+  binViewID /= m_mashing;
+  size_t blockID = (tofBinID * m_sinogramNb + sinoID) * m_blocksPerSinogram + binViewID / m_viewsPerBlock;
+  SinogramDataType*& block = m_blocks[blockID];
+  if (!block) {
+    block = (SinogramDataType*) calloc( m_viewsPerBlock * m_radialElemNb, sizeof(SinogramDataType) );
+    if (!block) G4Exception( "GateSinogram::Fill", "Fill", FatalException, "Could not allocate a new block of 2D sinogram (out of memory?)\n");
+  }
+  SinogramDataType& dest = block[ binElemID + (binViewID % m_viewsPerBlock) * m_radialElemNb];
 
   if (signe > 0) {
     dest++;
@@ -249,8 +314,8 @@ G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int
     G4cerr <<   "[GateSinogram::Fill]: filling signe not provided\n";
     return -8;
   }
-  /*if (dest>=SHRT_MAX || dest<=SHRT_MIN) {
-    G4cerr  << "[GateSinogram]: bin (" << binElemID << "," << binViewID << ") of 2D sinogram " << sinoID << " has reached its maximum value (" << SHRT_MAX << "): hit will be lost!\n";
+  /*if (dest>=INT_MAX || dest<=INT_MIN) {
+    G4cerr  << "[GateSinogram]: bin (" << binElemID << "," << binViewID << ") of 2D sinogram " << sinoID << " has reached its maximum value (" << INT_MAX << "): hit will be lost!\n";
     return -7;
   }*/
   return 0;
@@ -262,13 +327,17 @@ G4int GateSinogram::Fill( G4int ring1ID, G4int ring2ID, G4int crystal1ID, G4int
 
    dest:    	  the destination stream
    sinoID:    	  the 2D sinogram whose data to stream-out
+   seekID:    	  the position of the 2D sinogram in the stream
+   tofBinID:      the time-of-flight bin whose data to stream-out
 */
-void GateSinogram::StreamOut(std::ofstream& dest, size_t sinoID, size_t seekID)
+void GateSinogram::StreamOut(std::ofstream& dest, size_t sinoID, size_t seekID, size_t tofBinID)
 {
     if (sinoID >= m_sinogramNb) G4Exception( "GateSinogram::StreamOut", "StreamOut", FatalException, "SinoID out of range !\n");
+    if (tofBinID >= m_tofBinNb) G4Exception( "GateSinogram::StreamOut", "StreamOut", FatalException, "TOF bin ID out of range !\n");
     dest.seekp(seekID * BytesPerSinogram(),std::ios::beg);
     if ( dest.bad() ) G4Exception( "GateSinogram::StreamOut", "StreamOut", FatalException, "Could not write a 2D sinogram onto the disk (out of disk space?)!\n");
-    dest.write((const char*)(m_data[sinoID]),BytesPerSinogram() );
+    for (size_t viewID=0; viewID<m_viewNb; viewID++)
+      dest.write((const char*)(GetView(sinoID,viewID,tofBinID)),m_radialElemNb * BytesPerPixel() );
     if ( dest.bad() ) G4Exception( "GateToSinogram:StreamOut", "StreamOut", FatalException, "Could not write a 2D sinogram onto the disk (out of disk space?)!\n");
     dest.flush();
 }
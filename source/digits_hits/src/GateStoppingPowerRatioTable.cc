@@ -0,0 +1,173 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateStoppingPowerRatioTable.hh"
+#include "GateMiscFunctions.hh"
+
+#include <G4EmCalculator.hh>
+#include <G4SystemOfUnits.hh>
+#include <cfloat>
+#include <cmath>
+
+// Coarsest and finest grids tried when building a table (bins per decade)
+static const int kMinBinsPerDecade = 10;
+static const int kMaxBinsPerDecade = 1280;
+
+//-----------------------------------------------------------------------------
+GateStoppingPowerRatioTable::GateStoppingPowerRatioTable()
+{
+  mEmCalculator = new G4EmCalculator;
+  mReferenceMaterial = 0;
+  mTolerance = 1e-4;
+  mNumberOfTables = 0;
+  mNumberOfNodes = 0;
+  mLastParticle = 0;
+  mLastTables = 0;
+  SetEnergyRange(1*keV, 10*GeV);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateStoppingPowerRatioTable::~GateStoppingPowerRatioTable()
+{
+  Clear();
+  delete mEmCalculator;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateStoppingPowerRatioTable::SetEnergyRange(double emin, double emax)
+{
+  if (emin <= 0 || emax <= emin) {
+    GateError("GateStoppingPowerRatioTable: wrong energy range "
+              << emin << " " << emax);
+  }
+  Clear();
+  mEnergyMin = emin;
+  mEnergyMax = emax;
+  mLogEnergyMin = std::log(emin);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateStoppingPowerRatioTable::Clear()
+{
+  for (auto & pt:mTables)
+    for (auto t:pt.second) delete t;
+  mTables.clear();
+  mLastParticle = 0;
+  mLastTables = 0;
+  mNumberOfTables = 0;
+  mNumberOfNodes = 0;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateStoppingPowerRatioTable::Build(const std::vector<const G4ParticleDefinition*> & particles,
+                                        const std::vector<G4Material*> & materials)
+{
+  for (auto p:particles)
+    for (auto m:materials)
+      FindOrBuildTable(p, m);
+  GateMessage("Actor", 1, "[GateStoppingPowerRatioTable] reference "
+              << mReferenceMaterial->GetName() << " : "
+              << mNumberOfTables << " tables, "
+              << mNumberOfNodes << " nodes, tolerance "
+              << mTolerance << Gateendl);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+double GateStoppingPowerRatioTable::ComputeRatio(const G4ParticleDefinition * p,
+                                                 const G4Material * m,
+                                                 double energy)
+{
+  const double dedx = mEmCalculator->ComputeTotalDEDX(energy, p, m, DBL_MAX);
+  const double dedx_ref = mEmCalculator->ComputeTotalDEDX(energy, p, mReferenceMaterial, DBL_MAX);
+  if (dedx == 0 || dedx_ref == 0) return 0.0;
+  return dedx_ref/dedx;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+double GateStoppingPowerRatioTable::ComputeNodeRatio(const G4ParticleDefinition * p,
+                                                     const G4Material * m,
+                                                     double energy)
+{
+  const double r = ComputeRatio(p, m, energy);
+  if (r == 0.0) return -1.0;
+  return r;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateStoppingPowerRatioTable::RatioTable *
+GateStoppingPowerRatioTable::FindOrBuildTable(const G4ParticleDefinition * p,
+                                              const G4Material * m)
+{
+  MaterialTablesType & tables = mTables[p];
+  if (tables.size() <= m->GetIndex()) tables.resize(G4Material::GetNumberOfMaterials(), 0);
+  if (!tables[m->GetIndex()]) tables[m->GetIndex()] = BuildTable(p, m);
+  mLastParticle = p;
+  mLastTables = &tables;
+  return tables[m->GetIndex()];
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateStoppingPowerRatioTable::RatioTable *
+GateStoppingPowerRatioTable::BuildTable(const G4ParticleDefinition * p,
+                                        const G4Material * m)
+{
+  const double decades = std::log10(mEnergyMax/mEnergyMin);
+  RatioTable * t = new RatioTable;
+
+  // Refine the grid until every bin middle is within tolerance
+  for(int binsPerDecade = kMinBinsPerDecade; ; binsPerDecade *= 2) {
+    const int nbins = (int)std::ceil(decades*binsPerDecade);
+    const double logStep = std::log(mEnergyMax/mEnergyMin)/nbins;
+    t->mInvLogStep = 1.0/logStep;
+    // One extra node to be safe with rounding at mEnergyMax
+    t->mRatio.resize(nbins+2);
+    for(int i=0; i<nbins+2; i++)
+      t->mRatio[i] = ComputeNodeRatio(p, m, std::exp(mLogEnergyMin + i*logStep));
+
+    if (binsPerDecade >= kMaxBinsPerDecade) {
+      GateWarning("GateStoppingPowerRatioTable: tolerance " << mTolerance
+                  << " not reached for " << p->GetParticleName()
+                  << " in " << m->GetName());
+      break;
+    }
+
+    bool ok = true;
+    for(int i=0; i<nbins && ok; i++) {
+      const double r0 = t->mRatio[i];
+      const double r1 = t->mRatio[i+1];
+      if (r0 < 0.0 || r1 < 0.0) continue; // exact computation is used there
+      const double exact = ComputeRatio(p, m, std::exp(mLogEnergyMin + (i+0.5)*logStep));
+      if (exact == 0.0) continue;
+      ok = (std::fabs(0.5*(r0+r1) - exact) <= mTolerance*exact);
+    }
+    if (ok) break;
+  }
+
+  mNumberOfTables++;
+  mNumberOfNodes += t->mRatio.size();
+  GateMessage("Actor", 3, "[GateStoppingPowerRatioTable] " << p->GetParticleName()
+              << " in " << m->GetName() << " : " << t->mRatio.size() << " nodes" << Gateendl);
+  return t;
+}
+//-----------------------------------------------------------------------------
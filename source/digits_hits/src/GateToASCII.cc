@@ -145,8 +145,7 @@ void GateToASCII::RecordEndOfRun(const G4Run * )
   if (nVerboseLevel > 2)
     G4cout << "GateToASCII::RecordEndOfRun\n";
   if (m_outFileRunsFlag) {
-    G4int nEvent = ((GatePrimaryGeneratorAction*)GateRunManager::GetRunManager()->
-		    GetUserPrimaryGeneratorAction())->GetEventNumber();
+    G4int nEvent = GatePrimaryGeneratorAction::GetPrimaryGeneratorAction()->GetEventNumber();
     if (nVerboseLevel > 0) G4cout
                              << "GateToASCII::RecordEndOfRun: Events in the past run: " << nEvent << Gateendl;
     m_outFileRun
@@ -126,8 +126,7 @@ void GateToBinary::RecordEndOfRun( G4Run const* )
   if( m_outFileRunsFlag )
     {
       G4int nEvent =
-        ( ( (GatePrimaryGeneratorAction*)GateRunManager::GetRunManager()->
-            GetUserPrimaryGeneratorAction())->GetEventNumber() );
+        ( GatePrimaryGeneratorAction::GetPrimaryGeneratorAction()->GetEventNumber() );
 
       if( nVerboseLevel > 0 )
         {
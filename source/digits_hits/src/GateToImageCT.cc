@@ -390,7 +390,7 @@ void GateToImageCT::RecordBeginOfEvent( const G4Event* aEvent )
   if( fabs( newPosition.getX() ) > m_detectorInX / 2
       || fabs( newPosition.getY() )  > m_detectorInY / 2 )
     {
-      GateRunManager::GetRunManager()->AbortEvent();
+      G4RunManager::GetRunManager()->AbortEvent();
       if ( nVerboseLevel > 1 )
         G4cout << " Abort event: Out of detector section "<< Gateendl;
     }
@@ -277,7 +277,7 @@ void GateToRoot::RecordBeginOfAcquisition() {
     if (nVerboseLevel > 2)
         G4cout << "GateToRoot::RecordBeginOfAcquisition\n";
 
-    GateSteppingAction *myAction = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()));
+    GateSteppingAction *myAction = (GateSteppingAction::GetSteppingAction());
     TrackingMode theMode = myAction->GetMode();
     if (nVerboseLevel > 1)
         G4cout << " GateToRoot::RecordBeginOfAcquisition()  Tracking Mode " << int(theMode) << Gateendl;
@@ -512,7 +512,7 @@ void GateToRoot::RecordEndOfAcquisition() {
 
 
     /* PY Descourt 08/09/2009 */
-    GateSteppingAction *myAction = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()));
+    GateSteppingAction *myAction = (GateSteppingAction::GetSteppingAction());
     TrackingMode theMode = myAction->GetMode();
     if (theMode == TrackingMode::kTracker) {
         G4cout << " ----- ROOT FILE DATA INFORMATIONS ----- \n";
@@ -647,7 +647,7 @@ void GateToRoot::RecordBeginOfEvent(const G4Event *evt) {
     strcpy(theCRData.theRayleighVolumeName2, G4String("NULL").c_str());
 
 
-    TrackingMode theMode = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()))->GetMode();
+    TrackingMode theMode = (GateSteppingAction::GetSteppingAction())->GetMode();
     if ((theMode == TrackingMode::kDetector) && (evt->GetNumberOfPrimaryVertex() > 0)) {
 
         // we read the RecStep and number of rayleigh & compton scatterings from the RecStep Data Root file
@@ -689,7 +689,7 @@ void GateToRoot::RecordEndOfEvent(const G4Event *event) {
     // GateMessage("Output", 5 , " GateToRoot::RecordEndOfEvent -- begin\n";);
 
 
-    GateSteppingAction *myAction = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()));
+    GateSteppingAction *myAction = (GateSteppingAction::GetSteppingAction());
     TrackingMode theMode = myAction->GetMode();
     if (theMode == TrackingMode::kTracker)return;
 
@@ -789,8 +789,7 @@ void GateToRoot::RecordEndOfEvent(const G4Event *event) {
             } else {
                 //! better than the simple eventID, but still not enough: it's valid only for
                 //! the single run and not for the application
-                G4int iEvent = ((GatePrimaryGeneratorAction *) GateRunManager::GetRunManager()->
-                        GetUserPrimaryGeneratorAction())->GetEventNumber();
+                G4int iEvent = GatePrimaryGeneratorAction::GetPrimaryGeneratorAction()->GetEventNumber();
                 if (m_rootNtupleFlag)
                     ntuple->Fill(iEvent,
                                  eventTime / s,
@@ -1283,7 +1282,7 @@ void GateToRoot::OpenTracksFile() {
     G4String previousFN = fTracksFN;
 
 
-    GateSteppingAction *myAction = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()));
+    GateSteppingAction *myAction = (GateSteppingAction::GetSteppingAction());
 
     G4int currentN = myAction->GetcurrentN();
 
@@ -1460,7 +1459,7 @@ void GateToRoot::GetCurrentRecStepData(const G4Event *evt) {
     //PrintRecStep();
 
     if (m_RSEventID != evt->GetEventID()) {
-        const G4Run *currentRun = GateRunManager::GetRunManager()->GetCurrentRun();
+        const G4Run *currentRun = G4RunManager::GetRunManager()->GetCurrentRun();
         G4int RunID = currentRun->GetRunID();
         G4cout << " GateToRoot::GetCurrentRecStepData :::: current Run ID " << RunID << "    current RecStep File "
                << m_RecStepTree->GetCurrentFile()->GetName() << Gateendl;
@@ -1478,7 +1477,7 @@ void GateToRoot::GetCurrentRecStepData(const G4Event *evt) {
 
 
 GateTrack *GateToRoot::GetCurrentTracksData() {
-    GateSteppingAction *myAction = ((GateSteppingAction *) (GateRunManager::GetRunManager()->GetUserSteppingAction()));
+    GateSteppingAction *myAction = (GateSteppingAction::GetSteppingAction());
     if (m_currentTracksData == tracksTuple->GetEntries()) // check if we are done
     {
         m_EOF = 1;
@@ -1545,7 +1544,7 @@ GateTrack *GateToRoot::GetCurrentTracksData() {
 void GateToRoot::RecordRecStepData(const G4Event *evt) {
     //G4cout << " GateToRoot::RecordRecStepData : recording RecStep Data to ROOT file \n";
     m_RSEventID = evt->GetEventID();
-    m_RSRunID = GateRunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    m_RSRunID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
     m_RecStepTree->Fill();
     //PrintRecStep();
     //G4cout << " GateToRoot::RecordRecStepData : runID " << m_RSRunID << "  eventID "<< m_RSEventID  << Gateendl;
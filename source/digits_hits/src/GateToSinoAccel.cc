@@ -210,11 +210,11 @@ void GateToSinoAccel::RecordEndOfRun(const G4Run * r)
     m_infoFile << " AxialPosition varies as |RingDifference|,...," << 2*m_ringNb-2 << "-|RingDifference| per increment of 2\n";
     m_infoFile << " AzimuthalAngle varies as 0,...," << m_crystalNb/2-1 << " per increment of 1\n";
     m_infoFile << " RadialPosition varies as 0,...," << m_radialElemNb-1 << " per increment of 1\n";
-    m_infoFile << " Date type : unsigned short integer (U" << 8*sizeof(unsigned short) << ")\n";
+    m_infoFile << " Date type : signed integer (I" << 8*m_sinogram->BytesPerPixel() << ")\n";
     m_infoFile.close();
     m_dimFile.open((frameFileName+".dim").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
     m_dimFile << " " << m_radialElemNb << " " << m_crystalNb/2 << " " << m_ringNb*m_ringNb << Gateendl;
-    m_dimFile << "-type U" << 8*sizeof(unsigned short) << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
+    m_dimFile << "-type I" << 8*m_sinogram->BytesPerPixel() << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
     m_dimFile.close();
   }
 
@@ -387,7 +387,7 @@ void GateToSinoAccel::Describe(size_t indent)
   G4cout << GateTools::Indent(indent) << " >> Number of crystals per crystal ring " << m_crystalNb << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Number of crystal rings             " << m_ringNb << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Number of radial sinogram bins      " << m_radialElemNb << Gateendl;
-  G4cout << GateTools::Indent(indent) << " >> Filled?                             " << ( m_sinogram->GetData() ? "Yes" : "No" ) << Gateendl;
+  G4cout << GateTools::Indent(indent) << " >> Filled?                             " << ( m_sinogram->IsAllocated() ? "Yes" : "No" ) << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Attached to system:                 " << m_system->GetObjectName() << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Input data                          " << m_inputDataChannel;
 }
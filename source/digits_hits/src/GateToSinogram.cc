@@ -30,6 +30,22 @@ See LICENSE.md for further details
 #include "GateVSystem.hh"
 #include "GateApplicationMgr.hh"
 
+#include <algorithm>
+#include <cstdint>
+
+//---------------------------------------------------------------------------
+// Mix of the event IDs and crystals of a delayed coincidence (splitmix64
+// finalizer), used to spread the delayeds over the TOF bins
+static uint64_t DelayedHash(G4int eventID1, G4int eventID2, G4int crystal1, G4int crystal2)
+{
+  uint64_t x = ((uint64_t)(uint32_t)eventID1 << 32) | (uint32_t)eventID2;
+  x ^= (((uint64_t)(uint32_t)crystal1 << 32) | (uint32_t)crystal2) * 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+//---------------------------------------------------------------------------
+
 // #include "GatePlacementMove.hh"
 
 // Public constructor (creates an empty, uninitialised, project set)
@@ -74,6 +90,12 @@ GateToSinogram::GateToSinogram(const G4String& name, GateOutputMgr* outputMgr,Ga
   , m_virtualRingPerBlockNb(0)
   , m_virtualCrystalPerBlockNb(0)
 
+  , m_tofBinNb(1)
+  , m_tofBinSize(0.)
+  , m_span(1)
+  , m_mashing(1)
+  , m_maxRingDiff(0)
+
 {
   m_isEnabled = false; // Keep this flag false: all output are disabled by default
   m_sinogram = new GateSinogram();
@@ -194,6 +216,17 @@ void GateToSinogram::RecordBeginOfAcquisition()
     G4cout << "    Crystal location blurring in axial direction: " << m_axialCrystalResolution/mm << " mm\n";
   }
 
+  // Time-of-flight bins and compression of the sinograms
+  if (m_tofBinNb > 1 && m_tofBinSize <= 0.) {
+    G4Exception( "GateToSinogram::RecordBeginOfAcquisition", "RecordBeginOfAcquisition", FatalException, "The size of the TOF bins must be set with setTOFBinSize\n");
+  }
+  m_sinogram->SetTOFBinNb(m_tofBinNb);
+  m_sinogram->SetCompression(m_span,m_mashing,m_maxRingDiff);
+  m_sinoDelayeds->SetTOFBinNb(m_tofBinNb);
+  m_sinoDelayeds->SetCompression(m_span,m_mashing,m_maxRingDiff);
+  m_sinoScatters->SetTOFBinNb(m_tofBinNb);
+  m_sinoScatters->SetCompression(m_span,m_mashing,m_maxRingDiff);
+
   // Prepare the sinogram
   m_sinogram->Reset(m_ringNb,m_crystalNb,m_radialElemNb,m_virtualRingPerBlockNb,m_virtualCrystalPerBlockNb);
 
@@ -202,6 +235,13 @@ void GateToSinogram::RecordBeginOfAcquisition()
   if (m_flagStoreDelayeds) m_sinoDelayeds->Reset(m_ringNb,m_crystalNb,m_radialElemNb,m_virtualRingPerBlockNb,m_virtualCrystalPerBlockNb);
   if (m_flagStoreScatters) m_sinoScatters->Reset(m_ringNb,m_crystalNb,m_radialElemNb,m_virtualRingPerBlockNb,m_virtualCrystalPerBlockNb);
 
+  // Memory: the blocks of views are allocated at their first count
+  G4int sinogramSetNb = 1 + (m_flagStoreDelayeds ? 1 : 0) + (m_flagStoreScatters ? 1 : 0);
+  G4cout << "    Sinograms: " << m_sinogram->GetSinogramNb() << " 2D sinograms of " << m_radialElemNb << " x " << m_sinogram->GetViewNb()
+         << " bins, " << m_tofBinNb << " TOF bins, span " << m_sinogram->GetSpan() << ", mashing " << m_sinogram->GetMashing() << Gateendl;
+  G4cout << "    Sinograms: at most " << sinogramSetNb*m_sinogram->GetDenseBytes()/1048576. << " MB for " << sinogramSetNb
+         << " set(s), allocated by blocks of " << std::min<size_t>(8,m_sinogram->GetViewNb()) << " views at their first count\n";
+
   if (nVerboseLevel>0) {
 
     // 07.02.2006, C. Comtat, Store randoms and scatters sino
@@ -252,11 +292,7 @@ void GateToSinogram::RecordBeginOfRun(const G4Run * r)
 
 void GateToSinogram::RecordEndOfRun(const G4Run * r)
 {
-  G4String         frameFileName;
-  std::ofstream    m_dataFile,m_infoFile,m_dimFile;
   char             ctemp[512];
-  G4int            aringdiff,nseg,seg,ringdiff,ring_1_min,ring_1_max,ring_1,ring_2,sinoID;
-  size_t           seekID;
 
   if (nVerboseLevel>0) {
     G4cout << " >> entering [GateToSinogram::RecordEndOfRun]\n";
@@ -265,19 +301,52 @@ void GateToSinogram::RecordEndOfRun(const G4Run * r)
     G4cout << "        Number of scattered coincidences for all ring combinations     " << m_nScatter << Gateendl;
     G4cout << "      Number of random coincidences for all ring combinations        " << m_nRandom << Gateendl;
     G4cout << "    Number of delayed coincidences for all ring combinations       " << m_nDelayed << Gateendl;
+    G4cout << "    Memory of the allocated sinogram blocks                        " << m_sinogram->GetAllocatedBytes()/1048576. << " MB\n";
   }
 
   // Write the projection sets
   if (m_flagIsRawOutputEnabled) {
     sprintf(ctemp,"%s_%0d",m_fileName.c_str(),r->GetRunID()+1);
-    frameFileName = ctemp;
-    G4cout << "    sinograms " <<  m_sinogram->GetCurrentFrameID()<< ",1,"
-                               <<  m_sinogram->GetCurrentGateID() << ","
-                               <<  m_sinogram->GetCurrentDataID() << ","
-			       <<  m_sinogram->GetCurrentBedID()  <<
-              " written to the raw file " << frameFileName << ".ima\n";
-    m_dataFile.open((frameFileName+".ima").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-    seekID = 0;
+    WriteRawSinograms(m_sinogram,ctemp,"2D sinograms");
+
+    // 07.02.2006, C. Comtat, Store randoms and scatters sino
+    if (m_flagStoreDelayeds) {
+      sprintf(ctemp,"%s_%0d_del",m_fileName.c_str(),r->GetRunID()+1);
+      WriteRawSinograms(m_sinoDelayeds,ctemp,"2D delayed coincidences sinograms");
+    }
+    if (m_flagStoreScatters) {
+      sprintf(ctemp,"%s_%0d_sct",m_fileName.c_str(),r->GetRunID()+1);
+      WriteRawSinograms(m_sinoScatters,ctemp,"2D true scattered coincidences sinograms");
+    }
+  }
+
+  if (nVerboseLevel>0) G4cout << " >> leaving [GateToSinogram::RecordEndOfRun]\n";
+}
+
+
+// Write a set of 2D sinograms in a raw file (.ima), with its .info and .dim files
+void GateToSinogram::WriteRawSinograms(GateSinogram* sinogram, const G4String& frameFileName, const G4String& description)
+{
+  std::ofstream    m_dataFile,m_infoFile,m_dimFile;
+  G4int            aringdiff,nseg,seg,ringdiff,ring_1_min,ring_1_max,ring_1,ring_2,sinoID;
+  size_t           seekID,tofBinID;
+
+  G4cout << "    sinograms " << sinogram->GetCurrentFrameID()<< ",1,"
+                             << sinogram->GetCurrentGateID() << ","
+                             << sinogram->GetCurrentDataID() << ","
+                             << sinogram->GetCurrentBedID()  <<
+            " written to the raw file " << frameFileName << ".ima\n";
+  m_dataFile.open((frameFileName+".ima").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
+  seekID = 0;
+  for (tofBinID=0 ; tofBinID<sinogram->GetTOFBinNb(); tofBinID++) {
+    if (sinogram->GetSpan() > 1) {
+      // 2D sinograms in the order of their ID (segment, then axial position)
+      for (sinoID=0 ; sinoID<(G4int)sinogram->GetSinogramNb(); sinoID++) {
+        sinogram->StreamOut( m_dataFile , sinoID, seekID, tofBinID );
+        seekID++;
+      }
+      continue;
+    }
     for (aringdiff=0 ; aringdiff<(G4int)m_ringNb; aringdiff++) {
       if (aringdiff == 0) nseg = 1;
       else nseg = 2;
@@ -293,142 +362,43 @@ void GateToSinogram::RecordEndOfRun(const G4Run * r)
 	}
 	for (ring_1 = ring_1_min; ring_1 <= ring_1_max ; ++ring_1) {
 	  ring_2 = ring_1 + ringdiff;
-	  sinoID = m_sinogram->GetSinoID(ring_1,ring_2);
-	  if (sinoID < 0 || (unsigned)sinoID >= m_sinogram->GetSinogramNb()) {
+	  sinoID = sinogram->GetSinoID(ring_1,ring_2);
+	  if (sinoID < 0 || (unsigned)sinoID >= sinogram->GetSinogramNb()) {
 	    G4Exception( "GateToSinogram::RecordEndOfRun", "RecordEndOfRun", FatalException, "Wrong 2D sinogram ID\n");
           }
 	  if (nVerboseLevel>2) {
             G4cout << " >> rings " << ring_1 << "," << ring_2  << " give sino ID " << sinoID << Gateendl;
 	  }
-	  m_sinogram->StreamOut( m_dataFile , sinoID, seekID );
+	  sinogram->StreamOut( m_dataFile , sinoID, seekID, tofBinID );
 	  seekID++;
         }
       }
     }
-    m_dataFile.close();
-    m_infoFile.open((frameFileName+".info").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-    m_infoFile << m_sinogram->GetSinogramNb() << " 2D sinograms\n";
-    m_infoFile << " [RadialPosition;AzimuthalAngle;AxialPosition;RingDifference]\n";
+  }
+  m_dataFile.close();
+  m_infoFile.open((frameFileName+".info").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
+  m_infoFile << sinogram->GetSinogramNb() << " " << description << Gateendl;
+  m_infoFile << " [RadialPosition;AzimuthalAngle;AxialPosition;RingDifference]\n";
+  if (sinogram->GetSpan() > 1) {
+    G4int segmentNb = (sinogram->GetMaxRingDiff() + (sinogram->GetSpan()-1)/2)/sinogram->GetSpan();
+    m_infoFile << " Span " << sinogram->GetSpan() << ", maximum ring difference " << sinogram->GetMaxRingDiff() << Gateendl;
+    m_infoFile << " Segment varies as -" << segmentNb << ",...,+" << segmentNb << " per increment of 1 (segment s groups the ring differences of s*span-(span-1)/2 to s*span+(span-1)/2)\n";
+    m_infoFile << " AxialPosition (ring1+ring2) varies as 0,...," << 2*m_ringNb-2 << " per increment of 1 for each segment (empty 2D sinograms outside the segment)\n";
+  } else {
     m_infoFile << " RingDifference varies as 0,+1,-1,+2,-2, ...,+" << m_ringNb-1 << ",-" << m_ringNb-1 << Gateendl;
     m_infoFile << " AxialPosition varies as |RingDifference|,...," << 2*m_ringNb-2 << "-|RingDifference| per increment of 2\n";
-    m_infoFile << " AzimuthalAngle varies as 0,...," << m_crystalNb/2-1 << " per increment of 1\n";
-    m_infoFile << " RadialPosition varies as 0,...," << m_radialElemNb-1 << " per increment of 1\n";
-    m_infoFile << " Date type : unsigned short integer (U" << 8*sizeof(unsigned short) << ")\n";
-    m_infoFile.close();
-    m_dimFile.open((frameFileName+".dim").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-    m_dimFile << " " << m_radialElemNb << " " << m_crystalNb/2 << " " << m_ringNb*m_ringNb << Gateendl;
-    m_dimFile << "-type U" << 8*sizeof(unsigned short) << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
-    m_dimFile.close();
-
-    // 07.02.2006, C. Comtat, Store randoms and scatters sino
-    if (m_flagStoreDelayeds) {
-      sprintf(ctemp,"%s_%0d_del",m_fileName.c_str(),r->GetRunID()+1);
-      frameFileName = ctemp;
-      G4cout << "    sinograms " << m_sinoDelayeds->GetCurrentFrameID()<< ",1,"
-                                 << m_sinoDelayeds->GetCurrentGateID() << ","
-                                 << m_sinoDelayeds->GetCurrentDataID() << ","
-	  			 << m_sinoDelayeds->GetCurrentBedID()  <<
-                " written to the raw file " << frameFileName << ".ima\n";
-      m_dataFile.open((frameFileName+".ima").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      seekID = 0;
-      for (aringdiff=0 ; aringdiff<(G4int)m_ringNb; aringdiff++) {
-        if (aringdiff == 0) nseg = 1;
-        else nseg = 2;
-        for (seg=0 ; seg<nseg; seg++) {
-          if (seg == 0) { /* Positive ring difference */
-	    ringdiff = aringdiff;
-	    ring_1_min = 0;
-	    ring_1_max = m_ringNb - ringdiff - 1;
-	  } else { /* Negative ring difference */
-	    ringdiff = -aringdiff;
-	    ring_1_min = -ringdiff;
-	    ring_1_max = m_ringNb - 1;
-	  }
-	  for (ring_1 = ring_1_min; ring_1 <= ring_1_max ; ++ring_1) {
-	    ring_2 = ring_1 + ringdiff;
-	    sinoID = m_sinoDelayeds->GetSinoID(ring_1,ring_2);
-	    if (sinoID < 0 || (unsigned)sinoID >= m_sinoDelayeds->GetSinogramNb()) {
-	      G4Exception( "GateToSinogram::RecordEndOfRun", "RecordEndOfRun", FatalException, "Wrong 2D sinogram ID\n");
-            }
-	    if (nVerboseLevel>2) {
-              G4cout << " >> rings " << ring_1 << "," << ring_2  << " give sino ID " << sinoID << Gateendl;
-	    }
-	    m_sinoDelayeds->StreamOut( m_dataFile , sinoID, seekID );
-	    seekID++;
-          }
-        }
-      }
-      m_dataFile.close();
-      m_infoFile.open((frameFileName+".info").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      m_infoFile << m_sinoDelayeds->GetSinogramNb() << " 2D delayed coincidences sinograms\n";
-      m_infoFile << " [RadialPosition;AzimuthalAngle;AxialPosition;RingDifference]\n";
-      m_infoFile << " RingDifference varies as 0,+1,-1,+2,-2, ...,+" << m_ringNb-1 << ",-" << m_ringNb-1 << Gateendl;
-      m_infoFile << " AxialPosition varies as |RingDifference|,...," << 2*m_ringNb-2 << "-|RingDifference| per increment of 2\n";
-      m_infoFile << " AzimuthalAngle varies as 0,...," << m_crystalNb/2-1 << " per increment of 1\n";
-      m_infoFile << " RadialPosition varies as 0,...," << m_radialElemNb-1 << " per increment of 1\n";
-      m_infoFile << " Date type : unsigned short integer (U" << 8*sizeof(unsigned short) << ")\n";
-      m_infoFile.close();
-      m_dimFile.open((frameFileName+".dim").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      m_dimFile << " " << m_radialElemNb << " " << m_crystalNb/2 << " " << m_ringNb*m_ringNb << Gateendl;
-      m_dimFile << "-type U" << 8*sizeof(unsigned short) << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
-      m_dimFile.close();
-    }
-    if (m_flagStoreScatters) {
-      sprintf(ctemp,"%s_%0d_sct",m_fileName.c_str(),r->GetRunID()+1);
-      frameFileName = ctemp;
-      G4cout << "    sinograms " << m_sinoScatters->GetCurrentFrameID()<< ",1,"
-                                 << m_sinoScatters->GetCurrentGateID() << ","
-                                 << m_sinoScatters->GetCurrentDataID() << ","
-	  			 << m_sinoScatters->GetCurrentBedID()  <<
-                " written to the raw file " << frameFileName << ".ima\n";
-      m_dataFile.open((frameFileName+".ima").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      seekID = 0;
-      for (aringdiff=0 ; aringdiff<(G4int)m_ringNb; aringdiff++) {
-        if (aringdiff == 0) nseg = 1;
-        else nseg = 2;
-        for (seg=0 ; seg<nseg; seg++) {
-          if (seg == 0) { /* Positive ring difference */
-	    ringdiff = aringdiff;
-	    ring_1_min = 0;
-	    ring_1_max = m_ringNb - ringdiff - 1;
-	  } else { /* Negative ring difference */
-	    ringdiff = -aringdiff;
-	    ring_1_min = -ringdiff;
-	    ring_1_max = m_ringNb - 1;
-	  }
-	  for (ring_1 = ring_1_min; ring_1 <= ring_1_max ; ++ring_1) {
-	    ring_2 = ring_1 + ringdiff;
-	    sinoID = m_sinoScatters->GetSinoID(ring_1,ring_2);
-	    if (sinoID < 0 || (unsigned)sinoID >= m_sinoScatters->GetSinogramNb()) {
-	      G4Exception( "GateToSinogram::RecordEndOfRun", "RecordEndOfRun", FatalException, "Wrong 2D sinogram ID\n");
-            }
-	    if (nVerboseLevel>2) {
-              G4cout << " >> rings " << ring_1 << "," << ring_2  << " give sino ID " << sinoID << Gateendl;
-	    }
-	    m_sinoScatters->StreamOut( m_dataFile , sinoID, seekID );
-	    seekID++;
-          }
-        }
-      }
-      m_dataFile.close();
-      m_infoFile.open((frameFileName+".info").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      m_infoFile << m_sinoScatters->GetSinogramNb() << " 2D true scattered coincidences sinograms\n";
-      m_infoFile << " [RadialPosition;AzimuthalAngle;AxialPosition;RingDifference]\n";
-      m_infoFile << " RingDifference varies as 0,+1,-1,+2,-2, ...,+" << m_ringNb-1 << ",-" << m_ringNb-1 << Gateendl;
-      m_infoFile << " AxialPosition varies as |RingDifference|,...," << 2*m_ringNb-2 << "-|RingDifference| per increment of 2\n";
-      m_infoFile << " AzimuthalAngle varies as 0,...," << m_crystalNb/2-1 << " per increment of 1\n";
-      m_infoFile << " RadialPosition varies as 0,...," << m_radialElemNb-1 << " per increment of 1\n";
-      m_infoFile << " Date type : unsigned short integer (U" << 8*sizeof(unsigned short) << ")\n";
-      m_infoFile.close();
-      m_dimFile.open((frameFileName+".dim").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
-      m_dimFile << " " << m_radialElemNb << " " << m_crystalNb/2 << " " << m_ringNb*m_ringNb << Gateendl;
-      m_dimFile << "-type U" << 8*sizeof(unsigned short) << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
-      m_dimFile.close();
-    }
-
   }
-
-  if (nVerboseLevel>0) G4cout << " >> leaving [GateToSinogram::RecordEndOfRun]\n";
+  m_infoFile << " AzimuthalAngle varies as 0,...," << sinogram->GetViewNb()-1 << " per increment of 1 (mashing " << sinogram->GetMashing() << ")\n";
+  m_infoFile << " RadialPosition varies as 0,...," << m_radialElemNb-1 << " per increment of 1\n";
+  if (sinogram->GetTOFBinNb() > 1) {
+    m_infoFile << " TOF bins 0,...," << sinogram->GetTOFBinNb()-1 << " of " << m_tofBinSize/ps << " ps, one set of 2D sinograms after the other\n";
+  }
+  m_infoFile << " Date type : signed integer (I" << 8*sinogram->BytesPerPixel() << ")\n";
+  m_infoFile.close();
+  m_dimFile.open((frameFileName+".dim").c_str(),std::ios::out | std::ios::trunc | std::ios::binary);
+  m_dimFile << " " << m_radialElemNb << " " << sinogram->GetViewNb() << " " << sinogram->GetSinogramNb()*sinogram->GetTOFBinNb() << Gateendl;
+  m_dimFile << "-type I" << 8*sinogram->BytesPerPixel() << Gateendl << "-dx 1.0\n" << "-dy 1.0\n" << "-dz 1.0";
+  m_dimFile.close();
 }
 
 
@@ -479,6 +449,7 @@ void GateToSinogram::RecordEndOfEvent(const G4Event* )
     // 07.02.2006, C. Comtat, Store randoms and scatters sino
     G4int ScattID1 = ((*CDC)[iDigi]->GetPulse(0)).GetNPhantomCompton()+((*CDC)[iDigi]->GetPulse(0)).GetNPhantomRayleigh();
     G4int ScattID2 = ((*CDC)[iDigi]->GetPulse(1)).GetNPhantomCompton()+((*CDC)[iDigi]->GetPulse(1)).GetNPhantomRayleigh();
+    G4double TOFTime = ((*CDC)[iDigi]->GetPulse(0)).GetTime()-((*CDC)[iDigi]->GetPulse(1)).GetTime();
     G4double DiffTime = fabs(((*CDC)[iDigi]->GetPulse(0)).GetTime()/s-((*CDC)[iDigi]->GetPulse(1)).GetTime()/s);
     if (DiffTime > MIN_COINC_OFFSET/2.) Delayed = 1;  else Delayed = 0;
     if (Delayed && (eventID1 == eventID2)) {
@@ -592,14 +563,30 @@ void GateToSinogram::RecordEndOfEvent(const G4Event* )
 	return;
       }
     }
+
+    // Time-of-flight bin: time at crystal c1 minus time at crystal c2, the delayed
+    // coincidences (uniform in time) being spread over the TOF bins by a hash of
+    // their events and crystals, so that the random engine of the simulation
+    // is not used by the output
+    G4int tofBin = 0;
+    if (m_tofBinNb > 1) {
+      if (Delayed) {
+        tofBin = (G4int) (DelayedHash(eventID1, eventID2, r1*m_crystalNb+c1, r2*m_crystalNb+c2) % m_tofBinNb);
+      } else {
+        if (c1 != crystal1) TOFTime = -TOFTime;
+        tofBin = (G4int) floor(TOFTime/m_tofBinSize + 0.5*m_tofBinNb);
+      }
+      if (tofBin < 0) tofBin = 0;
+      else if (tofBin >= (G4int) m_tofBinNb) tofBin = m_tofBinNb - 1;
+    }
     if (m_flagStoreDelayeds) { // prompts and delayeds in separate sinograms
       if (Delayed) {
-        if (m_sinoDelayeds->Fill( r1, r2, c1, c2, +1) == 0) {
+        if (m_sinoDelayeds->Fill( r1, r2, c1, c2, +1, tofBin) == 0) {
 	  m_sinogram->FillRandoms( r1, r2);
 	  m_nDelayed++;
 	}
       } else {
-        if (m_sinogram->Fill( r1, r2, c1, c2, +1) == 0) {
+        if (m_sinogram->Fill( r1, r2, c1, c2, +1, tofBin) == 0) {
 	  m_nPrompt++;
 	  if (eventID1 == eventID2) {
 	    m_nTrue++;
@@ -611,12 +598,12 @@ void GateToSinogram::RecordEndOfEvent(const G4Event* )
       }
     } else { // prompts minus delayeds
       if (Delayed) {
-        if (m_sinogram->Fill( r1, r2, c1, c2, -1) == 0) {
+        if (m_sinogram->Fill( r1, r2, c1, c2, -1, tofBin) == 0) {
 	  m_sinogram->FillRandoms( r1, r2);
 	  m_nDelayed++;
 	}
       } else {
-        if (m_sinogram->Fill( r1, r2, c1, c2, +1) == 0) {
+        if (m_sinogram->Fill( r1, r2, c1, c2, +1, tofBin) == 0) {
 	  m_nPrompt++;
 	  if (eventID1 == eventID2) {
 	    m_nTrue++;
@@ -628,7 +615,7 @@ void GateToSinogram::RecordEndOfEvent(const G4Event* )
       }
     }
     if (m_flagStoreScatters && ((ScattID1+ScattID2) > 0) && (eventID1 == eventID2)) {
-      m_sinoScatters->Fill( r1, r2, c1, c2, +1);
+      m_sinoScatters->Fill( r1, r2, c1, c2, +1, tofBin);
     }
 
     // DEBUG
@@ -657,7 +644,9 @@ void GateToSinogram::Describe(size_t indent)
   G4cout << GateTools::Indent(indent) << " >> Number of crystals per crystal ring: " << m_crystalNb << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Number of crystal rings:             " << m_ringNb << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Number of radial sinogram bins:      " << m_radialElemNb << Gateendl;
-  G4cout << GateTools::Indent(indent) << " >> Filled ?                             " << ( m_sinogram->GetData() ? "Yes" : "No" ) << Gateendl;
+  G4cout << GateTools::Indent(indent) << " >> Number of TOF bins:                  " << m_tofBinNb << Gateendl;
+  G4cout << GateTools::Indent(indent) << " >> Span, mashing:                       " << m_span << ", " << m_mashing << Gateendl;
+  G4cout << GateTools::Indent(indent) << " >> Filled ?                             " << ( m_sinogram->IsAllocated() ? "Yes" : "No" ) << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Attached to system:                  " << m_system->GetObjectName() << Gateendl;
   G4cout << GateTools::Indent(indent) << " >> Input data:                          " << m_inputDataChannel;
 }
@@ -109,6 +109,37 @@ GateToSinogramMessenger::GateToSinogramMessenger(GateToSinogram* gateToSinogram)
   SetVirtualCrystalCmd->SetRange("Number>=0");
   SetVirtualCrystalCmd->SetDefaultValue(0);
 
+  cmdName = GetDirectoryName()+"setTOFBins";
+  SetTOFBinNbCmd = new G4UIcmdWithAnInteger(cmdName,this);
+  SetTOFBinNbCmd->SetGuidance("Set the number of time-of-flight bins of the sinograms");
+  SetTOFBinNbCmd->SetParameterName("Number",false);
+  SetTOFBinNbCmd->SetRange("Number>0");
+
+  cmdName = GetDirectoryName()+"setTOFBinSize";
+  SetTOFBinSizeCmd = new G4UIcmdWithADoubleAndUnit(cmdName,this);
+  SetTOFBinSizeCmd->SetGuidance("Set the size of the time-of-flight bins (difference of the arrival times)");
+  SetTOFBinSizeCmd->SetParameterName("Size",false);
+  SetTOFBinSizeCmd->SetRange("Size>0.");
+  SetTOFBinSizeCmd->SetUnitCategory("Time");
+
+  cmdName = GetDirectoryName()+"setSpan";
+  SetSpanCmd = new G4UIcmdWithAnInteger(cmdName,this);
+  SetSpanCmd->SetGuidance("Set the span (odd) of the sinograms: ring differences of a segment are grouped while filling");
+  SetSpanCmd->SetParameterName("Number",false);
+  SetSpanCmd->SetRange("Number>0");
+
+  cmdName = GetDirectoryName()+"setMashing";
+  SetMashingCmd = new G4UIcmdWithAnInteger(cmdName,this);
+  SetMashingCmd->SetGuidance("Set the number of adjacent views summed while filling");
+  SetMashingCmd->SetParameterName("Number",false);
+  SetMashingCmd->SetRange("Number>0");
+
+  cmdName = GetDirectoryName()+"setMaxRingDifference";
+  SetMaxRingDiffCmd = new G4UIcmdWithAnInteger(cmdName,this);
+  SetMaxRingDiffCmd->SetGuidance("Set the maximum ring difference stored with a span > 1 (0: all)");
+  SetMaxRingDiffCmd->SetParameterName("Number",false);
+  SetMaxRingDiffCmd->SetRange("Number>=0");
+
 }
 GateToSinogramMessenger::~GateToSinogramMessenger()
 {
@@ -127,6 +158,12 @@ GateToSinogramMessenger::~GateToSinogramMessenger()
   // C. Comtat, February 2011: Required to simulate Biograph output sinograms with virtual crystals
   delete SetVirtualRingCmd;
   delete SetVirtualCrystalCmd;
+
+  delete SetTOFBinNbCmd;
+  delete SetTOFBinSizeCmd;
+  delete SetSpanCmd;
+  delete SetMashingCmd;
+  delete SetMaxRingDiffCmd;
 }
 
 
@@ -164,6 +201,17 @@ void GateToSinogramMessenger::SetNewValue(G4UIcommand* command,G4String newValue
  else if (command == SetVirtualCrystalCmd)
     { m_gateToSinogram->SetVirtualCrystalPerBlockNb(SetVirtualCrystalCmd->GetNewIntValue(newValue)) ; }
 
+  else if (command == SetTOFBinNbCmd)
+    { m_gateToSinogram->SetTOFBinNb(SetTOFBinNbCmd->GetNewIntValue(newValue)); }
+  else if (command == SetTOFBinSizeCmd)
+    { m_gateToSinogram->SetTOFBinSize(SetTOFBinSizeCmd->GetNewDoubleValue(newValue)); }
+  else if (command == SetSpanCmd)
+    { m_gateToSinogram->SetSpan(SetSpanCmd->GetNewIntValue(newValue)); }
+  else if (command == SetMashingCmd)
+    { m_gateToSinogram->SetMashing(SetMashingCmd->GetNewIntValue(newValue)); }
+  else if (command == SetMaxRingDiffCmd)
+    { m_gateToSinogram->SetMaxRingDiff(SetMaxRingDiffCmd->GetNewIntValue(newValue)); }
+
 
   else
     { GateOutputModuleMessenger::SetNewValue(command,newValue); }
@@ -13,11 +13,14 @@ See LICENSE.md for further details
 
 #include "GateToTreeMessenger.hh"
 #include "GateToTree.hh"
+#include "GateChunkedTreeFile.hh"
+#include "GateMessageManager.hh"
 
 
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
 
 GateToTreeMessenger::GateToTreeMessenger(GateToTree *m) :
     GateOutputModuleMessenger(m),
@@ -42,6 +45,18 @@ GateToTreeMessenger::GateToTreeMessenger(GateToTree *m) :
   cmdName = GetDirectoryName() + "addCollection";
   m_addCollectionCmd = new G4UIcmdWithAString(cmdName, this);
 
+  cmdName = GetDirectoryName() + "setChunkSize";
+  m_setChunkSizeCmd = new G4UIcmdWithAnInteger(cmdName, this);
+  m_setChunkSizeCmd->SetGuidance("Number of entries per chunk of the .gtc files (default 65536)");
+  m_setChunkSizeCmd->SetParameterName("Size", false);
+  m_setChunkSizeCmd->SetRange("Size>0");
+
+  cmdName = GetDirectoryName() + "setCompression";
+  m_setCompressionCmd = new G4UIcmdWithAString(cmdName, this);
+  m_setCompressionCmd->SetGuidance("Compression of the chunks of the .gtc files: none, zstd or lz4 (when Gate is built with them)");
+  m_setCompressionCmd->SetParameterName("Compression", false);
+  m_setCompressionCmd->SetCandidates("none zstd lz4");
+
   for(auto &&m: m_gateToTree->getHitsParamsToWrite())
   {
     auto name = m.first;
@@ -85,6 +100,8 @@ GateToTreeMessenger::~GateToTreeMessenger()
   delete m_addFileNameCmd;
   delete m_enableHitsOutput;
   delete m_disableHitsOutput;
+  delete m_setChunkSizeCmd;
+  delete m_setCompressionCmd;
 
 }
 
@@ -111,6 +128,20 @@ void GateToTreeMessenger::SetNewValue(G4UIcommand *icommand, G4String string)
   if(icommand == m_addCollectionCmd)
     m_gateToTree->addCollection(string);
 
+  if(icommand == m_setChunkSizeCmd)
+    GateOutputChunkedTreeFile::set_default_chunk_size(m_setChunkSizeCmd->GetNewIntValue(string));
+  if(icommand == m_setCompressionCmd)
+  {
+    try
+    {
+      GateOutputChunkedTreeFile::set_default_codec(string);
+    }
+    catch (const std::invalid_argument &e)
+    {
+      GateError("/gate/output/tree/setCompression: " << e.what());
+    }
+  }
+
   auto c = static_cast<G4UIcmdWithoutParameter*>(icommand);
   if(m_maphits_cmdParameter_toTreeParameter.count(c))
   {
@@ -19,11 +19,13 @@ See LICENSE.md for further details
 
 
 #include "GateSteppingVerbose.hh"
+#include "GateProfiler.hh"
+#include "GateMTHelper.hh"
 #include "G4SteppingManager.hh"
 #include "G4SliceTimer.hh"
 
 //class GateRecorderBase;
-GateUserActions* GateUserActions::pUserActions=0;
+G4ThreadLocal GateUserActions* GateUserActions::pUserActions=0;
 
 //-----------------------------------------------------------------------------
 GateUserActions::GateUserActions(GateRunManager* m)
@@ -50,15 +52,17 @@ GateUserActions::GateUserActions(GateRunManager* m)
 
   // Set fGate' user action classes to the GateRunmanager :
   // Run/Event/Tracking/Stepping in order to get the callbacks
-  GateRunAction* RunAction = new GateRunAction(this);
-  GateEventAction* EventAction = new GateEventAction(this);
-  GateTrackingAction* TrackingAction = new GateTrackingAction(this);
-  GateSteppingAction* SteppingAction = new GateSteppingAction(this);
-
-  pRunManager->SetUserAction(RunAction);
-  pRunManager->SetUserAction(EventAction);
-  pRunManager->SetUserAction(TrackingAction);
-  pRunManager->SetUserAction(SteppingAction);
+  if (pRunManager) {
+    GateRunAction* RunAction = new GateRunAction(this);
+    GateEventAction* EventAction = new GateEventAction(this);
+    GateTrackingAction* TrackingAction = new GateTrackingAction(this);
+    GateSteppingAction* SteppingAction = new GateSteppingAction(this);
+
+    pRunManager->SetUserAction(RunAction);
+    pRunManager->SetUserAction(EventAction);
+    pRunManager->SetUserAction(TrackingAction);
+    pRunManager->SetUserAction(SteppingAction);
+  }
 
   //pRunManager->SetUserAction(dynamic_cast<G4UserRunAction *>(this)); //Don't know why this don't work
   //pRunManager->SetUserAction(dynamic_cast<G4UserEventAction *>(this));
@@ -110,6 +114,10 @@ void GateUserActions::EndOfRunAction(const G4Run* run)
      steppingVerbose->EndOfRun();
   }
 
+  // The counters of the worker threads are summed by the master
+  if (GateProfiler::IsEnabled() && !GateMTHelper::IsWorkerThread())
+    GateProfiler::Report();
+
   // Run ended, update the visualization
   if (G4VVisManager::GetConcreteInstance()) {
     G4UImanager::GetUIpointer()->ApplyCommand("/vis/viewer/update");
@@ -13,6 +13,7 @@
 #include "GateActorMessenger.hh"
 #include "GateActorManager.hh"
 #include "GateMiscFunctions.hh"
+#include "GateMTHelper.hh"
 
 #include <sys/time.h>
 #include <stdio.h>
@@ -41,11 +42,25 @@ GateVActor::GateVActor(G4String name, G4int depth)
   mNumOfFilters = 0;
   mOverWriteFilesFlag = true;
   pFilterManager = new GateFilterManager(GetObjectName()+"_filter");
+  for(int i=0; i<kNumberOfProfiledCallbacks; i++) mProfilerCounters[i] = -1;
   GateDebugMessageDec("Actor",4,"GateVActor() -- end\n");
 }
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+void GateVActor::RegisterProfilerCounters()
+{
+  static const char * names[kNumberOfProfiledCallbacks] = {
+    "BeginOfRunAction", "EndOfRunAction", "BeginOfEventAction", "EndOfEventAction",
+    "PreUserTrackingAction", "PostUserTrackingAction", "UserSteppingAction",
+    "RecordEndOfAcquisition" };
+  for(int i=0; i<kNumberOfProfiledCallbacks; i++)
+    mProfilerCounters[i] = GateProfiler::Register("Actor", GetObjectName(), names[i]);
+}
+//-----------------------------------------------------------------------------
+
+
 //-----------------------------------------------------------------------------
 GateVActor::~GateVActor()
 {
@@ -82,6 +97,9 @@ void GateVActor::EndOfRunAction(const G4Run*)
 // EndOfNEventAction (if it is enabled)
 void GateVActor::EndOfEventAction(const G4Event*e)
 {
+  // Only the master saves (at the end of the run) in MT mode
+  if (GateMTHelper::IsWorkerThread()) return;
+
   int ne = e->GetEventID()+1;
 
   // Save every n events
@@ -15,6 +15,7 @@
 #include "GateObjectStore.hh"
 #include "GateVImageVolume.hh"
 #include "GateUtilityForG4ThreeVector.hh"
+#include "GateMTHelper.hh"
 
 #include <G4Step.hh>
 #include <G4TouchableHistory.hh>
@@ -324,25 +325,16 @@ int GateVImageActor::GetIndexFromTrackPosition(const GateVVolume * v , const G4T
 
   G4TouchableHistory* theTouchable = (G4TouchableHistory*)(track->GetTouchable());
   int maxDepth = theTouchable->GetHistoryDepth();
-  G4LogicalVolume * currentVol = theTouchable->GetVolume(0)->GetLogicalVolume();
 
-  GateDebugMessage("Track",3,"GateVImageActor -- GetIndexFromTrackPosition: Step in "<<currentVol->GetName()<<" - Max Depth = "<<maxDepth
+  GateDebugMessage("Track",3,"GateVImageActor -- GetIndexFromTrackPosition: Step in "<<theTouchable->GetVolume(0)->GetLogicalVolume()->GetName()<<" - Max Depth = "<<maxDepth
                                                                       <<" -> target = "<<v->GetLogicalVolume()->GetName()<< Gateendl );
-  int depth = 0;
-  int transDepth = maxDepth;
-
-  while((depth<maxDepth) && (currentVol != v->GetLogicalVolume()))
-  {
-    depth++;
-    transDepth--;
-    currentVol = theTouchable->GetVolume(depth)->GetLogicalVolume();
-  }
-
-  if(depth>=maxDepth) return -1;
+  int depth = GetAncestorDepth(v->GetLogicalVolume(), theTouchable, false);
+  if(depth<0) return -1;
+  int transDepth = maxDepth - depth;
 
   // GateError( "currentVol : "<< currentVol->GetName()<<"    Logical Volume "<< v->GetLogicalVolume()->GetName()<<" not found!" );
 
-  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromTrackPosition: Logical volume "<<currentVol->GetName() <<" found! - Depth = "<<depth << Gateendl );
+  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromTrackPosition: Logical volume "<<v->GetLogicalVolume()->GetName() <<" found! - Depth = "<<depth << Gateendl );
 
   G4ThreeVector position = theTouchable->GetHistory()->GetTransform(transDepth).TransformPoint(tmpPosition);
 
@@ -362,7 +354,88 @@ int GateVImageActor::GetIndexFromTrackPosition(const GateVVolume * v , const G4T
 //-----------------------------------------------------------------------------
 int GateVImageActor::GetIndexFromStepPosition(const GateVVolume * v, const G4Step * step)
 {
-  return GetIndexFromStepPosition2(v, step, mImage, mPositionIsSet, mPosition, mStepHitType);
+  return GetIndexFromStepPosition2(v, step, mImage, mPositionIsSet, mPosition, GetCurrentStepHitType());
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateVImageActor::AddThreadImage(GateImageWithStatistic & image)
+{
+  for(auto i:mThreadImageList) if (i == &image) return;
+  mThreadImageList.push_back(&image);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Called by the master before the workers start a run. The buffers are
+// empty at that time (SaveData merges them at the end of each run), they
+// are only reallocated when the number of threads changes.
+void GateVImageActor::AllocateThreadData()
+{
+  if (!GateMTHelper::IsMultithreaded()) return;
+  const int n = GateMTHelper::GetNumberOfThreads();
+  if ((int)mThreadStates.size() == n) return;
+  mThreadStates.resize(n);
+  for(auto & t:mThreadStates) {
+    t.mCurrentEvent = -1;
+    t.mNumberOfEvents = 0;
+    t.mStepHitType = mStepHitType;
+  }
+  for(auto i:mThreadImageList) i->AllocateThreadImages(n);
+  AllocateThreadBuffers(n);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+// Called by the master when the workers are idle. The threads are merged
+// in index order (each thread always processes the same events, see
+// GateRunManager::GetNextEvent).
+int GateVImageActor::MergeThreadData()
+{
+  int n = 0;
+  for(auto & t:mThreadStates) {
+    n += t.mNumberOfEvents;
+    t.mNumberOfEvents = 0;
+  }
+  if (mThreadStates.empty()) return 0;
+  for(auto i:mThreadImageList) i->MergeThreadImages();
+  MergeThreadBuffers();
+  return n;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateVImageActor::CountEvent(int & currentEvent)
+{
+  ThreadState * t = GetThreadState();
+  if (!t) { currentEvent++; return; }
+  t->mCurrentEvent++;
+  t->mNumberOfEvents++;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateVImageActor::StepHitType & GateVImageActor::GetCurrentStepHitType()
+{
+  ThreadState * t = GetThreadState();
+  if (!t) return mStepHitType;
+  return t->mStepHitType;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateVImageActor::ThreadState * GateVImageActor::GetThreadState()
+{
+  if (mThreadStates.empty()) return 0;
+  const int i = GateMTHelper::GetThreadIndex();
+  if (i < 0 || i >= (int)mThreadStates.size()) return 0;
+  return &mThreadStates[i];
 }
 //-----------------------------------------------------------------------------
 
@@ -382,27 +455,16 @@ int GateVImageActor::GetIndexFromStepPosition2(const GateVVolume * v,
 
   G4TouchableHistory* theTouchable = (G4TouchableHistory*)(step->GetPreStepPoint()->GetTouchable());
   int maxDepth = theTouchable->GetHistoryDepth();
-  G4LogicalVolume * currentVol = theTouchable->GetVolume(0)->GetLogicalVolume();
 
-  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromStepPosition: Step in "<<currentVol->GetName()<<" - Max Depth = "<<maxDepth
+  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromStepPosition: Step in "<<theTouchable->GetVolume(0)->GetLogicalVolume()->GetName()<<" - Max Depth = "<<maxDepth
 		   <<" -> target = "<<v->GetLogicalVolume()->GetName()<< Gateendl );
   GateDebugMessage("Step", 3, " worldPre = " << worldPre<< Gateendl);
   GateDebugMessage("Step", 3, " worldPos = " << worldPos<< Gateendl);
-  int depth = 0;
-  int transDepth = maxDepth;
-
-  while((depth<maxDepth) &&
-        (currentVol->GetName() != v->GetLogicalVolume()->GetName()))
-    //(currentVol != v->GetLogicalVolume())) //depth<=maxDepth or depth<maxDepth ? OK < only
-    {
-      depth++;
-      transDepth--;
-      currentVol = theTouchable->GetVolume(depth)->GetLogicalVolume();
-    }
-
-  if(depth>=maxDepth) return -1;
+  int depth = GetAncestorDepth(v->GetLogicalVolume(), theTouchable, true);
+  if(depth<0) return -1;
+  int transDepth = maxDepth - depth;
 
-  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromStepPosition: Logical volume "<<currentVol->GetName() <<" found! - Depth = "<<depth << Gateendl );
+  GateDebugMessage("Step",3,"GateVImageActor -- GetIndexFromStepPosition: Logical volume "<<v->GetLogicalVolume()->GetName() <<" found! - Depth = "<<depth << Gateendl );
 
   G4ThreeVector postPosition = theTouchable->GetHistory()->GetTransform(transDepth).TransformPoint(worldPos);
   G4ThreeVector prePosition = theTouchable->GetHistory()->GetTransform(transDepth).TransformPoint(worldPre);
@@ -469,4 +531,56 @@ int GateVImageActor::GetIndexFromStepPosition2(const GateVVolume * v,
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+namespace {
+  // Last ancestor depths found, per thread. A cached depth is reused when
+  // the logical volume found at this depth is still the same, which is
+  // the case for all the steps in the voxels of an image volume.
+  struct GateAncestorDepthEntry {
+    const G4LogicalVolume * target;
+    const G4VPhysicalVolume * volume; // volume of the step (depth 0)
+    const G4LogicalVolume * ancestor; // logical volume found at depth
+    G4bool byName;
+    G4int depth;
+  };
+  const G4int kAncestorDepthCacheSize = 8;
+  G4ThreadLocal GateAncestorDepthEntry gAncestorDepthCache[kAncestorDepthCacheSize];
+  G4ThreadLocal G4int gAncestorDepthNext = 0;
+}
+
+int GateVImageActor::GetAncestorDepth(const G4LogicalVolume * target, const G4VTouchable * touchable,
+                                      G4bool byName)
+{
+  const int maxDepth = touchable->GetHistoryDepth();
+  const G4VPhysicalVolume * volume = touchable->GetVolume(0);
+  for(int i=0; i<kAncestorDepthCacheSize; i++) {
+    const GateAncestorDepthEntry & e = gAncestorDepthCache[i];
+    if (e.target == target && e.volume == volume && e.byName == byName && e.depth < maxDepth &&
+        touchable->GetVolume(e.depth)->GetLogicalVolume() == e.ancestor)
+      return e.depth;
+  }
+
+  // Not cached
+  const G4String & targetName = target->GetName();
+  int depth = 0;
+  G4LogicalVolume * currentVol = volume->GetLogicalVolume();
+  while((depth<maxDepth) &&
+        (byName ? (currentVol->GetName() != targetName) : (currentVol != target))) {
+    depth++;
+    currentVol = touchable->GetVolume(depth)->GetLogicalVolume();
+  }
+  if(depth>=maxDepth) return -1;
+
+  GateAncestorDepthEntry & e = gAncestorDepthCache[gAncestorDepthNext];
+  gAncestorDepthNext = (gAncestorDepthNext+1) % kAncestorDepthCacheSize;
+  e.target = target;
+  e.volume = volume;
+  e.ancestor = currentVol;
+  e.byName = byName;
+  e.depth = depth;
+  return depth;
+}
+//-----------------------------------------------------------------------------
+
+
 #endif /* end #define GATEVIMAGEACTOR_CC */
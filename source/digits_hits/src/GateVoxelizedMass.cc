@@ -19,6 +19,8 @@
 
 #include "GateVoxelizedMass.hh"
 #include "GateMiscFunctions.hh"
+#include "GateCacheFile.hh"
+#include "GateParallelFor.hh"
 #include "GateDetectorConstruction.hh"
 #include "GateMaterialDatabase.hh"
 
@@ -29,8 +31,46 @@
 #include <G4Box.hh>
 #include <G4VPVParameterisation.hh>
 
+#include <algorithm>
 #include <ctime>
 #include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+namespace {
+  // Key of the data the dosel masses depend on, geometry included
+  class MassCacheKey : public GateCacheKey
+  {
+  public:
+    using GateCacheKey::Add;
+    void Add(const G4ThreeVector & v) { Add(v.x()); Add(v.y()); Add(v.z()); }
+    void Add(const G4RotationMatrix & m)
+    {
+      Add(m.xx()); Add(m.xy()); Add(m.xz());
+      Add(m.yx()); Add(m.yy()); Add(m.yz());
+      Add(m.zx()); Add(m.zy()); Add(m.zz());
+    }
+    // Placement, shape and material of a volume and of its daughters
+    void AddVolume(const G4VPhysicalVolume * pv)
+    {
+      const G4LogicalVolume * lv = pv->GetLogicalVolume();
+      Add(pv->GetName());
+      Add(pv->GetObjectTranslation());
+      Add(pv->GetObjectRotationValue());
+      std::ostringstream solid;
+      lv->GetSolid()->StreamInfo(solid);
+      Add(solid.str());
+      Add(lv->GetMaterial()->GetName());
+      Add(lv->GetMaterial()->GetDensity());
+      for (size_t i = 0; i < lv->GetNoDaughters(); i++) AddVolume(lv->GetDaughter(i));
+    }
+  };
+
+  const char theMassCacheMagic[8] = "GateVM1";
+}
+//-----------------------------------------------------------------------------
 
 
 //-----------------------------------------------------------------------------
@@ -45,6 +85,8 @@ GateVoxelizedMass::GateVoxelizedMass()
 
   mMassFile       = "";
   mMaterialFilter = "";
+  mMassCacheDirectory = "";
+  mLabelOffset    = 0;
 
   mCubicVolume.clear();
   mMass       .clear();
@@ -131,8 +173,10 @@ void GateVoxelizedMass::Initialize(const G4String _mVolumeName, const GateVImage
     imageVolume = dynamic_cast<GateVImageVolume*>(GateObjectStore::GetInstance()->FindVolumeCreator(mVolumeName));
     imageVoxel  = imageVolume->GetImage();
 
-    if (doselExternalMass.size() == 0)
+    if (doselExternalMass.size() == 0) {
       GenerateVoxels();
+      GenerateLabelTables();
+    }
   }
 
   GateMessage("Actor", 1,  "[GateVoxelizedMass::" << __FUNCTION__ << "] Has same resolution ? " << mHasSameResolution << Gateendl);
@@ -153,6 +197,12 @@ void GateVoxelizedMass::Initialize(const G4String _mVolumeName, const GateVImage
     }
   }
 
+  // Dosel masses read from the cache, or computed now (in parallel)
+  // for voxelized volumes rather than on first hit during the tracking
+  if (!mHasSameResolution && doselExternalMass.size() == 0)
+    if (!ReadMassCache() && mIsParameterised)
+      GenerateVectors();
+
   mIsInitialized=true;
 
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Ended" << Gateendl);
@@ -184,7 +234,7 @@ double GateVoxelizedMass::GetDoselMass(const int index)
   if (mHasSameResolution) {
     GateMessage("Actor", 10,  "[GateVoxelizedMass::" << __FUNCTION__ << "] Volume and actor resolution are the same ! I will simply read the mass of the voxel." << Gateendl);
 
-    return theMaterialDatabase.GetMaterial((G4String)imageVolume->GetMaterialNameFromLabel(imageVolume->GetImage()->GetValue(index)))->GetDensity() * imageVolume->GetImage()->GetVoxelVolume();
+    return mLabelDensity[(int)imageVoxel->GetValue(index) - mLabelOffset] * imageVoxel->GetVoxelVolume();
   }
 
   // Case of imported mass image
@@ -265,38 +315,42 @@ void GateVoxelizedMass::GenerateVectors()
       doselReconstructedMass.clear();
       doselReconstructedMass.resize(mImage->GetNumberOfValues(),-1.);
     }
+  doselReconstructedCubicVolume.resize(mImage->GetNumberOfValues(),-1.);
 
-  doselReconstructedTotalCubicVolume = 0.;
-  doselReconstructedTotalMass        = 0.;
-
-  for(signed long int i=0; i < mImage->GetNumberOfValues(); i++)
-    {
-      time(&timer3);
+  if (mIsParameterised)
+    GenerateVectorsInParallel();
+  else
+    for(signed long int i=0; i < mImage->GetNumberOfValues(); i++)
+      {
+        time(&timer3);
 
-      if(mIsParameterised)
-        doselReconstructedData = ParameterizedVolume(i);
-      else
         doselReconstructedData = VoxelIteration(DAPV,
                                                 0,
                                                 DAPV->GetObjectRotationValue(),
                                                 DAPV->GetObjectTranslation(),
                                                 i);
 
-      doselReconstructedMass[i]        = doselReconstructedData.first;
+        doselReconstructedMass[i]        = doselReconstructedData.first;
+        doselReconstructedCubicVolume[i] = doselReconstructedData.second;
 
-      doselReconstructedTotalMass        += doselReconstructedMass[i];
-      doselReconstructedTotalCubicVolume += doselReconstructedData.second;
+        time(&timer4);
+        seconds=difftime(timer4,timer1);
 
-      time(&timer4);
-      seconds=difftime(timer4,timer1);
+        if (difftime(timer4,timer1) >= 60 && i%100 == 0)
+          {
+            std::cout<<" "<<i*100/mImage->GetNumberOfValues()<<"% (time elapsed : "<<seconds/60<<"min"<<seconds%60<<"s)      \r"<<std::flush;
+            // Experimental
+            /*seconds=(mImage->GetNumberOfValues()-i)*difftime(timer4,timer3);
+              if(seconds!=0.) std::cout<<"Estimated remaining time : "<<seconds/60<<"min"<<seconds%60<<"s ("<<seconds<<"s)                \r"<<std::flush;*/
+          }
+      }
 
-      if (difftime(timer4,timer1) >= 60 && i%100 == 0)
-        {
-          std::cout<<" "<<i*100/mImage->GetNumberOfValues()<<"% (time elapsed : "<<seconds/60<<"min"<<seconds%60<<"s)      \r"<<std::flush;
-          // Experimental
-          /*seconds=(mImage->GetNumberOfValues()-i)*difftime(timer4,timer3);
-            if(seconds!=0.) std::cout<<"Estimated remaining time : "<<seconds/60<<"min"<<seconds%60<<"s ("<<seconds<<"s)                \r"<<std::flush;*/
-        }
+  doselReconstructedTotalCubicVolume = 0.;
+  doselReconstructedTotalMass        = 0.;
+  for(signed long int i=0; i < mImage->GetNumberOfValues(); i++)
+    {
+      doselReconstructedTotalMass        += doselReconstructedMass[i];
+      doselReconstructedTotalCubicVolume += doselReconstructedCubicVolume[i];
     }
 
   time(&timer2);
@@ -317,10 +371,174 @@ void GateVoxelizedMass::GenerateVectors()
 
   mIsVecGenerated=true;
 
+  WriteMassCache();
+
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Ended" << Gateendl);
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+void GateVoxelizedMass::GenerateVectorsInParallel()
+{
+  // ParameterizedVolume only reads the label image and the label
+  // tables: the dosels are shared among threads, by chunks
+  if (mLabelDensity.empty())
+    GenerateLabelTables();
+
+  const long nbDosels  = mImage->GetNumberOfValues();
+  const long chunkSize = 64;
+  const long nbChunks  = (nbDosels + chunkSize - 1) / chunkSize;
+  GateMessage("Actor", 1, "[GateVoxelizedMass::" << __FUNCTION__ << "] " << nbDosels << " dosels, "
+              << GateParallel::GetNumberOfThreads(nbChunks) << " threads" << Gateendl);
+
+  GateParallel::For(nbChunks, [this, nbDosels, chunkSize](unsigned int, size_t c) {
+      const long first = c * chunkSize;
+      const long last = std::min(first + chunkSize, nbDosels);
+      for (long i = first; i < last; i++) {
+        const pair<double,double> data = ParameterizedVolume(i);
+        doselReconstructedMass[i]        = data.first;
+        doselReconstructedCubicVolume[i] = data.second;
+      }
+    });
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateVoxelizedMass::GenerateLabelTables()
+{
+  // Density (and material filter) of each label, instead of a material
+  // database lookup by name for each voxel
+  GateImage* labelImage = imageVolume->GetImage();
+  const int minLabel = (int)labelImage->GetMinValue();
+  const int maxLabel = (int)labelImage->GetMaxValue();
+
+  std::vector<char> isUsed(maxLabel - minLabel + 1, 0);
+  for (GateImage::const_iterator it = labelImage->begin(); it != labelImage->end(); ++it)
+    isUsed[(int)(*it) - minLabel] = 1;
+
+  mLabelOffset = minLabel;
+  mLabelDensity   .assign(isUsed.size(), -1.);
+  mLabelIsFiltered.assign(isUsed.size(), 0);
+  for (size_t i = 0; i < isUsed.size(); i++)
+    if (isUsed[i]) {
+      const G4String matName = imageVolume->GetMaterialNameFromLabel(minLabel + i);
+      mLabelDensity[i]    = theMaterialDatabase.GetMaterial(matName)->GetDensity();
+      mLabelIsFiltered[i] = (mMaterialFilter == "" || mMaterialFilter == matName);
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+unsigned long long GateVoxelizedMass::ComputeCacheKey()
+{
+  MassCacheKey key;
+  key.Add(G4String("GateVoxelizedMass"));
+
+  // Dosels
+  key.Add(mImage->GetResolution());
+  key.Add(mImage->GetVoxelSize());
+  key.Add(mImage->GetTransformMatrix());
+  key.Add(mImage->GetVoxelCenterFromIndex(0));
+  key.Add(mImage->GetVoxelCenterFromIndex(mImage->GetNumberOfValues()-1));
+  key.Add(mVolumeName);
+  key.Add(mMaterialFilter);
+  key.Add(mVolumeFilter);
+
+  // Geometry
+  if (mIsParameterised) {
+    GateImage* labelImage = imageVolume->GetImage();
+    key.Add(G4ThreeVector(DABox->GetXHalfLength(), DABox->GetYHalfLength(), DABox->GetZHalfLength()));
+    key.Add(labelImage->GetResolution());
+    key.Add(labelImage->GetVoxelSize());
+    if (labelImage->GetNumberOfValues() > 0)
+      key.Add(&(*labelImage->begin()), labelImage->GetNumberOfValues()*sizeof(*labelImage->begin()));
+    key.Add(double(mLabelOffset));
+    if (!mLabelDensity.empty())
+      key.Add(&mLabelDensity[0], mLabelDensity.size()*sizeof(double));
+  }
+  else
+    key.AddVolume(DAPV);
+
+  return key.Get();
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+G4String GateVoxelizedMass::GetCacheFileName(unsigned long long key)
+{
+  std::ostringstream name;
+  name << mMassCacheDirectory << "/GateVoxelizedMass_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+  return name.str();
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool GateVoxelizedMass::ReadMassCache()
+{
+  if (mMassCacheDirectory == "")
+    return false;
+
+  const unsigned long long key = ComputeCacheKey();
+  const G4String fileName = GetCacheFileName(key);
+  std::ifstream is(fileName.c_str(), std::ios::binary);
+  if (!is) {
+    GateMessage("Actor", 1, "[GateVoxelizedMass::" << __FUNCTION__ << "] No mass cache " << fileName << ", the dosel masses are computed." << Gateendl);
+    return false;
+  }
+
+  char magic[8];
+  unsigned long long fileKey = 0;
+  unsigned long long n = 0;
+  is.read(magic, sizeof(magic));
+  is.read((char*)&fileKey, sizeof(fileKey));
+  is.read((char*)&n, sizeof(n));
+  if (!is || memcmp(magic, theMassCacheMagic, sizeof(magic)) != 0 || fileKey != key ||
+      n != (unsigned long long)mImage->GetNumberOfValues()) {
+    GateWarning("[GateVoxelizedMass::" << __FUNCTION__ << "] " << fileName << " is not a valid mass cache, the dosel masses are computed.");
+    return false;
+  }
+
+  std::vector<double> mass(n), volume(n);
+  is.read((char*)&mass[0], n*sizeof(double));
+  is.read((char*)&volume[0], n*sizeof(double));
+  if (!is) {
+    GateWarning("[GateVoxelizedMass::" << __FUNCTION__ << "] " << fileName << " is truncated, the dosel masses are computed.");
+    return false;
+  }
+
+  doselReconstructedMass       .swap(mass);
+  doselReconstructedCubicVolume.swap(volume);
+  mIsVecGenerated = true;
+  GateMessage("Actor", 1, "[GateVoxelizedMass::" << __FUNCTION__ << "] Dosel masses read from " << fileName << Gateendl);
+  return true;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void GateVoxelizedMass::WriteMassCache()
+{
+  if (mMassCacheDirectory == "" || !mIsVecGenerated)
+    return;
+
+  const unsigned long long key = ComputeCacheKey();
+  const G4String fileName = GetCacheFileName(key);
+  const unsigned long long n = doselReconstructedMass.size();
+
+  const bool isWritten = GateCacheFile::Write(fileName, [&](std::ostream & os) {
+      os.write(theMassCacheMagic, sizeof(theMassCacheMagic));
+      os.write((const char*)&key, sizeof(key));
+      os.write((const char*)&n, sizeof(n));
+      os.write((const char*)&doselReconstructedMass[0], n*sizeof(double));
+      os.write((const char*)&doselReconstructedCubicVolume[0], n*sizeof(double));
+    });
+  if (!isWritten) {
+    GateWarning("[GateVoxelizedMass::" << __FUNCTION__ << "] Cannot write the mass cache " << fileName);
+    return;
+  }
+  GateMessage("Actor", 1, "[GateVoxelizedMass::" << __FUNCTION__ << "] Dosel masses written to " << fileName << Gateendl);
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 void GateVoxelizedMass::GenerateVoxels()
 {
@@ -459,7 +677,10 @@ G4double GateVoxelizedMass::GetVoxelMass(const unsigned long int x, const unsign
 {
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Started" << Gateendl);
 
-  const G4double density = theMaterialDatabase.GetMaterial(GetVoxelMatName(x,y,z))->GetDensity();
+  if (mLabelDensity.empty())
+    GenerateLabelTables();
+
+  const G4double density = mLabelDensity[GetLabelIndex(x,y,z)];
   const G4double mass    = density * GetVoxelVolume();
 
   if (mass <= 0.)
@@ -475,12 +696,11 @@ G4double GateVoxelizedMass::GetVoxelMass(const unsigned long int x, const unsign
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-void GateVoxelizedMass::GenerateDosels(const int index)
+void GateVoxelizedMass::GenerateDosels(const int index, double doselMin[3], double doselMax[3])
 {
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Started" << Gateendl);
   // INFO : Dimension of the vectors : x = 0, y = 1, z = 2
 
-  doselMin.resize(3,-1.);
   doselMin[0]=(DABox->GetXHalfLength()+mImage->GetVoxelCenterFromIndex(index).getX()-mImage->GetVoxelSize().getX()/2.)/imageVolume->GetImage()->GetVoxelSize().x();
   doselMin[1]=(DABox->GetYHalfLength()+mImage->GetVoxelCenterFromIndex(index).getY()-mImage->GetVoxelSize().getY()/2.)/imageVolume->GetImage()->GetVoxelSize().y();
   doselMin[2]=(DABox->GetZHalfLength()+mImage->GetVoxelCenterFromIndex(index).getZ()-mImage->GetVoxelSize().getZ()/2.)/imageVolume->GetImage()->GetVoxelSize().z();
@@ -511,7 +731,6 @@ void GateVoxelizedMass::GenerateDosels(const int index)
       exit(EXIT_FAILURE);
     }
 
-  doselMax.resize(3,-1.);
   doselMax[0]=(DABox->GetXHalfLength()+mImage->GetVoxelCenterFromIndex(index).getX()+mImage->GetVoxelSize().getX()/2.)/imageVolume->GetImage()->GetVoxelSize().x();
   doselMax[1]=(DABox->GetYHalfLength()+mImage->GetVoxelCenterFromIndex(index).getY()+mImage->GetVoxelSize().getY()/2.)/imageVolume->GetImage()->GetVoxelSize().y();
   doselMax[2]=(DABox->GetZHalfLength()+mImage->GetVoxelCenterFromIndex(index).getZ()+mImage->GetVoxelSize().getZ()/2.)/imageVolume->GetImage()->GetVoxelSize().z();
@@ -525,10 +744,13 @@ pair<double,double> GateVoxelizedMass::ParameterizedVolume(const int index)
 {
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Started" << Gateendl);
 
-  GenerateDosels(index);
+  // Local data only: called by several threads (GenerateVectorsInParallel)
+  double doselMin[3], doselMax[3];
+  GenerateDosels(index, doselMin, doselMax);
 
+  const G4double voxelVolume        = GetVoxelVolume();
   G4double doselReconstructedVolume = 0.;
-  doselReconstructedMass[index]     = 0.;
+  G4double doselMass                = 0.;
 
   //GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] DEBUG: doselMin[0]: " << doselMin[0] << ", doselMax[0]: " << doselMax[0] <<
   //                                                                          ", doselMin[1]: " << doselMin[1] << ", doselMax[1]: " << doselMax[1] <<
@@ -644,39 +866,38 @@ pair<double,double> GateVoxelizedMass::ParameterizedVolume(const int index)
                 {
                   //GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] DEBUG: coord[0][xVox]: " << coord[0][xVox] << ", coord[1][xVox]: " << coord[1][yVox] << ", coord[2][xVox]: " << coord[2][zVox] << Gateendl);
 
-                  if (mMaterialFilter == "" ||
-                      mMaterialFilter == GetVoxelMatName(coord[0][xVox], coord[1][yVox], coord[2][zVox]))
+                  if (mLabelIsFiltered[GetLabelIndex(coord[0][xVox], coord[1][yVox], coord[2][zVox])])
                     {
                       const double coefVox(coef[0][xVox] * coef[1][yVox] * coef[2][zVox]);
 
-                      doselReconstructedVolume      += GetVoxelVolume() * coefVox;
-                      doselReconstructedMass[index] += GetVoxelMass(coord[0][xVox], coord[1][yVox], coord[2][zVox]) * coefVox;
+                      doselReconstructedVolume += voxelVolume * coefVox;
+                      doselMass                += GetVoxelMass(coord[0][xVox], coord[1][yVox], coord[2][zVox]) * coefVox;
 
                       if(doselReconstructedVolume < 0.)
                         GateError("[GateVoxelizedMass::" << __FUNCTION__ << "] ERROR : doselReconstructedVolume is negative !" << Gateendl
                                   <<"     More informations :" << Gateendl
                                   <<"            doselReconstructedVolume=" << doselReconstructedVolume << Gateendl
-                                  <<"            Voxel Volume: " << GetVoxelVolume() << Gateendl
+                                  <<"            Voxel Volume: " << voxelVolume << Gateendl
                                   <<"            coefVox=" << coefVox <<Gateendl);
 
-                      if(doselReconstructedMass[index] < 0.)
+                      if(doselMass < 0.)
                         GateError("[GateVoxelizedMass::" << __FUNCTION__ << "] ERROR : doselReconstructedMass is negative !" << Gateendl
                                   <<"     More informations:" << Gateendl
-                                  <<"            doselReconstructedMass[" << index << "]=" << doselReconstructedMass[index] << Gateendl
+                                  <<"            doselReconstructedMass[" << index << "]=" << doselMass << Gateendl
                                   <<"            Voxel Mass: " << GetVoxelMass(coord[0][xVox], coord[1][yVox], coord[2][zVox]) << Gateendl
                                   <<"            coefVox= " << coefVox << Gateendl);
                     }
                 }
         }
 
-  if(doselReconstructedMass[index] < 0.)
-    GateError("[GateVoxelizedMass::" << __FUNCTION__ << "] ERROR: doselReconstructedMass is negative ! (doselReconstructedMass["<<index<<"] = "<<doselReconstructedMass[index]<<")"<<Gateendl);
+  if(doselMass < 0.)
+    GateError("[GateVoxelizedMass::" << __FUNCTION__ << "] ERROR: doselReconstructedMass is negative ! (doselReconstructedMass["<<index<<"] = "<<doselMass<<")"<<Gateendl);
   if(doselReconstructedVolume < 0.)
     GateError("[GateVoxelizedMass::" << __FUNCTION__ << "] ERROR: doselReconstructedVolume is negative ! (doselReconstructedVolume = "<<doselReconstructedVolume<<")"<<Gateendl);
 
   GateMessage("Actor", 10, "[GateVoxelizedMass::" << __FUNCTION__ << "] Ended" << Gateendl);
 
-  return std::make_pair(doselReconstructedMass[index],doselReconstructedVolume);
+  return std::make_pair(doselMass,doselReconstructedVolume);
 }
 //-----------------------------------------------------------------------------
 
@@ -985,8 +1206,9 @@ double GateVoxelizedMass::GetPartialVolumeWithSV(int index,G4String SVName)
     exit(EXIT_FAILURE);
   }
 
+  // The dosel mass may come from the cache, without the partial values
   if(mCubicVolume[index].empty())
-    GetDoselMass(index);
+    VoxelIteration(DAPV,0,DAPV->GetObjectRotationValue(),DAPV->GetObjectTranslation(),index);
 
   for(size_t i=0;i<mCubicVolume[index].size();i++)
     if(mCubicVolume[index][i].first==SVName)
@@ -1005,8 +1227,9 @@ double GateVoxelizedMass::GetPartialMassWithSV(int index,G4String SVName)
     exit(EXIT_FAILURE);
   }
 
+  // The dosel mass may come from the cache, without the partial values
   if(mMass[index].empty())
-    GetDoselMass(index);
+    VoxelIteration(DAPV,0,DAPV->GetObjectRotationValue(),DAPV->GetObjectTranslation(),index);
 
   for(size_t i=0;i<mMass[index].size();i++)
     if(mMass[index][i].first==SVName)
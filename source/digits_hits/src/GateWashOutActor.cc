@@ -90,6 +90,11 @@ void GateWashOutActor::BeginOfRunAction(const G4Run * r) {
       ActWashOut = VSReaderIni->GetTempTotalActivity(); }
 
     mGateWashOutActivityIni.push_back(ActWashOut);
+
+    // The activity is changed at each event: the source manager must not
+    // keep the next time of this source between events
+    for ( G4int iRow = 0; iRow<(G4int)mGateWashOutSources.size(); iRow++ )
+      if ( mGateWashOutSources[iRow] == SourceIni->GetName() ) SourceIni->SetVariableActivityFlag(true);
   }
 }
 //-----------------------------------------------------------------------------
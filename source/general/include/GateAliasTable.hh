@@ -0,0 +1,77 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateAliasTable
+  \brief  Walker alias table: samples an index in [0, n[ with probability
+  proportional to a weight, in constant time.
+
+  The table is built in linear time (Vose's method). Build() can be
+  called again when the weights change: the storage is reused.
+*/
+
+#ifndef GATEALIASTABLE_HH
+#define GATEALIASTABLE_HH
+
+#include "globals.hh"
+#include "Randomize.hh"
+
+#include <vector>
+
+//-----------------------------------------------------------------------------
+class GateAliasTable
+{
+public:
+  GateAliasTable() : mTotalWeight(0.) {}
+
+  /// Weights must be positive or null. The table is empty when the sum
+  /// of the weights is null.
+  void Build(const std::vector<G4double> & weights);
+  void Clear();
+
+  bool IsEmpty() const { return mEntries.empty(); }
+  size_t GetSize() const { return mEntries.size(); }
+  G4double GetTotalWeight() const { return mTotalWeight; }
+
+  /// Index sampled from two uniform numbers in [0, 1[
+  inline G4int Sample(G4double u1, G4double u2) const;
+  inline G4int Sample() const;
+
+protected:
+  struct Entry {
+    G4double probability; // probability to keep this index
+    G4int alias;          // index chosen otherwise
+  };
+  std::vector<Entry> mEntries;
+  std::vector<G4int> mSmall; // work buffers
+  std::vector<G4int> mLarge;
+  G4double mTotalWeight;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline G4int GateAliasTable::Sample(G4double u1, G4double u2) const
+{
+  const G4int n = mEntries.size();
+  G4int i = (G4int)(u1 * n);
+  if (i >= n) i = n-1;
+  return (u2 < mEntries[i].probability) ? i : mEntries[i].alias;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline G4int GateAliasTable::Sample() const
+{
+  const G4double u1 = G4UniformRand();
+  return Sample(u1, G4UniformRand());
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEALIASTABLE_HH */
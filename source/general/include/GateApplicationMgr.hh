@@ -15,6 +15,9 @@
 #include "GateConfiguration.h"
 #include "GateApplicationMgrMessenger.hh"
 #include <vector>
+#ifdef GATE_USE_MT
+#include "G4Threading.hh"
+#endif
 
 class GateApplicationMgr
 {
@@ -70,8 +73,14 @@ public:
   bool IsAnAmountOfPrimariesPerRunModeEnabled(){return mRequestedAmountOfPrimariesPerRun;}
   void ReadTimeSlicesInAFile(G4String filename);
 
+#ifdef GATE_USE_MT
+  // Workers see the time of the event they are processing
+  void SetCurrentTime(G4double value){m_time=value; mThreadTime=value;}
+  G4double GetCurrentTime(){return G4Threading::IsWorkerThread() ? mThreadTime : m_time;}
+#else
   void SetCurrentTime(G4double value){m_time=value;}
   G4double GetCurrentTime(){return m_time;}
+#endif
 
 
   G4double GetTimeStepInTotalAmountOfPrimariesMode(){return mTimeStepInTotalAmountOfPrimariesMode;}
@@ -79,6 +88,7 @@ public:
 
   void EnableTimeStudy(G4String filename);
   void EnableTimeStudyForSteps(G4String filename);
+  void EnableCallbackProfiler(G4String filename);
   long GetRequestedAmountOfPrimariesPerRun() { return mRequestedAmountOfPrimariesPerRun; }
 
 protected:
@@ -92,6 +102,9 @@ protected:
   G4int nVerboseLevel;
 
   G4double m_time;
+#ifdef GATE_USE_MT
+  static G4ThreadLocal G4double mThreadTime;
+#endif
 
   G4double m_weight;
 
@@ -55,6 +55,7 @@ private:
   G4UIcmdWithoutParameter * NoOutputCmd;
   G4UIcmdWithAString * TimeStudyCmd;
   G4UIcmdWithAString * TimeStudyForStepsCmd;
+  G4UIcmdWithAString * CallbackProfilerCmd;
   //G4UIcmdWithoutParameter * EnableSuccessiveSourceMode;
   G4UIcmdWithAString *      ReadTimeSlicesInAFileCmd;
   G4UIcmdWithADouble *      SetTotalNumberOfPrimariesCmd;
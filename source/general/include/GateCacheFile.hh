@@ -0,0 +1,63 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateCacheKey
+  \brief  FNV-1a hash of the data a cached result depends on
+
+  \class  GateCacheFile
+  \brief  Write of a cache file shared by several jobs: the file is
+  written aside (in a file created with mkstemp in the same directory),
+  then renamed, so that it is either complete or absent for the jobs
+  reading it meanwhile.
+*/
+
+#ifndef GATECACHEFILE_HH
+#define GATECACHEFILE_HH
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+//-----------------------------------------------------------------------------
+class GateCacheKey
+{
+public:
+  GateCacheKey() : mHash(14695981039346656037ULL) {}
+
+  void Add(const void * data, size_t size)
+  {
+    const unsigned char * p = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++) {
+      mHash ^= p[i];
+      mHash *= 1099511628211ULL;
+    }
+  }
+  void Add(double v) { Add(&v, sizeof(v)); }
+  /// The string is followed by a separator: ("ab","c") and ("a","bc") differ
+  void Add(const std::string & s) { Add(s.data(), s.size()); Add(0.); }
+
+  unsigned long long Get() const { return mHash; }
+
+protected:
+  unsigned long long mHash;
+};
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+class GateCacheFile
+{
+public:
+  /// Write fileName with write(), false (and no file) if the stream
+  /// fails or if the file cannot be renamed
+  static bool Write(const std::string & fileName,
+                    const std::function<void(std::ostream &)> & write);
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATECACHEFILE_HH */
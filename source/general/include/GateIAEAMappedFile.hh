@@ -0,0 +1,63 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateIAEAMappedFile
+  \brief  Memory-mapped reader of the particles of an IAEA phase space file
+
+  - The .IAEAphsp file is mapped in memory and read sequentially: a
+  particle is decoded from the mapped record into an iaea_record_type,
+  exactly as iaea_record_type::read_particle does from the FILE (same
+  record layout, no byte swapping), without any fread call.
+
+  - Open() fails (and the caller keeps the fread reader) when the file
+  cannot be mapped, or when the record length given by the contents of
+  the record differs from the one of the header.
+
+  \sa iaea_record_type, GateSourcePhaseSpace
+*/
+
+#ifndef GATEIAEAMAPPEDFILE_HH
+#define GATEIAEAMAPPEDFILE_HH
+
+#include "globals.hh"
+#include "GateMappedFile.hh"
+
+struct iaea_record_type;
+
+//-----------------------------------------------------------------------------
+class GateIAEAMappedFile
+{
+public:
+  GateIAEAMappedFile();
+  ~GateIAEAMappedFile();
+
+  /// Map the file. record gives the stored quantities (see
+  /// iaea_header_type::get_record_contents)
+  G4bool Open(const G4String & fileName, const iaea_record_type * record, G4int headerRecordLength);
+  void Close();
+  G4bool IsOpen() const { return mFile.IsOpen(); }
+
+  /// Decode the next particle in record, false at the end of the file
+  G4bool ReadParticle(iaea_record_type * record);
+
+  G4long GetNumberOfRecords() const { return mRecordLength > 0 ? mFile.GetSize()/mRecordLength : 0; }
+  G4int GetRecordLength() const { return mRecordLength; }
+
+  /// Length in bytes of a record with the contents of record
+  static G4int ComputeRecordLength(const iaea_record_type * record);
+
+protected:
+  GateMappedFile mFile;
+  size_t mPosition;
+  G4int mRecordLength;
+  G4int mNumberOfFloats;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEIAEAMAPPEDFILE_HH */
@@ -0,0 +1,85 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \file   GateMTHelper.hh
+  \brief  Helpers for the multithreaded event loop (GATE_USE_MT).
+
+  - GateMTHelper: thread count and thread index. The functions are
+  also valid in a sequential build (one "thread", index 0), so that the
+  callers do not need to be guarded.
+
+  - GateEventSequencer: lets worker threads enter a section in
+  increasing event ID order. It is used for the objects that are shared
+  by all threads and whose result depends on the order of the events
+  (sources and clock during primary generation). With a sequential
+  build, Wait() returns immediately.
+*/
+
+#ifndef GATEMTHELPER_HH
+#define GATEMTHELPER_HH
+
+#include "GateConfiguration.h"
+#include "globals.hh"
+
+#ifdef GATE_USE_MT
+#include <condition_variable>
+#include <mutex>
+#endif
+
+//-----------------------------------------------------------------------------
+namespace GateMTHelper
+{
+  /// True when the events are processed by worker threads
+  bool IsMultithreaded();
+
+  /// True in a worker thread (always false in a sequential build)
+  bool IsWorkerThread();
+
+  /// Number of worker threads (1 in a sequential build)
+  int GetNumberOfThreads();
+
+  /// Index of the calling worker thread in [0, GetNumberOfThreads()[.
+  /// 0 in a sequential build, -1 on the master thread of a MT build.
+  int GetThreadIndex();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+class GateEventSequencer
+{
+public:
+  GateEventSequencer();
+
+  /// Start a new run: the next event allowed to enter is event 0
+  void Reset();
+
+  /// Block until all events with a lower ID have been released. Return
+  /// false (without waiting) when the event is after the last event of
+  /// the run (see Abort).
+  bool Wait(G4int eventID);
+
+  /// Allow the next event to enter
+  void Release(G4int eventID);
+
+  /// The run ends at lastEventID, waiting threads with higher IDs
+  /// are woken up and Wait returns false for them.
+  void Abort(G4int lastEventID);
+
+protected:
+#ifdef GATE_USE_MT
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+#endif
+  G4int mNextEventID;
+  G4int mLastEventID;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEMTHELPER_HH */
@@ -0,0 +1,48 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateMappedFile
+  \brief  Whole file mapped read-only in memory
+
+  - Open() fails when the file is empty or cannot be mapped, and always
+  on the systems without mmap: the callers then read the file as usual.
+
+  \sa GateIAEAMappedFile, GateMDBFileIndex
+*/
+
+#ifndef GATEMAPPEDFILE_HH
+#define GATEMAPPEDFILE_HH
+
+#include "globals.hh"
+
+//-----------------------------------------------------------------------------
+class GateMappedFile
+{
+public:
+  GateMappedFile();
+  ~GateMappedFile();
+
+  /// isSequential: the file is read once from the beginning to the end
+  G4bool Open(const G4String & fileName, G4bool isSequential = false);
+  void Close();
+  G4bool IsOpen() const { return mData != 0; }
+
+  const char * GetData() const { return mData; }
+  size_t GetSize() const { return mSize; }
+
+private:
+  GateMappedFile(const GateMappedFile &);
+  GateMappedFile & operator=(const GateMappedFile &);
+
+  const char * mData;
+  size_t mSize;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEMAPPEDFILE_HH */
@@ -0,0 +1,49 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \file   GateParallelFor.hh
+  \brief  Loops run by all the cores, for the initialization work that
+  is done outside of the event loop (tables, caches, images).
+
+  - For(): the items are taken one by one by the threads, for items of
+  uneven cost. The thread index lets each thread fill its own
+  accumulator, to be merged by the caller.
+
+  - ForChunks(): contiguous chunks, one per thread, for the loops over
+  voxels whose per-chunk results must not depend on the scheduling.
+
+  The calling thread is one of the threads. The function must not raise
+  a G4Exception: the errors are to be recorded and reported by the
+  caller once the loop is done.
+*/
+
+#ifndef GATEPARALLELFOR_HH
+#define GATEPARALLELFOR_HH
+
+#include <cstddef>
+#include <functional>
+
+//-----------------------------------------------------------------------------
+namespace GateParallel
+{
+  /// Number of threads of a loop of n items: the number of cores, at
+  /// most n, at least 1
+  unsigned int GetNumberOfThreads(size_t n);
+
+  /// Call f(thread, i) for i in [0, n[, thread in [0, GetNumberOfThreads(n)[
+  void For(size_t n, const std::function<void(unsigned int, size_t)> & f);
+
+  /// Call f(chunk, begin, end) on nbChunks contiguous chunks of [0, n[,
+  /// one thread per chunk
+  void ForChunks(size_t n, unsigned int nbChunks,
+                 const std::function<void(unsigned int, size_t, size_t)> & f);
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEPARALLELFOR_HH */
@@ -13,9 +13,15 @@ See LICENSE.md for further details
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "GatePrimaryGeneratorMessenger.hh"
 #include "globals.hh"
+#include "GateConfiguration.h"
+
+#ifdef GATE_USE_MT
+#include "G4Threading.hh"
+#endif
 
 class G4GeneralParticleSource;
 class G4Event;
+class G4Run;
 class GatePrimaryGeneratorMessenger;
 
 //---------------------------------------------------------------------------
@@ -30,10 +36,21 @@ public:
   void GenerateSimulationPrimaries(G4Event* anEvent);
   void GenerateDigitisationPrimaries(G4Event* anEvent);
   void AddEvent();
+#ifdef GATE_USE_MT
+  // Workers see the count at the generation of their current event,
+  // the master the count of the whole run
+  G4int GetEventNumber() { return G4Threading::IsWorkerThread() ? m_nEvents : mNumberOfGeneratedEvents; };
+  // Called by the master at the beginning of each run
+  static void PrepareNextRun(const G4Run * run);
+#else
   G4int GetEventNumber() { return m_nEvents; };
+#endif
+  // Primary generator action of the calling thread
+  static GatePrimaryGeneratorAction * GetPrimaryGeneratorAction() { return pInstance; }
   //  G4double GetTimeSlice()           { return m_timeSlice; };
   //  void SetTimeSlice(G4double value) { m_timeSlice = value; };
   void SetVerboseLevel(G4int value);
+  G4int GetVerboseLevel() const { return m_nVerboseLevel; }
   void EnableGPS(G4bool b) { m_useGPS = b; }
 
 private:
@@ -52,6 +69,11 @@ private:
   G4int    m_printModulo;
   G4int    m_nVerboseLevel;
   G4bool   m_useGPS;
+
+  static G4ThreadLocal GatePrimaryGeneratorAction * pInstance;
+#ifdef GATE_USE_MT
+  static G4int mNumberOfGeneratedEvents;
+#endif
 };
 
 #endif
@@ -0,0 +1,122 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateProfiler
+  \brief  Cumulative time and number of calls of the callbacks of the
+  actors, sensitive detectors and output modules.
+
+  - A counter is registered once per (category, object name, callback),
+  usually when the object is created: the same counter is returned to
+  all the threads that register the same callback.
+
+  - The callbacks are timed with GateProfilerScope. The time is read
+  with the time stamp counter of the CPU when available (converted to
+  seconds with the wall clock at the end), and the counters are per
+  thread, so that a measure costs a few tens of cycles. Nothing is
+  measured until Enable() is called
+  (/gate/application/enableCallbackProfiler).
+
+  - Report() prints the counters of all threads, sorted by time, and
+  writes them in a JSON file. It is called at the end of each run: the
+  counters are cumulated over the runs.
+*/
+
+#ifndef GATEPROFILER_HH
+#define GATEPROFILER_HH
+
+#include "globals.hh"
+
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+//-----------------------------------------------------------------------------
+class GateProfiler
+{
+public:
+  /// Start the measures, the report is also written in jsonFileName
+  static void Enable(const G4String & jsonFileName);
+  static inline G4bool IsEnabled() { return sEnabled; }
+
+  /// Counter of a callback (thread-safe)
+  static G4int Register(const G4String & category, const G4String & name,
+                        const G4String & callback);
+
+  static inline unsigned long long ReadTicks();
+  static inline void Add(G4int counter, unsigned long long ticks);
+
+  /// Print the counters of all threads and write the JSON file
+  static void Report();
+
+  struct Counter {
+    unsigned long long ticks;
+    unsigned long long calls;
+  };
+
+protected:
+  static std::vector<Counter> * NewThreadCounters(G4int counter);
+
+  static G4bool sEnabled;
+  static G4ThreadLocal std::vector<Counter> * sThreadCounters;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+/// Adds the time spent in its scope to a counter (nothing if the
+/// profiler is not enabled or if the counter is negative)
+class GateProfilerScope
+{
+public:
+  inline GateProfilerScope(G4int counter)
+    : mCounter(GateProfiler::IsEnabled() ? counter : -1), mStart(0)
+  {
+    if (mCounter >= 0) mStart = GateProfiler::ReadTicks();
+  }
+  inline ~GateProfilerScope()
+  {
+    if (mCounter >= 0) GateProfiler::Add(mCounter, GateProfiler::ReadTicks() - mStart);
+  }
+
+protected:
+  G4int mCounter;
+  unsigned long long mStart;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline unsigned long long GateProfiler::ReadTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline void GateProfiler::Add(G4int counter, unsigned long long ticks)
+{
+  std::vector<Counter> * counters = sThreadCounters;
+  if (!counters || (size_t)counter >= counters->size())
+    counters = NewThreadCounters(counter);
+  (*counters)[counter].ticks += ticks;
+  (*counters)[counter].calls++;
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEPROFILER_HH */
@@ -284,6 +284,8 @@ class GateSingleTree : public  TTree
     virtual inline ~GateSingleTree() {}
 
     void Init(GateRootSingleBuffer& buffer);
+    //! Read back a tree written by Init (the branches absent from the tree are skipped)
+    static void SetBranchAddresses(TTree* singleTree,GateRootSingleBuffer& buffer);
 };
 
 
@@ -20,6 +20,11 @@
   - RunInitialisation(): overload of G4RunManager()::RunInitialisation() that resets the geometry
   navigator.
 
+  - With GATE_USE_MT, GateRunManager derives from G4MTRunManager. Worker i
+  processes the events i, i+n, i+2n... (n threads) and each event is seeded
+  from the run seed and its event ID, so that a run is reproducible for a
+  given seed and number of threads.
+
   \sa GateSystemComponent, GateBoxCreatorComponent, GateArrayRepeater
 */
 
@@ -27,13 +32,24 @@
 #ifndef GateRunManager_h
 #define GateRunManager_h 1
 
-#include "G4RunManager.hh"
+#include "GateConfiguration.h"
 #include "GateHounsfieldToMaterialsBuilder.hh"
+#include "GateMTHelper.hh"
+
+#ifdef GATE_USE_MT
+#include "G4MTRunManager.hh"
+typedef G4MTRunManager GateRunManagerBase;
+#else
+#include "G4RunManager.hh"
+typedef G4RunManager GateRunManagerBase;
+#endif
+
+#include <vector>
 
 class GateRunManagerMessenger;
 class GateDetectorConstruction;
 
-class GateRunManager : public G4RunManager
+class GateRunManager : public GateRunManagerBase
 {
 public:
   //! Constructor
@@ -58,15 +74,40 @@ public:
   //! Overload of G4RunManager()::RunInitialisation() that resets the geometry navigator
   void RunInitialization();
 
-  //! Return the instance of the run manager
+  //! Return the instance of the run manager (the master one in MT mode)
+#ifdef GATE_USE_MT
+  static GateRunManager* GetRunManager()
+  {	return dynamic_cast<GateRunManager*>(G4MTRunManager::GetMasterRunManager()); }
+#else
   static GateRunManager* GetRunManager()
   {	return dynamic_cast<GateRunManager*>(G4RunManager::GetRunManager()); }
+#endif
 
   bool GetGlobalOutputFlag() { return mGlobalOutputFlag; }
   void EnableGlobalOutput(bool b) { mGlobalOutputFlag = b; }
   void SetUserPhysicList(G4VUserPhysicsList * m) { mUserPhysicList = m; }
   void SetUserPhysicListName(G4String m) { mUserPhysicListName = m; }
 
+#ifdef GATE_USE_MT
+  //! Event dispatching and seeding of the worker threads
+  virtual void InitializeEventLoop(G4int n_event, const char* macroFile=0, G4int n_select=-1);
+  virtual G4bool InitializeSeeds(G4int) { return true; }
+  virtual G4bool SetUpAnEvent(G4Event*, long& s1, long& s2, long& s3, G4bool reseedRequired=true);
+  virtual G4int SetUpNEvents(G4Event*, G4SeedsQueue* seedsQueue, G4bool reseedRequired=true);
+
+  //! The run stops after this event (called by a worker when the sources are exhausted)
+  void AbortRunAfterEvent(G4int eventID);
+
+  //! Primary generation is processed in event ID order by the workers
+  GateEventSequencer & GetGenerationSequencer() { return mGenerationSequencer; }
+
+protected:
+  //! Do not send the /gate/ commands to the workers (their objects are shared)
+  virtual void PrepareCommandsStack();
+  bool GetNextEvent(G4int & eventID);
+  void ComputeEventSeeds(G4int eventID, long * seeds, int n);
+#endif
+
 private :
 
   GateDetectorConstruction* detConstruction;
@@ -77,6 +118,14 @@ private :
   bool mGlobalOutputFlag;
   G4VUserPhysicsList * mUserPhysicList;
   G4String mUserPhysicListName;
+
+#ifdef GATE_USE_MT
+  std::mutex mDispatchMutex;
+  std::vector<G4int> mNextEventIDs; //!< next event of each worker
+  G4int mLastEventID;
+  unsigned long long mRunSeed;
+  GateEventSequencer mGenerationSequencer;
+#endif
 };
 //----------------------------------------------------------------------------------------
 
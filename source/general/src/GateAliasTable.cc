@@ -0,0 +1,60 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateAliasTable.hh"
+
+//-----------------------------------------------------------------------------
+void GateAliasTable::Clear()
+{
+  mEntries.clear();
+  mTotalWeight = 0.;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateAliasTable::Build(const std::vector<G4double> & weights)
+{
+  mTotalWeight = 0.;
+  for (size_t i = 0; i < weights.size(); i++) mTotalWeight += weights[i];
+  if (mTotalWeight <= 0.) {
+    Clear();
+    return;
+  }
+
+  // Probabilities scaled so that the mean is 1
+  const G4int n = weights.size();
+  const G4double scale = n / mTotalWeight;
+  mEntries.resize(n);
+  mSmall.clear();
+  mLarge.clear();
+  for (G4int i = 0; i < n; i++) {
+    mEntries[i].probability = weights[i] * scale;
+    mEntries[i].alias = i;
+    if (mEntries[i].probability < 1.0) mSmall.push_back(i);
+    else mLarge.push_back(i);
+  }
+
+  // Each small entry is completed by a large one
+  while (!mSmall.empty() && !mLarge.empty()) {
+    const G4int s = mSmall.back();
+    const G4int l = mLarge.back();
+    mSmall.pop_back();
+    mEntries[s].alias = l;
+    mEntries[l].probability -= 1.0 - mEntries[s].probability;
+    if (mEntries[l].probability < 1.0) {
+      mLarge.pop_back();
+      mSmall.push_back(l);
+    }
+  }
+
+  // Remaining entries (rounding errors) are kept with probability 1
+  for (size_t i = 0; i < mSmall.size(); i++) mEntries[mSmall[i]].probability = 1.0;
+  for (size_t i = 0; i < mLarge.size(); i++) mEntries[mLarge[i]].probability = 1.0;
+}
+//-----------------------------------------------------------------------------
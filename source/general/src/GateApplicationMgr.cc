@@ -21,9 +21,13 @@
 #include "GateVSource.hh"
 #include "GateSourceMgr.hh"
 #include "GateOutputMgr.hh"
+#include "GateProfiler.hh"
 #include <algorithm> /* min and max */
 
 GateApplicationMgr* GateApplicationMgr::instance = 0;
+#ifdef GATE_USE_MT
+G4ThreadLocal G4double GateApplicationMgr::mThreadTime = 0;
+#endif
 //------------------------------------------------------------------------------------------
 GateApplicationMgr::GateApplicationMgr():
   nVerboseLevel(0), m_time(0),
@@ -592,9 +596,17 @@ void GateApplicationMgr::EnableTimeStudyForSteps(G4String filename)
 }
 //------------------------------------------------------------------------------------------
 
+
+//------------------------------------------------------------------------------------------
+void GateApplicationMgr::EnableCallbackProfiler(G4String filename)
+{
+  GateProfiler::Enable(filename);
+}
+//------------------------------------------------------------------------------------------
+
 void GateApplicationMgr::PrintStatus()
 {
-  const G4Run * run = GateRunManager::GetRunManager()->GetCurrentRun();
+  const G4Run * run = G4RunManager::GetRunManager()->GetCurrentRun();
   const int runID = run->GetRunID() + 1;
   const int runTotal = mTimeSlices.size()-1;
 
@@ -127,6 +127,10 @@ GateApplicationMgrMessenger::GateApplicationMgrMessenger()
   TimeStudyForStepsCmd = new G4UIcmdWithAString("/gate/application/enableStepAndTrackTimeStudy", this);
   TimeStudyForStepsCmd->SetGuidance("Activate the time measurement of steps and tracks (Slow down the simulation).");
   TimeStudyForStepsCmd->SetParameterName("File name",false);
+
+  CallbackProfilerCmd = new G4UIcmdWithAString("/gate/application/enableCallbackProfiler", this);
+  CallbackProfilerCmd->SetGuidance("Measure the time and number of calls of the callbacks of the actors, sensitive detectors and output modules. The report is printed and written in the given JSON file at the end of each run.");
+  CallbackProfilerCmd->SetParameterName("File name",false);
 }
 //-------------------------------------------------------------------------------------------------------------------
 
@@ -156,6 +160,7 @@ GateApplicationMgrMessenger::~GateApplicationMgrMessenger()
   delete AddSliceCmd;
   delete TimeStudyCmd;
   delete TimeStudyForStepsCmd;
+  delete CallbackProfilerCmd;
 
   //LSLS
   delete ReadNumberOfPrimariesInAFileCmd;
@@ -248,5 +253,8 @@ void GateApplicationMgrMessenger::SetNewValue(G4UIcommand* command, G4String new
   else if (command == TimeStudyForStepsCmd) {
     appMgr->EnableTimeStudyForSteps(newValue);
   }
+  else if (command == CallbackProfilerCmd) {
+    appMgr->EnableCallbackProfiler(newValue);
+  }
 }
 //-------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,49 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateCacheFile.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+bool GateCacheFile::Write(const std::string & fileName,
+                          const std::function<void(std::ostream &)> & write)
+{
+  // Created exclusively next to the target (mkstemp), so that the name is
+  // unique among the threads, processes and hosts writing the same file
+  // (e.g. on a shared NFS directory), and the rename stays atomic
+  const std::string pattern = fileName + ".tmp.XXXXXX";
+  std::vector<char> name(pattern.begin(), pattern.end());
+  name.push_back('\0');
+  const int fd = mkstemp(name.data());
+  if (fd < 0) return false;
+  fchmod(fd, 0644); // mkstemp creates it readable by its owner only
+  close(fd);
+  const std::string tmpName(name.data());
+  {
+    std::ofstream os(tmpName.c_str(), std::ios::binary);
+    if (os) write(os);
+    os.close();
+    if (!os) {
+      std::remove(tmpName.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+    std::remove(tmpName.c_str());
+    return false;
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,139 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateIAEAMappedFile.hh"
+#include "GateMessageManager.hh"
+
+#include <cmath>
+#include <cstring>
+
+// after the standard headers (defines min and max macros)
+#include "GateIAEARecord.h"
+
+//-----------------------------------------------------------------------------
+namespace {
+  // Floats of a record, as read by iaea_record_type::read_particle: the
+  // energy, the stored coordinates and weight, and the extra floats
+  G4int NumberOfFloats(const iaea_record_type * record)
+  {
+    G4int n = 1;
+    if (record->ix > 0) n++;
+    if (record->iy > 0) n++;
+    if (record->iz > 0) n++;
+    if (record->iu > 0) n++;
+    if (record->iv > 0) n++;
+    if (record->iweight > 0) n++;
+    if (record->iextrafloat > 0) n += record->iextrafloat;
+    return n;
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateIAEAMappedFile::GateIAEAMappedFile()
+  : mPosition(0), mRecordLength(0), mNumberOfFloats(0)
+{
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateIAEAMappedFile::~GateIAEAMappedFile()
+{
+  Close();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4int GateIAEAMappedFile::ComputeRecordLength(const iaea_record_type * record)
+{
+  // particle type, floats and extra longs
+  G4int length = sizeof(char) + NumberOfFloats(record)*sizeof(float);
+  if (record->iextralong > 0) length += record->iextralong*sizeof(IAEA_I32);
+  return length;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateIAEAMappedFile::Open(const G4String & fileName, const iaea_record_type * record,
+                                G4int headerRecordLength)
+{
+  Close();
+  mRecordLength = ComputeRecordLength(record);
+  mNumberOfFloats = NumberOfFloats(record);
+  if (headerRecordLength > 0 && headerRecordLength != mRecordLength) {
+    GateMessage("Beam", 1, "IAEA phase space " << fileName << ": record length " << headerRecordLength
+                << " in the header, " << mRecordLength << " from the record contents. The file is not mapped.\n");
+    return false;
+  }
+
+  return mFile.Open(fileName, true);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateIAEAMappedFile::Close()
+{
+  mFile.Close();
+  mPosition = 0;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateIAEAMappedFile::ReadParticle(iaea_record_type * record)
+{
+  if (!mFile.IsOpen() || mPosition + mRecordLength > mFile.GetSize()) return false;
+  const char * p = mFile.GetData() + mPosition;
+  mPosition += mRecordLength;
+
+  // see iaea_record_type::read_particle
+  short particle = (short) p[0];
+  p += sizeof(char);
+  int is = 1; // sign of the Z director cosine w
+  if (particle < 0) { is = -1; particle = -particle; }
+  record->particle = particle;
+
+  float floatArray[NUM_EXTRA_FLOAT+7];
+  memcpy(floatArray, p, mNumberOfFloats*sizeof(float));
+  p += mNumberOfFloats*sizeof(float);
+
+  record->IsNewHistory = (floatArray[0] < 0) ? 1 : 0;
+  record->energy = fabs(floatArray[0]);
+
+  int i = 0;
+  if (record->ix > 0) record->x = floatArray[++i];
+  if (record->iy > 0) record->y = floatArray[++i];
+  if (record->iz > 0) record->z = floatArray[++i];
+  if (record->iu > 0) record->u = floatArray[++i];
+  if (record->iv > 0) record->v = floatArray[++i];
+  if (record->iweight > 0) record->weight = floatArray[++i];
+  for (int j = 0; j < record->iextrafloat; j++) record->extrafloat[j] = floatArray[++i];
+
+  if (record->iw > 0) {
+    const float u = record->u;
+    const float v = record->v;
+    record->w = 0.f;
+    double aux = (u*u + v*v);
+    if (aux <= 1.0) record->w = (float) (is * sqrt((float)(1.0 - aux)));
+    else {
+      aux = sqrt((float)aux);
+      record->u /= (float)aux;
+      record->v /= (float)aux;
+    }
+  }
+
+  if (record->iextralong > 0)
+    memcpy(record->extralong, p, record->iextralong*sizeof(IAEA_I32));
+  return true;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateMTHelper.hh"
+
+#ifdef GATE_USE_MT
+#include "G4Threading.hh"
+#include "G4MTRunManager.hh"
+#endif
+
+#include <climits>
+
+//-----------------------------------------------------------------------------
+bool GateMTHelper::IsMultithreaded()
+{
+#ifdef GATE_USE_MT
+  return true;
+#else
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+bool GateMTHelper::IsWorkerThread()
+{
+#ifdef GATE_USE_MT
+  return G4Threading::IsWorkerThread();
+#else
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+int GateMTHelper::GetNumberOfThreads()
+{
+#ifdef GATE_USE_MT
+  G4MTRunManager * rm = G4MTRunManager::GetMasterRunManager();
+  if (rm) return rm->GetNumberOfThreads();
+#endif
+  return 1;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+int GateMTHelper::GetThreadIndex()
+{
+#ifdef GATE_USE_MT
+  return G4Threading::G4GetThreadId();
+#else
+  return 0;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateEventSequencer::GateEventSequencer()
+{
+  Reset();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateEventSequencer::Reset()
+{
+#ifdef GATE_USE_MT
+  std::lock_guard<std::mutex> lock(mMutex);
+#endif
+  mNextEventID = 0;
+  mLastEventID = INT_MAX;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+bool GateEventSequencer::Wait(G4int eventID)
+{
+#ifdef GATE_USE_MT
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this, eventID] {
+      return eventID <= mNextEventID || eventID > mLastEventID; });
+#endif
+  return eventID <= mLastEventID;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateEventSequencer::Release(G4int eventID)
+{
+#ifdef GATE_USE_MT
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (eventID >= mNextEventID) mNextEventID = eventID+1;
+  }
+  mCondition.notify_all();
+#else
+  mNextEventID = eventID+1;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateEventSequencer::Abort(G4int lastEventID)
+{
+#ifdef GATE_USE_MT
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (lastEventID < mLastEventID) mLastEventID = lastEventID;
+  }
+  mCondition.notify_all();
+#else
+  if (lastEventID < mLastEventID) mLastEventID = lastEventID;
+#endif
+}
+//-----------------------------------------------------------------------------
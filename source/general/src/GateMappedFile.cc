@@ -0,0 +1,72 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateMappedFile.hh"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GATE_USE_MMAP
+#endif
+
+//-----------------------------------------------------------------------------
+GateMappedFile::GateMappedFile()
+  : mData(0), mSize(0)
+{
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateMappedFile::~GateMappedFile()
+{
+  Close();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateMappedFile::Open(const G4String & fileName, G4bool isSequential)
+{
+  Close();
+#ifdef GATE_USE_MMAP
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  void * data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+  if (data == MAP_FAILED) return false;
+  if (isSequential) madvise(data, st.st_size, MADV_SEQUENTIAL);
+  mData = static_cast<const char *>(data);
+  mSize = st.st_size;
+  return true;
+#else
+  (void)fileName;
+  (void)isSequential;
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateMappedFile::Close()
+{
+#ifdef GATE_USE_MMAP
+  if (mData) munmap(const_cast<char *>(mData), mSize);
+#endif
+  mData = 0;
+  mSize = 0;
+}
+//-----------------------------------------------------------------------------
@@ -657,7 +657,7 @@ int GetIndexFromTime(std::vector<double> & mTimeList, double aTime) {
 G4String GetSaveCurrentFilename(G4String & mSaveFilename) {
   int nr=0;
   // int ne=0;
-  const G4Run * run = GateRunManager::GetRunManager()->GetCurrentRun();
+  const G4Run * run = G4RunManager::GetRunManager()->GetCurrentRun();
   if (run) nr = run->GetRunID();
   else {
     nr = 0;
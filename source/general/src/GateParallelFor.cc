@@ -0,0 +1,53 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateParallelFor.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+unsigned int GateParallel::GetNumberOfThreads(size_t n)
+{
+  const size_t nbCores = std::max(1u, std::thread::hardware_concurrency());
+  return (unsigned int)std::max<size_t>(1, std::min(nbCores, n));
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateParallel::For(size_t n, const std::function<void(unsigned int, size_t)> & f)
+{
+  const unsigned int nbThreads = GetNumberOfThreads(n);
+  std::atomic<size_t> next(0);
+  auto worker = [&f, &next, n](unsigned int t) {
+    size_t i;
+    while ((i = next++) < n) f(t, i);
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < nbThreads; t++) threads.push_back(std::thread(worker, t));
+  worker(0);
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateParallel::ForChunks(size_t n, unsigned int nbChunks,
+                             const std::function<void(unsigned int, size_t, size_t)> & f)
+{
+  if (nbChunks < 1) nbChunks = 1;
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < nbChunks; t++)
+    threads.push_back(std::thread(f, t, n*t/nbChunks, n*(t+1)/nbChunks));
+  f(0, 0, n/nbChunks);
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+//-----------------------------------------------------------------------------
@@ -27,15 +27,23 @@ See LICENSE.md for further details
 //#include "GateHitFileReader.hh"
 
 #include "GateConfiguration.h"
+#include "GateRunManager.hh"
+
+G4ThreadLocal GatePrimaryGeneratorAction * GatePrimaryGeneratorAction::pInstance = 0;
+#ifdef GATE_USE_MT
+G4int GatePrimaryGeneratorAction::mNumberOfGeneratedEvents = 0;
+#endif
 
 //---------------------------------------------------------------------------
 GatePrimaryGeneratorAction::GatePrimaryGeneratorAction()
 {
+  pInstance = this;
   m_messenger = new GatePrimaryGeneratorMessenger(this);
   m_printModulo  = 100;
   m_nVerboseLevel = 0;
   m_particleGun  = 0;//new G4GeneralParticleSource();
   m_useGPS = false;
+  m_nEvents = 0;
 }
 //---------------------------------------------------------------------------
 
@@ -92,23 +100,41 @@ void GatePrimaryGeneratorAction::GenerateSimulationPrimaries(G4Event* event)
   //! compute the right number of events per slice at this time
   G4int eventID = event->GetEventID();
   GateSourceMgr* sourceMgr = GateSourceMgr::GetInstance();
+#ifdef GATE_USE_MT
+  // Sources and clock are shared by the workers: the events are generated
+  // one at a time, in event ID order. The run is prepared by the master.
+  GateEventSequencer & sequencer = GateRunManager::GetRunManager()->GetGenerationSequencer();
+  if (!sequencer.Wait(eventID)) {
+    // the sources have been exhausted by a previous event
+    G4RunManager::GetRunManager()->AbortRun(true);
+    return;
+  }
+#else
   if (eventID==0) {
-    const G4Run* currentRun = GateRunManager::GetRunManager()->GetCurrentRun();
+    const G4Run* currentRun = G4RunManager::GetRunManager()->GetCurrentRun();
     //if( currentRun->GetRunID()==0) sourceMgr->Initialization();
     sourceMgr->PrepareNextRun( currentRun );
     m_nEvents=0;
   }
+#endif
 
   G4int numVertices = sourceMgr->PrepareNextEvent(event);
   //! stop the run if no particle has been generated by the source manager
   if (numVertices == 0) {
-    GateRunManager* runManager = GateRunManager::GetRunManager();
+    G4RunManager* runManager = G4RunManager::GetRunManager();
 
     runManager->AbortRun(true);
+#ifdef GATE_USE_MT
+    GateRunManager::GetRunManager()->AbortRunAfterEvent(eventID);
+#endif
     if (m_nVerboseLevel>1) G4cout << "GatePrimaryGeneratorAction::GeneratePrimaries: numVertices == 0, run aborted \n";
   }
   else {
+#ifdef GATE_USE_MT
+    m_nEvents = ++mNumberOfGeneratedEvents;
+#else
     m_nEvents++;
+#endif
     G4PrimaryParticle  * p = event->GetPrimaryVertex(0)->GetPrimary(0);
 //    if(sourceMgr->GetWeight()>0)  event->GetPrimaryVertex()->SetWeight(sourceMgr->GetWeight());
      if(sourceMgr->GetWeight()>0)  p->SetWeight(sourceMgr->GetWeight());
@@ -119,9 +145,23 @@ void GatePrimaryGeneratorAction::GenerateSimulationPrimaries(G4Event* event)
       }
     }
   }
+#ifdef GATE_USE_MT
+  sourceMgr->SaveEventStateOfThisThread();
+  sequencer.Release(eventID);
+#endif
 }
 //---------------------------------------------------------------------------
 
+#ifdef GATE_USE_MT
+//---------------------------------------------------------------------------
+void GatePrimaryGeneratorAction::PrepareNextRun(const G4Run * run)
+{
+  GateSourceMgr::GetInstance()->PrepareNextRun(run);
+  mNumberOfGeneratedEvents = 0;
+}
+//---------------------------------------------------------------------------
+#endif
+
 /*
 //---------------------------------------------------------------------------
 void GatePrimaryGeneratorAction::GenerateDigitisationPrimaries(G4Event* event)
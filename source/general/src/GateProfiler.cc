@@ -0,0 +1,172 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateProfiler.hh"
+#include "GateMessageManager.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+G4bool GateProfiler::sEnabled = false;
+G4ThreadLocal std::vector<GateProfiler::Counter> * GateProfiler::sThreadCounters = 0;
+
+//-----------------------------------------------------------------------------
+namespace {
+  struct GateProfilerCounterInfo {
+    G4String category;
+    G4String name;
+    G4String callback;
+  };
+
+  // Registered counters and counters of all threads, protected by the mutex
+  std::mutex & GetProfilerMutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+  std::vector<GateProfilerCounterInfo> gCounterInfos;
+  std::map<G4String, G4int> gCounterIds;
+  std::vector<std::unique_ptr<std::vector<GateProfiler::Counter> > > gThreadCounters;
+
+  G4String gJsonFileName;
+  unsigned long long gStartTicks = 0;
+  std::chrono::steady_clock::time_point gStartTime;
+
+  std::string JsonString(const G4String & s)
+  {
+    std::ostringstream os;
+    os << '"';
+    for (size_t i=0; i<s.size(); i++) {
+      if (s[i] == '"' || s[i] == '\\') os << '\\';
+      os << s[i];
+    }
+    os << '"';
+    return os.str();
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateProfiler::Enable(const G4String & jsonFileName)
+{
+  gJsonFileName = jsonFileName;
+  gStartTicks = ReadTicks();
+  gStartTime = std::chrono::steady_clock::now();
+  sEnabled = true;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4int GateProfiler::Register(const G4String & category, const G4String & name,
+                             const G4String & callback)
+{
+  const G4String key = category + "/" + name + "/" + callback;
+  std::lock_guard<std::mutex> lock(GetProfilerMutex());
+  std::map<G4String, G4int>::const_iterator it = gCounterIds.find(key);
+  if (it != gCounterIds.end()) return it->second;
+  const G4int id = gCounterInfos.size();
+  GateProfilerCounterInfo info = { category, name, callback };
+  gCounterInfos.push_back(info);
+  gCounterIds[key] = id;
+  return id;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+std::vector<GateProfiler::Counter> * GateProfiler::NewThreadCounters(G4int counter)
+{
+  std::lock_guard<std::mutex> lock(GetProfilerMutex());
+  if (!sThreadCounters) {
+    gThreadCounters.push_back(std::unique_ptr<std::vector<Counter> >(new std::vector<Counter>));
+    sThreadCounters = gThreadCounters.back().get();
+  }
+  const size_t size = std::max((size_t)counter+1, gCounterInfos.size());
+  const Counter zero = { 0, 0 };
+  sThreadCounters->resize(size, zero);
+  return sThreadCounters;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateProfiler::Report()
+{
+  if (!sEnabled) return;
+
+  // Ticks per second, from the wall clock time since Enable()
+  const double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - gStartTime).count();
+  const unsigned long long elapsedTicks = ReadTicks() - gStartTicks;
+  const double secondsPerTick = (elapsedTicks > 0) ? wallTime/elapsedTicks : 0.;
+
+  // Sum of the threads
+  std::lock_guard<std::mutex> lock(GetProfilerMutex());
+  const size_t n = gCounterInfos.size();
+  std::vector<Counter> total(n);
+  for (size_t i=0; i<n; i++) total[i].ticks = total[i].calls = 0;
+  for (size_t t=0; t<gThreadCounters.size(); t++) {
+    const std::vector<Counter> & c = *gThreadCounters[t];
+    for (size_t i=0; i<c.size() && i<n; i++) {
+      total[i].ticks += c[i].ticks;
+      total[i].calls += c[i].calls;
+    }
+  }
+
+  std::vector<size_t> order;
+  for (size_t i=0; i<n; i++) if (total[i].calls > 0) order.push_back(i);
+  std::sort(order.begin(), order.end(),
+            [&total](size_t a, size_t b) { return total[a].ticks > total[b].ticks; });
+
+  // Report sorted by time (the time of all threads is summed)
+  std::ostringstream os;
+  os << "Callback profiler: wall time " << wallTime << " s, "
+     << gThreadCounters.size() << " thread(s)\n"
+     << std::setw(12) << "time (s)" << std::setw(10) << "% wall"
+     << std::setw(14) << "calls" << std::setw(12) << "ns/call" << "  callback\n";
+  for (size_t k=0; k<order.size(); k++) {
+    const size_t i = order[k];
+    const double time = total[i].ticks * secondsPerTick;
+    os << std::setw(12) << std::setprecision(4) << time
+       << std::setw(10) << std::setprecision(3) << (wallTime > 0 ? 100.*time/wallTime : 0.)
+       << std::setw(14) << total[i].calls
+       << std::setw(12) << std::setprecision(4) << 1e9*time/total[i].calls
+       << "  " << gCounterInfos[i].category << " " << gCounterInfos[i].name
+       << " " << gCounterInfos[i].callback << "\n";
+  }
+  GateMessage("Core", 0, os.str());
+
+  if (gJsonFileName == "") return;
+  std::ofstream json(gJsonFileName.c_str());
+  if (!json) {
+    GateWarning("Cannot write the profiler report in " << gJsonFileName);
+    return;
+  }
+  json << "{\n"
+       << "  \"wallTime\": " << wallTime << ",\n"
+       << "  \"threads\": " << gThreadCounters.size() << ",\n"
+       << "  \"counters\": [";
+  for (size_t k=0; k<order.size(); k++) {
+    const size_t i = order[k];
+    json << (k ? ",\n" : "\n")
+         << "    {\"category\": " << JsonString(gCounterInfos[i].category)
+         << ", \"name\": " << JsonString(gCounterInfos[i].name)
+         << ", \"callback\": " << JsonString(gCounterInfos[i].callback)
+         << ", \"calls\": " << total[i].calls
+         << ", \"time\": " << total[i].ticks * secondsPerTick << "}";
+  }
+  json << "\n  ]\n}\n";
+}
+//-----------------------------------------------------------------------------
@@ -446,6 +446,40 @@ void GateSingleTree::Init(GateRootSingleBuffer& buffer)
 }
 
 
+
+static void SetBranchAddressIfAny(TTree* tree, const char* name, void* address)
+{
+  if (tree->GetBranch(name))
+    tree->SetBranchAddress(name,address);
+}
+
+void GateSingleTree::SetBranchAddresses(TTree* singleTree,GateRootSingleBuffer& buffer)
+{
+  // Same branches as Init: those of the ASCII mask only
+  SetBranchAddressIfAny(singleTree,"runID",&buffer.runID);
+  SetBranchAddressIfAny(singleTree,"eventID",&buffer.eventID);
+  SetBranchAddressIfAny(singleTree,"sourceID",&buffer.sourceID);
+  SetBranchAddressIfAny(singleTree,"sourcePosX",&buffer.sourcePosX);
+  SetBranchAddressIfAny(singleTree,"sourcePosY",&buffer.sourcePosY);
+  SetBranchAddressIfAny(singleTree,"sourcePosZ",&buffer.sourcePosZ);
+  SetBranchAddressIfAny(singleTree,"time",&buffer.time);
+  SetBranchAddressIfAny(singleTree,"energy",&buffer.energy);
+  SetBranchAddressIfAny(singleTree,"globalPosX",&buffer.globalPosX);
+  SetBranchAddressIfAny(singleTree,"globalPosY",&buffer.globalPosY);
+  SetBranchAddressIfAny(singleTree,"globalPosZ",&buffer.globalPosZ);
+  for (size_t d=0; d<ROOT_OUTPUTIDSIZE ; ++d)
+    SetBranchAddressIfAny(singleTree,outputIDName[d],(void *)(buffer.outputID+d));
+  SetBranchAddressIfAny(singleTree,"comptonPhantom",&buffer.comptonPhantom);
+  SetBranchAddressIfAny(singleTree,"comptonCrystal",&buffer.comptonCrystal);
+  SetBranchAddressIfAny(singleTree,"RayleighPhantom",&buffer.RayleighPhantom);
+  SetBranchAddressIfAny(singleTree,"RayleighCrystal",&buffer.RayleighCrystal);
+  SetBranchAddressIfAny(singleTree,"axialPos",&buffer.axialPos);
+  SetBranchAddressIfAny(singleTree,"rotationAngle",&buffer.rotationAngle);
+  SetBranchAddressIfAny(singleTree,"comptVolName",(void *)buffer.comptonVolumeName);
+  SetBranchAddressIfAny(singleTree,"RayleighVolName",(void *)buffer.RayleighVolumeName);
+  SetBranchAddressIfAny(singleTree,"septalNb",&buffer.septalNb);
+}
+
 void GateRootCoincBuffer::Clear()
 {
   size_t d;
@@ -25,6 +25,13 @@
 
 #include "G4RadioactiveDecayPhysics.hh"
 
+#ifdef GATE_USE_MT
+#include "G4Threading.hh"
+#include "G4Event.hh"
+#include "Randomize.hh"
+#include <climits>
+#endif
+
 #if (G4VERSION_MAJOR > 9)
 
 #include "G4StepLimiterPhysics.hh"
@@ -32,13 +39,19 @@
 #endif
 
 //----------------------------------------------------------------------------------------
-GateRunManager::GateRunManager() : G4RunManager() {
+GateRunManager::GateRunManager() : GateRunManagerBase() {
     pMessenger = new GateRunManagerMessenger(this);
     mHounsfieldToMaterialsBuilder = new GateHounsfieldToMaterialsBuilder();
     mIsGateInitializationCalled = false;
     mUserPhysicList = 0;
     mUserPhysicListName = "";
     EnableGlobalOutput(true);
+#ifdef GATE_USE_MT
+    // Events are requested one by one, see SetUpNEvents
+    SetEventModulo(1);
+    mLastEventID = INT_MAX;
+    mRunSeed = 0;
+#endif
 }
 //----------------------------------------------------------------------------------------
 
@@ -221,7 +234,7 @@ void GateRunManager::RunInitialization() {
 
     // GateMessage("Core", 0, "Initialization of the run \n");
     // Perform a regular initialisation
-    G4RunManager::RunInitialization();
+    GateRunManagerBase::RunInitialization();
 
     // Initialization of the atom deexcitation processes
     // must be done after all other initialization
@@ -240,3 +253,114 @@ void GateRunManager::RunInitialization() {
             ->LocateGlobalPointAndSetup(center, 0, false);
 }
 //----------------------------------------------------------------------------------------
+
+
+#ifdef GATE_USE_MT
+//----------------------------------------------------------------------------------------
+void GateRunManager::InitializeEventLoop(G4int n_event, const char *macroFile, G4int n_select) {
+    // One seed per run, drawn from the master engine: the per-event seeds
+    // only depend on it and on the event ID (see ComputeEventSeeds)
+    const unsigned long long high = (unsigned long long) (G4UniformRand() * 4294967296.0);
+    const unsigned long long low = (unsigned long long) (G4UniformRand() * 4294967296.0);
+    mRunSeed = (high << 32) | low;
+
+    // Worker i processes the events i, i+n, i+2n... (n threads): each
+    // thread always sums the same events in the same order, and the
+    // merge in thread index order gives the same result at each run
+    mNextEventIDs.assign(GetNumberOfThreads(), 0);
+    for (size_t i = 0; i < mNextEventIDs.size(); i++) mNextEventIDs[i] = i;
+    mLastEventID = INT_MAX;
+    mGenerationSequencer.Reset();
+
+    G4MTRunManager::InitializeEventLoop(n_event, macroFile, n_select);
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+bool GateRunManager::GetNextEvent(G4int &eventID) {
+    const int thread = GateMTHelper::GetThreadIndex();
+    std::lock_guard<std::mutex> lock(mDispatchMutex);
+    if (thread < 0 || thread >= (int) mNextEventIDs.size()) {
+        GateError("GateRunManager: event requested by an unknown thread (" << thread << ")");
+    }
+    eventID = mNextEventIDs[thread];
+    if (eventID >= numberOfEventToBeProcessed || eventID > mLastEventID) return false;
+    mNextEventIDs[thread] += mNextEventIDs.size();
+    numberOfEventProcessed++;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+// splitmix64 of the run seed and the event ID. Seeds are kept positive and
+// non-zero on 31 bits, as expected by all CLHEP engines.
+void GateRunManager::ComputeEventSeeds(G4int eventID, long *seeds, int n) {
+    unsigned long long x = mRunSeed ^ ((unsigned long long) eventID * 0xd1b54a32d192ed03ULL);
+    for (int i = 0; i < n; i++) {
+        x += 0x9e3779b97f4a7c15ULL;
+        unsigned long long z = x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+        seeds[i] = (long) (z & 0x7fffffffULL);
+        if (seeds[i] == 0) seeds[i] = 1;
+    }
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+G4bool GateRunManager::SetUpAnEvent(G4Event *evt, long &s1, long &s2, long &s3, G4bool reseedRequired) {
+    G4int eventID;
+    if (!GetNextEvent(eventID)) return false;
+    evt->SetEventID(eventID);
+    if (reseedRequired) {
+        long seeds[3];
+        ComputeEventSeeds(eventID, seeds, 3);
+        s1 = seeds[0];
+        s2 = seeds[1];
+        if (nSeedsPerEvent == 3) s3 = seeds[2];
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+G4int GateRunManager::SetUpNEvents(G4Event *evt, G4SeedsQueue *seedsQueue, G4bool reseedRequired) {
+    G4int eventID;
+    if (!GetNextEvent(eventID)) return 0;
+    evt->SetEventID(eventID);
+    if (reseedRequired) {
+        long seeds[3];
+        ComputeEventSeeds(eventID, seeds, nSeedsPerEvent);
+        for (int i = 0; i < nSeedsPerEvent; i++) seedsQueue->push(seeds[i]);
+    }
+    return 1;
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+void GateRunManager::AbortRunAfterEvent(G4int eventID) {
+    {
+        std::lock_guard<std::mutex> lock(mDispatchMutex);
+        if (eventID < mLastEventID) mLastEventID = eventID;
+    }
+    mGenerationSequencer.Abort(eventID);
+}
+//----------------------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------------------
+void GateRunManager::PrepareCommandsStack() {
+    G4MTRunManager::PrepareCommandsStack();
+    std::vector<G4String> cmds;
+    for (auto &c:uiCmdsForWorkers)
+        if (c.substr(0, 6) != "/gate/") cmds.push_back(c);
+    uiCmdsForWorkers = cmds;
+}
+//----------------------------------------------------------------------------------------
+#endif
@@ -73,6 +73,9 @@ public:
   virtual ~GateDetectorConstruction();
 
   virtual G4VPhysicalVolume* Construct();
+#ifdef GATE_USE_MT
+  virtual void ConstructSDandField();
+#endif
   virtual void UpdateGeometry();
   virtual void SetMagField (G4ThreeVector);
   virtual void SetMagFieldTabulatedFile (G4String);
@@ -103,6 +106,7 @@ public:
   // Material DB
   /// Mandatory : Adds a Material Database to use (filename, callback for Messenger)
   void AddFileToMaterialDatabase(const G4String& f);
+  void SetMaterialDatabaseCacheDirectory(const G4String& dir);
 
   static GateDetectorConstruction* GetGateDetectorConstruction()
   {
@@ -154,6 +158,11 @@ public:
 
   virtual void DestroyGeometry();
 
+  //! Updates the placements (Construct(true)) and re-optimises only the
+  //! mother volumes of the moved placements. Returns false if the solids
+  //! or the number of volumes changed: the whole geometry must be closed again.
+  G4bool UpdateMovedPlacements();
+
   //void SetIonisationPotential(G4String n, G4double v){mMaterialDatabase.SetMaterialIoniPotential(n,v);}
 
   void SetMaterialIoniPotential(G4String n,G4double v){theListOfIonisationPotential[n]=v;}
@@ -39,6 +39,8 @@ class GateFictitiousVoxelMap : public GateVFictitiousMap
 		inline G4int GetNx() const;
 		inline G4int GetNy() const;
 		inline G4int GetNz() const;
+		inline const G4ThreeVector& GetVoxelDim() const;
+		inline const G4ThreeVector& GetHalfContainerDim() const;
 		void Check() const;
 
 		inline G4Material* GetMaterial ( const G4ThreeVector& pos ) const;
@@ -65,6 +67,14 @@ inline G4int GateFictitiousVoxelMap::GetNz() const
 {
 	return m_nNz;
 }
+inline const G4ThreeVector& GateFictitiousVoxelMap::GetVoxelDim() const
+{
+	return m_nVoxelDim;
+}
+inline const G4ThreeVector& GateFictitiousVoxelMap::GetHalfContainerDim() const
+{
+	return m_nHalfContainerDim;
+}
 
 
 inline const GateCrossSectionsTable* GateFictitiousVoxelMap::GetCrossSectionsTable() const
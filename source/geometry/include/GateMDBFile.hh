@@ -18,6 +18,7 @@ See LICENSE.md for further details
 
 #include "GateMDBCreators.hh"
 #include "GateMDBFieldReader.hh"
+#include "GateMDBFileIndex.hh"
 
 class GateMaterialDatabase;
 
@@ -53,18 +54,18 @@ protected:
   void     ReadAllMaterialOptions(const G4String& materialName,const G4String& line,GateMaterialCreator* creator);
   void     ReadMaterialOption(const G4String& materialName,const G4String& field,GateMaterialCreator* creator);
 
-  void     FindSection(const G4String& name);
-  G4bool   LookForText(const G4String& text);
   G4String ReadItem(const G4String& sectionName,const G4String& itemName);
   G4int    ReadNonEmptyLine(G4String& lineBuffer);
-  G4int    ReadLine(G4String& lineBuffer);
 
 private:
   // Stores the database which instanciated this (used by creators)
   GateMaterialDatabase* mDatabase;
   G4String fileName;
   G4String filePath;
-  std::ifstream dbStream;
+  // Lines of the file, items indexed by name
+  GateMDBFileIndex mIndex;
+  // Next line read by ReadNonEmptyLine
+  G4int mCurrentLine;
 
 public:
   static char theStarterSeparator;
@@ -0,0 +1,109 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GateMDBFileIndex
+  \brief  Lines of a material database file, with the items of each section indexed by name
+
+  - The non empty lines of the file (cleaned up as by
+  GateMDBFile::ReadNonEmptyLine) are stored once, and the items of each
+  section ("name: ...") are sorted by name, so that an item is found
+  by a binary search instead of a scan of the file.
+
+  - When a cache directory is given, the index is a single binary block
+  written in this directory, and memory-mapped by the next runs (there
+  is no cache otherwise). The cache is used when the size of the
+  database file is unchanged and its modification time, or otherwise
+  the hash of its content, is the one stored in the cache; in the
+  latter case the new time is stored. It is rebuilt from the text
+  otherwise; a cache that cannot be written is not an error.
+
+  \sa GateMDBFile
+*/
+
+#ifndef GATEMDBFILEINDEX_HH
+#define GATEMDBFILEINDEX_HH
+
+#include "globals.hh"
+#include "GateMappedFile.hh"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+class GateMDBFileIndex
+{
+public:
+  GateMDBFileIndex();
+  ~GateMDBFileIndex();
+
+  /// Index of the database file: read from the cache of cacheDirectory
+  /// if it is up to date, built from the file otherwise (always if
+  /// cacheDirectory is empty). Return false if the file cannot be read.
+  G4bool Load(const G4String & filePath, const G4String & cacheDirectory = "");
+  void Clear();
+
+  /// Line of the first item named itemName in the section [sectionName],
+  /// or -1 if there is none
+  G4int FindItem(const G4String & sectionName, const G4String & itemName) const;
+
+  G4int GetNumberOfLines() const { return mHeader ? mHeader->nbLines : 0; }
+  G4String GetLine(G4int line) const;
+
+  /// True if the index has been read from the cache
+  G4bool IsReadFromCache() const { return mIsReadFromCache; }
+
+  static G4String GetCacheFileName(const G4String & filePath, const G4String & cacheDirectory);
+
+protected:
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t nbLines;
+    uint32_t nbSections;
+    uint32_t nbItems;
+    uint64_t sourceSize;
+    int64_t  sourceTime;
+    uint64_t sourceHash;
+    uint64_t size;       //!< size of the whole block
+  };
+  struct Section {
+    uint32_t nameOffset; //!< in the text
+    uint32_t nameLength;
+    uint32_t firstItem;
+    uint32_t nbItems;
+  };
+  struct Item {
+    uint32_t line;
+    uint32_t nameLength; //!< the name starts the line
+  };
+
+  void Build(const std::string & text, int64_t sourceTime);
+  G4bool Map(const G4String & cacheName);
+  void Write(const G4String & cacheName) const;
+  G4bool SetPointers(const char * data, size_t size);
+
+  static G4bool ReadText(const G4String & filePath, std::string & text);
+  static uint64_t Hash(const std::string & text);
+
+  // Either the mapped cache or mBuffer
+  const char * mData;
+  GateMappedFile mMappedFile;
+  std::vector<char> mBuffer;
+  G4bool mIsReadFromCache;
+
+  const Header * mHeader;
+  const uint32_t * mLineOffsets; //!< nbLines+1 offsets in the text
+  const Section * mSections;
+  const Item * mItems;
+  const char * mText;
+};
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEMDBFILEINDEX_HH */
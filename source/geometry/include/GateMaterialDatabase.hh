@@ -36,6 +36,11 @@ public:
 
   void AddMDBFile(const G4String& filename);
 
+  /// Directory of the index caches of the files added afterwards (next
+  /// to each file if empty, see GateMDBFileIndex)
+  void SetCacheDirectory(const G4String& dir) { mCacheDirectory = dir; }
+  const G4String& GetCacheDirectory() const { return mCacheDirectory; }
+
   G4Isotope*  GetIsotope(const G4String& isotopeName);
   G4Element*  GetElement(const G4String& name);
   G4Material* GetMaterial(const G4String& materialName);
@@ -53,6 +58,7 @@ protected:
 
 private:
   std::vector<GateMDBFile*> mMDBFile;
+  G4String mCacheDirectory;
   G4MaterialPropertiesTable * water_MPT;
 };
 
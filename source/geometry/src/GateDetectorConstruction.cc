@@ -30,9 +30,17 @@
 #include "G4SDManager.hh"
 #include "G4Material.hh"
 #include "G4NistManager.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4Timer.hh"
 
 #ifdef GATE_USE_OPTICAL
 #include "GateSurfaceList.hh"
+#ifdef GATE_USE_MT
+#include "GateMultiSensitiveDetector.hh"
+#include "G4LogicalVolumeStore.hh"
+#endif
 #endif
 
 GateDetectorConstruction* GateDetectorConstruction::pTheGateDetectorConstruction=0;
@@ -177,6 +185,36 @@ G4VPhysicalVolume* GateDetectorConstruction::Construct()
 }
 //---------------------------------------------------------------------------------
 
+
+#ifdef GATE_USE_MT
+//---------------------------------------------------------------------------------
+// Called by each worker thread. The sensitive detector of a logical
+// volume is thread local: the workers use the detectors of the master.
+// This is only possible for the detectors of the actors (the actors
+// themselves handle the concurrent calls); the crystal/phantom SD keep
+// the hits of the current event and fields are built per thread by
+// Geant4, so they are refused.
+void GateDetectorConstruction::ConstructSDandField()
+{
+  if (m_magFieldUniform || m_magFieldTabulated || e_electFieldUniform ||
+      e_electFieldTabulated || em_electmagFieldTabulated)
+    GateError("Electric/magnetic fields cannot be used with multithreading (GATE_USE_MT).");
+
+  G4LogicalVolumeStore * store = G4LogicalVolumeStore::GetInstance();
+  for(size_t i=0; i<store->size(); i++) {
+    G4LogicalVolume * lv = (*store)[i];
+    G4VSensitiveDetector * sd = lv->GetMasterSensitiveDetector();
+    if (!sd) continue;
+    GateMultiSensitiveDetector * msd = dynamic_cast<GateMultiSensitiveDetector*>(sd);
+    if (!msd || msd->GetSensitiveDetector())
+      GateError("Volume " << lv->GetName() << ": sensitive detectors (crystalSD, phantomSD, ...)"
+                << " cannot be used with multithreading (GATE_USE_MT), only actors.");
+    lv->SetSensitiveDetector(msd);
+  }
+}
+//---------------------------------------------------------------------------------
+#endif
+
 //---------------------------------------------------------------------------------
 // Adds a Material Database
 void GateDetectorConstruction::AddFileToMaterialDatabase(const G4String& f)
@@ -184,6 +222,11 @@ void GateDetectorConstruction::AddFileToMaterialDatabase(const G4String& f)
   mMaterialDatabase.AddMDBFile(f);
 }
 //---------------------------------------------------------------------------------
+void GateDetectorConstruction::SetMaterialDatabaseCacheDirectory(const G4String& dir)
+{
+  mMaterialDatabase.SetCacheDirectory(dir);
+}
+//---------------------------------------------------------------------------------
 void GateDetectorConstruction::SetElectField(G4ThreeVector fieldValue)
 {
   e_electFieldValue = fieldValue;
@@ -430,9 +473,12 @@ void GateDetectorConstruction::UpdateGeometry()
     return;
   }
 
+  G4Timer timer;
+  timer.Start();
+  G4bool incremental = false;
   switch (nGeometryStatus){
   case geometry_needs_update:
-    pworld->Construct(true);
+    incremental = UpdateMovedPlacements();
     break;
 
   case geometry_needs_rebuild:
@@ -441,7 +487,12 @@ void GateDetectorConstruction::UpdateGeometry()
     Construct();
     break;
   }
-  GateRunManager::GetRunManager()->DefineWorldVolume(pworldPhysicalVolume);
+  // The run manager closes (and optimises) the whole geometry again
+  if (!incremental) GateRunManager::GetRunManager()->DefineWorldVolume(pworldPhysicalVolume);
+  timer.Stop();
+  GateMessage("Geometry", 1, "Geometry " << (incremental ? "updated" : "rebuilt")
+              << " in " << timer.GetRealElapsed()*1000. << " ms"
+              << (incremental ? "" : " (+ optimisation of the whole geometry at the next run)") << Gateendl);
 
   nGeometryStatus = geometry_is_uptodate;
 
@@ -450,6 +501,74 @@ void GateDetectorConstruction::UpdateGeometry()
 }
 //---------------------------------------------------------------------------------
 
+//---------------------------------------------------------------------------------
+namespace {
+  struct GatePlacementState {
+    G4ThreeVector translation;
+    G4RotationMatrix rotation;
+  };
+
+  GatePlacementState GetPlacementState(const G4VPhysicalVolume * pv)
+  {
+    GatePlacementState s;
+    s.translation = pv->GetTranslation();
+    if (pv->GetRotation()) s.rotation = *pv->GetRotation();
+    return s;
+  }
+}
+
+G4bool GateDetectorConstruction::UpdateMovedPlacements()
+{
+  G4PhysicalVolumeStore * pvStore = G4PhysicalVolumeStore::GetInstance();
+  G4SolidStore * solidStore = G4SolidStore::GetInstance();
+
+  // Placements and solid extents before the update
+  std::vector<GatePlacementState> placements(pvStore->size());
+  for (size_t i=0; i<pvStore->size(); i++) placements[i] = GetPlacementState((*pvStore)[i]);
+  std::vector<G4ThreeVector> solidMin(solidStore->size()), solidMax(solidStore->size());
+  for (size_t i=0; i<solidStore->size(); i++) (*solidStore)[i]->BoundingLimits(solidMin[i], solidMax[i]);
+
+  pworld->Construct(true);
+
+  // Before the first run, the geometry is not closed yet
+  G4GeometryManager * geometryManager = G4GeometryManager::GetInstance();
+  if (!geometryManager->IsGeometryClosed()) return false;
+  if (pvStore->size() != placements.size() || solidStore->size() != solidMin.size()) return false;
+  for (size_t i=0; i<solidStore->size(); i++) {
+    G4ThreeVector pMin, pMax;
+    (*solidStore)[i]->BoundingLimits(pMin, pMax);
+    if (pMin != solidMin[i] || pMax != solidMax[i]) {
+      GateMessage("Geometry", 2, "Solid " << (*solidStore)[i]->GetName() << " has changed\n");
+      return false;
+    }
+  }
+
+  // One moved placement per mother volume: its mother is optimised again
+  std::map<G4LogicalVolume*, G4VPhysicalVolume*> movedMothers;
+  size_t nbMoved = 0;
+  for (size_t i=0; i<pvStore->size(); i++) {
+    G4VPhysicalVolume * pv = (*pvStore)[i];
+    const GatePlacementState s = GetPlacementState(pv);
+    if (s.translation == placements[i].translation && s.rotation == placements[i].rotation) continue;
+    if (!pv->GetMotherLogical()) return false; // the world has moved
+    movedMothers[pv->GetMotherLogical()] = pv;
+    nbMoved++;
+  }
+
+  std::map<G4LogicalVolume*, G4VPhysicalVolume*>::const_iterator it;
+  for (it = movedMothers.begin(); it != movedMothers.end(); ++it) {
+    geometryManager->OpenGeometry(it->second);
+    geometryManager->CloseGeometry(true, false, it->second);
+  }
+  // Navigation history may refer to the former placements
+  G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->ResetStackAndState();
+
+  GateMessage("Geometry", 2, nbMoved << " placements moved, "
+              << movedMothers.size() << " mother volumes optimised again\n");
+  return true;
+}
+//---------------------------------------------------------------------------------
+
 //---------------------------------------------------------------------------------
 void GateDetectorConstruction::DestroyGeometry()
 {
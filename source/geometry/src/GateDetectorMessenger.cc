@@ -163,6 +163,11 @@ GateDetectorMessenger::GateDetectorMessenger(GateDetectorConstruction* GateDet)
   pMaterialDatabaseFilenameCmd = new G4UIcmdWithAString(cmd, this);
   pMaterialDatabaseFilenameCmd->SetGuidance("Sets the filename of the material database to use");
   pMaterialDatabaseFilenameCmd->SetParameterName("Material database filename", true);
+
+  cmd = "/gate/geometry/setMaterialDatabaseCacheDirectory";
+  pMaterialDatabaseCacheDirectoryCmd = new G4UIcmdWithAString(cmd, this);
+  pMaterialDatabaseCacheDirectoryCmd->SetGuidance("Set the directory where the index of the material database files set afterwards is cached (no cache by default)");
+  pMaterialDatabaseCacheDirectoryCmd->SetParameterName("Cache directory", false);
   
   pListCreatorsCmd = new G4UIcmdWithoutParameter("/gate/geometry/listVolumes",this);
   pListCreatorsCmd->SetGuidance("List all the volume creators in the GATE geometry");
@@ -183,6 +188,7 @@ GateDetectorMessenger::GateDetectorMessenger(GateDetectorConstruction* GateDet)
 GateDetectorMessenger::~GateDetectorMessenger()
 {
   delete pMaterialDatabaseFilenameCmd;
+  delete pMaterialDatabaseCacheDirectoryCmd;
   delete pMagFieldCmd;
   delete pListCreatorsCmd;
   delete IoniCmd;
@@ -200,6 +206,9 @@ void GateDetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
   if (command == pMaterialDatabaseFilenameCmd ) {
       pDetectorConstruction->AddFileToMaterialDatabase(newValue);
   }
+  else if (command == pMaterialDatabaseCacheDirectoryCmd ) {
+      pDetectorConstruction->SetMaterialDatabaseCacheDirectory(newValue);
+  }
   else if( command == pMagFieldCmd )
     { pDetectorConstruction->SetMagField(pMagFieldCmd->GetNew3VectorValue(newValue));}
 
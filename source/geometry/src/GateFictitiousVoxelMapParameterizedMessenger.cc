@@ -66,6 +66,12 @@ GateFictitiousVoxelMapParameterizedMessenger::GateFictitiousVoxelMapParameterize
   DiscardEnergyCmd->SetUnitCategory("Energy");
 //  DiscardEnergyCmd->AvailableForStates(G4State_PreInit);
 
+  cmdName = G4String("/gate/") + itsInserter->GetObjectName()+"/setMajorantCellSize";
+  MajorantCellSizeCmd = new G4UIcmdWithAnInteger(cmdName,this);
+  MajorantCellSizeCmd->SetGuidance("Use a local majorant cross section per cell of n*n*n voxels instead of the maximal cross section of the whole phantom (default: 0, global majorant)");
+  MajorantCellSizeCmd->SetParameterName("n",false);
+  MajorantCellSizeCmd->SetRange("n>=0");
+
   cmdName = GetDirectoryName()+"removeReader";
   RemoveReaderCmd = new G4UIcmdWithoutParameter(cmdName,this);
   RemoveReaderCmd->SetGuidance("Remove the reader");
@@ -84,6 +90,7 @@ GateFictitiousVoxelMapParameterizedMessenger::~GateFictitiousVoxelMapParameteriz
    delete VerboseCmd;
    delete DiscardEnergyCmd;
    delete FictitiousEnergyCmd;
+   delete MajorantCellSizeCmd;
    delete SkipEqualMaterialsCmd;
 }
 
@@ -117,6 +124,9 @@ void GateFictitiousVoxelMapParameterizedMessenger::SetNewValue(G4UIcommand* comm
   else if (command == DiscardEnergyCmd)
     { GatePETVRTManager::GetInstance()->GetOrCreatePETVRTSettings()->SetDiscardEnergy(DiscardEnergyCmd->GetNewDoubleValue(newValue)); }
 
+  else if (command == MajorantCellSizeCmd)
+    { GatePETVRTManager::GetInstance()->GetOrCreatePETVRTSettings()->SetMajorantCellSize(MajorantCellSizeCmd->GetNewIntValue(newValue)); }
+
   else
     GateMessenger::SetNewValue(command,newValue);
 }
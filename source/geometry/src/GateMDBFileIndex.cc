@@ -0,0 +1,385 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GateMDBFileIndex.hh"
+#include "GateCacheFile.hh"
+#include "GateMessageManager.hh"
+#include "GateTokenizer.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// the cache is mapped (see GateMappedFile) and checked against the
+// modification time of the database
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define GATE_MDB_USE_CACHE
+#endif
+
+static const char theMagic[8] = "GateMDB";
+static const uint32_t theVersion = 1;
+
+//-----------------------------------------------------------------------------
+namespace {
+  // Lexicographic comparison of two strings of given lengths
+  int Compare(const char * a, size_t la, const char * b, size_t lb)
+  {
+    const int c = memcmp(a, b, std::min(la, lb));
+    if (c != 0) return c;
+    return (la < lb) ? -1 : (la > lb ? 1 : 0);
+  }
+
+  // Size and modification time (in ns) of a file
+  G4bool GetFileStatus(const G4String & filePath, uint64_t & size, int64_t & time)
+  {
+#ifdef GATE_MDB_USE_CACHE
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) return false;
+    size = st.st_size;
+#ifdef __APPLE__
+    time = (int64_t)st.st_mtimespec.tv_sec*1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    time = (int64_t)st.st_mtim.tv_sec*1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+#else
+    size = 0;
+    time = 0;
+    return false;
+#endif
+  }
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateMDBFileIndex::GateMDBFileIndex()
+  : mData(0), mIsReadFromCache(false),
+    mHeader(0), mLineOffsets(0), mSections(0), mItems(0), mText(0)
+{
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GateMDBFileIndex::~GateMDBFileIndex()
+{
+  Clear();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateMDBFileIndex::Clear()
+{
+  mMappedFile.Close();
+  mData = 0;
+  std::vector<char>().swap(mBuffer);
+  mIsReadFromCache = false;
+  mHeader = 0;
+  mLineOffsets = 0;
+  mSections = 0;
+  mItems = 0;
+  mText = 0;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateMDBFileIndex::Load(const G4String & filePath, const G4String & cacheDirectory)
+{
+  Clear();
+  uint64_t size = 0;
+  int64_t time = 0;
+  const G4bool hasStatus = GetFileStatus(filePath, size, time);
+  const G4bool useCache = (cacheDirectory != "") && hasStatus;
+
+  std::string text;
+  G4bool isTextRead = false;
+  const G4String cacheName = GetCacheFileName(filePath, cacheDirectory);
+  if (useCache && Map(cacheName)) {
+    G4bool isUpToDate = false;
+    if (mHeader->sourceSize == size) {
+      if (mHeader->sourceTime == time) isUpToDate = true;
+      else {
+        // modified (or copied) since: compare the content
+        isTextRead = ReadText(filePath, text);
+        isUpToDate = isTextRead && (Hash(text) == mHeader->sourceHash);
+      }
+    }
+    if (isUpToDate) {
+      if (mHeader->sourceTime != time) {
+        // same content with another time (touched or copied): store the
+        // time, so that the next runs do not hash the file again
+        std::vector<char> buffer(mData, mData + mHeader->size);
+        reinterpret_cast<Header *>(&buffer[0])->sourceTime = time;
+        Clear();
+        mBuffer.swap(buffer);
+        mData = &mBuffer[0];
+        SetPointers(mData, mBuffer.size());
+        Write(cacheName);
+      }
+      mIsReadFromCache = true;
+      GateMessage("Materials", 2, "GateMDBFileIndex: index of <" << filePath
+                  << "> read from <" << cacheName << ">\n");
+      return true;
+    }
+    Clear();
+  }
+
+  if (!isTextRead && !ReadText(filePath, text)) return false;
+  Build(text, time);
+  if (useCache) Write(cacheName);
+  return true;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateMDBFileIndex::ReadText(const G4String & filePath, std::string & text)
+{
+  std::ifstream is(filePath.c_str(), std::ios::binary);
+  if (!is) return false;
+  std::ostringstream os;
+  os << is.rdbuf();
+  text = os.str();
+  return true;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4String GateMDBFileIndex::GetCacheFileName(const G4String & filePath, const G4String & cacheDirectory)
+{
+  // the path is hashed: databases of the same name may share the directory
+  const size_t slash = filePath.find_last_of('/');
+  const G4String baseName = (slash == std::string::npos) ? filePath : filePath.substr(slash + 1);
+  std::ostringstream name;
+  name << cacheDirectory << "/" << baseName << "_" << std::hex << std::setw(16) << std::setfill('0')
+       << Hash(filePath) << ".cache";
+  return name.str();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+uint64_t GateMDBFileIndex::Hash(const std::string & text)
+{
+  GateCacheKey key;
+  key.Add(text.data(), text.size());
+  return key.Get();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateMDBFileIndex::Build(const std::string & text, int64_t sourceTime)
+{
+  // Non empty lines, cleaned up, and first occurrence of each section
+  std::vector<std::string> lines;
+  std::vector<std::string> sectionNames;
+  std::vector<uint32_t> sectionFirstLines;
+  std::istringstream is(text);
+  std::string raw;
+  while (std::getline(is, raw)) {
+    if (!raw.empty() && raw[0] == '[') {
+      const size_t end = raw.find(']');
+      if (end != std::string::npos) {
+        const std::string name = raw.substr(1, end-1);
+        if (std::find(sectionNames.begin(), sectionNames.end(), name) == sectionNames.end()) {
+          sectionNames.push_back(name);
+          // the items start after the line of the section
+          sectionFirstLines.push_back(lines.size()+1);
+        }
+      }
+    }
+    G4String line = raw;
+    GateTokenizer::CleanUpString(line);
+    if (line != "") lines.push_back(line);
+  }
+
+  // Items of each section ("name:" lines, until the next section),
+  // sorted by name, keeping the first definition of a name
+  std::vector<Section> sections(sectionNames.size());
+  std::vector<Item> items;
+  std::vector<std::pair<std::string, uint32_t> > sectionItems;
+  for (size_t s = 0; s < sectionNames.size(); s++) {
+    sectionItems.clear();
+    for (uint32_t l = sectionFirstLines[s]; l < lines.size(); l++) {
+      if (lines[l][0] == '[') break;
+      const size_t colon = lines[l].find(':');
+      if (colon != std::string::npos) sectionItems.push_back(std::make_pair(lines[l].substr(0, colon), l));
+    }
+    std::sort(sectionItems.begin(), sectionItems.end());
+    sections[s].firstItem = items.size();
+    for (size_t i = 0; i < sectionItems.size(); i++) {
+      if (i > 0 && sectionItems[i].first == sectionItems[i-1].first) continue;
+      Item item;
+      item.line = sectionItems[i].second;
+      item.nameLength = sectionItems[i].first.size();
+      items.push_back(item);
+    }
+    sections[s].nbItems = items.size() - sections[s].firstItem;
+  }
+
+  // Text: the lines, then the names of the sections
+  std::string allText;
+  std::vector<uint32_t> lineOffsets(lines.size()+1);
+  for (size_t l = 0; l < lines.size(); l++) {
+    lineOffsets[l] = allText.size();
+    allText += lines[l];
+  }
+  lineOffsets[lines.size()] = allText.size();
+  for (size_t s = 0; s < sectionNames.size(); s++) {
+    sections[s].nameOffset = allText.size();
+    sections[s].nameLength = sectionNames[s].size();
+    allText += sectionNames[s];
+  }
+
+  // Single block
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, theMagic, sizeof(header.magic));
+  header.version = theVersion;
+  header.nbLines = lines.size();
+  header.nbSections = sections.size();
+  header.nbItems = items.size();
+  header.sourceSize = text.size();
+  header.sourceTime = sourceTime;
+  header.sourceHash = Hash(text);
+  size_t size = sizeof(Header) + lineOffsets.size()*sizeof(uint32_t)
+    + sections.size()*sizeof(Section) + items.size()*sizeof(Item) + allText.size();
+  size = (size + 7) & ~size_t(7);
+  header.size = size;
+
+  mBuffer.assign(size, 0);
+  char * p = &mBuffer[0];
+  memcpy(p, &header, sizeof(Header));
+  p += sizeof(Header);
+  memcpy(p, &lineOffsets[0], lineOffsets.size()*sizeof(uint32_t));
+  p += lineOffsets.size()*sizeof(uint32_t);
+  if (!sections.empty()) memcpy(p, &sections[0], sections.size()*sizeof(Section));
+  p += sections.size()*sizeof(Section);
+  if (!items.empty()) memcpy(p, &items[0], items.size()*sizeof(Item));
+  p += items.size()*sizeof(Item);
+  if (!allText.empty()) memcpy(p, allText.data(), allText.size());
+
+  mData = &mBuffer[0];
+  SetPointers(mData, size);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateMDBFileIndex::SetPointers(const char * data, size_t size)
+{
+  // Check the block before use: a cache may be truncated or from
+  // another version
+  if (size < sizeof(Header)) return false;
+  const Header * header = reinterpret_cast<const Header *>(data);
+  if (memcmp(header->magic, theMagic, sizeof(header->magic)) != 0 ||
+      header->version != theVersion || header->size != size) return false;
+  const size_t textOffset = sizeof(Header) + (size_t(header->nbLines)+1)*sizeof(uint32_t)
+    + size_t(header->nbSections)*sizeof(Section) + size_t(header->nbItems)*sizeof(Item);
+  if (textOffset > size) return false;
+  const size_t textSize = size - textOffset;
+
+  const uint32_t * lineOffsets = reinterpret_cast<const uint32_t *>(data + sizeof(Header));
+  const Section * sections = reinterpret_cast<const Section *>(lineOffsets + header->nbLines + 1);
+  const Item * items = reinterpret_cast<const Item *>(sections + header->nbSections);
+  for (uint32_t l = 0; l < header->nbLines; l++)
+    if (lineOffsets[l] > lineOffsets[l+1]) return false;
+  if (lineOffsets[header->nbLines] > textSize) return false;
+  for (uint32_t s = 0; s < header->nbSections; s++)
+    if (size_t(sections[s].nameOffset) + sections[s].nameLength > textSize ||
+        size_t(sections[s].firstItem) + sections[s].nbItems > header->nbItems) return false;
+  for (uint32_t i = 0; i < header->nbItems; i++)
+    if (items[i].line >= header->nbLines ||
+        items[i].nameLength > lineOffsets[items[i].line+1] - lineOffsets[items[i].line]) return false;
+
+  mHeader = header;
+  mLineOffsets = lineOffsets;
+  mSections = sections;
+  mItems = items;
+  mText = data + textOffset;
+  return true;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4bool GateMDBFileIndex::Map(const G4String & cacheName)
+{
+  if (!mMappedFile.Open(cacheName)) return false;
+  mData = mMappedFile.GetData();
+  if (!SetPointers(mData, mMappedFile.GetSize())) {
+    GateMessage("Materials", 1, "GateMDBFileIndex: <" << cacheName << "> is not a valid cache, it is rebuilt.\n");
+    Clear();
+    return false;
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GateMDBFileIndex::Write(const G4String & cacheName) const
+{
+#ifdef GATE_MDB_USE_CACHE
+  // Several jobs may share the database
+  const bool isWritten = GateCacheFile::Write(cacheName, [this](std::ostream & os) {
+      os.write(mData, mHeader->size);
+    });
+  if (!isWritten) {
+    GateMessage("Materials", 1, "GateMDBFileIndex: cannot write the cache <" << cacheName << ">\n");
+    return;
+  }
+  GateMessage("Materials", 2, "GateMDBFileIndex: cache <" << cacheName << "> written\n");
+#endif
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4int GateMDBFileIndex::FindItem(const G4String & sectionName, const G4String & itemName) const
+{
+  if (!mHeader) return -1;
+  for (uint32_t s = 0; s < mHeader->nbSections; s++) {
+    const Section & section = mSections[s];
+    if (Compare(mText + section.nameOffset, section.nameLength,
+                sectionName.data(), sectionName.size()) != 0) continue;
+    // binary search among the items of the section
+    uint32_t first = section.firstItem;
+    uint32_t last = section.firstItem + section.nbItems;
+    while (first < last) {
+      const uint32_t middle = first + (last-first)/2;
+      const Item & item = mItems[middle];
+      const int c = Compare(mText + mLineOffsets[item.line], item.nameLength,
+                            itemName.data(), itemName.size());
+      if (c == 0) return item.line;
+      if (c < 0) first = middle+1;
+      else last = middle;
+    }
+    return -1;
+  }
+  return -1;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+G4String GateMDBFileIndex::GetLine(G4int line) const
+{
+  if (!mHeader || line < 0 || line >= (G4int)mHeader->nbLines) return "";
+  return G4String(std::string(mText + mLineOffsets[line], mLineOffsets[line+1] - mLineOffsets[line]));
+}
+//-----------------------------------------------------------------------------
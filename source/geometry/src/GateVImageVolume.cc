@@ -13,6 +13,8 @@
 
 
 #include <pthread.h>
+#include <algorithm>
+#include <cmath>
 #include <set>
 
 #include "GateVImageVolume.hh"
@@ -23,11 +25,38 @@
 #include "GateDMaplongvol.h"
 #include "GateDMapdt.h"
 #include "GateHounsfieldMaterialTable.hh"
+#include "GateParallelFor.hh"
 #include <G4TransportationManager.hh>
 #include "globals.hh"
 
 typedef unsigned int uint;
 
+//--------------------------------------------------------------------
+namespace {
+  // Beyond this range of values, the dense tables are not built
+  const long theMaxDenseTableSize = 1L << 24;
+
+  // Number of chunks of an image of n voxels (no threads for the small ones)
+  unsigned int NumberOfChunks(size_t n)
+  {
+    return GateParallel::GetNumberOfThreads(n / 65536);
+  }
+
+  // output = value of the label of each voxel
+  void MapLabelImage(const GateImage & labels, GateImage & output, const std::vector<float> & valueOfLabel)
+  {
+    const size_t n = labels.GetNumberOfValues();
+    if (n == 0 || valueOfLabel.empty()) return;
+    const float * in = &(*labels.begin());
+    float * out = &(*output.begin());
+    const float * values = &valueOfLabel[0];
+    GateParallel::ForChunks(n, NumberOfChunks(n), [in, out, values](unsigned int, size_t begin, size_t end) {
+        for(size_t k=begin; k<end; k++) out[k] = values[lrint(in[k])];
+      });
+  }
+}
+//--------------------------------------------------------------------
+
 //--------------------------------------------------------------------
 /// Constructor with :
 /// the path to the volume to create (for commands)
@@ -402,14 +431,16 @@ void GateVImageVolume::LoadImageMaterialsFromHounsfieldTable() {
     }
 
   // Bounds check
-  GateMessage("Volume",5,"ImageMinValue: " << pImage->GetMinValue() << ", ImageMaxValue: " << pImage->GetMaxValue() << Gateendl);
+  const double imageMin = pImage->GetMinValue();
+  const double imageMax = pImage->GetMaxValue();
+  GateMessage("Volume",5,"ImageMinValue: " << imageMin << ", ImageMaxValue: " << imageMax << Gateendl);
   GateMessage("Volume",5,"HUMinValue   : " << low << ", HUMaxValue: " << high << Gateendl);
 
-  if (pImage->GetMinValue() < low || pImage->GetMaxValue() > high) {
+  if (imageMin < low || imageMax > high) {
     GateWarning( "The image contains HU indices out of range of the HU range found in " <<
                  mHounsfieldToImageMaterialTableFilename << Gateendl <<
                  "HU    min, max: " << low << ", " << high << Gateendl <<
-                 "Image min, max: " << pImage->GetMinValue() << ", " << pImage->GetMaxValue() << Gateendl );
+                 "Image min, max: " << imageMin << ", " << imageMax << Gateendl );
     // GateError( "Abort." << Gateendl);
   }
   if (mHounsfieldMaterialTable.GetNumberOfMaterials() == 0 ) {
@@ -420,31 +451,71 @@ void GateVImageVolume::LoadImageMaterialsFromHounsfieldTable() {
   // Loop, create map H->label + verify
   mHounsfieldMaterialTable.MapLabelToMaterial(mLabelToMaterialName);
 
-  // Loop change image label
-  ImageType::iterator iter;
-  iter = pImage->begin();
-  while (iter != pImage->end()) {
-    double label = mHounsfieldMaterialTable.GetLabelFromH(*iter);
-    if (label<0) {
-      GateMessage("Volume",1," I find H=" << *iter
-                << " in the image, while Hounsfield range start at "
-                << mHounsfieldMaterialTable[0].mH1 << Gateendl);
-      label = 0;
-      ++mUnderflow;
+  // Change image label. The labels of the integer H values of the image
+  // are tabulated once (dense table), the values out of the H range
+  // being clamped to the first or last material and counted.
+  const int nbMaterials = mHounsfieldMaterialTable.GetNumberOfMaterials();
+  const long tableMin = (long)std::floor(imageMin);
+  const long tableMax = (long)std::ceil(imageMax);
+  const bool useTable = (tableMax - tableMin < theMaxDenseTableSize);
+  std::vector<int> tableLabel;
+  std::vector<unsigned char> tableFlag; // 1: underflow, 2: overflow
+  if (useTable) {
+    tableLabel.resize(tableMax - tableMin + 1);
+    tableFlag.resize(tableMax - tableMin + 1, 0);
+    for(long h=tableMin; h<=tableMax; h++) {
+      int label = mHounsfieldMaterialTable.GetLabelFromH(h);
+      if (label < 0) { label = 0; tableFlag[h-tableMin] = 1; }
+      if (label >= nbMaterials) { label = nbMaterials - 1; tableFlag[h-tableMin] = 2; }
+      tableLabel[h-tableMin] = label;
     }
-    if (label>=mHounsfieldMaterialTable.GetNumberOfMaterials()) {
-      GateMessage("Volume",1," I find H=" << *iter
-                << " in the image, while Hounsfield range stop at "
-                << mHounsfieldMaterialTable[mHounsfieldMaterialTable.GetNumberOfMaterials()-1].mH2
-                << Gateendl);
-      label = mHounsfieldMaterialTable.GetNumberOfMaterials() - 1;
-      ++mOverflow;
-    }
-    //GateMessage("Core", 0, " pix = " << (*iter) << " lab = " << label << Gateendl);
-    (*iter) = label;
-    ++iter;
   }
 
+  const size_t nbValues = pImage->GetNumberOfValues();
+  const unsigned int nbChunks = NumberOfChunks(nbValues);
+  std::vector<unsigned int> underflows(nbChunks, 0);
+  std::vector<unsigned int> overflows(nbChunks, 0);
+  float * data = nbValues ? &(*pImage->begin()) : 0;
+  GateParallel::ForChunks(nbValues, nbChunks, [&](unsigned int chunk, size_t begin, size_t end) {
+      unsigned int underflow = 0;
+      unsigned int overflow = 0;
+      size_t nbNotInTable = useTable ? 0 : 1;
+      if (useTable)
+        for(size_t k=begin; k<end; k++) nbNotInTable += (data[k] != std::floor(data[k]));
+
+      if (nbNotInTable == 0) {
+        // Branch free loop (vectorized by the compiler)
+        const int * labels = &tableLabel[0];
+        const unsigned char * flags = &tableFlag[0];
+        for(size_t k=begin; k<end; k++) {
+          const long i = (long)data[k] - tableMin;
+          data[k] = labels[i];
+          underflow += (flags[i] == 1);
+          overflow  += (flags[i] == 2);
+        }
+      }
+      else {
+        // Non integer values: search of the H range of each voxel
+        for(size_t k=begin; k<end; k++) {
+          double label = mHounsfieldMaterialTable.GetLabelFromH(data[k]);
+          if (label < 0) { label = 0; ++underflow; }
+          if (label >= nbMaterials) { label = nbMaterials - 1; ++overflow; }
+          data[k] = label;
+        }
+      }
+      underflows[chunk] = underflow;
+      overflows[chunk] = overflow;
+    });
+  for(unsigned int t=0; t<nbChunks; t++) {
+    mUnderflow += underflows[t];
+    mOverflow += overflows[t];
+  }
+  if (mUnderflow > 0 || mOverflow > 0)
+    GateMessage("Volume",1," I find " << mUnderflow << " H values below " << mHounsfieldMaterialTable[0].mH1
+                << " and " << mOverflow << " H values above "
+                << mHounsfieldMaterialTable[nbMaterials-1].mH2
+                << " (Hounsfield range) in the image" << Gateendl);
+
   assert( pImage->GetNumberOfValues() > 0 );
   // double out_of_range_fraction = double(mUnderflow+mOverflow)/pImage->GetNumberOfValues(); // not yet
   double out_of_range_fraction = double(mOverflow)/pImage->GetNumberOfValues();
@@ -493,26 +564,11 @@ void GateVImageVolume::DumpHLabelImage() {
     output.SetOrigin(pImage->GetOrigin());
     output.Allocate();
 
-    //  GateHounsfieldMaterialTable::LabelToMaterialNameType lab2mat;
-    //     mHounsfieldMaterialTable.MapLabelToMaterial(lab2mat);
-
-    ImageType::const_iterator pi;
-    ImageType::iterator po;
-    pi = pImage->begin();
-    po = output.begin();
-    while (pi != pImage->end()) {
-      if (1) { // HU mean or d mean or label
-        // G4Material * mat =
-        // 	  theMaterialDatabase.GetMaterial(lab2mat[*pi]);
-        // 	GateDebugMessage("Volume", 2, "lab " << *pi << " = " << mat->GetName() << Gateendl);
-        // 	po = mat->GetDensity;
-
-        double HU = mHounsfieldMaterialTable.GetHMeanFromLabel((int)lrint(*pi));
-        *po = HU;
-        ++po;
-        ++pi;
-      }
-    }
+    // HU mean of each label
+    std::vector<float> HUOfLabel(mHounsfieldMaterialTable.GetNumberOfMaterials());
+    for(size_t l=0; l<HUOfLabel.size(); l++)
+      HUOfLabel[l] = mHounsfieldMaterialTable.GetHMeanFromLabel(l);
+    MapLabelImage(*pImage, output, HUOfLabel);
 
     // Write image
     output.Write(mHLabelImageFilename);
@@ -529,27 +585,17 @@ void GateVImageVolume::DumpDensityImage() {
     output.SetOrigin(pImage->GetOrigin());
     output.Allocate();
 
-    //  GateHounsfieldMaterialTable::LabelToMaterialNameType lab2mat;
-    //     mHounsfieldMaterialTable.MapLabelToMaterial(lab2mat);
-
-    ImageType::const_iterator pi;
-    ImageType::iterator po;
-    pi = pImage->begin();
-    po = output.begin();
-    while (pi != pImage->end()) {
-      if (1) { // HU mean or d mean or label
-        // G4Material * mat =
-        // 	  theMaterialDatabase.GetMaterial(lab2mat[*pi]);
-        // 	GateDebugMessage("Volume", 2, "lab " << *pi << " = " << mat->GetName() << Gateendl);
-        // 	po = mat->GetDensity;
-        double density = mLoadImageMaterialsFromHounsfieldTable ?
-          mHounsfieldMaterialTable[(int)lrint(*pi)].md1 :
-          mRangeMaterialTable[(int)lrint(*pi)].md1;
-        *po = density / (g / cm3);
-        ++po;
-        ++pi;
-      }
+    // Density of each label
+    std::vector<float> densityOfLabel(mLoadImageMaterialsFromHounsfieldTable ?
+                                      mHounsfieldMaterialTable.GetNumberOfMaterials() :
+                                      mRangeMaterialTable.GetNumberOfMaterials());
+    for(size_t l=0; l<densityOfLabel.size(); l++) {
+      double density = mLoadImageMaterialsFromHounsfieldTable ?
+        mHounsfieldMaterialTable[l].md1 :
+        mRangeMaterialTable[l].md1;
+      densityOfLabel[l] = density / (g / cm3);
     }
+    MapLabelImage(*pImage, output, densityOfLabel);
 
     // Write image
     output.Write(mDensityImageFilename);
@@ -566,21 +612,20 @@ void GateVImageVolume::DumpMassImage() {
     output.SetOrigin(pImage->GetOrigin());
     output.Allocate();
 
-    ImageType::const_iterator pi = pImage->begin();
-    ImageType::iterator       po = output.begin();
-
-    while (pi != pImage->end()) {
+    // Mass of a voxel of each label
+    std::vector<float> massOfLabel(mLoadImageMaterialsFromHounsfieldTable ?
+                                   mHounsfieldMaterialTable.GetNumberOfMaterials() :
+                                   mRangeMaterialTable.GetNumberOfMaterials());
+    for(size_t l=0; l<massOfLabel.size(); l++) {
       double density = mLoadImageMaterialsFromHounsfieldTable ?
-                       mHounsfieldMaterialTable[(int)lrint(*pi)].md1 :
-                       mRangeMaterialTable     [(int)lrint(*pi)].md1;
+                       mHounsfieldMaterialTable[l].md1 :
+                       mRangeMaterialTable     [l].md1;
 
       double mass    = density * pImage->GetVoxelVolume();
 
-      *po = mass / g; // dump mass in grams
-
-      ++po;
-      ++pi;
+      massOfLabel[l] = mass / g; // dump mass in grams
     }
+    MapLabelImage(*pImage, output, massOfLabel);
 
     // Write image
     output.Write(mMassImageFilename);
@@ -726,24 +771,45 @@ void GateVImageVolume::LoadImageMaterialsFromRangeTable() {
   }
   else {G4cout << "Error opening file.\n";}
 
-  ImageType::iterator iter;
-  iter = pImage->begin();
-  while (iter != pImage->end()) {
-    double label = mRangeMaterialTable.GetLabelFromR(*iter);
-    if (label<0) {
-      GateError(" I find R=" << *iter
+  // Change image label, with a dense table of the labels of the
+  // (integer) R values of the image
+  const int nbRanges = mRangeMaterialTable.GetNumberOfMaterials();
+  const long tableMin = (int)pImage->GetMinValue();
+  const long tableMax = (int)pImage->GetMaxValue();
+  const bool useTable = (tableMax - tableMin < theMaxDenseTableSize);
+  std::vector<int> tableLabel;
+  if (useTable) {
+    tableLabel.resize(tableMax - tableMin + 1);
+    for(long r=tableMin; r<=tableMax; r++) tableLabel[r-tableMin] = mRangeMaterialTable.GetLabelFromR(r);
+  }
+
+  const size_t nbValues = pImage->GetNumberOfValues();
+  const unsigned int nbChunks = NumberOfChunks(nbValues);
+  std::vector<float> firstBadValue(nbChunks);
+  std::vector<int> firstBadLabel(nbChunks, 0);
+  float * data = nbValues ? &(*pImage->begin()) : 0;
+  GateParallel::ForChunks(nbValues, nbChunks, [&](unsigned int chunk, size_t begin, size_t end) {
+      for(size_t k=begin; k<end; k++) {
+        const int label = useTable ? tableLabel[(int)data[k] - tableMin] : mRangeMaterialTable.GetLabelFromR(data[k]);
+        if ((label < 0 || label >= nbRanges) && firstBadLabel[chunk] == 0) {
+          firstBadValue[chunk] = data[k];
+          firstBadLabel[chunk] = (label < 0) ? -1 : 1;
+        }
+        data[k] = label;
+      }
+    });
+  for(unsigned int t=0; t<nbChunks; t++) {
+    if (firstBadLabel[t] < 0) {
+      GateError(" I find R=" << firstBadValue[t]
                 << " in the image, while range start at "
                 << mRangeMaterialTable[0].mR1 << Gateendl);
     }
-    if (label>=mRangeMaterialTable.GetNumberOfMaterials()) {
-      GateError(" I find R=" << *iter
+    if (firstBadLabel[t] > 0) {
+      GateError(" I find R=" << firstBadValue[t]
                 << " in the image, while range stop at "
-                << mRangeMaterialTable[mRangeMaterialTable.GetNumberOfMaterials()-1].mR1
+                << mRangeMaterialTable[nbRanges-1].mR1
                 << Gateendl);
     }
-    //GateMessage("Core", 0, " pix = " << (*iter) << " lab = " << label << Gateendl);
-    (*iter) = label;
-    ++iter;
   }
   mImageMaterialsFromRangeTableDone = true;
 
@@ -823,10 +889,29 @@ void GateVImageVolume::RemapLabelsContiguously( std::vector<LabelType>& labels,
     *i = cur;
   }
 
-  // updates the image
-  ImageType::iterator j;
-  for (j=pImage->begin(); j!=pImage->end(); ++j) {
-    *j = lmap[(LabelType)*j];
+  // updates the image, with a dense table of the new labels (0 for the
+  // labels which are not in lmap, as lmap[] does)
+  const size_t nbValues = pImage->GetNumberOfValues();
+  if (nbValues > 0) {
+    const LabelType tableMin = (LabelType)pImage->GetMinValue();
+    const LabelType tableMax = (LabelType)pImage->GetMaxValue();
+    if ((long)tableMax - tableMin < theMaxDenseTableSize) {
+      std::vector<LabelType> newLabel(tableMax - tableMin + 1, 0);
+      std::map<LabelType,LabelType>::iterator m;
+      for (m=lmap.lower_bound(tableMin); m!=lmap.end() && m->first<=tableMax; ++m)
+        newLabel[m->first - tableMin] = m->second;
+      float * data = &(*pImage->begin());
+      const LabelType * labels = &newLabel[0];
+      GateParallel::ForChunks(nbValues, NumberOfChunks(nbValues), [data, labels, tableMin](unsigned int, size_t begin, size_t end) {
+          for(size_t k=begin; k<end; k++) data[k] = labels[(LabelType)data[k] - tableMin];
+        });
+    }
+    else {
+      ImageType::iterator j;
+      for (j=pImage->begin(); j!=pImage->end(); ++j) {
+        *j = lmap[(LabelType)*j];
+      }
+    }
   }
 
   // updates the material map
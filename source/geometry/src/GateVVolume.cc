@@ -331,6 +331,16 @@ void GateVVolume::ConstructOwnPhysicalVolume(G4bool flagUpdateOnly) {
             //----------------------------------------------------------------
             pOwnPhys = GetPhysicalVolume(copyNumber);
 
+            // Placements that did not move are left untouched, so that
+            // only the mothers of the moved ones are optimised again
+            const G4RotationMatrix *oldRotationMatrix = pOwnPhys->GetRotation();
+            const G4bool sameRotation = oldRotationMatrix ? (newRotationMatrix && *oldRotationMatrix == *newRotationMatrix)
+                                                          : !newRotationMatrix;
+            if (sameRotation && pOwnPhys->GetTranslation() == position) {
+                delete newRotationMatrix;
+                continue;
+            }
+
             // Set the translation vector for this physical volume
             pOwnPhys->SetTranslation(position);
 
@@ -0,0 +1,193 @@
+//
+// Created by the OpenGATE collaboration.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+#include <stdexcept>
+#include <cxxabi.h>
+
+#include "GateTreeFile.hh"
+
+/*
+ * Columnar tree file (".gtc"): the entries are buffered by chunks of
+ * chunk_size entries, each variable of a chunk being stored as one
+ * column, compressed on its own (zstd or lz4 when Gate is built with
+ * them). A footer at the end of the file indexes the columns of each
+ * chunk, so that a reader seeks directly to the chunk of any entry and
+ * only decompresses the columns it reads.
+ *
+ * File layout:
+ *   magic | chunk 0 (column 0, column 1, ...) | chunk 1 ... | footer | footer position | magic
+ */
+
+class GateChunkedData : public GateData
+{
+public:
+  GateChunkedData(const void * pointer_to_data,
+                  const size_t size_of_data,
+                  const std::string _name,
+                  const std::string format,
+                  const std::type_index type_index
+  ) : GateData(pointer_to_data, _name, type_index),
+      m_size_of_data(size_of_data),
+      m_format(format),
+      m_nb_characters(0),
+      m_type_index_read(type_index)
+  {
+  }
+
+  size_t m_size_of_data;
+  std::string m_format;
+  size_t m_nb_characters;
+
+  std::type_index m_type_index_read; // type index of read variable, in case where we want to read a string
+  std::vector<char> m_column;        // values of the current chunk
+};
+
+// Position of a column of a chunk in the file
+struct GateChunkedColumnIndex
+{
+  uint64_t offset;
+  uint64_t stored_size;
+  uint8_t codec;
+  uint8_t shuffled;
+};
+
+struct GateChunkedChunkIndex
+{
+  uint64_t nb_entries;
+  std::vector<GateChunkedColumnIndex> columns;
+};
+
+class GateChunkedTree : public GateTree
+{
+public:
+  enum codec_t : uint8_t { codec_none = 0, codec_zstd = 1, codec_lz4 = 2 };
+
+  GateChunkedTree();
+  static std::string _get_factory_name() { return "gtc"; }
+  uint64_t nb_elements();
+
+  static codec_t codec_from_name(const std::string &name);
+  static std::string codec_name(codec_t codec);
+
+protected:
+  void register_variable(const std::string &name, const void *p, std::type_index t_index) override;
+  void register_variable(const std::string &name, const char *p, size_t nb_char) override;
+  void register_variable(const std::string &name, const std::string *p, size_t nb_char) override;
+  void register_variable(const std::string &name, const int *p, size_t n) override;
+
+  template<typename T>
+  void register_variable(const std::string &name, const T *p)
+  {
+    if(!std::is_arithmetic<T>::value)
+    {
+      throw std::invalid_argument(std::string("templated version of register_variable can not be used for type = ") +
+                                      abi::__cxa_demangle(typeid(T).name(), 0, 0, nullptr));
+    }
+    register_variable(name, p, typeid(T));
+  }
+
+  void register_variable(const std::string& name, const void *p, const size_t size, const std::string &format, std::type_index t_index);
+
+  // Element size of the shuffle filter (bytes of the same rank grouped), 1 if not shuffled
+  static size_t shuffle_size(const GateChunkedData &d);
+
+protected:
+  uint64_t m_nb_elements;
+  uint64_t m_chunk_size;
+  std::vector<GateChunkedData> m_vector_of_pointer_to_data;
+  std::vector<GateChunkedChunkIndex> m_chunks;
+  std::fstream m_file;
+
+  const std::string magic = std::string("GATETC\x01\x00", 8);
+  std::unordered_map<std::type_index, std::string> m_tmap_cppToFormat;
+  std::unordered_map<std::string, std::type_index> m_tmap_formatToCpp;
+};
+
+
+class GateOutputChunkedTreeFile: public GateChunkedTree, public GateOutputTreeFile
+{
+public:
+  GateOutputChunkedTreeFile();
+  void open(const std::string& s) override ;
+  bool is_open() override;
+  void close() override;
+
+  void write_header() override ;
+  void write() override ;
+  void fill() override;
+
+  void write_variable(const std::string &name, const void *p, std::type_index t_index) override;
+  void write_variable(const std::string &name, const std::string *p, size_t nb_char) override;
+  void write_variable(const std::string &name, const char *p, size_t nb_char) override;
+  void write_variable(const std::string &name, const int *p, size_t n) override;
+
+  template<typename T >
+  void write_variable(const std::string &name, const T *p)
+  {
+    register_variable(name, p);
+  }
+
+  // Defaults of the files opened afterwards
+  static void set_default_chunk_size(uint64_t n);
+  static void set_default_codec(const std::string &name);
+
+private:
+  void write_chunk();
+  void write_footer();
+
+  bool m_write_header_called;
+  codec_t m_codec;
+  uint64_t m_nb_in_chunk;
+  uint64_t m_position_of_footer;
+  std::vector<char> m_shuffled;
+  std::vector<char> m_compressed;
+
+  static uint64_t s_default_chunk_size;
+  static codec_t s_default_codec;
+  static bool s_registered;
+};
+
+
+class GateInputChunkedTreeFile: public GateChunkedTree, public GateInputTreeFile
+{
+public:
+  GateInputChunkedTreeFile();
+
+  void open(const std::string &name) override ;
+  bool is_open() override;
+  void read_next_entrie() override ;
+  void close() override;
+  uint64_t nb_elements() override ;
+
+  void read_entrie(const uint64_t &i) override;
+
+  void read_variable(const std::string &name, void *p, std::type_index t_index) override ;
+  void read_variable(const std::string &name, char* p) override ;
+  void read_variable(const std::string &name, std::string *p) override ;
+  using GateInputTreeFile::read_variable; //call templated version
+  void read_header() override;
+  bool data_to_read() override ;
+
+  bool has_variable(const std::string &name) override;
+  std::type_index get_type_of_variable(const std::string &name) override;
+
+private:
+  void load_chunk(size_t c);
+
+  bool m_read_header_called;
+  uint64_t m_current_entry;
+  int64_t m_loaded_chunk;
+  std::vector<uint64_t> m_first_entry_of_chunk;
+  std::vector<char> m_stored;
+  std::vector<char> m_shuffled;
+  static bool s_registered;
+};
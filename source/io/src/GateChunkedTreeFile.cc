@@ -0,0 +1,728 @@
+//
+// Created by the OpenGATE collaboration.
+//
+
+#include "GateChunkedTreeFile.hh"
+
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+#include "GateConfiguration.h"
+#include "GateFileExceptions.hh"
+#include "GateTreeFileManager.hh"
+
+#ifdef GATE_USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef GATE_USE_LZ4
+#include <lz4.h>
+#endif
+
+using namespace std;
+
+uint64_t GateOutputChunkedTreeFile::s_default_chunk_size = 65536;
+#if defined(GATE_USE_ZSTD)
+GateChunkedTree::codec_t GateOutputChunkedTreeFile::s_default_codec = GateChunkedTree::codec_zstd;
+#elif defined(GATE_USE_LZ4)
+GateChunkedTree::codec_t GateOutputChunkedTreeFile::s_default_codec = GateChunkedTree::codec_lz4;
+#else
+GateChunkedTree::codec_t GateOutputChunkedTreeFile::s_default_codec = GateChunkedTree::codec_none;
+#endif
+
+namespace
+{
+
+bool is_little_endian()
+{
+  const uint16_t one = 1;
+  return *(const uint8_t*)&one == 1;
+}
+
+template<typename T>
+void write_value(std::fstream &file, const T &v)
+{
+  file.write((const char*)&v, sizeof(T));
+}
+
+void write_string(std::fstream &file, const std::string &s)
+{
+  write_value<uint32_t>(file, s.size());
+  file.write(s.data(), s.size());
+}
+
+template<typename T>
+T read_value(std::fstream &file)
+{
+  T v = T();
+  file.read((char*)&v, sizeof(T));
+  return v;
+}
+
+std::string read_string(std::fstream &file)
+{
+  uint32_t n = read_value<uint32_t>(file);
+  if(!file || n > (1u << 16))
+    throw GateMalFormedHeaderException("InputChunkedTreeFile::read_header: bad string in footer");
+  std::string s(n, '\0');
+  file.read(&s[0], n);
+  return s;
+}
+
+// Bytes of the same rank of the elements grouped together: the high
+// bytes of doubles or integers are alike, and compress much better
+void shuffle(const char *src, char *dst, size_t nb_bytes, size_t element_size)
+{
+  const size_t n = nb_bytes / element_size;
+  for(size_t b = 0; b < element_size; ++b)
+    for(size_t e = 0; e < n; ++e)
+      dst[b * n + e] = src[e * element_size + b];
+}
+
+void unshuffle(const char *src, char *dst, size_t nb_bytes, size_t element_size)
+{
+  const size_t n = nb_bytes / element_size;
+  for(size_t b = 0; b < element_size; ++b)
+    for(size_t e = 0; e < n; ++e)
+      dst[e * element_size + b] = src[b * n + e];
+}
+
+// Size of the compressed data, 0 if it could not be compressed
+size_t compress(GateChunkedTree::codec_t codec, const char *src, size_t n, std::vector<char> &dst)
+{
+  switch(codec)
+  {
+#ifdef GATE_USE_ZSTD
+    case GateChunkedTree::codec_zstd:
+    {
+      dst.resize(ZSTD_compressBound(n));
+      size_t size = ZSTD_compress(dst.data(), dst.size(), src, n, 3);
+      return ZSTD_isError(size) ? 0 : size;
+    }
+#endif
+#ifdef GATE_USE_LZ4
+    case GateChunkedTree::codec_lz4:
+    {
+      if(n > (size_t)LZ4_MAX_INPUT_SIZE)
+        return 0;
+      dst.resize(LZ4_compressBound(n));
+      int size = LZ4_compress_default(src, dst.data(), n, dst.size());
+      return size > 0 ? size : 0;
+    }
+#endif
+    default:
+      UNUSED(src);
+      UNUSED(n);
+      UNUSED(dst);
+      return 0;
+  }
+}
+
+void decompress(GateChunkedTree::codec_t codec, const char *src, size_t n, char *dst, size_t raw_size)
+{
+  bool ok = false;
+  switch(codec)
+  {
+#ifdef GATE_USE_ZSTD
+    case GateChunkedTree::codec_zstd:
+      ok = ZSTD_decompress(dst, raw_size, src, n) == raw_size;
+      break;
+#endif
+#ifdef GATE_USE_LZ4
+    case GateChunkedTree::codec_lz4:
+      ok = LZ4_decompress_safe(src, dst, n, raw_size) == (int)raw_size;
+      break;
+#endif
+    default:
+      UNUSED(src);
+      UNUSED(n);
+      UNUSED(dst);
+      UNUSED(raw_size);
+      throw std::runtime_error("InputChunkedTreeFile: data compressed with " + GateChunkedTree::codec_name(codec) +
+                               ", which is not available in this build of Gate");
+  }
+  if(!ok)
+    throw std::runtime_error("InputChunkedTreeFile: corrupted chunk");
+}
+
+}
+
+
+GateChunkedTree::GateChunkedTree() : m_nb_elements(0), m_chunk_size(0)
+{
+  const std::pair<std::type_index, std::string> formats[] = {
+      {typeid(long double), "f16"}, {typeid(double), "f8"}, {typeid(float), "f4"},
+      {typeid(uint8_t), "u1"}, {typeid(uint16_t), "u2"}, {typeid(uint32_t), "u4"}, {typeid(uint64_t), "u8"},
+      {typeid(int8_t), "i1"}, {typeid(int16_t), "i2"}, {typeid(int32_t), "i4"}, {typeid(int64_t), "i8"},
+      {typeid(bool), "?"}, {typeid(char), "c"}};
+
+  for(auto &&f : formats)
+  {
+    m_tmap_cppToFormat.emplace(f.first, f.second);
+    m_tmap_formatToCpp.emplace(f.second, f.first);
+  }
+}
+
+uint64_t GateChunkedTree::nb_elements()
+{
+  return m_nb_elements;
+}
+
+GateChunkedTree::codec_t GateChunkedTree::codec_from_name(const std::string &name)
+{
+  if(name == "none")
+    return codec_none;
+#ifdef GATE_USE_ZSTD
+  if(name == "zstd")
+    return codec_zstd;
+#endif
+#ifdef GATE_USE_LZ4
+  if(name == "lz4")
+    return codec_lz4;
+#endif
+  throw std::invalid_argument("compression '" + name + "' is not available (none"
+#ifdef GATE_USE_ZSTD
+                              ", zstd"
+#endif
+#ifdef GATE_USE_LZ4
+                              ", lz4"
+#endif
+                              ")");
+}
+
+std::string GateChunkedTree::codec_name(codec_t codec)
+{
+  switch(codec)
+  {
+    case codec_none: return "none";
+    case codec_zstd: return "zstd";
+    case codec_lz4: return "lz4";
+  }
+  return "unknown";
+}
+
+void GateChunkedTree::register_variable(const std::string &name, const void *p, const size_t size, const std::string &format, std::type_index t_index)
+{
+  for (auto&& d_ : m_vector_of_pointer_to_data)
+  {
+    if(d_.name() == name)
+    {
+      string s("Error: Key '");
+      s += name;
+      s += "' already used !";
+      throw GateKeyAlreadyExistsException( s );
+    }
+  }
+  m_vector_of_pointer_to_data.emplace_back(p, size, name, format, t_index);
+}
+
+void GateChunkedTree::register_variable(const std::string &name, const void *p, std::type_index t_index)
+{
+  register_variable(name, p, m_tmapOfSize.at(t_index), m_tmap_cppToFormat.at(t_index), t_index);
+}
+
+void GateChunkedTree::register_variable(const std::string &name, const char *p, size_t nb_char)
+{
+  if(!nb_char)
+    throw std::out_of_range("nb_char == 0 does not make any sense");
+
+  register_variable(name, p, nb_char, "S" + std::to_string(nb_char), typeid(char*));
+  m_vector_of_pointer_to_data.back().m_nb_characters = nb_char;
+}
+
+void GateChunkedTree::register_variable(const std::string &name, const std::string *p, size_t nb_char)
+{
+  if(!nb_char)
+    throw std::out_of_range("nb_char == 0 does not make any sense");
+
+  register_variable(name, p, nb_char, "S" + std::to_string(nb_char), typeid(string));
+  m_vector_of_pointer_to_data.back().m_nb_characters = nb_char;
+}
+
+void GateChunkedTree::register_variable(const std::string &name, const int *p, size_t n)
+{
+  if(!n)
+    throw std::out_of_range("n == 0 does not make any sense");
+
+  // Array of int (volumeID): n int per entry
+  register_variable(name, p, n * sizeof(int), "V" + std::to_string(n), typeid(int*));
+}
+
+size_t GateChunkedTree::shuffle_size(const GateChunkedData &d)
+{
+  if(d.m_nb_characters)
+    return 1;
+  if(d.m_type_index == typeid(int*))
+    return sizeof(int);
+  return d.m_size_of_data;
+}
+
+
+//-----------------------------------------------------------------------------
+GateOutputChunkedTreeFile::GateOutputChunkedTreeFile() :
+    m_write_header_called(false),
+    m_codec(s_default_codec),
+    m_nb_in_chunk(0),
+    m_position_of_footer(0)
+{
+  m_chunk_size = s_default_chunk_size;
+}
+
+void GateOutputChunkedTreeFile::set_default_chunk_size(uint64_t n)
+{
+  if(!n)
+    throw std::out_of_range("chunk size == 0 does not make any sense");
+  s_default_chunk_size = n;
+}
+
+void GateOutputChunkedTreeFile::set_default_codec(const std::string &name)
+{
+  s_default_codec = codec_from_name(name);
+}
+
+void GateOutputChunkedTreeFile::open(const std::string& s)
+{
+  GateFile::open(s, std::ofstream::binary | std::fstream::out);
+  m_file.open(s, std::ofstream::binary | std::fstream::out | std::fstream::trunc);
+  if(!m_file.is_open())
+  {
+    std::stringstream ss;
+    ss << "Error opening file! '"  << s <<  "' : " << strerror(errno) ;
+    throw std::ios::failure(ss.str());
+  }
+}
+
+bool GateOutputChunkedTreeFile::is_open()
+{
+  return m_file.is_open();
+}
+
+void GateOutputChunkedTreeFile::write_variable(const std::string &name, const void *p, std::type_index t_index)
+{
+  this->register_variable(name, p, t_index);
+}
+
+void GateOutputChunkedTreeFile::write_variable(const std::string &name, const std::string *p, size_t nb_char)
+{
+  this->register_variable(name, p, nb_char);
+}
+
+void GateOutputChunkedTreeFile::write_variable(const std::string &name, const char *p, size_t nb_char)
+{
+  this->register_variable(name, p, nb_char);
+}
+
+void GateOutputChunkedTreeFile::write_variable(const std::string &name, const int *p, size_t n)
+{
+  this->register_variable(name, p, n);
+}
+
+void GateOutputChunkedTreeFile::write_header()
+{
+  if( (m_mode & ios_base::out) != ios_base::out )
+    throw std::runtime_error("ChunkedTreeFile::write_header: file not opened in write mode");
+
+  m_file.write(magic.data(), magic.size());
+  m_position_of_footer = m_file.tellp();
+
+  for(auto &&d : m_vector_of_pointer_to_data)
+    d.m_column.resize(m_chunk_size * d.m_size_of_data);
+  m_write_header_called = true;
+}
+
+void GateOutputChunkedTreeFile::fill()
+{
+  if(!m_write_header_called)
+    throw std::logic_error("write_header not called");
+
+  if (m_vector_of_pointer_to_data.empty())
+    return;
+
+  for (auto&& d : m_vector_of_pointer_to_data)
+  {
+    char *dst = d.m_column.data() + m_nb_in_chunk * d.m_size_of_data;
+    if(d.m_nb_characters == 0)
+      memcpy(dst, d.m_pointer_to_data, d.m_size_of_data);
+    else if(d.m_type_index == typeid(char*))
+    {
+      const char *p_data = (const char*)d.m_pointer_to_data;
+      size_t n = strnlen(p_data, d.m_nb_characters);
+      memcpy(dst, p_data, n);
+      memset(dst + n, 0, d.m_nb_characters - n);
+    }
+    else
+    {
+      const auto *p_s = (const string*) d.m_pointer_to_data;
+      if( p_s->size() > d.m_nb_characters)
+      {
+        string m;
+        m += "length(" + *p_s + ") = (" + std::to_string(p_s->size()) +   ") > " + std::to_string(d.m_nb_characters);
+        throw std::length_error(m);
+      }
+      memcpy(dst, p_s->data(), p_s->size());
+      memset(dst + p_s->size(), 0, d.m_nb_characters - p_s->size());
+    }
+  }
+
+  m_nb_elements++;
+  if(++m_nb_in_chunk == m_chunk_size)
+    write_chunk();
+}
+
+void GateOutputChunkedTreeFile::write_chunk()
+{
+  if(!m_nb_in_chunk)
+    return;
+
+  // The chunk replaces the footer written by a previous write()
+  m_file.seekp(m_position_of_footer);
+
+  GateChunkedChunkIndex chunk;
+  chunk.nb_entries = m_nb_in_chunk;
+  for(auto &&d : m_vector_of_pointer_to_data)
+  {
+    const size_t raw_size = m_nb_in_chunk * d.m_size_of_data;
+    const char *raw = d.m_column.data();
+    GateChunkedColumnIndex column = {(uint64_t)m_file.tellp(), raw_size, codec_none, 0};
+
+    size_t size = 0;
+    const size_t element_size = shuffle_size(d);
+    if(m_codec != codec_none)
+    {
+      const char *src = raw;
+      if(element_size > 1)
+      {
+        m_shuffled.resize(raw_size);
+        shuffle(raw, m_shuffled.data(), raw_size, element_size);
+        src = m_shuffled.data();
+      }
+      size = compress(m_codec, src, raw_size, m_compressed);
+    }
+
+    // Stored as is when the compression does not reduce the size
+    if(size > 0 && size < raw_size)
+    {
+      column.stored_size = size;
+      column.codec = m_codec;
+      column.shuffled = element_size > 1;
+      m_file.write(m_compressed.data(), size);
+    }
+    else
+      m_file.write(raw, raw_size);
+    chunk.columns.push_back(column);
+  }
+
+  if(!m_file)
+    throw std::ios::failure("ChunkedTreeFile: error while writing '" + m_path + "'");
+  m_chunks.push_back(chunk);
+  m_position_of_footer = m_file.tellp();
+  m_nb_in_chunk = 0;
+}
+
+void GateOutputChunkedTreeFile::write_footer()
+{
+  m_file.seekp(m_position_of_footer);
+
+  write_value<uint8_t>(m_file, is_little_endian());
+  write_string(m_file, m_nameOfTree);
+  write_value<uint64_t>(m_file, m_nb_elements);
+  write_value<uint64_t>(m_file, m_chunk_size);
+
+  write_value<uint32_t>(m_file, m_vector_of_pointer_to_data.size());
+  for(auto &&d : m_vector_of_pointer_to_data)
+  {
+    write_string(m_file, d.name());
+    write_string(m_file, d.m_format);
+    write_value<uint64_t>(m_file, d.m_size_of_data);
+  }
+
+  write_value<uint64_t>(m_file, m_chunks.size());
+  for(auto &&chunk : m_chunks)
+  {
+    write_value<uint64_t>(m_file, chunk.nb_entries);
+    for(auto &&column : chunk.columns)
+    {
+      write_value<uint64_t>(m_file, column.offset);
+      write_value<uint64_t>(m_file, column.stored_size);
+      write_value<uint8_t>(m_file, column.codec);
+      write_value<uint8_t>(m_file, column.shuffled);
+    }
+  }
+
+  write_value<uint64_t>(m_file, m_position_of_footer);
+  m_file.write(magic.data(), magic.size());
+  m_file.flush();
+}
+
+void GateOutputChunkedTreeFile::write()
+{
+  if(!m_file.is_open() || !m_write_header_called)
+    return;
+
+  // Pending entries written as a (smaller) chunk, so that the file is
+  // complete after each write; the next entries start a new chunk
+  write_chunk();
+  write_footer();
+}
+
+void GateOutputChunkedTreeFile::close()
+{
+  if(!m_file.is_open())
+    return;
+
+  GateOutputChunkedTreeFile::write();
+  m_file.close();
+}
+
+
+//-----------------------------------------------------------------------------
+GateInputChunkedTreeFile::GateInputChunkedTreeFile() :
+    m_read_header_called(false),
+    m_current_entry(0),
+    m_loaded_chunk(-1)
+{}
+
+void GateInputChunkedTreeFile::open(const std::string &s)
+{
+  GateFile::open(s, std::fstream::in);
+  m_file.open(s, std::ofstream::binary | std::fstream::in);
+  if(!m_file.is_open())
+  {
+    std::stringstream ss;
+    ss << "Error opening file! '"  << s <<  "' : " << strerror(errno) ;
+    throw std::ios::failure(ss.str());
+  }
+}
+
+bool GateInputChunkedTreeFile::is_open()
+{
+  return m_file.is_open();
+}
+
+void GateInputChunkedTreeFile::close()
+{
+  if(!m_file.is_open())
+    return;
+
+  m_file.close();
+}
+
+void GateInputChunkedTreeFile::read_header()
+{
+  if(!m_file.is_open())
+    throw std::runtime_error("InputChunkedTreeFile::read_header: try to read from closed file");
+
+  // Trailer: position of the footer and magic
+  string trailer_magic(magic.size(), '\0');
+  m_file.seekg(-(std::streamoff)(sizeof(uint64_t) + magic.size()), std::fstream::end);
+  uint64_t position_of_footer = read_value<uint64_t>(m_file);
+  m_file.read(&trailer_magic[0], trailer_magic.size());
+  if(!m_file || trailer_magic != magic)
+    throw GateMissingHeaderException("InputChunkedTreeFile::read_header: '" + m_path + "' is not a complete chunked tree file");
+
+  m_file.seekg(position_of_footer);
+  if(read_value<uint8_t>(m_file) != is_little_endian())
+    throw GateMalFormedHeaderException("InputChunkedTreeFile::read_header: file written with another endianness");
+  read_string(m_file); // name of the tree
+  m_nb_elements = read_value<uint64_t>(m_file);
+  m_chunk_size = read_value<uint64_t>(m_file);
+
+  uint32_t nb_columns = read_value<uint32_t>(m_file);
+  for(uint32_t i = 0; i < nb_columns && m_file; ++i)
+  {
+    string name = read_string(m_file);
+    string format = read_string(m_file);
+    uint64_t size = read_value<uint64_t>(m_file);
+
+    if(format.empty())
+      throw GateNoTypeInHeaderException("InputChunkedTreeFile::read_header: no type for '" + name + "'");
+    if(format[0] == 'S')
+      this->register_variable(name, (const string *)nullptr, stol(format.substr(1)));
+    else if(format[0] == 'V')
+      this->register_variable(name, (const int *)nullptr, stol(format.substr(1)));
+    else
+    {
+      auto it = m_tmap_formatToCpp.find(format);
+      if(it == m_tmap_formatToCpp.end())
+        throw GateNoTypeInHeaderException("InputChunkedTreeFile::read_header: unknown type '" + format + "' for '" + name + "'");
+      this->register_variable(name, nullptr, it->second);
+    }
+    if(m_vector_of_pointer_to_data.back().m_size_of_data != size)
+      throw GateMalFormedHeaderException("InputChunkedTreeFile::read_header: wrong size for '" + name + "'");
+  }
+
+  uint64_t nb_chunks = read_value<uint64_t>(m_file);
+  uint64_t first_entry = 0;
+  for(uint64_t c = 0; c < nb_chunks && m_file; ++c)
+  {
+    GateChunkedChunkIndex chunk;
+    chunk.nb_entries = read_value<uint64_t>(m_file);
+    for(uint32_t i = 0; i < nb_columns; ++i)
+    {
+      GateChunkedColumnIndex column;
+      column.offset = read_value<uint64_t>(m_file);
+      column.stored_size = read_value<uint64_t>(m_file);
+      column.codec = read_value<uint8_t>(m_file);
+      column.shuffled = read_value<uint8_t>(m_file);
+      chunk.columns.push_back(column);
+    }
+    m_chunks.push_back(chunk);
+    m_first_entry_of_chunk.push_back(first_entry);
+    first_entry += chunk.nb_entries;
+  }
+
+  if(!m_file || first_entry != m_nb_elements)
+    throw GateMalFormedHeaderException("InputChunkedTreeFile::read_header: corrupted footer in '" + m_path + "'");
+
+  m_read_header_called = true;
+}
+
+void GateInputChunkedTreeFile::load_chunk(size_t c)
+{
+  const GateChunkedChunkIndex &chunk = m_chunks[c];
+  for(size_t i = 0; i < m_vector_of_pointer_to_data.size(); ++i)
+  {
+    // Only the columns read are decompressed
+    GateChunkedData &d = m_vector_of_pointer_to_data[i];
+    if(!d.m_pointer_to_data)
+      continue;
+
+    const GateChunkedColumnIndex &column = chunk.columns[i];
+    const size_t raw_size = chunk.nb_entries * d.m_size_of_data;
+    d.m_column.resize(raw_size);
+    m_file.seekg(column.offset);
+    if(column.codec == codec_none)
+    {
+      m_file.read(d.m_column.data(), raw_size);
+    }
+    else
+    {
+      m_stored.resize(column.stored_size);
+      m_file.read(m_stored.data(), column.stored_size);
+      if(column.shuffled)
+      {
+        m_shuffled.resize(raw_size);
+        decompress((codec_t)column.codec, m_stored.data(), column.stored_size, m_shuffled.data(), raw_size);
+        unshuffle(m_shuffled.data(), d.m_column.data(), raw_size, shuffle_size(d));
+      }
+      else
+        decompress((codec_t)column.codec, m_stored.data(), column.stored_size, d.m_column.data(), raw_size);
+    }
+    if(!m_file)
+      throw std::runtime_error("InputChunkedTreeFile: '" + m_path + "' is truncated");
+  }
+  m_loaded_chunk = c;
+}
+
+void GateInputChunkedTreeFile::read_entrie(const uint64_t &i)
+{
+  if(!m_read_header_called)
+    throw std::logic_error("read_header not called");
+  if(i >= m_nb_elements)
+    throw std::out_of_range("InputChunkedTreeFile::read_entrie: entry " + std::to_string(i) + " out of the file");
+
+  size_t c = std::upper_bound(m_first_entry_of_chunk.begin(), m_first_entry_of_chunk.end(), i) - m_first_entry_of_chunk.begin() - 1;
+  if((int64_t)c != m_loaded_chunk)
+    load_chunk(c);
+
+  const uint64_t j = i - m_first_entry_of_chunk[c];
+  for (auto&& d : m_vector_of_pointer_to_data)
+  {
+    if(!d.m_pointer_to_data)
+      continue;
+    const char *src = d.m_column.data() + j * d.m_size_of_data;
+    if(d.m_nb_characters && d.m_type_index_read == typeid(string))
+      ((string*)d.m_pointer_to_data)->assign(src, strnlen(src, d.m_nb_characters));
+    else
+      memcpy((void*)d.m_pointer_to_data, src, d.m_size_of_data);
+  }
+  m_current_entry = i + 1;
+}
+
+void GateInputChunkedTreeFile::read_next_entrie()
+{
+  read_entrie(m_current_entry);
+}
+
+bool GateInputChunkedTreeFile::data_to_read()
+{
+  if(!m_read_header_called)
+    throw std::logic_error("read_header not called");
+  return m_current_entry < m_nb_elements;
+}
+
+uint64_t GateInputChunkedTreeFile::nb_elements()
+{
+  return GateChunkedTree::nb_elements();
+}
+
+void GateInputChunkedTreeFile::read_variable(const std::string &name, void *p, std::type_index t_index)
+{
+  if(!m_read_header_called)
+    throw std::logic_error("read_header not called");
+
+  for (auto&& d : m_vector_of_pointer_to_data)
+  {
+    if(name != d.name())
+      continue;
+
+    if(t_index == typeid(string) || t_index == typeid(char*))
+    {
+      if(d.m_type_index != typeid(string))
+        throw GateTypeMismatchHeaderException("Provided a string for non string variable");
+    }
+    else if(t_index != d.m_type_index)
+    {
+      std::stringstream ss;
+      ss << "type_index given to store '" << name << "' has not the right type (need " << d.m_format << ")";
+      throw GateTypeMismatchHeaderException(ss.str());
+    }
+
+    d.m_pointer_to_data = p;
+    d.m_type_index_read = t_index;
+    m_loaded_chunk = -1; // the column is not loaded yet
+    return;
+  }
+
+  std::stringstream ss;
+  ss << "Variable named '" << name << "' not found !";
+  throw GateKeyNotFoundInHeaderException(ss.str());
+}
+
+void GateInputChunkedTreeFile::read_variable(const std::string &name, char *p)
+{
+  read_variable(name, p, typeid(char*));
+}
+
+void GateInputChunkedTreeFile::read_variable(const std::string &name, std::string *p)
+{
+  read_variable(name, p, typeid(string));
+}
+
+bool GateInputChunkedTreeFile::has_variable(const std::string &name)
+{
+  if(!m_read_header_called)
+    throw std::logic_error("read_header not called");
+  for (auto&& d : m_vector_of_pointer_to_data) {
+    if (name == d.name())
+      return true;
+  }
+  return false;
+}
+
+type_index GateInputChunkedTreeFile::get_type_of_variable(const std::string &name)
+{
+  if(!m_read_header_called)
+    throw std::logic_error("read_header not called");
+  for (auto&& d : m_vector_of_pointer_to_data) {
+    if (name == d.name())
+      return d.m_type_index;
+  }
+  std::stringstream ss;
+  ss << "Variable named '" << name << "' not found !";
+  throw GateKeyNotFoundInHeaderException(ss.str());
+}
+
+
+bool GateOutputChunkedTreeFile::s_registered =  GateOutputTreeFileFactory::_register(GateOutputChunkedTreeFile::_get_factory_name(), &GateOutputChunkedTreeFile::_create_method<GateOutputChunkedTreeFile>);
+bool GateInputChunkedTreeFile::s_registered =  GateInputTreeFileFactory::_register(GateInputChunkedTreeFile::_get_factory_name(), &GateInputChunkedTreeFile::_create_method<GateInputChunkedTreeFile>);
@@ -62,6 +62,7 @@ class GateCrossSectionsTable: public G4PhysicsTable
 		inline G4double GetCrossSection ( size_t materialIndex, G4double energy ) const;
 		inline G4double GetCrossSection ( size_t materialIndex, G4double energy, G4double density ) const;	//assuming that cross section linear in density (not yet implemented)
 		inline G4double GetMaxCrossSection ( G4double energy ) const;
+		inline const G4PhysicsVector* GetMaxCrossSectionVector() const;
 
 	protected:
 		size_t AddMaterial ( const G4MaterialCutsCouple* ); // returns index for that material
@@ -113,6 +114,11 @@ inline G4double GateCrossSectionsTable::GetMaxCrossSection ( G4double energy ) c
 	return m_pMaxCrossSection->GetValue ( energy,NotUsedAnyMoreIsOutOfRange );
 }
 
+inline const G4PhysicsVector* GateCrossSectionsTable::GetMaxCrossSectionVector() const
+{
+	return m_pMaxCrossSection;
+}
+
 inline G4double GateCrossSectionsTable::GetCrossSection ( size_t materialIndex, G4double energy) const
 {
 	bool NotUsedAnyMoreIsOutOfRange;
@@ -16,6 +16,7 @@ See LICENSE.md for further details
 */
 
 class GateFictitiousVoxelMap;
+class GateFictitiousMajorantGrid;
 class GateCrossSectionsTable;
 class GateTotalDiscreteProcess;
 class G4Material;
@@ -90,6 +91,10 @@ class GateFictitiousFastSimulationModel : public G4VFastSimulationModel
 		const G4AffineTransform* pTransform;
 		G4double m_nAbsMinEnergy;
 		G4double m_nAbsMaxEnergy;
+		GateFictitiousMajorantGrid* pMajorantGrid; // NULL: global majorant
+		long long m_nNumberOfPhotons;
+		long long m_nNumberOfRealInteractions;
+		long long m_nNumberOfFictitiousInteractions;
 }
 ;
 
@@ -0,0 +1,87 @@
+/*----------------------
+   Copyright (C): OpenGATE Collaboration
+
+This software is distributed under the terms
+of the GNU Lesser General  Public Licence (LGPL)
+See LICENSE.md for further details
+----------------------*/
+
+#ifndef GateFictitiousMajorantGrid_hh
+#define GateFictitiousMajorantGrid_hh 1
+
+#include "G4ThreeVector.hh"
+#include "Randomize.hh"
+#include "G4PhysicsVector.hh"
+#include <vector>
+
+class GateFictitiousVoxelMap;
+class GateCrossSectionsTable;
+
+/**
+	Coarse grid of super-voxels (cells of n*n*n voxels of a fictitious voxel
+	map) with a majorant cross section per cell, so that the rejection rate of
+	the fictitious interaction tracking only depends on the materials close to
+	the photon, not on the densest material of the whole phantom.
+
+	The grid is built on the materials of the voxel map, or on any labelled
+	image with a cross section per label (see GateFictitiousMajorant_benchmark).
+	The cells made of the same set of materials share a majorant, which is the
+	maximal cross section of these materials at the energy of the photon
+	(computed once per energy). The materials of the voxels adjacent to a cell
+	are included, so that the majorant stays valid when a point sampled close
+	to the cell boundary falls in the neighbour voxel.
+*/
+class GateFictitiousMajorantGrid
+{
+	public:
+		GateFictitiousMajorantGrid ( const GateFictitiousVoxelMap* voxelMap, const GateCrossSectionsTable* table, G4int cellSize );
+		// Grid of a labelled image (label of each voxel, x varying fastest), with the cross section
+		// of each label and the maximal cross section of all labels, centred on the origin
+		GateFictitiousMajorantGrid ( const std::vector<G4int>& labelOfVoxel, G4int nx, G4int ny, G4int nz, const G4ThreeVector& voxelDim,
+		                             const std::vector<const G4PhysicsVector*>& crossSectionOfLabel, const G4PhysicsVector* maxCrossSection, G4int cellSize );
+		~GateFictitiousMajorantGrid();
+
+		// Samples the distance to the next (real or fictitious) interaction,
+		// traversing the cells from pos along dir. Returns a value larger than
+		// maxDistance if there is no interaction before maxDistance. invMajorant
+		// is set to the inverse majorant at the interaction point.
+		G4double SampleDistance ( const G4ThreeVector& pos, const G4ThreeVector& dir, G4double maxDistance, G4double energy, G4double& invMajorant ) const;
+
+		inline G4int GetNumberOfCells() const;
+		inline G4int GetNumberOfMaterialSets() const;
+
+	protected:
+		void Build ( const std::vector<G4int>& labelOfVoxel, G4int nx, G4int ny, G4int nz, const G4ThreeVector& voxelDim );
+		G4double GetMajorant ( G4int cell, G4double energy ) const;
+		inline G4double GetMaxCrossSection ( G4double energy ) const;
+
+		std::vector<const G4PhysicsVector*> m_oLabelCrossSection;
+		const G4PhysicsVector* pMaxCrossSection;
+		G4int m_nCellSize;
+		G4int m_nNx, m_nNy, m_nNz; // number of cells
+		G4ThreeVector m_nCellDim;
+		G4ThreeVector m_nHalfContainerDim;
+		std::vector<G4int> m_oCellSet; // material set of each cell
+		std::vector<std::vector<G4int> > m_oSetLabels;
+		// majorant of each material set at the last energy
+		mutable std::vector<G4double> m_oSetEnergy;
+		mutable std::vector<G4double> m_oSetMajorant;
+};
+
+inline G4int GateFictitiousMajorantGrid::GetNumberOfCells() const
+{
+	return m_oCellSet.size();
+}
+
+inline G4int GateFictitiousMajorantGrid::GetNumberOfMaterialSets() const
+{
+	return m_oSetLabels.size();
+}
+
+inline G4double GateFictitiousMajorantGrid::GetMaxCrossSection ( G4double energy ) const
+{
+	bool NotUsedAnyMoreIsOutOfRange;
+	return pMaxCrossSection->GetValue ( energy,NotUsedAnyMoreIsOutOfRange );
+}
+
+#endif
@@ -41,6 +41,7 @@ public:
     void SetFictitiousEnergy(double);
     void SetDiscardEnergy(double); //should be equal or below fictitious energy
     void SetApproximations(GatePETVRT::Approx);
+    void SetMajorantCellSize(G4int); // voxels per cell of the local majorant grid, 0 for a global majorant
 	
     inline G4Envelope* GetEnvelope() const;
     inline GateVFictitiousMap* GetFictitiousMap() const;
@@ -50,6 +51,7 @@ public:
     inline GatePhantomSD* GetPhantomSD() const;
     inline G4double GetFictitiousEnergy() const;
     inline G4double GetDiscardEnergy() const;
+    inline G4int GetMajorantCellSize() const;
 	inline void SetVerbosity(VerbosityLevel);
 	inline VerbosityLevel GetVerbosity() const;
 
@@ -63,6 +65,7 @@ private:
     GatePhantomSD* pPhantomSD;
     G4double m_nFictitiousEnergy;
     G4double m_nDiscardEnergy;
+    G4int m_nMajorantCellSize;
 	VerbosityLevel m_nVerbosityLevel;
 };
 
@@ -93,6 +96,10 @@ inline G4double GatePETVRTSettings::GetFictitiousEnergy() const
 inline G4double GatePETVRTSettings::GetDiscardEnergy() const
 {
 	return m_nDiscardEnergy;
+}
+inline G4int GatePETVRTSettings::GetMajorantCellSize() const
+{
+	return m_nMajorantCellSize;
 }
 	inline void GatePETVRTSettings::SetVerbosity(GatePETVRTSettings::VerbosityLevel v)
 {
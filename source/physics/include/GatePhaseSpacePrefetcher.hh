@@ -0,0 +1,128 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+/*!
+  \class  GatePhaseSpacePrefetcher
+  \brief  Reads the entries of a phase space in a background thread
+
+  - The thread reads blocks of consecutive entries (wrapping at the end
+  of the phase space) with the given read function, and keeps a bounded
+  number of decoded blocks ready, so that the source only copies an
+  entry from memory.
+
+  - GetEntry(i) is expected to be called for i, i+1, i+2... A jump (a
+  new run restarting at the first particle, for instance) discards the
+  blocks read ahead and restarts the reading at the requested entry.
+
+  - The read function is only called by the thread, from Start() to
+  Stop(): the file (and the variables it is bound to) must not be used
+  by the source meanwhile.
+
+  \sa GateSourcePhaseSpace
+*/
+
+#ifndef GATEPHASESPACEPREFETCHER_HH
+#define GATEPHASESPACEPREFETCHER_HH
+
+#include "globals.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+/// An entry of a phase space file, single particle or pair of particles
+/// (variables of the PhaseSpace tree)
+struct GatePhaseSpaceEntry
+{
+  char particleName[64];
+  float energy;
+  float x, y, z;
+  float dx, dy, dz;
+  float ftime;
+  double dtime;
+  float weight;
+
+  float E1, E2;
+  float X1, Y1, Z1;
+  float X2, Y2, Z2;
+  float dX1, dY1, dZ1;
+  float dX2, dY2, dZ2;
+  float t1, t2;
+  float w1, w2;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+class GatePhaseSpacePrefetcher
+{
+public:
+  typedef std::function<void(G4long, GatePhaseSpaceEntry &)> ReadFunction;
+
+  GatePhaseSpacePrefetcher(ReadFunction read, G4long nbEntries,
+                           G4int blockSize, G4int maxQueuedBlocks = 4);
+  ~GatePhaseSpacePrefetcher();
+
+  /// Start the thread, reading from the entry first
+  void Start(G4long first);
+
+  /// Stop the thread (called by the destructor)
+  void Stop();
+
+  /// Entry i (0 <= i < nbEntries). The reference is valid until the next call.
+  inline const GatePhaseSpaceEntry & GetEntry(G4long i);
+
+  /// Time spent by GetEntry waiting for the thread (in seconds)
+  G4double GetWaitingTime() const { return mWaitingTime; }
+
+protected:
+  void Restart(G4long first);
+  void NextBlock();
+  void ReadBlocks();
+
+  ReadFunction mRead;
+  G4long mNumberOfEntries;
+  G4int mBlockSize;
+  G4int mMaxQueuedBlocks;
+
+  // Block being used by GetEntry
+  std::vector<GatePhaseSpaceEntry> mCurrentBlock;
+  size_t mPosition;
+  G4long mExpectedEntry;
+  G4double mWaitingTime;
+
+  // Shared with the thread, protected by the mutex
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::vector<GatePhaseSpaceEntry> > mQueue; //!< blocks read ahead, in entry order
+  std::vector<std::vector<GatePhaseSpaceEntry> > mFreeBlocks; //!< recycled buffers
+  G4long mNextEntry;   //!< first entry of the next block read by the thread
+  G4long mGeneration;  //!< incremented at each restart
+  G4bool mStop;
+  std::string mError;
+};
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+inline const GatePhaseSpaceEntry & GatePhaseSpacePrefetcher::GetEntry(G4long i)
+{
+  if (i != mExpectedEntry) Restart(i);
+  if (mPosition >= mCurrentBlock.size()) NextBlock();
+  mExpectedEntry = (i+1 < mNumberOfEntries) ? i+1 : 0;
+  return mCurrentBlock[mPosition++];
+}
+//-----------------------------------------------------------------------------
+
+#endif /* end #define GATEPHASESPACEPREFETCHER_HH */
@@ -85,6 +85,7 @@ protected:
   G4UIcmdWithADoubleAndUnit * pMuHandlerSetAtomicShellEMin;
   G4UIcmdWithADoubleAndUnit * pMuHandlerSetAtomicShellTolerance;
   G4UIcmdWithADouble * pMuHandlerSetPrecision;
+  G4UIcmdWithAString * pMuHandlerSetCacheDirectory;
 
   G4UIcommand * pAddAtomDeexcitation;
   G4UIcmdWithAString * pAddPhysicsList;
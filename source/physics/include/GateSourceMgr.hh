@@ -11,10 +11,15 @@
 #define GateSourceMgr_h 1
 
 #include "globals.hh"
+#include "GateConfiguration.h"
 #include <vector>
+#ifdef GATE_USE_MT
+#include "G4Threading.hh"
+#endif
 #include "G4Event.hh"
 #include "G4Run.hh"
 #include "GateVSource.hh"
+#include "GateAliasTable.hh"
 
 #include "GateApplicationMgr.hh"
 #include "GateSourcePencilBeam.hh"
@@ -70,6 +75,23 @@ public:
    * which source(s) has(have) been used for the present
    * event, to set the corresponding flag in the output.
    */
+#ifdef GATE_USE_MT
+  // In a worker thread, the values of the event currently processed by
+  // this thread (the shared members may already describe later events)
+  inline GateVSourceVector GetSourcesForThisEvent()
+  { return G4Threading::IsWorkerThread() ? *mThreadCurrentSources : m_currentSources; }
+
+  G4int GetCurrentSourceID() { return G4Threading::IsWorkerThread() ? mThreadCurrentSourceID : m_currentSourceID; };
+  void SetCurrentSourceID( G4int aID ) { m_currentSourceID = aID ; };
+
+  void SetTime( G4double value ) { m_time = value; }
+  G4double GetTime() { return G4Threading::IsWorkerThread() ? mThreadTime : m_time; }
+
+  /** Called by the worker after PrepareNextEvent, while the
+   * generation is still serialised, to keep the event values
+   */
+  void SaveEventStateOfThisThread();
+#else
   inline GateVSourceVector GetSourcesForThisEvent()
   { return m_currentSources; }
 
@@ -80,6 +102,7 @@ public:
 
   void SetTime( G4double value ) { m_time = value; }
   G4double GetTime() { return m_time; }
+#endif
 
   /** It is used internally by PrepareNextEvent
    * to decide which source has to be used for the current event.
@@ -155,6 +178,22 @@ protected:
   G4int                     mNbOfParticleInTheCurrentRun;
   G4double                  mWeight;
   G4double                  mTotalIntensity;
+
+  // Next event time of the sources with a constant activity, as a binary
+  // min-heap, so that only the source that emits is sampled again at each
+  // event. The other sources are sampled at each event (see GetNextSource).
+  struct GateSourceNextTime {
+    G4double time;
+    G4int    index;
+  };
+  static bool SourceNextTimeIsLater(const GateSourceNextTime & a, const GateSourceNextTime & b)
+  { return a.time > b.time || (a.time == b.time && a.index > b.index); }
+  std::vector<GateSourceNextTime> mSourceQueue;
+  std::vector<G4int>        mTimeDependentSources;
+  // Intensities of the sources, for the total amount of primaries mode
+  GateAliasTable            mSourceIntensityTable;
+  G4bool                    mSourceQueueNeedsUpdate;
+  void UpdateSourceQueue();
   //std::vector<G4double>     listOfActivity;
   std::vector<G4int>        listOfWeight;
   std::map<G4int,G4int>     mNumberOfEventBySource;
@@ -166,6 +205,12 @@ protected:
   GateVSource* m_fictiveSource; // idem
   G4int p_cK;
 
+#ifdef GATE_USE_MT
+  static G4ThreadLocal G4double mThreadTime;
+  static G4ThreadLocal G4int mThreadCurrentSourceID;
+  static G4ThreadLocal GateVSourceVector * mThreadCurrentSources;
+#endif
+
 };
 
 #endif
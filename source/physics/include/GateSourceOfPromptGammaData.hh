@@ -12,8 +12,10 @@
   \class  GateSourceOfPromptGammaData
 
   Manage a 3D distribution of prompt gamma, with 1 energy spectrum at
-  each voxel, stored as TH1D. For voxels with yield==0, the TH1D is not
-  instantiated/allocated.
+  each voxel. Only the voxels with yield>0 are kept: they are sampled
+  with a single alias table, and their spectra are packed (CSR) as the
+  cumulative counts of their non zero bins. The memory is thus
+  proportional to the non zero content of the image.
 
 */
 
@@ -27,6 +29,7 @@
 #include "G4SPSEneDistribution.hh"
 #include "GateConfiguration.h"
 #include "GateImageOfHistograms.hh"
+#include "GateAliasTable.hh"
 
 //------------------------------------------------------------------------
 class GateSourceOfPromptGammaData
@@ -47,25 +50,26 @@ public:
 protected:
   // The 3D prompt gamma distribution
   GateImageOfHistograms * mImage;
-  std::vector<float> mDataCounts;
 
-  // Current pixel index for position in 3D space
-  int mCurrentIndex_i;
-  int mCurrentIndex_j;
-  int mCurrentIndex_k;
+  // Current voxel (position in mVoxelIndices) for position in 3D space
+  long mCurrentVoxel;
 
-  // Physical coordinates from index coordinate
-  std::vector<double> mIndexCoordX;
-  std::vector<double> mIndexCoordY;
-  std::vector<double> mIndexCoordZ;
+  // Non zero voxels (index in the image), sampled according to their
+  // total of counts
+  std::vector<unsigned int> mVoxelIndices;
+  GateAliasTable mVoxelGen;
 
-  // The angular, position and energy generator
+  // Energy spectra, packed: the non zero bins of the voxel v are
+  // mEnergyBins[mEnergyOffsets[v]] to mEnergyBins[mEnergyOffsets[v+1]-1],
+  // and mEnergyCDF holds their cumulative counts, normalized to 1
+  std::vector<unsigned long> mEnergyOffsets;
+  std::vector<unsigned int> mEnergyBins;
+  std::vector<float> mEnergyCDF;
+  double mEnergyMin;
+  double mEnergyStep;
+
+  // The angular generator
   G4SPSAngDistribution mAngleGen;
-  //  std::vector<G4SPSEneDistribution> mEnergyGen;
-  std::vector<TH1D*> mEnergyGen;
-  G4SPSRandomGenerator mPositionXGen;
-  std::vector<G4SPSRandomGenerator*> mPositionYGen;
-  std::vector<std::vector<G4SPSRandomGenerator*> > mPositionZGen;
 
 }; // end class
 //------------------------------------------------------------------------
@@ -39,11 +39,13 @@
 #include "GateSourcePhaseSpaceMessenger.hh"
 #include "GateUserActions.hh"
 #include "GateTreeFileManager.hh"
+#include "GatePhaseSpacePrefetcher.hh"
 #include <typeindex>
 #include "json.hpp"
 
 struct iaea_record_type;
 struct iaea_header_type;
+class GateIAEAMappedFile;
 
 class GateSourcePhaseSpace : public GateVSource {
 public:
@@ -59,6 +61,12 @@ public:
 
     void GenerateROOTVertexPairs();
 
+    const GatePhaseSpaceEntry &ReadROOTEntry(G4long i);
+
+    void SetROOTEntry(const GatePhaseSpaceEntry &e);
+
+    void ReadIAEAParticle();
+
     void GenerateIAEAVertex(G4Event *);
 
     void GeneratePyTorchVertex(G4Event *);
@@ -126,6 +134,8 @@ public:
 
     void SetPytorchBatchSize(int b) { mPTBatchSize = b; }
 
+    void SetReadAheadBlockSize(int n) { mReadAheadBlockSize = n; }
+
     void InitializeIAEA();
 
     void InitializeROOT();
@@ -235,6 +245,13 @@ protected:
 
     bool mUseNbOfParticleAsIntensity;
     GateInputTreeFileChain mChain;
+    // ROOT/npy variables are read in mEntry, by the read-ahead thread if any
+    GatePhaseSpaceEntry mEntry;
+    GatePhaseSpacePrefetcher *pPrefetcher;
+    int mReadAheadBlockSize;
+    GateIAEAMappedFile *pIAEAMappedFile;
+    G4String mCachedParticleName;
+    G4ParticleDefinition *pCachedParticleDefinition;
 
     bool mIgnoreWeight;
 
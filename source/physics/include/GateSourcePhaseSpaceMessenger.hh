@@ -61,6 +61,7 @@ private:
     G4UIcmdWithABool *IgnoreTimeCmd;
     G4UIcmdWithADouble *setStartIdCmd;
     G4UIcmdWithAnInteger *setPytorchBatchSizeCmd;
+    G4UIcmdWithAnInteger *setReadAheadBlockSizeCmd;
     G4UIcmdWithAString *setPytorchParamsCmd;
 };
 //----------------------------------------------------------------------------------------
@@ -95,6 +95,7 @@ public:
 protected:
 
   void ConfigurePencilBeam();
+  void ComputeSpotOptics();
   GateSourceTPSPencilBeamMessenger * pMessenger;
 
   bool mIsInitialized;
@@ -149,6 +150,11 @@ protected:
   std::vector<double> mSpotWeight; // (proportional to) the expected number (for each bin in a multinomial distribution)
   std::vector<int> mNbIonsToGenerate; // the actual number (for each bin in a multinomial distribution)
   std::vector<G4ThreeVector> mSpotPosition, mSpotRotation;
+  //Beam optics of each spot (clinical beam model at the spot energy, sigma energy in MeV)
+  struct SpotOptics {
+    double sourceEnergy, sigmaEnergy, sigmaX, sigmaY, sigmaTheta, sigmaPhi, ellipseXThetaArea, ellipseYPhiArea;
+  };
+  std::vector<SpotOptics> mSpotOptics;
 };
 //------------------------------------------------------------------------------------------------------
 // vim: ai sw=2 ts=2 et
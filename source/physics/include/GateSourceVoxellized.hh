@@ -27,6 +27,8 @@ public:
 
   virtual G4double GetNextTime(G4double timeNow);
 
+  virtual G4bool IsActivityConstant(G4double timeNow);
+
   virtual void Dump(G4int level);
 
   virtual void Update(G4double time);
@@ -88,6 +88,13 @@ class GateVPulseProcessor : public GateClockDependent
      inline GatePulseProcessorChain* GetChain()
        { return m_chain; }
 
+     //! Time during which a pulse may change the processing of the next
+     //! ones (dead time, pile-up, buffer), 0 for a processor without memory
+     //! from an event to the next. The parallel offline digitizer overlaps
+     //! its shards by this time.
+     virtual G4double GetMemoryTime() const
+       { return 0.; }
+
    //@}
 
      //! Method overloading GateClockDependent::Describe()
@@ -77,6 +77,13 @@ public:
   virtual void SetIonDefaultHalfLife();
   virtual void Update(double time);
   virtual G4double GetNextTime( G4double timeStart );
+  // True when GetNextTime samples the same distribution at any time after
+  // timeStart, until the next call to Update (the source manager then keeps
+  // the sampled time of the source instead of sampling it at each event)
+  virtual G4bool IsActivityConstant( G4double timeStart );
+  // Set when the activity is changed between events (e.g. washout actor)
+  virtual void SetVariableActivityFlag( G4bool value ) { m_variableActivityFlag = value; }
+  virtual G4bool GetVariableActivityFlag()             { return m_variableActivityFlag; }
   //virtual G4double GetNextTimeInSuccessiveSourceMode(G4double timeStart, G4int mNbOfParticleInTheCurrentRun);
   virtual void Dump( G4int level );
   virtual void SetVerboseLevel( G4int value ) { nVerboseLevel = value; }
@@ -164,6 +171,7 @@ protected:
   G4int      nVerboseLevel;
   G4bool     m_forcedUnstableFlag;
   G4double   m_forcedLifeTime;
+  G4bool     m_variableActivityFlag;
   G4bool     m_accolinearityFlag;
   G4double   m_accoValue;
   G4String   mRelativePlacementVolumeName;
@@ -14,6 +14,7 @@
 #include <map>
 #include "globals.hh"
 #include "G4ThreeVector.hh"
+#include "GateAliasTable.hh"
 
 class GateVSource;
 class GateVSourceVoxelTranslator;
@@ -49,6 +50,7 @@ public:
   virtual void AddVoxel(G4int ix, G4int iy, G4int iz, G4double activity);
 
   void SetTimeActivTables( G4String );
+  G4bool HasTimeActivityTables() const { return !m_TimeActivTables.empty(); }
 
   void SetTimeSampling ( G4double );
 
@@ -87,9 +89,12 @@ protected:
   G4String                       m_name;
   G4String                       m_fileName;
   GateVSource*                   m_source;
-  typedef std::map<G4double,G4int >  GateSourceIntegratedActivityMap;
   GateSourceActivityMap           m_sourceVoxelActivities;
-  GateSourceIntegratedActivityMap m_sourceVoxelIntegratedActivities;
+  // Alias table of the active voxels: the emitting voxel is sampled in
+  // constant time. The storage is kept between updates of the activities.
+  GateAliasTable                 m_sourceVoxelAliasTable;
+  std::vector<G4int>             m_activeVoxels;          // voxel of each entry of the table
+  std::vector<G4double>          m_activeVoxelActivities;
   void PrepareIntegratedActivityMap();
   G4ThreeVector                  m_voxelSize;
   G4int							 m_voxelNx;
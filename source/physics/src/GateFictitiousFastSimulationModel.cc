@@ -9,6 +9,7 @@ See LICENSE.md for further details
 #include "GateFictitiousFastSimulationModel.hh"
 
 #include "GateFictitiousVoxelMap.hh"
+#include "GateFictitiousMajorantGrid.hh"
 #include "GateCrossSectionsTable.hh"
 #include <cassert>
 #include "G4FastTrack.hh"
@@ -37,11 +38,26 @@ GateFictitiousFastSimulationModel::GateFictitiousFastSimulationModel ( G4double
 	m_pTrackFastVector=new G4TrackFastVector();
 	m_nNumSecondaries=0;
 	m_nSurfaceTolerance=G4GeometryTolerance::GetInstance()->GetSurfaceTolerance() *3.;
+	pMajorantGrid=NULL;
+	m_nNumberOfPhotons=0;
+	m_nNumberOfRealInteractions=0;
+	m_nNumberOfFictitiousInteractions=0;
 }
 
 
 GateFictitiousFastSimulationModel::~GateFictitiousFastSimulationModel()
 {
+#ifdef G4VERBOSE
+	if ( m_nNumberOfPhotons>0 )
+	{
+		G4cout << "GateFictitiousFastSimulationModel: "<< m_nNumberOfPhotons << " photons tracked, "
+		       << m_nNumberOfRealInteractions << " real and "<< m_nNumberOfFictitiousInteractions << " fictitious interactions";
+		if ( m_nNumberOfRealInteractions+m_nNumberOfFictitiousInteractions>0 )
+			G4cout << " (real/total="<< static_cast<G4double> ( m_nNumberOfRealInteractions ) / ( m_nNumberOfRealInteractions+m_nNumberOfFictitiousInteractions ) << ")";
+		G4cout << "\n";
+	}
+#endif
+	delete pMajorantGrid;
 	delete m_pTrackFastVector;
 }
 
@@ -125,6 +141,16 @@ void GateFictitiousFastSimulationModel::DoIt ( const G4FastTrack& ft, G4FastStep
 		}
 
 		pFictitiousMap->Check();
+
+		const G4int cellSize=GatePETVRTManager::GetInstance()->GetOrCreatePETVRTSettings()->GetMajorantCellSize();
+		if ( cellSize>0 )
+		{
+			const GateFictitiousVoxelMap* vmap=dynamic_cast<const GateFictitiousVoxelMap*> ( pFictitiousMap );
+			if ( vmap )
+				pMajorantGrid=new GateFictitiousMajorantGrid ( vmap,pTotalCrossSectionsTable,cellSize );
+			else
+				G4cout << "Warning! GateFictitiousFastSimulationModel: the local majorant grid needs a fictitious voxel map, the global majorant is used.\n";
+		}
 	}
 
 	pCurrentFastTrack=&ft;
@@ -141,6 +167,7 @@ void GateFictitiousFastSimulationModel::DoIt ( const G4FastTrack& ft, G4FastStep
 
 
 	pCurrentFastStep=&fs;
+	m_nNumberOfPhotons++;
 
 	m_nCurrentLocalDirection=ft.GetPrimaryTrackLocalDirection();
 	m_nCurrentLocalPosition=ft.GetPrimaryTrackLocalPosition();
@@ -192,8 +219,16 @@ void GateFictitiousFastSimulationModel::VolumeTrace()
 	do
 	{
 		G4double fict;
-		fict=-log ( G4UniformRand() ); // number mean free path lengths
-		fict*=m_nCurrentInvFictCrossSection;      // distance including fictitious interaction
+		if ( pMajorantGrid )
+		{
+			// distance with the local majorants, also sets the majorant at the new position
+			fict=pMajorantGrid->SampleDistance ( m_nCurrentLocalPosition,m_nCurrentLocalDirection,m_nDistToOut-m_nPathLength,m_nCurrentEnergy,m_nCurrentInvFictCrossSection );
+		}
+		else
+		{
+			fict=-log ( G4UniformRand() ); // number mean free path lengths
+			fict*=m_nCurrentInvFictCrossSection;      // distance including fictitious interaction
+		}
 		m_nPathLength+=fict;   // add to total real distance
 		if ( m_nPathLength>=m_nDistToOut ) // leaves Region before interaction would occur --> no interaction in envelope
 		{
@@ -210,8 +245,11 @@ void GateFictitiousFastSimulationModel::VolumeTrace()
 		Affine ( m_nCurrentLocalPosition,m_nCurrentLocalDirection,fict ); // transport particle to new position
 		currentMaterial=pFictitiousMap->GetMaterial ( m_nCurrentLocalPosition );
 		assert ( pTotalCrossSectionsTable->GetCrossSection ( currentMaterial,m_nCurrentEnergy ) *m_nCurrentInvFictCrossSection<=1. );
+		m_nNumberOfFictitiousInteractions++;
 	}
 	while ( G4UniformRand() >=pTotalCrossSectionsTable->GetCrossSection ( currentMaterial,m_nCurrentEnergy ) *m_nCurrentInvFictCrossSection ); // check whether fictitious interaction
+	m_nNumberOfFictitiousInteractions--;
+	m_nNumberOfRealInteractions++;
 
 	// real interaction takes places:
 	m_nTotalPathLength+=m_nPathLength; // update total path length
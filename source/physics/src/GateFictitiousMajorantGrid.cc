@@ -0,0 +1,215 @@
+/*----------------------
+   Copyright (C): OpenGATE Collaboration
+
+This software is distributed under the terms
+of the GNU Lesser General  Public Licence (LGPL)
+See LICENSE.md for further details
+----------------------*/
+
+#include "GateFictitiousMajorantGrid.hh"
+#include "GateFictitiousVoxelMap.hh"
+#include "GateCrossSectionsTable.hh"
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+
+using namespace std;
+
+GateFictitiousMajorantGrid::GateFictitiousMajorantGrid ( const GateFictitiousVoxelMap* voxelMap, const GateCrossSectionsTable* table, G4int cellSize )
+		: pMaxCrossSection ( table->GetMaxCrossSectionVector() ),m_nCellSize ( cellSize )
+{
+	// One label per material of the map
+	GateVGeometryVoxelReader* reader=voxelMap->GetGeometryVoxelReader();
+	const G4int vnx=voxelMap->GetNx();
+	const G4int vny=voxelMap->GetNy();
+	const G4int vnz=voxelMap->GetNz();
+	map<const G4Material*,G4int> labelOfMaterial;
+	vector<G4int> labelOfVoxel ( vnx*vny*vnz );
+	for ( G4int k=0;k<vnz;k++ )
+		for ( G4int j=0;j<vny;j++ )
+			for ( G4int i=0;i<vnx;i++ )
+			{
+				const G4Material* mat=reader->GetVoxelMaterial ( i,j,k );
+				map<const G4Material*,G4int>::const_iterator it=labelOfMaterial.find ( mat );
+				G4int label;
+				if ( it==labelOfMaterial.end() )
+				{
+					label=m_oLabelCrossSection.size();
+					labelOfMaterial[mat]=label;
+					m_oLabelCrossSection.push_back ( ( *table ) ( table->GetIndex ( mat ) ) );
+				}
+				else
+					label=it->second;
+				labelOfVoxel[i+vnx* ( j+vny*k )]=label;
+			}
+
+	Build ( labelOfVoxel,vnx,vny,vnz,voxelMap->GetVoxelDim() );
+	m_nHalfContainerDim=voxelMap->GetHalfContainerDim();
+}
+
+
+GateFictitiousMajorantGrid::GateFictitiousMajorantGrid ( const vector<G4int>& labelOfVoxel, G4int nx, G4int ny, G4int nz, const G4ThreeVector& voxelDim,
+                                                         const vector<const G4PhysicsVector*>& crossSectionOfLabel, const G4PhysicsVector* maxCrossSection, G4int cellSize )
+		: m_oLabelCrossSection ( crossSectionOfLabel ),pMaxCrossSection ( maxCrossSection ),m_nCellSize ( cellSize )
+{
+	Build ( labelOfVoxel,nx,ny,nz,voxelDim );
+}
+
+
+void GateFictitiousMajorantGrid::Build ( const vector<G4int>& labelOfVoxel, G4int vnx, G4int vny, G4int vnz, const G4ThreeVector& voxelDim )
+{
+	if ( m_nCellSize<=0 )
+		G4Exception ( "GateFictitiousMajorantGrid::GateFictitiousMajorantGrid", "Cell size too small", FatalException,
+		              "The number of voxels per cell must be positive!" );
+
+	m_nNx= ( vnx+m_nCellSize-1 ) /m_nCellSize;
+	m_nNy= ( vny+m_nCellSize-1 ) /m_nCellSize;
+	m_nNz= ( vnz+m_nCellSize-1 ) /m_nCellSize;
+	m_nCellDim=voxelDim*m_nCellSize;
+	m_nHalfContainerDim=G4ThreeVector ( vnx*voxelDim.x(),vny*voxelDim.y(),vnz*voxelDim.z() ) /2.;
+
+	// Labels of each cell, including the voxels adjacent to the cell
+	map<vector<G4int>,G4int> sets;
+	m_oCellSet.resize ( m_nNx*m_nNy*m_nNz );
+	vector<G4int> labels;
+	for ( G4int k=0;k<m_nNz;k++ )
+		for ( G4int j=0;j<m_nNy;j++ )
+			for ( G4int i=0;i<m_nNx;i++ )
+			{
+				labels.clear();
+				for ( G4int vk=max ( k*m_nCellSize-1,0 );vk<=min ( ( k+1 ) *m_nCellSize,vnz-1 );vk++ )
+					for ( G4int vj=max ( j*m_nCellSize-1,0 );vj<=min ( ( j+1 ) *m_nCellSize,vny-1 );vj++ )
+						for ( G4int vi=max ( i*m_nCellSize-1,0 );vi<=min ( ( i+1 ) *m_nCellSize,vnx-1 );vi++ )
+						{
+							const G4int label=labelOfVoxel[vi+vnx* ( vj+vny*vk )];
+							if ( find ( labels.begin(),labels.end(),label ) ==labels.end() )
+								labels.push_back ( label );
+						}
+				sort ( labels.begin(),labels.end() );
+				map<vector<G4int>,G4int>::const_iterator it=sets.find ( labels );
+				G4int set;
+				if ( it==sets.end() )
+				{
+					set=m_oSetLabels.size();
+					sets[labels]=set;
+					m_oSetLabels.push_back ( labels );
+				}
+				else
+					set=it->second;
+				m_oCellSet[i+m_nNx* ( j+m_nNy*k )]=set;
+			}
+
+	m_oSetEnergy.assign ( m_oSetLabels.size(),-1. );
+	m_oSetMajorant.assign ( m_oSetLabels.size(),0. );
+
+#ifdef G4VERBOSE
+	G4cout << "GateFictitiousMajorantGrid: "<< m_nNx << "x" << m_nNy << "x" << m_nNz << " cells of "<< m_nCellSize << " voxels, "
+	       << m_oSetLabels.size() << " different sets of materials\n";
+#endif
+}
+
+
+GateFictitiousMajorantGrid::~GateFictitiousMajorantGrid()
+{
+}
+
+
+G4double GateFictitiousMajorantGrid::GetMajorant ( G4int cell, G4double energy ) const
+{
+	const G4int set=m_oCellSet[cell];
+	if ( m_oSetEnergy[set]!=energy ) // the energy only changes at real interactions
+	{
+		const vector<G4int>& labels=m_oSetLabels[set];
+		bool NotUsedAnyMoreIsOutOfRange;
+		G4double b=0.;
+		for ( size_t i=0;i<labels.size();i++ )
+			b=max ( b,m_oLabelCrossSection[labels[i]]->GetValue ( energy,NotUsedAnyMoreIsOutOfRange ) );
+		m_oSetEnergy[set]=energy;
+		m_oSetMajorant[set]=b;
+	}
+	return m_oSetMajorant[set];
+}
+
+
+G4double GateFictitiousMajorantGrid::SampleDistance ( const G4ThreeVector& pos, const G4ThreeVector& dir, G4double maxDistance, G4double energy, G4double& invMajorant ) const
+{
+	// Number of mean free paths to the next interaction, consumed cell by cell
+	// (3D DDA traversal of the cells)
+	G4double tau=-log ( G4UniformRand() );
+
+	const G4int n[3]={m_nNx,m_nNy,m_nNz};
+	G4int cell[3], step[3];
+	G4double tMax[3], tDelta[3];
+	for ( G4int a=0;a<3;a++ )
+	{
+		const G4double u=pos[a]+m_nHalfContainerDim[a];
+		cell[a]=static_cast<G4int> ( floor ( u/m_nCellDim[a] ) );
+		cell[a]=max ( 0,min ( cell[a],n[a]-1 ) ); // points on the surface
+		if ( dir[a]>0 )
+		{
+			step[a]=1;
+			tMax[a]=max ( ( ( cell[a]+1 ) *m_nCellDim[a]-u ) /dir[a],0. );
+			tDelta[a]=m_nCellDim[a]/dir[a];
+		}
+		else if ( dir[a]<0 )
+		{
+			step[a]=-1;
+			tMax[a]=max ( ( cell[a]*m_nCellDim[a]-u ) /dir[a],0. );
+			tDelta[a]=-m_nCellDim[a]/dir[a];
+		}
+		else
+		{
+			step[a]=0;
+			tMax[a]=DBL_MAX;
+			tDelta[a]=DBL_MAX;
+		}
+	}
+
+	G4double t=0.;
+	bool inside=true;
+	while ( t<maxDistance )
+	{
+		G4int axis=0;
+		if ( tMax[1]<tMax[axis] ) axis=1;
+		if ( tMax[2]<tMax[axis] ) axis=2;
+
+		// outside of the grid (only within the surface tolerance of the
+		// envelope): global majorant
+		G4double majorant;
+		G4double end;
+		if ( inside )
+		{
+			majorant=GetMajorant ( cell[0]+m_nNx* ( cell[1]+m_nNy*cell[2] ),energy );
+			end=min ( tMax[axis],maxDistance );
+		}
+		else
+		{
+			majorant=GetMaxCrossSection ( energy );
+			end=maxDistance;
+		}
+
+		if ( majorant>0 )
+		{
+			const G4double opticalLength=majorant* ( end-t );
+			if ( tau<opticalLength )
+			{
+				invMajorant=1./majorant;
+				return t+tau*invMajorant;
+			}
+			tau-=opticalLength;
+		}
+
+		t=end;
+		if ( inside )
+		{
+			cell[axis]+=step[axis];
+			tMax[axis]+=tDelta[axis];
+			if ( ( cell[axis]<0 ) || ( cell[axis]>=n[axis] ) ) inside=false;
+		}
+	}
+	invMajorant=1./GetMaxCrossSection ( energy );
+	return maxDistance+1.*mm; // leaves the envelope before any interaction
+}
@@ -27,6 +27,7 @@ GatePETVRTSettings::GatePETVRTSettings()
 	pPhantomSD=NULL;
 	m_nFictitiousEnergy=-1;
 	m_nDiscardEnergy=-1;
+	m_nMajorantCellSize=0;
 	m_nVerbosityLevel=Verbose;
 }
 
@@ -70,6 +71,15 @@ void GatePETVRTSettings::SetDiscardEnergy ( G4double en )
 		}
 	}
 }
+void GatePETVRTSettings::SetMajorantCellSize ( G4int n )
+{
+	m_nMajorantCellSize=n;
+	if (m_nVerbosityLevel>=Verbose)
+	{
+		G4cout << "GatePETVRTSettings::SetMajorantCellSize: Set to "<< m_nMajorantCellSize << Gateendl;
+	}
+}
+
 void GatePETVRTSettings::RegisterFictitiousMap ( GateVFictitiousMap* map, bool deleteWithThis )
 {
 	if ( ( pFictitiousMap !=NULL ) && ( m_nDeleteFictitiousMap ) )
@@ -0,0 +1,158 @@
+/*----------------------
+  Copyright (C): OpenGATE Collaboration
+
+  This software is distributed under the terms
+  of the GNU Lesser General  Public Licence (LGPL)
+  See LICENSE.md for further details
+  ----------------------*/
+
+#include "GatePhaseSpacePrefetcher.hh"
+#include "GateMessageManager.hh"
+
+#include <chrono>
+#include <exception>
+
+//-----------------------------------------------------------------------------
+GatePhaseSpacePrefetcher::GatePhaseSpacePrefetcher(ReadFunction read, G4long nbEntries,
+                                                   G4int blockSize, G4int maxQueuedBlocks)
+  : mRead(read)
+  , mNumberOfEntries(nbEntries)
+  , mBlockSize(blockSize > 0 ? blockSize : 1)
+  , mMaxQueuedBlocks(maxQueuedBlocks > 0 ? maxQueuedBlocks : 1)
+  , mPosition(0)
+  , mExpectedEntry(0)
+  , mWaitingTime(0.)
+  , mNextEntry(0)
+  , mGeneration(0)
+  , mStop(false)
+{
+  if (mNumberOfEntries <= 0) GateError("GatePhaseSpacePrefetcher: the phase space is empty.");
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+GatePhaseSpacePrefetcher::~GatePhaseSpacePrefetcher()
+{
+  Stop();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePhaseSpacePrefetcher::Start(G4long first)
+{
+  Stop();
+  mStop = false;
+  mError = "";
+  mCurrentBlock.clear();
+  mPosition = 0;
+  mExpectedEntry = first;
+  mNextEntry = first;
+  mThread = std::thread(&GatePhaseSpacePrefetcher::ReadBlocks, this);
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePhaseSpacePrefetcher::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+  if (mThread.joinable()) mThread.join();
+  mQueue.clear();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePhaseSpacePrefetcher::Restart(G4long first)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // the block being read by the thread is discarded when it is done
+    mGeneration++;
+    mNextEntry = first;
+    while (!mQueue.empty()) {
+      mFreeBlocks.push_back(std::vector<GatePhaseSpaceEntry>());
+      mFreeBlocks.back().swap(mQueue.front());
+      mQueue.pop_front();
+    }
+  }
+  mCondition.notify_all();
+  mPosition = mCurrentBlock.size();
+  mExpectedEntry = first;
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePhaseSpacePrefetcher::NextBlock()
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this] { return !mQueue.empty() || !mError.empty(); });
+    if (mQueue.empty()) GateError("Cannot read the phase space: " << mError);
+    if (!mCurrentBlock.empty()) {
+      mFreeBlocks.push_back(std::vector<GatePhaseSpaceEntry>());
+      mFreeBlocks.back().swap(mCurrentBlock);
+    }
+    mCurrentBlock.swap(mQueue.front());
+    mQueue.pop_front();
+  }
+  mCondition.notify_all();
+  mPosition = 0;
+  mWaitingTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+//-----------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------
+void GatePhaseSpacePrefetcher::ReadBlocks()
+{
+  std::vector<GatePhaseSpaceEntry> block;
+  while (true) {
+    G4long first;
+    G4long generation;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this] { return mStop || (G4int)mQueue.size() < mMaxQueuedBlocks; });
+      if (mStop) break;
+      first = mNextEntry;
+      generation = mGeneration;
+      mNextEntry = (first + mBlockSize) % mNumberOfEntries;
+      if (block.empty() && !mFreeBlocks.empty()) {
+        block.swap(mFreeBlocks.back());
+        mFreeBlocks.pop_back();
+      }
+    }
+
+    block.resize(mBlockSize);
+    try {
+      G4long entry = first;
+      for (G4int k = 0; k < mBlockSize; k++) {
+        mRead(entry, block[k]);
+        if (++entry >= mNumberOfEntries) entry = 0;
+      }
+    }
+    catch (std::exception & e) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mError = e.what();
+      mCondition.notify_all();
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (generation != mGeneration) continue; // restarted meanwhile: read again
+      mQueue.push_back(std::vector<GatePhaseSpaceEntry>());
+      mQueue.back().swap(block);
+    }
+    mCondition.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
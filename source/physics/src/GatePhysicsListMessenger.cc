@@ -59,6 +59,7 @@ GatePhysicsListMessenger::~GatePhysicsListMessenger()
   delete pMuHandlerSetENumber;
   delete pMuHandlerSetAtomicShellEMin;
   delete pMuHandlerSetPrecision;
+  delete pMuHandlerSetCacheDirectory;
 
   delete pAddAtomDeexcitation;
   delete pAddPhysicsList;
@@ -243,6 +244,11 @@ void GatePhysicsListMessenger::BuildCommands(G4String base)
   guidance = "Set precision to be reached in %";
   pMuHandlerSetPrecision->SetGuidance(guidance);
 
+  bb = base+"/MuHandler/setCacheDirectory";
+  pMuHandlerSetCacheDirectory = new G4UIcmdWithAString(bb,this);
+  guidance = "Set the directory where the mu/muen tables are cached (reused for the same materials, database, energies and physics)";
+  pMuHandlerSetCacheDirectory->SetGuidance(guidance);
+
   bb = base+"/addAtomDeexcitation";
   pAddAtomDeexcitation = new G4UIcommand(bb,this);
   guidance = "Add atom deexcitation into the energy loss table manager";
@@ -444,6 +450,10 @@ void GatePhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String param)
     nMuHandler->SetPrecision(val);
     GateMessage("Physic", 1, "(MuHandler Options) Precision set to "<<val<<". Precision defaut Value: 0.01\n");
   }
+  if(command == pMuHandlerSetCacheDirectory){
+    nMuHandler->SetCacheDirectory(param);
+    GateMessage("Physic", 1, "(MuHandler Options) Cache directory set to "<<param<<". No cache by default.\n");
+  }
 
   if (command == pAddAtomDeexcitation) {
     pPhylist->AddAtomDeexcitation();
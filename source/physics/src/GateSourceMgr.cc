@@ -25,6 +25,7 @@
 #include "GateRTPhantomMgr.hh"
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include "GateActions.hh"
 #include "G4RunManager.hh"
 #include "GateSourceOfPromptGamma.hh"
@@ -33,6 +34,11 @@
 
 //----------------------------------------------------------------------------------------
 GateSourceMgr* GateSourceMgr::mInstance = 0;
+#ifdef GATE_USE_MT
+G4ThreadLocal G4double GateSourceMgr::mThreadTime = 0;
+G4ThreadLocal G4int GateSourceMgr::mThreadCurrentSourceID = -1;
+G4ThreadLocal GateVSourceVector * GateSourceMgr::mThreadCurrentSources = 0;
+#endif
 
 //----------------------------------------------------------------------------------------
 GateSourceMgr::GateSourceMgr()
@@ -52,6 +58,7 @@ GateSourceMgr::GateSourceMgr()
   m_currentSourceID = -1;
   mTotalIntensity=0.;
   m_launchLastBuffer = false;
+  mSourceQueueNeedsUpdate = true;
 }
 //----------------------------------------------------------------------------------------
 
@@ -74,6 +81,7 @@ GateSourceMgr::~GateSourceMgr()
 G4int GateSourceMgr::AddSource( GateVSource* pSource )
 {
   mSources.push_back( pSource );
+  mSourceQueueNeedsUpdate = true;
   return 0;
 }
 //----------------------------------------------------------------------------------------
@@ -83,6 +91,7 @@ G4int GateSourceMgr::AddSource( GateVSource* pSource )
 G4int GateSourceMgr::RemoveSource( G4String name )
 {
   G4int found = 0;
+  mSourceQueueNeedsUpdate = true;
   if( name == G4String( "all" ) )
     {
       for( size_t is = 0; is != mSources.size(); ++is )//Use an iterator??
@@ -243,6 +252,7 @@ G4int GateSourceMgr::AddSource( std::vector<G4String> sourceVec )
       }
 
     mSources.push_back( source );
+    mSourceQueueNeedsUpdate = true;
     m_sourceProgressiveNumber++;
   }
   else
@@ -314,38 +324,60 @@ GateVSource* GateSourceMgr::GetNextSource()
 
   G4double aTime;
 
+  if( mSourceQueueNeedsUpdate ) UpdateSourceQueue();
+
   if (IsTotalAmountOfPrimariesModeEnabled()) {
-    G4double randNumber = G4UniformRand()*mTotalIntensity;
-    G4double sumIntensity=0.;
-    G4int currentSourceNumber = 0;
-    while ( (currentSourceNumber<(int)mSources.size()) && (sumIntensity<=randNumber)){
-      pFirstSource = mSources[ currentSourceNumber ];
-      sumIntensity += pFirstSource->GetIntensity();
-      currentSourceNumber++;
-    }
+    // source chosen according to its relative intensity
+    pFirstSource = mSources[ mSourceIntensityTable.Sample() ];
 
     m_firstTime = GateApplicationMgr::GetInstance()->GetTimeStepInTotalAmountOfPrimariesMode();
   }
   else {
     // if there is at least one source
     // make a competition among all the available sources
-    // the source that proposes the shortest interval for the next event wins
-    GateVSourceVector::iterator itr;
-    for( itr = mSources.begin(); itr != mSources.end(); ++itr )
+    // the source that proposes the shortest interval for the next event wins.
+    // The intervals of the sources with a constant activity are exponential:
+    // the time sampled at a previous event is still valid (memoryless
+    // property), the first one is at the top of the queue.
+    G4bool firstIsQueued = false;
+    if( !mSourceQueue.empty() )
       {
-        aTime = (*itr)->GetNextTime( m_time ); // compute random time for this source
+        m_firstTime = mSourceQueue.front().time - m_time;
+        pFirstSource = mSources[ mSourceQueue.front().index ];
+        firstIsQueued = true;
         if( mVerboseLevel > 1 )
           G4cout << "GateSourceMgr::GetNextSource : source "
-                 << (*itr)->GetName()
+                 << pFirstSource->GetName()
+                 << "    Next time (s) : " << m_firstTime/s
+                 << " (queued)\n";
+      }
+
+    for( size_t i = 0; i < mTimeDependentSources.size(); ++i )
+      {
+        GateVSource* source = mSources[ mTimeDependentSources[i] ];
+        aTime = source->GetNextTime( m_time ); // compute random time for this source
+        if( mVerboseLevel > 1 )
+          G4cout << "GateSourceMgr::GetNextSource : source "
+                 << source->GetName()
                  << "    Next time (s) : " << aTime/s
                  << "   m_firstTime (s) : " << m_firstTime/s << Gateendl;
 
         if( m_firstTime < 0. || ( aTime < m_firstTime ) )
           {
             m_firstTime = aTime;
-            pFirstSource = *itr;
+            pFirstSource = source;
+            firstIsQueued = false;
           }
       }
+
+    // The queued source emits: sample its following event
+    if( firstIsQueued )
+      {
+        std::pop_heap( mSourceQueue.begin(), mSourceQueue.end(), SourceNextTimeIsLater );
+        G4double eventTime = m_time + m_firstTime;
+        mSourceQueue.back().time = eventTime + pFirstSource->GetNextTime( eventTime );
+        std::push_heap( mSourceQueue.begin(), mSourceQueue.end(), SourceNextTimeIsLater );
+      }
   }
 
   m_currentSourceID = pFirstSource->GetSourceID(); /* PY Descourt 08/09/2009 */
@@ -355,6 +387,45 @@ GateVSource* GateSourceMgr::GetNextSource()
 //----------------------------------------------------------------------------------------
 
 
+//----------------------------------------------------------------------------------------
+void GateSourceMgr::UpdateSourceQueue()
+{
+  mSourceQueueNeedsUpdate = false;
+  mSourceQueue.clear();
+  mTimeDependentSources.clear();
+
+  if (IsTotalAmountOfPrimariesModeEnabled()) {
+    std::vector<G4double> intensities( mSources.size() );
+    for( size_t i = 0; i < mSources.size(); ++i )
+      intensities[i] = mSources[i]->GetIntensity();
+    mSourceIntensityTable.Build( intensities );
+    if( mSourceIntensityTable.IsEmpty() )
+      GateError( "GateSourceMgr::UpdateSourceQueue : the total intensity of the sources is null" );
+    return;
+  }
+
+  for( size_t i = 0; i < mSources.size(); ++i )
+    {
+      if( mSources[i]->IsActivityConstant( m_time ) )
+        {
+          GateSourceNextTime next;
+          next.time = m_time + mSources[i]->GetNextTime( m_time );
+          next.index = i;
+          mSourceQueue.push_back( next );
+        }
+      else
+        mTimeDependentSources.push_back( i );
+    }
+  std::make_heap( mSourceQueue.begin(), mSourceQueue.end(), SourceNextTimeIsLater );
+
+  if( mVerboseLevel > 0 )
+    G4cout << "GateSourceMgr::UpdateSourceQueue : " << mSourceQueue.size()
+           << " source(s) with a constant activity, "
+           << mTimeDependentSources.size() << " sampled at each event\n";
+}
+//----------------------------------------------------------------------------------------
+
+
 //----------------------------------------------------------------------------------------
 void GateSourceMgr::ListSources()
 {
@@ -500,6 +571,8 @@ G4int GateSourceMgr::PrepareNextRun( const G4Run* r)
   // Update the sources (for example for new positioning according to the geometry movements)
   for(GateVSourceVector::iterator itr = mSources.begin(); itr != mSources.end(); ++itr )
     (*itr)->Update(m_time);
+  // the activities may have changed, and the time restarts from the clock
+  mSourceQueueNeedsUpdate = true;
 
 
 //  m_runNumber++;
@@ -536,7 +609,7 @@ G4int GateSourceMgr::PrepareNextEvent( G4Event* event )
   // GateDebugMessage("Acquisition", 0, "PrepareNextEvent "  << event->GetEventID()
   //                    << " at time " << m_time/s << " sec.\n");
 
-  GateSteppingAction* myAction = (GateSteppingAction *) ( GateRunManager::GetRunManager()->GetUserSteppingAction() );
+  GateSteppingAction* myAction = GateSteppingAction::GetSteppingAction();
   TrackingMode theMode =myAction->GetMode();
   m_currentSources.clear();
 
@@ -627,6 +700,19 @@ G4int GateSourceMgr::PrepareNextEvent( G4Event* event )
 //----------------------------------------------------------------------------------------
 
 
+#ifdef GATE_USE_MT
+//----------------------------------------------------------------------------------------
+void GateSourceMgr::SaveEventStateOfThisThread()
+{
+  if (!mThreadCurrentSources) mThreadCurrentSources = new GateVSourceVector;
+  *mThreadCurrentSources = m_currentSources;
+  mThreadCurrentSourceID = m_currentSourceID;
+  mThreadTime = m_time;
+}
+//----------------------------------------------------------------------------------------
+#endif
+
+
 //----------------------------------------------------------------------------------------
 /*void GateSourceMgr::SetTimeSlice(G4double time)
   {
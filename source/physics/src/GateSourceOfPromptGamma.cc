@@ -163,7 +163,7 @@ G4int GateSourceOfPromptGamma::GeneratePrimaries(G4Event* event)
   //  TerminateEvenloop seems to have no effect.
   //  if(event->GetEventID()>nrGammaPrim){
   //      GateRunManager::GetRunManager()->AbortRun();
-  //      GateRunManager::GetRunManager()->AbortEvent();
+  //      G4RunManager::GetRunManager()->AbortEvent();
   //      GateRunManager::GetRunManager()->TerminateEventLoop();
   //      return 0;
   //  }
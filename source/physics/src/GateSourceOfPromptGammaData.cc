@@ -13,11 +13,17 @@
 #include "Randomize.hh" // needed for G4UniformRand
 #include "G4Gamma.hh"
 #include "GateRandomEngine.hh"
+#include "GateParallelFor.hh"
+
+#include <algorithm>
 
 //------------------------------------------------------------------------
 GateSourceOfPromptGammaData::GateSourceOfPromptGammaData()
 {
-    computesum = 0;
+  computesum = 0;
+  mCurrentVoxel = -1;
+  mEnergyMin = 0.0;
+  mEnergyStep = 0.0;
 }
 //------------------------------------------------------------------------
 
@@ -25,11 +31,6 @@ GateSourceOfPromptGammaData::GateSourceOfPromptGammaData()
 //------------------------------------------------------------------------
 GateSourceOfPromptGammaData::~GateSourceOfPromptGammaData()
 {
-  for(unsigned int i=0; i< mPositionYGen.size(); i++)
-    delete mPositionYGen[i];
-  for(unsigned int i=0; i< mPositionZGen.size(); i++)
-    for(unsigned int j=0; i< mPositionZGen[i].size(); j++)
-      delete mPositionZGen[i][j];
 }
 //------------------------------------------------------------------------
 
@@ -46,83 +47,100 @@ void GateSourceOfPromptGammaData::LoadData(std::string mFilename)
 //------------------------------------------------------------------------
 void GateSourceOfPromptGammaData::Initialize()
 {
-  unsigned int sizeX = mImage->GetResolution().x();
-  unsigned int sizeY = mImage->GetResolution().y();
-  unsigned int sizeZ = mImage->GetResolution().z();
-  unsigned int nbOfBins = mImage->GetNbOfBins();
-  unsigned long nbOfValues = sizeX*sizeY*sizeZ;
-
-  // Random generators for position: set sizes
-  mPositionYGen.resize(sizeX);
-  mPositionZGen.resize(sizeX);
-  for(unsigned int i=0; i<sizeX; i++) {
-    mPositionZGen[i].resize(sizeY);
-  }
-
-  // Build the scalar image with total number of counts at each pixel
-  mImage->ComputeTotalOfCountsImageDataFloat(mDataCounts);
-  computesum = mImage->ComputeSum();
-
-  // Initialize random generator for position. Loop over the total
-  // count scalar image (mDataCounts)
-  mPositionXGen.SetXBias(G4ThreeVector(0., 0., 0.)); // important
-  for(unsigned int i=0; i<sizeX; i++) {
-    double sumYZ = 0.0;
-    mPositionYGen[i] = new G4SPSRandomGenerator;
-    mPositionYGen[i]->SetYBias(G4ThreeVector(0., 0., 0.)); // important
-    for(unsigned int j=0; j<sizeY; j++) {
-      double sumZ = 0.0;
-      mPositionZGen[i][j] = new G4SPSRandomGenerator;
-      mPositionZGen[i][j]->SetZBias(G4ThreeVector(0., 0., 0.)); // important
-      for(unsigned int k=0; k<sizeZ; k++) {
-        double val = mDataCounts[mImage->GetIndexFromPixelIndex(i, j, k)];
-        sumZ += val;
-        // Bias the Z component according to the voxel value
-        mPositionZGen[i][j]->SetZBias(G4ThreeVector(k+1 ,val,0.));
+  const unsigned int sizeX = mImage->GetResolution().x();
+  const unsigned int sizeY = mImage->GetResolution().y();
+  const unsigned int sizeZ = mImage->GetResolution().z();
+  const unsigned int nbOfBins = mImage->GetNbOfBins();
+  const unsigned long sizePlane = (unsigned long)sizeX*sizeY;
+  const float * data = mImage->GetDataFloatPointer();
+
+  // The slices (along Z) are processed in parallel, in two passes: the
+  // first one counts the non zero voxels and bins of each slice, the
+  // second one fills the tables at the offsets of the slice.
+  std::vector<unsigned long> nbVoxelsOfSlice(sizeZ+1, 0);
+  std::vector<unsigned long> nbBinsOfSlice(sizeZ+1, 0);
+  std::vector<double> sumOfSlice(sizeZ, 0.0);
+  GateParallel::For(sizeZ, [&](unsigned int, size_t k) {
+      const float * d = data + k*sizePlane*nbOfBins;
+      double sum = 0.0;
+      for(unsigned long p=0; p<sizePlane; p++, d+=nbOfBins) {
+        float total = 0.0;
+        unsigned int nbNonZero = 0;
+        for(unsigned int l=0; l<nbOfBins; l++) {
+          total += d[l];
+          sum += d[l];
+          if (d[l] > 0) nbNonZero++;
+        }
+        if (total > 0) {
+          nbVoxelsOfSlice[k]++;
+          nbBinsOfSlice[k] += nbNonZero;
+        }
       }
-      sumYZ += sumZ;
-      // Bias the Y component according to integration over Z
-      mPositionYGen[i]->SetYBias(G4ThreeVector(j+1, sumZ,0.));
-    }
-    // Bias the X component according to integration over YZ plane
-    mPositionXGen.SetXBias(G4ThreeVector(i+1, sumYZ,0.));
+      sumOfSlice[k] = sum;
+    });
+
+  // Offsets of the slices (exclusive prefix sums)
+  unsigned long nbVoxels = 0;
+  unsigned long nbBins = 0;
+  computesum = 0.0;
+  for(unsigned int k=0; k<=sizeZ; k++) {
+    const unsigned long v = nbVoxelsOfSlice[k];
+    const unsigned long b = nbBinsOfSlice[k];
+    nbVoxelsOfSlice[k] = nbVoxels;
+    nbBinsOfSlice[k] = nbBins;
+    nbVoxels += v;
+    nbBins += b;
+    if (k<sizeZ) computesum += sumOfSlice[k];
+  }
+  if (nbVoxels == 0) {
+    GateError("The prompt gamma distribution is empty (all voxels have a null yield).");
   }
 
-  // Initialize energy.
-  mEnergyGen.resize(nbOfValues);
-  double energyStep  = (mImage->GetMaxValue()-mImage->GetMinValue())/nbOfBins;
-  double energy = 0.0;
-  long index_image = 0;
-  long index_data = 0;
-  float * data = mImage->GetDataFloatPointer();
-  long nbNonZero = 0;
-
-  // We only create TH1D for non zero pixel.
-  for(unsigned int k=0; k<sizeZ; k++) {
-    for(unsigned int j=0; j<sizeY; j++) {
-      for(unsigned int i=0; i<sizeX; i++) {
-        if (mDataCounts[index_image] == 0) { // FIXME
-          index_data+=nbOfBins;
+  mVoxelIndices.resize(nbVoxels);
+  mEnergyOffsets.resize(nbVoxels+1);
+  mEnergyBins.resize(nbBins);
+  mEnergyCDF.resize(nbBins);
+  std::vector<double> weights(nbVoxels);
+  GateParallel::For(sizeZ, [&](unsigned int, size_t k) {
+      unsigned long v = nbVoxelsOfSlice[k];
+      unsigned long b = nbBinsOfSlice[k];
+      const float * d = data + k*sizePlane*nbOfBins;
+      for(unsigned long p=0; p<sizePlane; p++, d+=nbOfBins) {
+        // same total as in the first pass
+        float total = 0.0;
+        double sum = 0.0;
+        for(unsigned int l=0; l<nbOfBins; l++) {
+          total += d[l];
+          if (d[l] > 0) sum += d[l];
         }
-        else {
-          energy = mImage->GetMinValue();
-          mEnergyGen[index_image] = new TH1D;
-          // This is much much faster to use the constructor without
-          // param, the SetBins than using the following line with constructor :
-          // new TH1D("", "", nbOfBins, mImage->GetMinValue(), mImage->GetMaxValue());
-          TH1D * h = mEnergyGen[index_image];
-          h->SetBins(nbOfBins, mImage->GetMinValue(), mImage->GetMaxValue());
-          for(unsigned int l=0; l<nbOfBins; l++) {
-            h->Fill(energy, data[index_data]);
-            index_data++;
-            energy += energyStep;
-          }
-          nbNonZero++;
+        if (total <= 0) continue;
+        mVoxelIndices[v] = k*sizePlane + p;
+        weights[v] = total;
+        mEnergyOffsets[v] = b;
+        double cumul = 0.0;
+        for(unsigned int l=0; l<nbOfBins; l++) {
+          if (d[l] <= 0) continue;
+          cumul += d[l];
+          mEnergyBins[b] = l;
+          mEnergyCDF[b] = cumul/sum;
+          b++;
         }
-        index_image++;
+        mEnergyCDF[b-1] = 1.0; // last non zero bin, despite rounding
+        v++;
       }
-    }
-  }
+    });
+  mEnergyOffsets[nbVoxels] = nbBins;
+
+  // Random generator for position: voxel according to its total of counts
+  mVoxelGen.Build(weights);
+
+  // Energy: the spectra are binned between min and max
+  mEnergyMin = mImage->GetMinValue();
+  mEnergyStep = (mImage->GetMaxValue()-mImage->GetMinValue())/nbOfBins;
+
+  GateMessage("Beam", 1, "Prompt gamma source: " << nbVoxels << " non zero voxels out of "
+              << sizePlane*sizeZ << ", " << nbBins << " non zero bins out of "
+              << nbVoxels*nbOfBins << std::endl);
 
   // Initialize direction sampling
   G4SPSRandomGenerator * biasRndm = new G4SPSRandomGenerator;
@@ -140,20 +158,14 @@ void GateSourceOfPromptGammaData::Initialize()
 //------------------------------------------------------------------------
 void GateSourceOfPromptGammaData::SampleRandomPosition(G4ThreeVector & position)
 {
-  // Random 3D position (in pixel). If size == 1, then bug in GenRand
-  // (infinite loop), so we test and set random value [0:1]
-  double x;
-  if (mImage->GetResolution().x() == 1) x=G4UniformRand();
-  else x = mPositionXGen.GenRandX();
-  int i =  mCurrentIndex_i = floor(x);
-  double y;
-  if (mImage->GetResolution().y() == 1) y=G4UniformRand();
-  else y = mPositionYGen[i]->GenRandY();
-  int j = mCurrentIndex_j = floor(y);
-  double z;
-  if (mImage->GetResolution().z() == 1) z=G4UniformRand();
-  else  z = mPositionZGen[i][j]->GenRandZ();
-  mCurrentIndex_k = floor(z);
+  // Random voxel, then uniform position in the voxel (in pixel)
+  mCurrentVoxel = mVoxelGen.Sample();
+  const unsigned long index = mVoxelIndices[mCurrentVoxel];
+  const unsigned long sizeX = mImage->GetResolution().x();
+  const unsigned long sizeY = mImage->GetResolution().y();
+  double x = (index % sizeX) + G4UniformRand();
+  double y = ((index / sizeX) % sizeY) + G4UniformRand();
+  double z = (index / (sizeX*sizeY)) + G4UniformRand();
 
   // Offset according to image origin (and half voxel position)
   x = mImage->GetOrigin().x() + x*mImage->GetVoxelSize().x();
@@ -171,13 +183,24 @@ void GateSourceOfPromptGammaData::SampleRandomPosition(G4ThreeVector & position)
 //------------------------------------------------------------------------
 void GateSourceOfPromptGammaData::SampleRandomEnergy(double & energy)
 {
-  // Get energy spectrum in the current pixel
-  long index = mImage->GetIndexFromPixelIndex(mCurrentIndex_i, mCurrentIndex_j, mCurrentIndex_k);
-
-  if (mDataCounts[index] != 0) {
-    energy = mEnergyGen[index]->GetRandom();
+  if (mCurrentVoxel < 0) {
+    energy = 0.0;
+    return;
   }
-  else energy = 0.0;
+
+  // Non zero bin of the spectrum of the current voxel, then uniform
+  // energy in the bin (as TH1::GetRandom)
+  const float * cdf = &mEnergyCDF[0];
+  const float * first = cdf + mEnergyOffsets[mCurrentVoxel];
+  const float * last = cdf + mEnergyOffsets[mCurrentVoxel+1] - 1;
+  const double r = G4UniformRand();
+  const float * p = std::upper_bound(first, last, (float)r);
+  const double low = (p == first) ? 0.0 : *(p-1);
+  double fraction = 0.0;
+  if (*p > low) fraction = (r-low)/(*p-low);
+  if (fraction > 1.0) fraction = 1.0;
+  else if (fraction < 0.0) fraction = 0.0;
+  energy = mEnergyMin + (mEnergyBins[p-cdf] + fraction)*mEnergyStep;
 }
 //------------------------------------------------------------------------
 
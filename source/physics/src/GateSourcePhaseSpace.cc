@@ -25,6 +25,7 @@
 #include "GateIAEAHeader.h"
 #include "GateIAEARecord.h"
 #include "GateIAEAUtilities.h"
+#include "GateIAEAMappedFile.hh"
 #include "G4Gamma.hh"
 #include "G4Electron.hh"
 #include "G4Positron.hh"
@@ -93,12 +94,26 @@ GateSourcePhaseSpace::GateSourcePhaseSpace(G4String name) :
     mIsPair = false;
     mRelativeTimeFlag = false;
     mTimeIsUsed = true;
+    memset(&mEntry, 0, sizeof(mEntry));
+    mEntry.dtime = -1.;
+    mEntry.ftime = -1.;
+    mEntry.weight = 1.;
+    mEntry.w1 = mEntry.w2 = 1.;
+    pPrefetcher = nullptr;
+    mReadAheadBlockSize = 0;
+    pIAEAMappedFile = nullptr;
+    pCachedParticleDefinition = nullptr;
 }
 // ----------------------------------------------------------------------------------
 
 
 // ----------------------------------------------------------------------------------
 GateSourcePhaseSpace::~GateSourcePhaseSpace() {
+    // stop the thread before closing the files
+    delete pPrefetcher;
+    pPrefetcher = nullptr;
+    delete pIAEAMappedFile;
+    pIAEAMappedFile = nullptr;
     listOfPhaseSpaceFile.clear();
     if (pIAEAFile) fclose(pIAEAFile);
     pIAEAFile = nullptr;
@@ -153,6 +168,10 @@ void GateSourcePhaseSpace::InitializeIAEA() {
 
 // ----------------------------------------------------------------------------------
 void GateSourcePhaseSpace::InitializeROOT() {
+    delete pPrefetcher;
+    pPrefetcher = nullptr;
+    // With read-ahead, the files are read by another thread while ROOT is
+    // used by the outputs (ROOT::EnableThreadSafety is called in main)
     for (const auto &file: listOfPhaseSpaceFile) {
         GateMessage("Beam", 1, "Phase Space Source. Read file " << file << Gateendl);
         auto extension = getExtension(file);
@@ -165,7 +184,7 @@ void GateSourcePhaseSpace::InitializeROOT() {
     mNumberOfParticlesInFile = mTotalNumberOfParticles;
 
     if (mChain.has_variable("ParticleName")) {
-        mChain.read_variable("ParticleName", particleName, 64);
+        mChain.read_variable("ParticleName", mEntry.particleName, 64);
     }
 
     // switch to single particle or pairs
@@ -180,23 +199,23 @@ void GateSourcePhaseSpace::InitializeROOT() {
 // ----------------------------------------------------------------------------------
 void GateSourcePhaseSpace::InitializeROOTSingle() {
     mIsPair = false;
-    mChain.read_variable("Ekine", &energy);
-    mChain.read_variable("X", &x);
-    mChain.read_variable("Y", &y);
-    mChain.read_variable("Z", &z);
-    mChain.read_variable("dX", &dx);
-    mChain.read_variable("dY", &dy);
-    mChain.read_variable("dZ", &dz);
+    mChain.read_variable("Ekine", &mEntry.energy);
+    mChain.read_variable("X", &mEntry.x);
+    mChain.read_variable("Y", &mEntry.y);
+    mChain.read_variable("Z", &mEntry.z);
+    mChain.read_variable("dX", &mEntry.dx);
+    mChain.read_variable("dY", &mEntry.dy);
+    mChain.read_variable("dZ", &mEntry.dz);
 
     if (mChain.has_variable("Weight") and not mIgnoreWeight)
-        mChain.read_variable("Weight", &weight);
+        mChain.read_variable("Weight", &mEntry.weight);
 
     if (mTimeIsUsed and mChain.has_variable("Time")) {
         if (mChain.get_type_of_variable("Time") == typeid(float)) {
-            mChain.read_variable("Time", &ftime);
+            mChain.read_variable("Time", &mEntry.ftime);
             time_type = typeid(float);
         } else {
-            mChain.read_variable("Time", &dtime);
+            mChain.read_variable("Time", &mEntry.dtime);
             time_type = typeid(double);
         }
     }
@@ -211,39 +230,39 @@ void GateSourcePhaseSpace::InitializeROOTPairs() {
     mIsPair = true;
 
     //  E1 E2 X1 Y1 Z1 X2 Y2 Z2 dX1 dY1 dZ1 dX2 dY2 dZ2 t1 t2
-    mChain.read_variable("E1", &E1);
-    mChain.read_variable("E2", &E2);
+    mChain.read_variable("E1", &mEntry.E1);
+    mChain.read_variable("E2", &mEntry.E2);
 
     if (mChain.has_variable("t1") and mChain.has_variable("t2") and mTimeIsUsed) {
-        mChain.read_variable("t1", &t1);
-        mChain.read_variable("t2", &t2);
+        mChain.read_variable("t1", &mEntry.t1);
+        mChain.read_variable("t2", &mEntry.t2);
     }
     if (mTimeIsUsed and (!mChain.has_variable("t1") or !mChain.has_variable("t2"))) {
         GateError("The option 'ignoreTime' is false, but no time t1 and t2 was found in the phsp.");
     }
 
-    mChain.read_variable("X1", &X1);
-    mChain.read_variable("Y1", &Y1);
-    mChain.read_variable("Z1", &Z1);
+    mChain.read_variable("X1", &mEntry.X1);
+    mChain.read_variable("Y1", &mEntry.Y1);
+    mChain.read_variable("Z1", &mEntry.Z1);
 
-    mChain.read_variable("X2", &X2);
-    mChain.read_variable("Y2", &Y2);
-    mChain.read_variable("Z2", &Z2);
+    mChain.read_variable("X2", &mEntry.X2);
+    mChain.read_variable("Y2", &mEntry.Y2);
+    mChain.read_variable("Z2", &mEntry.Z2);
 
-    mChain.read_variable("dX1", &dX1);
-    mChain.read_variable("dY1", &dY1);
-    mChain.read_variable("dZ1", &dZ1);
+    mChain.read_variable("dX1", &mEntry.dX1);
+    mChain.read_variable("dY1", &mEntry.dY1);
+    mChain.read_variable("dZ1", &mEntry.dZ1);
 
-    mChain.read_variable("dX2", &dX2);
-    mChain.read_variable("dY2", &dY2);
-    mChain.read_variable("dZ2", &dZ2);
+    mChain.read_variable("dX2", &mEntry.dX2);
+    mChain.read_variable("dY2", &mEntry.dY2);
+    mChain.read_variable("dZ2", &mEntry.dZ2);
 
     // consider one single weight
     if (mChain.has_variable("Weight") and not mIgnoreWeight) {
-        mChain.read_variable("w1", &w1);
-        mChain.read_variable("w2", &w2);
+        mChain.read_variable("w1", &mEntry.w1);
+        mChain.read_variable("w2", &mEntry.w2);
     } else {
-        w1 = w2 = 1.0;
+        mEntry.w1 = mEntry.w2 = 1.0;
     }
 }
 // ----------------------------------------------------------------------------------
@@ -406,19 +425,32 @@ void GateSourcePhaseSpace::InitializePyTorchSingle() {
 
 // ----------------------------------------------------------------------------------
 void GateSourcePhaseSpace::GenerateROOTVertex(G4Event * /*aEvent*/ ) {
-    if (pListOfSelectedEvents.size())
-        mChain.read_entrie(pListOfSelectedEvents[mCurrentParticleNumberInFile]);
-    else mChain.read_entrie(mCurrentParticleNumberInFile);
-
-    G4ParticleTable *particleTable = G4ParticleTable::GetParticleTable();
-    pParticleDefinition = particleTable->FindParticle(particleName);
-
-    if (pParticleDefinition == 0) {
-        if (mParticleTypeNameGivenByUser != "none") {
-            pParticleDefinition = particleTable->FindParticle(mParticleTypeNameGivenByUser);
+    // Entry read ahead by the thread, or read now
+    if (mReadAheadBlockSize > 0 && !pPrefetcher) {
+        pPrefetcher = new GatePhaseSpacePrefetcher(
+            [this](G4long i, GatePhaseSpaceEntry &e) { e = ReadROOTEntry(i); },
+            mNumberOfParticlesInFile, mReadAheadBlockSize);
+        pPrefetcher->Start(mCurrentParticleNumberInFile);
+    }
+    const GatePhaseSpaceEntry &entry = pPrefetcher ?
+                                       pPrefetcher->GetEntry(mCurrentParticleNumberInFile) :
+                                       ReadROOTEntry(mCurrentParticleNumberInFile);
+    SetROOTEntry(entry);
+
+    // The particle definition is only searched when the name changes
+    if (pCachedParticleDefinition == 0 || mCachedParticleName != entry.particleName) {
+        G4ParticleTable *particleTable = G4ParticleTable::GetParticleTable();
+        pCachedParticleDefinition = particleTable->FindParticle(entry.particleName);
+
+        if (pCachedParticleDefinition == 0) {
+            if (mParticleTypeNameGivenByUser != "none") {
+                pCachedParticleDefinition = particleTable->FindParticle(mParticleTypeNameGivenByUser);
+            }
+            if (pCachedParticleDefinition == 0) GateError("No particle type defined in phase space file.");
         }
-        if (pParticleDefinition == 0) GateError("No particle type defined in phase space file.");
+        mCachedParticleName = entry.particleName;
     }
+    pParticleDefinition = pCachedParticleDefinition;
 
     if (mIsPair) GenerateROOTVertexPairs();
     else GenerateROOTVertexSingle();
@@ -426,6 +458,53 @@ void GateSourcePhaseSpace::GenerateROOTVertex(G4Event * /*aEvent*/ ) {
 // ----------------------------------------------------------------------------------
 
 
+// ----------------------------------------------------------------------------------
+const GatePhaseSpaceEntry &GateSourcePhaseSpace::ReadROOTEntry(G4long i) {
+    if (pListOfSelectedEvents.size())
+        mChain.read_entrie(pListOfSelectedEvents[i]);
+    else mChain.read_entrie(i);
+    return mEntry;
+}
+// ----------------------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------------------
+void GateSourcePhaseSpace::SetROOTEntry(const GatePhaseSpaceEntry &e) {
+    if (mIsPair) {
+        E1 = e.E1;
+        E2 = e.E2;
+        X1 = e.X1;
+        Y1 = e.Y1;
+        Z1 = e.Z1;
+        X2 = e.X2;
+        Y2 = e.Y2;
+        Z2 = e.Z2;
+        dX1 = e.dX1;
+        dY1 = e.dY1;
+        dZ1 = e.dZ1;
+        dX2 = e.dX2;
+        dY2 = e.dY2;
+        dZ2 = e.dZ2;
+        t1 = e.t1;
+        t2 = e.t2;
+        w1 = e.w1;
+        w2 = e.w2;
+    } else {
+        energy = e.energy;
+        x = e.x;
+        y = e.y;
+        z = e.z;
+        dx = e.dx;
+        dy = e.dy;
+        dz = e.dz;
+        ftime = e.ftime;
+        dtime = e.dtime;
+        weight = e.weight;
+    }
+}
+// ----------------------------------------------------------------------------------
+
+
 // ----------------------------------------------------------------------------------
 void GateSourcePhaseSpace::GenerateROOTVertexSingle() {
     mParticlePosition = G4ThreeVector(x * mm, y * mm, z * mm);
@@ -584,9 +663,19 @@ void GateSourcePhaseSpace::GeneratePyTorchVertexSingle(G4Event * /*aEvent*/ ) {
 // ----------------------------------------------------------------------------------
 
 
+// ----------------------------------------------------------------------------------
+void GateSourcePhaseSpace::ReadIAEAParticle() {
+    if (pIAEAMappedFile && pIAEAMappedFile->IsOpen()) {
+        if (!pIAEAMappedFile->ReadParticle(pIAEARecordType))
+            GateError("Cannot read a particle in the IAEA phase space: end of the file.");
+    } else pIAEARecordType->read_particle();
+}
+// ----------------------------------------------------------------------------------
+
+
 // ----------------------------------------------------------------------------------
 void GateSourcePhaseSpace::GenerateIAEAVertex(G4Event * /*aEvent*/ ) {
-    pIAEARecordType->read_particle();
+    ReadIAEAParticle();
 
     switch (pIAEARecordType->particle) {
         case 1:
@@ -670,7 +759,7 @@ G4int GateSourcePhaseSpace::GeneratePrimaries(G4Event *event) {
             }
             if (pListOfSelectedEvents.size()) {
                 while (pListOfSelectedEvents[mCurrentUsedParticleInIAEAFiles] > mCurrentParticleInIAEAFiles) {
-                    if (!mAlreadyLoad) pIAEARecordType->read_particle();
+                    if (!mAlreadyLoad) ReadIAEAParticle();
 
                     mAlreadyLoad = false;
                     mCurrentParticleInIAEAFiles++;
@@ -850,6 +939,8 @@ void GateSourcePhaseSpace::AddFile(G4String file) {
             mFileType = "root";
         if (extension == "npy")
             mFileType = "root";
+        if (extension == "gtc")
+            mFileType = "root";
     }
 
     if ((extension == "IAEAphsp" || extension == "IAEAheader")) {
@@ -863,10 +954,10 @@ void GateSourcePhaseSpace::AddFile(G4String file) {
     }
 
     if (extension != "IAEAphsp" && extension != "IAEAheader" &&
-        extension != "npy" && extension != "root" && extension != "pt")
+        extension != "npy" && extension != "gtc" && extension != "root" && extension != "pt")
         GateError("Unknow phase space file extension. Knowns extensions are : "
                       << Gateendl
-                      << ".IAEAphsp (or IAEAheader) .root .npy .pt (pytorch) \n");
+                      << ".IAEAphsp (or IAEAheader) .root .npy .gtc .pt (pytorch) \n");
 
     listOfPhaseSpaceFile.push_back(file);
 }
@@ -958,6 +1049,12 @@ G4int GateSourcePhaseSpace::OpenIAEAFile(G4String file) {
     pIAEARecordType->initialize();
     pIAEAheader->get_record_contents(pIAEARecordType);
 
+    // Particles decoded from the memory-mapped file (fread otherwise)
+    if (!pIAEAMappedFile) pIAEAMappedFile = new GateIAEAMappedFile;
+    if (!pIAEAMappedFile->Open(IAEAFileName + IAEAFileExt, pIAEARecordType, pIAEAheader->record_length))
+        GateMessage("Beam", 1, "Phase Space Source. Cannot map " << IAEAFileName << IAEAFileExt
+                                                                 << " in memory, read with fread" << Gateendl);
+
     return pIAEAheader->nParticles;
 }
 // ----------------------------------------------------------------------------------
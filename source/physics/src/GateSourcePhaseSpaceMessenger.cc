@@ -74,6 +74,12 @@ GateSourcePhaseSpaceMessenger::GateSourcePhaseSpaceMessenger(GateSourcePhaseSpac
     setPytorchBatchSizeCmd = new G4UIcmdWithAnInteger(cmdName, this);
     setPytorchBatchSizeCmd->SetGuidance("set the batch size for pytorch PHSP");
 
+    cmdName = GetDirectoryName() + "setReadAheadBlockSize";
+    setReadAheadBlockSizeCmd = new G4UIcmdWithAnInteger(cmdName, this);
+    setReadAheadBlockSizeCmd->SetGuidance("Read the root/npy phase space in a background thread, by blocks of n particles (0: disabled, default)");
+    setReadAheadBlockSizeCmd->SetParameterName("n", false);
+    setReadAheadBlockSizeCmd->SetRange("n>=0");
+
     cmdName = GetDirectoryName() + "setPytorchParams";
     setPytorchParamsCmd = new G4UIcmdWithAString(cmdName, this);
     setPytorchParamsCmd->SetGuidance("set the json file associated with the .pt PHSP");
@@ -93,6 +99,7 @@ GateSourcePhaseSpaceMessenger::~GateSourcePhaseSpaceMessenger() {
     delete setUseNbParticleAsIntensityCmd;
     delete setStartIdCmd;
     delete setPytorchBatchSizeCmd;
+    delete setReadAheadBlockSizeCmd;
     delete setPytorchParamsCmd;
     delete ignoreWeightCmd;
     delete RelativeTimeCmd;
@@ -118,6 +125,8 @@ void GateSourcePhaseSpaceMessenger::SetNewValue(G4UIcommand *command, G4String n
     if (command == setPytorchBatchSizeCmd)
         pSource->SetPytorchBatchSize(setPytorchBatchSizeCmd->GetNewIntValue(newValue));
     if (command == setPytorchParamsCmd) pSource->SetPytorchParams(newValue);
+    if (command == setReadAheadBlockSizeCmd)
+        pSource->SetReadAheadBlockSize(setReadAheadBlockSizeCmd->GetNewIntValue(newValue));
 
 }
 //----------------------------------------------------------------------------------------
@@ -26,6 +26,9 @@
 #include "globals.hh"
 #include "G4Event.hh"
 
+// CLHEP
+#include "CLHEP/Random/RandBinomial.h"
+
 // GATE
 #include "GateConfiguration.h"
 #include "GateRandomEngine.hh"
@@ -268,12 +271,25 @@ void GateSourceTPSPencilBeam::GenerateVertex( G4Event *aEvent ) {
       }
     }
     mDistriGeneral = new RandGeneral(engine, mPDF, mTotalNumberOfSpots, 0);
+    ComputeSpotOptics();
     if (mSortedSpotGenerationFlag){
+      // Multinomial sampling of the number of ions of each spot, spot after
+      // spot: the number of ions of a spot follows a binomial law for the
+      // ions not yet attributed, with the probability of the spot among the
+      // remaining spots. Same law as one draw of mDistriGeneral by ion.
       mNbIonsToGenerate.resize(mTotalNumberOfSpots,0);
       long int ntotal = GateApplicationMgr::GetInstance()->GetTotalNumberOfPrimaries();
-      for (long int i = 0; i<ntotal; i++){
-        int bin = mTotalNumberOfSpots * mDistriGeneral->fire();
-        ++mNbIonsToGenerate[bin];
+      std::vector<double> remainingPDF(mTotalNumberOfSpots+1, 0.);
+      for (int i = mTotalNumberOfSpots-1; i >= 0; i--) remainingPDF[i] = remainingPDF[i+1] + mPDF[i];
+      long int nremaining = ntotal;
+      for (int i = 0; (i < mTotalNumberOfSpots) && (nremaining > 0); i++){
+        long int n = nremaining;
+        if ((i < mTotalNumberOfSpots-1) && (remainingPDF[i+1] > 0.)) {
+          double p = mPDF[i] / remainingPDF[i];
+          n = (p < 1.) ? CLHEP::RandBinomial::shoot(engine, nremaining, p) : nremaining;
+        }
+        mNbIonsToGenerate[i] = n;
+        nremaining -= n;
       }
       for (int i = 0; i < mTotalNumberOfSpots; i++) {
         GateMessage("Beam", 3, "[TPSPencilBeam] bin " << std::setw(5) << i << ": spotweight=" << std::setw(8) << mPDF[i] << ", Ngen=" << mNbIonsToGenerate[i] << Gateendl );
@@ -329,9 +345,35 @@ void GateSourceTPSPencilBeam::GenerateVertex( G4Event *aEvent ) {
 }
 //---------GENERATION - END-----------------------
 
+//------------------------------------------------------------------------------------------------------
+void GateSourceTPSPencilBeam::ComputeSpotOptics() {
+  // The spots of a layer have the same energy: the polynomials are
+  // evaluated once by layer
+  mSpotOptics.resize(mTotalNumberOfSpots);
+  for (int i = 0; i < mTotalNumberOfSpots; i++) {
+    double energy = mSpotEnergy[i];
+    SpotOptics & optics = mSpotOptics[i];
+    if ((i > 0) && (mSpotEnergy[i-1] == energy)) {
+      optics = mSpotOptics[i-1];
+      continue;
+    }
+    optics.sourceEnergy = GetEnergy(energy);
+    optics.sigmaEnergy = GetSigmaEnergy(energy);
+    if ( !mSigmaEnergyInMeVFlag ){
+      optics.sigmaEnergy *= optics.sourceEnergy/100.;
+    }
+    optics.sigmaX = GetSigmaX(energy);
+    optics.sigmaY = GetSigmaY(energy);
+    optics.sigmaTheta = GetSigmaTheta(energy);
+    optics.sigmaPhi = GetSigmaPhi(energy);
+    optics.ellipseXThetaArea = GetEllipseXThetaArea(energy);
+    optics.ellipseYPhiArea = GetEllipseYPhiArea(energy);
+  }
+}
 //------------------------------------------------------------------------------------------------------
 void GateSourceTPSPencilBeam::ConfigurePencilBeam() {
   double energy = mSpotEnergy[mCurrentSpot];
+  const SpotOptics & optics = mSpotOptics[mCurrentSpot];
   GateMessage("Beam", 5, "[TPSPencilBeam] configuring pencil beam with E= " << energy << Gateendl );
     //Particle Type
     mPencilBeam->SetParticleType(mParticleType);
@@ -340,28 +382,12 @@ void GateSourceTPSPencilBeam::ConfigurePencilBeam() {
     GateMessage("Beam", 5, "[TPSPencilBeam] configuring pencil beam with generic ion with parameters \"" << mParticleParameters << "\"" << Gateendl );
     mPencilBeam->SetIonParameter(mParticleParameters);
   }
-  //Energy
-  GateMessage("Beam", 5, "[TPSPencilBeam] configuring pencil beam with E= " << energy << Gateendl );
-  mPencilBeam->SetEnergy(GetEnergy(energy));
-  if ( mSigmaEnergyInMeVFlag ){
-    GateMessage("Beam", 5, "[TPSPencilBeam] sigma energy from polynomial in MEV" << Gateendl );
-    double sourceE = GetEnergy(energy);
-    mPencilBeam->SetEnergy(sourceE);
-    double sigmaE = GetSigmaEnergy(energy);
-    GateMessage("Beam", 5, "[TPSPencilBeam] : E=" << energy << " sourceE=" << sourceE << " sigmaE=" << sigmaE << Gateendl );
-    mPencilBeam->SetSigmaEnergy(sigmaE);
-  } else {
-    GateMessage("Beam", 5, "[TPSPencilBeam] sigma energy in PERCENT" << Gateendl );
-    double sourceE = GetEnergy(energy);
-    mPencilBeam->SetEnergy(sourceE);
-    double sigmaEPCT = GetSigmaEnergy(energy);
-    double sigmaEMEV = sigmaEPCT*sourceE/100.;
-    GateMessage("Beam", 5, "[TPSPencilBeam] : E=" << energy
-		                   << " sourceE=" << sourceE
-				   << " sigmaEPCT=" << sigmaEPCT
-				   << " sigmaEMEV=" << sigmaEMEV << Gateendl );
-    mPencilBeam->SetSigmaEnergy(sigmaEMEV);
-  }
+  //Energy (sigma energy in MeV, see ComputeSpotOptics)
+  GateMessage("Beam", 5, "[TPSPencilBeam] : E=" << energy
+                         << " sourceE=" << optics.sourceEnergy
+                         << " sigmaE=" << optics.sigmaEnergy << " MeV" << Gateendl );
+  mPencilBeam->SetEnergy(optics.sourceEnergy);
+  mPencilBeam->SetSigmaEnergy(optics.sigmaEnergy);
   //Weight
   if (mFlatGenerationFlag) {
     mPencilBeam->SetWeight(mSpotWeight[mCurrentSpot]);
@@ -370,13 +396,13 @@ void GateSourceTPSPencilBeam::ConfigurePencilBeam() {
   }
   //Position
   mPencilBeam->SetPosition(mSpotPosition[mCurrentSpot]);
-  mPencilBeam->SetSigmaX(GetSigmaX(energy));
-  mPencilBeam->SetSigmaY(GetSigmaY(energy));
+  mPencilBeam->SetSigmaX(optics.sigmaX);
+  mPencilBeam->SetSigmaY(optics.sigmaY);
   //Direction
-  mPencilBeam->SetSigmaTheta(GetSigmaTheta(energy));
-  mPencilBeam->SetEllipseXThetaArea(GetEllipseXThetaArea(energy));
-  mPencilBeam->SetSigmaPhi(GetSigmaPhi(energy));
-  mPencilBeam->SetEllipseYPhiArea(GetEllipseYPhiArea(energy));
+  mPencilBeam->SetSigmaTheta(optics.sigmaTheta);
+  mPencilBeam->SetEllipseXThetaArea(optics.ellipseXThetaArea);
+  mPencilBeam->SetSigmaPhi(optics.sigmaPhi);
+  mPencilBeam->SetEllipseYPhiArea(optics.ellipseYPhiArea);
   mPencilBeam->SetRotation(mSpotRotation[mCurrentSpot]);
   //Correlation Position/Direction
   //this parameter is not spot or energy dependent and is therefore once for all at the end of the initialization phase.
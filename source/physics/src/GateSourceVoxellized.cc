@@ -13,6 +13,7 @@
 #include "GateSourceVoxelTestReader.hh"
 #include "GateSourceVoxelImageReader.hh"
 #include "GateSourceVoxelInterfileReader.hh"
+#include "GateRTPhantomMgr.hh"
 
 //-------------------------------------------------------------------------------------------------
 GateSourceVoxellized::GateSourceVoxellized(G4String name)
@@ -56,6 +57,19 @@ G4double GateSourceVoxellized::GetNextTime(G4double timeNow)
 //-------------------------------------------------------------------------------------------------
 
 
+//-------------------------------------------------------------------------------------------------
+G4bool GateSourceVoxellized::IsActivityConstant(G4double timeNow)
+{
+  // the total activity is the one of the reader, which changes with the
+  // time activity curves and with the attached 4D phantoms
+  if (!m_voxelReader || m_voxelReader->HasTimeActivityTables()) return false;
+  if (GateRTPhantomMgr::GetInstance()->CheckSourceAttached(m_voxelReader->GetName())) return false;
+  m_activity = m_voxelReader->GetTempTotalActivity();
+  return GateVSource::IsActivityConstant(timeNow);
+}
+//-------------------------------------------------------------------------------------------------
+
+
 //-------------------------------------------------------------------------------------------------
 void GateSourceVoxellized::Dump(G4int level)
 {
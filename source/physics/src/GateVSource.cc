@@ -68,6 +68,7 @@ GateVSource::GateVSource(G4String name): m_name( name ) {
 
   m_forcedUnstableFlag  = false;
   m_forcedLifeTime      = -1.*s;
+  m_variableActivityFlag = false;
   m_materialName = "G4_AIR";
   mRelativePlacementVolumeName = "world";
   mEnableRegularActivity = false;
@@ -343,6 +344,18 @@ G4double GateVSource::GetNextTime( G4double timeStart )
 }
 //-------------------------------------------------------------------------------------------------
 
+
+//-------------------------------------------------------------------------------------------------
+G4bool GateVSource::IsActivityConstant( G4double timeStart )
+{
+  // see GetNextTime: the activity depends on the time before the start
+  // time of the source, or when it decays (forced lifetime)
+  if( m_variableActivityFlag ) return false;
+  if( m_activity <= 0. ) return true;
+  return ( timeStart >= m_startTime ) && !m_forcedUnstableFlag;
+}
+//-------------------------------------------------------------------------------------------------
+
 void GateVSource::TrigMat()
 {
 // Retrieve position according to world
@@ -451,7 +464,7 @@ G4int GateVSource::GeneratePrimaries( G4Event* event )
 
   G4int numVertices = 0;
 
-  GateSteppingAction* myAction = (GateSteppingAction *) ( GateRunManager::GetRunManager()->GetUserSteppingAction() );
+  GateSteppingAction* myAction = GateSteppingAction::GetSteppingAction();
 
   TrackingMode theMode =myAction->GetMode();
 
@@ -542,7 +555,7 @@ G4int GateVSource::GeneratePrimaries( G4Event* event )
           numVertices = 0;
           return numVertices;
         }
-      G4Run* currentRun = const_cast<G4Run*> ( GateRunManager::GetRunManager()->GetCurrentRun() );
+      G4Run* currentRun = const_cast<G4Run*> ( G4RunManager::GetRunManager()->GetCurrentRun() );
       currentRun->SetRunID( m_currentTrack->GetRunID() );
       event->SetEventID( m_currentTrack->GetEventID() );
       G4int event_id =  m_currentTrack->GetEventID();
@@ -673,7 +686,7 @@ void GateVSource::GeneratePrimaryVertex( G4Event* aEvent )
   }
 
   /* PY Descourt 08/09/2009 */
-  TrackingMode theMode =( (GateSteppingAction *)(GateRunManager::GetRunManager()->GetUserSteppingAction() ) )->GetMode();
+  TrackingMode theMode =( GateSteppingAction::GetSteppingAction() )->GetMode();
   if (  theMode == TrackingMode::kBoth || theMode == TrackingMode::kTracker )
     {
       G4ThreeVector particle_position;
@@ -36,7 +36,6 @@ GateVSourceVoxelReader::~GateVSourceVoxelReader()
   if (m_voxelTranslator) {
     delete m_voxelTranslator;
   }
-  m_sourceVoxelIntegratedActivities.clear();
 }
 //-------------------------------------------------------------------------------------------------
 
@@ -104,16 +103,13 @@ G4int GateVSourceVoxelReader::GetNextSource()
   // the method decides which is the source that has to be used for this event
 	G4int firstSource;
 
-  if (m_sourceVoxelActivities.size()==0) {
+  if (m_sourceVoxelAliasTable.IsEmpty()) {
     GateError("GateVSourceVoxelReader::GetNextSource : ERROR: No source available");
   } else {
     // if there is at least one voxel
 
     // now assign the event to one voxel, according to the relative activity
-    // integral method
-    // from STL doc: iterator upper_bound(const key_type& k)   Sorted Associative Container   Finds the first element whose key greater than k.
-    firstSource = (m_sourceVoxelIntegratedActivities.upper_bound(G4UniformRand() * m_activityTotal))->second;
-
+    firstSource = m_activeVoxels[m_sourceVoxelAliasTable.Sample()];
   }
 
   if (nVerboseLevel>1)
@@ -173,31 +169,27 @@ void GateVSourceVoxelReader::RemoveTranslator()
 //-------------------------------------------------------------------------------------------------
 void GateVSourceVoxelReader::PrepareIntegratedActivityMap()
 {
-  // erase all the elements of the old integrated activity map
-  m_sourceVoxelIntegratedActivities.clear();
-
-  // create the new integrated activity map
+  // Alias table of the active voxels, rebuilt when the activities
+  // change (time activity curves)
   m_activityTotal = 0.;
-  //GateSourceActivityMap::iterator voxel;
+  m_activeVoxels.clear();
+  m_activeVoxelActivities.clear();
   for (size_t iVoxel = 0; iVoxel < m_sourceVoxelActivities.size(); iVoxel++) {
-	  if (m_sourceVoxelActivities[iVoxel]>0.0) {
-		  m_activityTotal += m_sourceVoxelActivities[iVoxel];
-		  m_sourceVoxelIntegratedActivities[m_activityTotal] = iVoxel;
-	  }
-  }
-
-  if (nVerboseLevel>1) {
-	  GateSourceIntegratedActivityMap::iterator intVoxel;
-	  for (intVoxel = m_sourceVoxelIntegratedActivities.begin(); intVoxel != m_sourceVoxelIntegratedActivities.end(); intVoxel++) {
-		  G4int iVoxel = intVoxel->second;
-		  G4cout << "[GateVSourceVoxelReader::PrepareIntegratedActivityMap] "
-				  << "   voxel: " << GetVoxelIndices(iVoxel)
-				  << "   activity : (Bq) " << m_sourceVoxelActivities[iVoxel] / becquerel
-				  << "   integrated: (Bq) " << ((*intVoxel).first)  / becquerel
-				  << Gateendl;
+    if (m_sourceVoxelActivities[iVoxel]>0.0) {
+      m_activityTotal += m_sourceVoxelActivities[iVoxel];
+      m_activeVoxels.push_back(iVoxel);
+      m_activeVoxelActivities.push_back(m_sourceVoxelActivities[iVoxel]);
+      if (nVerboseLevel>1)
+        G4cout << "[GateVSourceVoxelReader::PrepareIntegratedActivityMap] "
+               << "   voxel: " << GetVoxelIndices(iVoxel)
+               << "   activity : (Bq) " << m_sourceVoxelActivities[iVoxel] / becquerel
+               << "   integrated: (Bq) " << m_activityTotal / becquerel
+               << Gateendl;
     }
   }
   m_tactivityTotal = m_activityTotal;  // added by I. Martinez-Rovira (immamartinez@gmail.com)
+
+  m_sourceVoxelAliasTable.Build(m_activeVoxelActivities);
 }
 //-------------------------------------------------------------------------------------------------
 